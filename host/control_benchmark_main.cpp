@@ -0,0 +1,162 @@
+/**
+* @file control_benchmark_main.cpp
+* @brief Banco de pruebas de lazo cerrado: recorre consignas, ambientes y masas térmicas para cada modo de control.
+*
+* Reemplaza a main.cpp en la compilación para host. Imprime una fila por caso con
+* tiempo de subida, sobrepaso, error estacionario, ondulación, conmutaciones del relé
+* y energía; termina con código 1 si algún caso supera los límites de aceptación (más
+* estrictos para los modos PID: error en décimas de grado y ondulación acotada).
+*
+* Compilación (desde la raíz del repositorio):
+*
+*   g++ -std=gnu++17 -O2 -Ihost -I. host/control_benchmark_main.cpp $(find modules -name '*.cpp') -o control_benchmark
+*
+* Uso: ./control_benchmark [horas por caso]
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]====================================================
+#include "mbed.h"
+#include <stdlib.h>
+#include <math.h>
+#include "modules/control_benchmark/control_benchmark.h"
+
+//=====[Declaration of private defines]===============================
+#define DEFAULT_HOURS   4   /**< Duración de cada caso, alcanza para estabilizar la bobina */
+
+#define MAX_OVERSHOOT_C 5.0f    /**< Límite de aceptación del sobrepaso */
+#define MAX_STEADY_ERROR_C  2.0f    /**< Límite de aceptación del error estacionario */
+#define PID_MAX_OVERSHOOT_C 1.5f    /**< Límite de aceptación del sobrepaso con PID */
+#define PID_MAX_STEADY_ERROR_C  0.1f    /**< Límite de aceptación del error estacionario con PID */
+#define PID_MAX_RIPPLE_C    1.2f    /**< Límite de aceptación de la ondulación con PID, la ventana del relé no deja bajar de ~1 °C */
+
+#define ARRAY_SIZE(array)   (int)(sizeof(array) / sizeof(array[0]))
+
+//=====[Declaration of private data types]============================
+/**
+ * @brief Variante de masa térmica de la carga.
+ */
+typedef struct{
+    const char *name;   /**< Nombre en la tabla */
+    float spool_scale;  /**< Factor sobre la capacidad de la bobina por defecto */
+}benchmarkMass_t;
+
+//=====[Declaration and Initialization of public global Variables]====
+
+//=====[Declaration and Initialization of private global Variables]===
+static const int setpoints[] = {30, 45, 60, 75, 90}; /**< Consignas en grados */
+static const float ambients[] = {15, 25, 35}; /**< Temperaturas ambiente */
+static const benchmarkMass_t masses[] = {
+    {"vacia", 0.25f},   // carrete sin filamento
+    {"1kg", 1.0f},
+    {"3kg", 3.0f}
+}; /**< Masas térmicas de la carga */
+static const heaterControlMode_t modes[] = {
+    HEATER_CONTROL_ON_OFF,
+    HEATER_CONTROL_PID,
+    HEATER_CONTROL_AUTOTUNE
+}; /**< Modos de control de heater.cpp */
+
+//=====[Declarations (prototypes) of private functions]===============
+/**
+ * @brief Nombre del modo de control para la tabla.
+ *
+ * @param mode modo de control
+ *
+ * @return const char* nombre
+ */
+static const char *benchmarkModeName(heaterControlMode_t mode);
+
+//=====[Main function]================================================
+/**
+ * @brief Punto de entrada del banco de pruebas.
+ */
+int main(int argc, char *argv[]){
+    int hours = (argc > 1) ? atoi(argv[1]) : DEFAULT_HOURS;
+    int failures = 0;
+    int cases = 0;
+
+    controlBenchmarkInit();
+
+    printf("modo,consigna_c,ambiente_c,carga,subida_s,sobrepaso_c,error_c,ondulacion_c,conmutaciones,energia_wh,resultado\n");
+
+    for(int m = 0; m < ARRAY_SIZE(modes); m++){
+        for(int a = 0; a < ARRAY_SIZE(ambients); a++){
+            for(int l = 0; l < ARRAY_SIZE(masses); l++){
+                for(int s = 0; s < ARRAY_SIZE(setpoints); s++){
+                    controlBenchmarkCase_t test;
+
+                    test.setpoint = setpoints[s];
+                    test.mode = modes[m];
+                    test.plant = thermalSimulatorDefaultPlant();
+                    test.plant.ambient_c = ambients[a];
+                    test.plant.spool_capacity_j_k = test.plant.spool_capacity_j_k * masses[l].spool_scale;
+                    test.duration_s = hours * 3600;
+
+                    controlBenchmarkResult_t result = controlBenchmarkRun(&test);
+
+                    // una consigna por debajo del ambiente no se puede alcanzar sin enfriar, no se evalúa
+                    bool evaluated = test.setpoint > ambients[a];
+                    bool pass = not evaluated or (result.reached and result.overshoot_c <= MAX_OVERSHOOT_C and fabsf(result.steady_error_c) <= MAX_STEADY_ERROR_C);
+
+                    // el PID además se mide en décimas de grado
+                    if(evaluated and test.mode != HEATER_CONTROL_ON_OFF){
+                        pass = pass and result.overshoot_c <= PID_MAX_OVERSHOOT_C and fabsf(result.steady_error_c) <= PID_MAX_STEADY_ERROR_C
+                            and result.ripple_c <= PID_MAX_RIPPLE_C;
+                    }
+
+                    if(not pass){
+                        failures = failures + 1;
+                    }
+
+                    cases = cases + 1;
+
+                    printf("%s,%d,%.0f,%s,", benchmarkModeName(test.mode), test.setpoint, ambients[a], masses[l].name);
+
+                    if(result.reached){
+                        printf("%.0f,", result.rise_time_s);
+                    }else{
+                        printf("-,");
+                    }
+
+                    printf("%.2f,%.2f,%.2f,%d,%.1f,%s\n", result.overshoot_c, result.steady_error_c, result.ripple_c,
+                        result.switches, result.energy_wh, not evaluated ? "n/a" : (pass ? "ok" : "FALLA"));
+
+                    if(test.mode == HEATER_CONTROL_AUTOTUNE and not result.tuned){
+                        printf("# autoajuste fallido, se midió el PID del firmware\n");
+                    }
+                }
+            }
+        }
+    }
+
+    printf("# %d casos, %d fallas (sobrepaso > %.1f C o |error| > %.1f C; con PID sobrepaso > %.1f C, |error| > %.1f C u ondulación > %.1f C)\n",
+        cases, failures, MAX_OVERSHOOT_C, MAX_STEADY_ERROR_C, PID_MAX_OVERSHOOT_C, PID_MAX_STEADY_ERROR_C, PID_MAX_RIPPLE_C);
+
+    return (failures > 0) ? 1 : 0;
+}
+
+//=====[Implementations of private functions]=========================
+/**
+ * @brief Nombre del modo de control para la tabla.
+ *
+ * @param mode modo de control
+ *
+ * @return const char* nombre
+ */
+static const char *benchmarkModeName(heaterControlMode_t mode){
+
+    switch(mode){
+        case HEATER_CONTROL_PID:
+            return "pid";
+
+        case HEATER_CONTROL_AUTOTUNE:
+            return "pid_autoajustado";
+
+        case HEATER_CONTROL_ON_OFF:
+        default:
+            return "on_off";
+    }
+}
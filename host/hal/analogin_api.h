@@ -0,0 +1,29 @@
+/**
+* @file analogin_api.h
+* @brief HAL analógico simulado para compilar en una PC, lee la tabla de valores de mbed.h.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _HOST_ANALOGIN_API_H_
+#define _HOST_ANALOGIN_API_H_
+
+#include "mbed.h"
+
+//=====[Declaration of private data types]==============================
+typedef struct{
+    PinName pin;
+}analogin_t;
+
+//=====[Declaration (prototypes) of public functions]===================
+inline void analogin_init(analogin_t *obj, PinName pin){
+    obj->pin = pin;
+}
+
+inline uint16_t analogin_read_u16(analogin_t *obj){
+    return hostAnalogValues[obj->pin];
+}
+
+//=====[#include guards - end]==========================================
+#endif
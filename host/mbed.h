@@ -0,0 +1,774 @@
+/**
+* @file mbed.h
+* @brief HAL simulado para compilar los módulos en una PC (Linux) sin mbed-os.
+*
+* Implementa solo lo que usan los módulos: DigitalOut, DigitalIn, BusIn, InterruptIn, AnalogIn,
+* UnbufferedSerial, Ticker, Timeout, Timer, ResetReason, FlashIAP, Kernel::Clock y ThisThread. Los niveles de los
+* pines se guardan en una tabla para que la simulación pueda presionar botones
+* (hostPinWrite, que dispara las interrupciones de InterruptIn) y observar salidas (hostPinRead);
+* los bytes que recibe la uart se inyectan con hostSerialReceive(). El tiempo es el reloj real de la PC;
+* la simulación lo reemplaza por un reloj virtual con rtcSetClockSource(). Los Timeout vencen
+* al llamar a hostTimeoutsRun(), medidos con hostTimeoutClock.
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _HOST_MBED_H_
+#define _HOST_MBED_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+//=====[Declaration of private defines]=================================
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk  (1UL << 0)
+
+#define MBED_SECTION(name)  __attribute__((section(name)))  /**< Igual que en mbed_toolchain.h */
+
+#define HOST_FLASH_START    0x08000000  /**< Comienzo de la flash del STM32F401RE */
+#define HOST_FLASH_SIZE (512 * 1024)    /**< Tamaño de la flash */
+#define HOST_FLASH_SECTORS  8   /**< Sectores de la flash */
+#define HOST_FLASH_ERASED   0xFF    /**< Valor de un byte borrado */
+
+#define DWT (&hostDwt)  /**< Contador de ciclos, en host cuenta nanosegundos */
+#define CoreDebug (&hostCoreDebug)
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Pines del Nucleo F401 que usa la secadora.
+ */
+typedef enum{
+    PA_13, PA_14, PA_15,
+    PB_2,
+    PC_4, PC_8, PC_10, PC_12,
+    PD_2,
+    USBTX, USBRX,
+    HOST_PIN_COUNT, /**< Cantidad de pines simulados */
+    NC = -1
+}PinName;
+
+typedef enum{
+    PullNone,
+    PullUp,
+    PullDown
+}PinMode;
+
+/**
+ * @brief Causa del último reinicio, mismos valores que reset_reason_api.h.
+ */
+typedef enum{
+    RESET_REASON_POWER_ON,
+    RESET_REASON_PIN_RESET,
+    RESET_REASON_BROWN_OUT,
+    RESET_REASON_SOFTWARE,
+    RESET_REASON_WATCHDOG,
+    RESET_REASON_LOCKUP,
+    RESET_REASON_WAKE_LOW_POWER,
+    RESET_REASON_ACCESS_ERROR,
+    RESET_REASON_BOOT_ERROR,
+    RESET_REASON_MULTIPLE,
+    RESET_REASON_PLATFORM,
+    RESET_REASON_UNKNOWN
+}reset_reason_t;
+
+/**
+ * @brief Registros del DWT usados para medir ciclos.
+ */
+typedef struct{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+}hostDwt_t;
+
+/**
+ * @brief Registros de CoreDebug usados para habilitar el DWT.
+ */
+typedef struct{
+    volatile uint32_t DEMCR;
+}hostCoreDebug_t;
+
+typedef void *osThreadId_t;    /**< Identificador de hilo de CMSIS-RTOS2 */
+
+class Timeout;
+
+//=====[Declaration and initialization of public global variables]======
+inline int hostPinLevels[HOST_PIN_COUNT]; /**< Nivel digital de cada pin */
+inline uint16_t hostAnalogValues[HOST_PIN_COUNT]; /**< Lectura analógica de cada pin (escala read_u16) */
+
+inline std::deque<uint8_t> hostSerialRx; /**< Bytes pendientes de leer por la uart */
+inline std::function<void()> hostSerialRxIrq; /**< Interrupción de recepción registrada */
+
+inline std::function<void()> hostPinRise[HOST_PIN_COUNT];  /**< Interrupción de flanco ascendente de cada pin */
+inline std::function<void()> hostPinFall[HOST_PIN_COUNT];  /**< Interrupción de flanco descendente de cada pin */
+
+inline std::vector<Timeout*> hostTimeouts;  /**< Timeout que se armaron alguna vez */
+inline uint64_t (*hostTimeoutClock)() = nullptr;    /**< Reloj en microsegundos de los Timeout, nullptr usa hostClockUs() */
+
+inline std::vector<uint8_t> hostFlash(HOST_FLASH_SIZE, HOST_FLASH_ERASED);  /**< Contenido de la flash emulada */
+inline uint32_t hostFlashErases[HOST_FLASH_SECTORS];    /**< Borrados de cada sector */
+inline long hostFlashProgramBudget = -1;    /**< Bytes que se programan antes de un corte de energía simulado, -1 sin corte */
+
+inline hostDwt_t hostDwt;
+inline hostCoreDebug_t hostCoreDebug;
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Reloj monótono de la PC.
+ *
+ * @return uint64_t Microsegundos desde el arranque del programa.
+ */
+inline uint64_t hostClockUs(){
+    static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+/**
+ * @brief Fija el nivel de un pin (botones presionados por la simulación).
+ *
+ * @param pin Pin a modificar.
+ * @param level Nivel 0 o 1.
+ */
+inline void hostPinWrite(PinName pin, const int level){
+    if(pin >= 0 and pin < HOST_PIN_COUNT){
+        int previous = hostPinLevels[pin];
+
+        hostPinLevels[pin] = level;
+
+        // como el EXTI, solo en los cambios de nivel
+        if(level and not previous and hostPinRise[pin]){
+            hostPinRise[pin]();
+        }else if(not level and previous and hostPinFall[pin]){
+            hostPinFall[pin]();
+        }
+    }
+}
+
+/**
+ * @brief Nivel actual de un pin (salidas escritas por los módulos).
+ *
+ * @param pin Pin a leer.
+ *
+ * @return int Nivel 0 o 1.
+ */
+inline int hostPinRead(PinName pin){
+    if(pin >= 0 and pin < HOST_PIN_COUNT){
+        return hostPinLevels[pin];
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Fija la lectura de un pin analógico.
+ *
+ * @param pin Pin a modificar.
+ * @param value Lectura con la escala de read_u16().
+ */
+inline void hostAnalogWrite(PinName pin, const uint16_t value){
+    if(pin >= 0 and pin < HOST_PIN_COUNT){
+        hostAnalogValues[pin] = value;
+    }
+}
+
+/**
+ * @brief Simula la recepción de texto por la uart y dispara la interrupción de recepción.
+ *
+ * @param text Bytes recibidos.
+ */
+inline void hostSerialReceive(const char *text){
+    while(*text != '\0'){
+        hostSerialRx.push_back((uint8_t)*text);
+        text = text + 1;
+    }
+
+    if(hostSerialRxIrq){
+        hostSerialRxIrq();
+    }
+}
+
+inline void thread_sleep_for(uint32_t millisec){
+    std::this_thread::sleep_for(std::chrono::milliseconds(millisec));
+}
+
+inline void wait_us(int us){
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+inline void core_util_critical_section_enter(){}
+inline void core_util_critical_section_exit(){}
+
+/**
+ * @brief Avisa a un hilo; en host no hay a quién despertar, las esperas no se interrumpen.
+ */
+inline uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags){
+    return flags;
+}
+
+/**
+ * @brief Enlaza una función con su argumento, como callback() de mbed.
+ */
+template <typename F, typename A>
+std::function<void()> callback(F func, A arg){
+    return [func, arg](){
+        func(arg);
+    };
+}
+
+/**
+ * @brief Sector de la flash que contiene una dirección, con la geometría del STM32F401RE.
+ *
+ * @param addr Dirección.
+ * @param start Destino de la dirección de comienzo del sector.
+ * @param size Destino del tamaño del sector.
+ *
+ * @return int Número de sector o -1 fuera de la flash.
+ */
+inline int hostFlashSector(uint32_t addr, uint32_t *start, uint32_t *size){
+    static const uint32_t sizes[HOST_FLASH_SECTORS] = {16384, 16384, 16384, 16384, 65536, 131072, 131072, 131072};
+    uint32_t sector_start = HOST_FLASH_START;
+
+    for(int i = 0; i < HOST_FLASH_SECTORS; i++){
+
+        if(addr >= sector_start and addr < sector_start + sizes[i]){
+            *start = sector_start;
+            *size = sizes[i];
+            return i;
+        }
+
+        sector_start = sector_start + sizes[i];
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Simula un corte de energía después de programar algunos bytes más.
+ *
+ * La escritura en curso queda a medias y las siguientes fallan hasta hostFlashPowerRestore().
+ *
+ * @param bytes Bytes que todavía se programan.
+ */
+inline void hostFlashPowerCutAfter(const long bytes){
+    hostFlashProgramBudget = bytes;
+}
+
+/**
+ * @brief Vuelve la energía, la flash conserva lo que se llegó a programar.
+ */
+inline void hostFlashPowerRestore(){
+    hostFlashProgramBudget = -1;
+}
+
+//=====[Declaration of public classes]==================================
+namespace Kernel{
+    /**
+     * @brief Reloj del sistema operativo en milisegundos.
+     */
+    struct Clock{
+        typedef std::chrono::milliseconds duration;
+        typedef std::chrono::duration<uint32_t, std::milli> duration_u32;
+        typedef std::chrono::time_point<Clock, duration> time_point;
+
+        static time_point now(){
+            return time_point(duration(hostClockUs() / 1000));
+        }
+    };
+}
+
+namespace ThisThread{
+    inline void sleep_for(Kernel::Clock::duration rel_time){
+        std::this_thread::sleep_for(rel_time);
+    }
+
+    inline osThreadId_t get_id(){
+        return nullptr;
+    }
+
+    inline uint32_t flags_wait_any_for(uint32_t flags, Kernel::Clock::duration_u32 rel_time, bool clear = true){
+        std::this_thread::sleep_for(rel_time);
+        return 0;
+    }
+
+    inline void sleep_until(Kernel::Clock::time_point abs_time){
+        Kernel::Clock::duration rel_time = abs_time - Kernel::Clock::now();
+
+        if(rel_time.count() > 0){
+            sleep_for(rel_time);
+        }
+    }
+}
+
+/**
+ * @brief Causa del último reinicio, en host siempre es el encendido.
+ */
+class ResetReason{
+    public:
+        static reset_reason_t get(){
+            return RESET_REASON_POWER_ON;
+        }
+};
+
+/**
+ * @brief Salida digital sobre la tabla de pines.
+ */
+class DigitalOut{
+    public:
+        DigitalOut(PinName pin, int value = 0) : _pin(pin){
+            write(value);
+        }
+
+        void write(int value){
+            hostPinWrite(_pin, value ? 1 : 0);
+        }
+
+        int read(){
+            return hostPinRead(_pin);
+        }
+
+        DigitalOut &operator=(int value){
+            write(value);
+            return *this;
+        }
+
+        operator int(){
+            return read();
+        }
+
+    private:
+        PinName _pin;
+};
+
+/**
+ * @brief Entrada digital sobre la tabla de pines.
+ */
+class DigitalIn{
+    public:
+        DigitalIn(PinName pin) : _pin(pin){}
+
+        void mode(PinMode pull){
+            // en reposo la entrada queda al nivel de la resistencia de pull
+            hostPinWrite(_pin, pull == PullUp ? 1 : 0);
+        }
+
+        int read(){
+            return hostPinRead(_pin);
+        }
+
+        operator int(){
+            return read();
+        }
+
+    private:
+        PinName _pin;
+};
+
+/**
+ * @brief Varios pines leídos juntos, el bit n es el pin n del constructor.
+ */
+class BusIn{
+    public:
+        BusIn(PinName p0, PinName p1 = NC, PinName p2 = NC, PinName p3 = NC,
+              PinName p4 = NC, PinName p5 = NC, PinName p6 = NC, PinName p7 = NC){
+            PinName pins[BUS_PINS] = {p0, p1, p2, p3, p4, p5, p6, p7};
+
+            for(int i = 0; i < BUS_PINS; i++){
+                _pins[i] = pins[i];
+            }
+        }
+
+        void mode(PinMode pull){
+            for(int i = 0; i < BUS_PINS; i++){
+                if(_pins[i] != NC){
+                    hostPinWrite(_pins[i], pull == PullUp ? 1 : 0);
+                }
+            }
+        }
+
+        int read(){
+            int value = 0;
+
+            for(int i = 0; i < BUS_PINS; i++){
+                if(_pins[i] != NC and hostPinRead(_pins[i])){
+                    value = value | (1 << i);
+                }
+            }
+
+            return value;
+        }
+
+        operator int(){
+            return read();
+        }
+
+    private:
+        static const int BUS_PINS = 8;
+        PinName _pins[BUS_PINS];
+};
+
+/**
+ * @brief Entrada digital con interrupciones, hostPinWrite() llama a rise() y fall().
+ */
+class InterruptIn{
+    public:
+        InterruptIn(PinName pin) : _pin(pin){}
+
+        ~InterruptIn(){
+            rise(nullptr);
+            fall(nullptr);
+        }
+
+        void mode(PinMode pull){
+            hostPinWrite(_pin, pull == PullUp ? 1 : 0);
+        }
+
+        int read(){
+            return hostPinRead(_pin);
+        }
+
+        operator int(){
+            return read();
+        }
+
+        void rise(std::function<void()> func){
+            if(_pin >= 0 and _pin < HOST_PIN_COUNT){
+                hostPinRise[_pin] = func;
+            }
+        }
+
+        void fall(std::function<void()> func){
+            if(_pin >= 0 and _pin < HOST_PIN_COUNT){
+                hostPinFall[_pin] = func;
+            }
+        }
+
+    private:
+        PinName _pin;
+};
+
+/**
+ * @brief Entrada analógica sobre la tabla de valores analógicos.
+ */
+class AnalogIn{
+    public:
+        AnalogIn(PinName pin) : _pin(pin){}
+
+        unsigned short read_u16(){
+            return hostAnalogValues[_pin];
+        }
+
+        float read(){
+            return read_u16() / 65535.0f;
+        }
+
+        operator float(){
+            return read();
+        }
+
+    private:
+        PinName _pin;
+};
+
+/**
+ * @brief Base de los puertos serie.
+ */
+class SerialBase{
+    public:
+        enum IrqType{
+            RxIrq = 0,
+            TxIrq
+        };
+};
+
+/**
+ * @brief Puerto serie sobre la salida/entrada estándar.
+ */
+class UnbufferedSerial : public SerialBase{
+    public:
+        UnbufferedSerial(PinName tx, PinName rx, int baud){}
+
+        ssize_t write(const void *buffer, size_t length){
+            return fwrite(buffer, 1, length, stdout);
+        }
+
+        ssize_t read(void *buffer, size_t length){
+            size_t count = 0;
+
+            while(count < length and not hostSerialRx.empty()){
+                ((uint8_t *)buffer)[count] = hostSerialRx.front();
+                hostSerialRx.pop_front();
+                count = count + 1;
+            }
+
+            return count;
+        }
+
+        bool readable(){
+            return not hostSerialRx.empty();
+        }
+
+        bool writable(){
+            return true;
+        }
+
+        /**
+         * @brief Registra la interrupción; la de transmisión se ejecuta en el momento
+         * porque la salida estándar siempre está lista, hasta que se deshabilita.
+         */
+        void attach(std::function<void()> func, IrqType type = RxIrq){
+            if(type == RxIrq){
+                _rx_irq = func;
+                hostSerialRxIrq = func;
+                return;
+            }
+
+            _tx_irq = func;
+
+            if(_in_tx_irq){
+                return;
+            }
+
+            _in_tx_irq = true;
+
+            while(_tx_irq){
+                std::function<void()> irq = _tx_irq; // la interrupción puede deshabilitarse a sí misma
+                irq();
+            }
+
+            _in_tx_irq = false;
+        }
+
+    private:
+        std::function<void()> _rx_irq;
+        std::function<void()> _tx_irq;
+        bool _in_tx_irq = false;
+};
+
+/**
+ * @brief Temporizador con el reloj de la PC.
+ */
+class Timer{
+    public:
+        void start(){
+            if(not _running){
+                _start_us = hostClockUs();
+                _running = true;
+            }
+        }
+
+        void stop(){
+            if(_running){
+                _elapsed_us = _elapsed_us + hostClockUs() - _start_us;
+                _running = false;
+            }
+        }
+
+        void reset(){
+            _elapsed_us = 0;
+            _start_us = hostClockUs();
+        }
+
+        std::chrono::microseconds elapsed_time(){
+            uint64_t elapsed_us = _elapsed_us;
+
+            if(_running){
+                elapsed_us = elapsed_us + hostClockUs() - _start_us;
+            }
+
+            return std::chrono::microseconds(elapsed_us);
+        }
+
+    private:
+        uint64_t _start_us = 0;
+        uint64_t _elapsed_us = 0;
+        bool _running = false;
+};
+
+/**
+ * @brief Flash interna emulada en memoria con las reglas del hardware.
+ *
+ * Programar solo puede pasar bits de 1 a 0 y borrar es por sector completo; se cuentan
+ * los borrados de cada sector y se pueden simular cortes a mitad de una escritura.
+ */
+class FlashIAP{
+    public:
+        int init(){
+            return 0;
+        }
+
+        int deinit(){
+            return 0;
+        }
+
+        int read(void *buffer, uint32_t addr, uint32_t size){
+            if(not inside(addr, size)){
+                return -1;
+            }
+
+            memcpy(buffer, &hostFlash[addr - HOST_FLASH_START], size);
+            return 0;
+        }
+
+        int program(const void *buffer, uint32_t addr, uint32_t size){
+            const uint8_t *data = (const uint8_t *)buffer;
+
+            if(not inside(addr, size)){
+                return -1;
+            }
+
+            for(uint32_t i = 0; i < size; i++){
+
+                if(hostFlashProgramBudget == 0){
+                    return -1;
+                }
+
+                if(hostFlashProgramBudget > 0){
+                    hostFlashProgramBudget = hostFlashProgramBudget - 1;
+                }
+
+                hostFlash[addr - HOST_FLASH_START + i] &= data[i];
+            }
+
+            return 0;
+        }
+
+        int erase(uint32_t addr, uint32_t size){
+            uint32_t start;
+            uint32_t sector_size;
+
+            if(hostFlashProgramBudget == 0 or not inside(addr, size)){
+                return -1;
+            }
+
+            while(size > 0){
+                int sector = hostFlashSector(addr, &start, &sector_size);
+
+                if(sector < 0 or start != addr or sector_size > size){
+                    return -1;
+                }
+
+                memset(&hostFlash[addr - HOST_FLASH_START], HOST_FLASH_ERASED, sector_size);
+                hostFlashErases[sector] = hostFlashErases[sector] + 1;
+                addr = addr + sector_size;
+                size = size - sector_size;
+            }
+
+            return 0;
+        }
+
+        uint32_t get_page_size() const{
+            return 1; // el STM32F4 programa de a un byte
+        }
+
+        uint32_t get_sector_size(uint32_t addr) const{
+            uint32_t start;
+            uint32_t size;
+
+            return (hostFlashSector(addr, &start, &size) < 0) ? 0 : size;
+        }
+
+        uint32_t get_flash_start() const{
+            return HOST_FLASH_START;
+        }
+
+        uint32_t get_flash_size() const{
+            return HOST_FLASH_SIZE;
+        }
+
+        uint8_t get_erase_value() const{
+            return HOST_FLASH_ERASED;
+        }
+
+    private:
+        static bool inside(uint32_t addr, uint32_t size){
+            return addr >= HOST_FLASH_START and size <= HOST_FLASH_SIZE and addr - HOST_FLASH_START <= HOST_FLASH_SIZE - size;
+        }
+};
+
+/**
+ * @brief Interrupción periódica; en host no se dispara, la simulación usa fuentes de muestras.
+ */
+class Ticker{
+    public:
+        template <typename F>
+        void attach(F func, std::chrono::microseconds period){}
+
+        void detach(){}
+};
+
+/**
+ * @brief Interrupción única, vence en hostTimeoutsRun() con el reloj hostTimeoutClock.
+ */
+class Timeout{
+    public:
+        ~Timeout(){
+            for(size_t i = 0; i < hostTimeouts.size(); i++){
+                if(hostTimeouts[i] == this){
+                    hostTimeouts.erase(hostTimeouts.begin() + i);
+                    break;
+                }
+            }
+        }
+
+        void attach(std::function<void()> func, std::chrono::microseconds t){
+            bool registered = false;
+
+            for(size_t i = 0; i < hostTimeouts.size(); i++){
+                registered = registered or hostTimeouts[i] == this;
+            }
+
+            if(not registered){
+                hostTimeouts.push_back(this);
+            }
+
+            _func = func;
+            _deadline_us = now() + t.count();
+            _armed = true;
+        }
+
+        void detach(){
+            _armed = false;
+        }
+
+        /**
+         * @brief Llama a la función si venció, una sola vez.
+         */
+        void run(){
+            if(_armed and now() >= _deadline_us){
+                _armed = false;
+                _func();
+            }
+        }
+
+    private:
+        static uint64_t now(){
+            return (hostTimeoutClock != nullptr) ? hostTimeoutClock() : hostClockUs();
+        }
+
+        std::function<void()> _func;
+        uint64_t _deadline_us = 0;
+        bool _armed = false;
+};
+
+/**
+ * @brief Ejecuta los Timeout vencidos, la simulación lo llama en cada vuelta del bucle.
+ */
+inline void hostTimeoutsRun(){
+    // por índice: una función puede armar un Timeout nuevo
+    for(size_t i = 0; i < hostTimeouts.size(); i++){
+        hostTimeouts[i]->run();
+    }
+}
+
+//=====[#include guards - end]==========================================
+#endif
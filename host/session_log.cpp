@@ -0,0 +1,611 @@
+/**
+* @file session_log.cpp
+* @brief Implementación del registro columnar de sesiones de secado (herramientas de PC).
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "session_log.h"
+#include <string.h>
+
+//=====[Declaration of private defines]=================================
+#define LOG_MAGIC   "TLG1"  /**< Comienzo de cada bloque de columnas */
+#define INDEX_MAGIC "TIDX"  /**< Comienzo del índice */
+#define INDEX_VERSION   1   /**< Versión del formato del índice */
+#define INDEX_HEADER    8   /**< Magia más versión */
+#define VARINT_MAX  10  /**< Bytes del varint de 64 bits más largo */
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Reinicia el resumen del bloque en curso conservando los datos de la sesión.
+ *
+ * @param writer Escritor.
+ */
+static void sessionLogResetChunk(sessionLogWriter_t *writer);
+
+/**
+ * @brief Codifica las columnas del bloque en curso, lo agrega al .tlog y su resumen al .tidx.
+ *
+ * @param writer Escritor.
+ * @param end Cómo termina la sesión en este bloque.
+ */
+static void sessionLogFlush(sessionLogWriter_t *writer, sessionEnd_t end);
+
+/**
+ * @brief Valor de una columna de una fila.
+ *
+ * @param row Fila.
+ * @param column Número de columna.
+ *
+ * @return int64_t Valor.
+ */
+static int64_t sessionLogColumnValue(const sessionRow_t *row, const int column);
+
+/**
+ * @brief Carga el valor de una columna en una fila.
+ *
+ * @param row Fila.
+ * @param column Número de columna.
+ * @param value Valor.
+ */
+static void sessionLogColumnStore(sessionRow_t *row, const int column, int64_t value);
+
+/**
+ * @brief Agrega un entero con signo en zigzag + varint.
+ *
+ * @param out Destino.
+ * @param value Valor.
+ */
+static void sessionLogPutVarint(std::vector<uint8_t> *out, int64_t value);
+
+/**
+ * @brief Lee un entero con signo en zigzag + varint.
+ *
+ * @param data Bytes.
+ * @param length Cantidad de bytes.
+ * @param position Posición, avanza lo leído.
+ * @param value Destino.
+ *
+ * @return true si había un varint completo.
+ */
+static bool sessionLogGetVarint(const uint8_t *data, const size_t length, size_t *position, int64_t *value);
+
+/**
+ * @brief Serializa un registro del índice en little-endian.
+ *
+ * @param chunk Registro.
+ * @param out Destino de SESSION_LOG_INDEX_RECORD bytes.
+ */
+static void sessionLogPackChunk(const sessionChunk_t *chunk, uint8_t *out);
+
+/**
+ * @brief Interpreta un registro del índice.
+ *
+ * @param data SESSION_LOG_INDEX_RECORD bytes.
+ * @param chunk Destino.
+ */
+static void sessionLogUnpackChunk(const uint8_t *data, sessionChunk_t *chunk);
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Abre (o crea) el registro de un equipo para agregar sesiones.
+ *
+ * @param writer Escritor.
+ * @param directory Directorio del registro, debe existir.
+ * @param dryer Nombre del equipo.
+ *
+ * @return true si se pudieron abrir los dos archivos.
+ */
+bool sessionLogOpen(sessionLogWriter_t *writer, const char *directory, const char *dryer){
+    char path[SESSION_LOG_PATH_MAX];
+
+    memset(writer, 0, sizeof(*writer));
+
+    snprintf(path, sizeof(path), "%s/%s.tlog", directory, dryer);
+    writer->log = fopen(path, "ab");
+
+    snprintf(path, sizeof(path), "%s/%s.tidx", directory, dryer);
+    writer->index = fopen(path, "ab");
+
+    if(writer->log == nullptr or writer->index == nullptr){
+        sessionLogClose(writer);
+        return false;
+    }
+
+    // índice nuevo: cabecera con la versión
+    fseek(writer->index, 0, SEEK_END);
+
+    if(ftell(writer->index) == 0){
+        uint8_t header[INDEX_HEADER] = {'T', 'I', 'D', 'X', INDEX_VERSION, 0, 0, 0};
+
+        fwrite(header, 1, sizeof(header), writer->index);
+        fflush(writer->index);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Inicia una sesión, si había una abierta la cierra como interrumpida.
+ *
+ * @param writer Escritor.
+ * @param session_id Hora de la PC en ms desde 1970.
+ * @param target_hours Horas de secado configuradas.
+ * @param source Formato de la telemetría.
+ */
+void sessionLogBegin(sessionLogWriter_t *writer, uint64_t session_id, const int target_hours, sessionSource_t source){
+
+    if(writer->open){
+        sessionLogEnd(writer, SESSION_END_INTERRUPTED);
+    }
+
+    // dos sesiones en el mismo milisegundo (simulación) no comparten identificador
+    if(session_id <= writer->last_session_id){
+        session_id = writer->last_session_id + 1;
+    }
+
+    writer->last_session_id = session_id;
+    writer->open = true;
+    writer->has_previous = false;
+
+    memset(&writer->chunk, 0, sizeof(writer->chunk));
+    writer->chunk.session_id = session_id;
+    writer->chunk.target_hours = target_hours;
+    writer->chunk.source = source;
+    sessionLogResetChunk(writer);
+}
+
+/**
+ * @brief Indica si hay una sesión en curso.
+ *
+ * @param writer Escritor.
+ *
+ * @return true si hay una sesión abierta.
+ */
+bool sessionLogIsOpen(const sessionLogWriter_t *writer){
+    return writer->open;
+}
+
+/**
+ * @brief Agrega una fila a la sesión en curso.
+ *
+ * @param writer Escritor.
+ * @param row Fila.
+ * @param target_hours Horas de secado configuradas (pueden cambiar durante la sesión).
+ */
+void sessionLogAppend(sessionLogWriter_t *writer, const sessionRow_t *row, const int target_hours){
+    sessionChunk_t *chunk = &writer->chunk;
+
+    if(not writer->open){
+        return;
+    }
+
+    // el intervalo desde la fila anterior se cuenta con los valores de la anterior
+    if(writer->has_previous and row->elapsed_ms > writer->previous.elapsed_ms){
+        uint32_t interval = row->elapsed_ms - writer->previous.elapsed_ms;
+
+        chunk->total_ms = chunk->total_ms + interval;
+        chunk->temperature_sum = chunk->temperature_sum + (int64_t)writer->previous.temperature_centi * interval;
+
+        if(writer->previous.heater){
+            chunk->heater_on_ms = chunk->heater_on_ms + interval;
+        }
+
+        if(writer->previous.temperature_centi > writer->previous.setpoint * 100){
+            chunk->above_ms = chunk->above_ms + interval;
+        }
+    }
+
+    if(writer->count == 0){
+        chunk->first_ms = row->elapsed_ms;
+        chunk->min_centi = row->temperature_centi;
+        chunk->max_centi = row->temperature_centi;
+    }
+
+    if(row->temperature_centi < chunk->min_centi){
+        chunk->min_centi = row->temperature_centi;
+    }
+
+    if(row->temperature_centi > chunk->max_centi){
+        chunk->max_centi = row->temperature_centi;
+    }
+
+    chunk->last_ms = row->elapsed_ms;
+    chunk->setpoint = row->setpoint;
+    chunk->target_hours = target_hours;
+
+    writer->rows[writer->count] = *row;
+    writer->count = writer->count + 1;
+    writer->previous = *row;
+    writer->has_previous = true;
+
+    if(writer->count == SESSION_LOG_CHUNK_ROWS){
+        sessionLogFlush(writer, SESSION_END_OPEN);
+    }
+}
+
+/**
+ * @brief Cuenta tramas perdidas en la sesión en curso.
+ *
+ * @param writer Escritor.
+ * @param frames Tramas perdidas.
+ */
+void sessionLogLost(sessionLogWriter_t *writer, const uint32_t frames){
+
+    if(writer->open){
+        writer->chunk.lost_frames = writer->chunk.lost_frames + frames;
+    }
+}
+
+/**
+ * @brief Termina la sesión en curso y escribe su último bloque.
+ *
+ * @param writer Escritor.
+ * @param end Cómo terminó.
+ */
+void sessionLogEnd(sessionLogWriter_t *writer, sessionEnd_t end){
+
+    if(not writer->open){
+        return;
+    }
+
+    // aunque no queden filas se escribe el registro que marca el final
+    sessionLogFlush(writer, end);
+
+    writer->open = false;
+}
+
+/**
+ * @brief Cierra el registro, la sesión abierta queda como interrumpida.
+ *
+ * @param writer Escritor.
+ */
+void sessionLogClose(sessionLogWriter_t *writer){
+
+    if(writer->log != nullptr and writer->index != nullptr){
+        sessionLogEnd(writer, SESSION_END_INTERRUPTED);
+    }
+
+    if(writer->log != nullptr){
+        fclose(writer->log);
+        writer->log = nullptr;
+    }
+
+    if(writer->index != nullptr){
+        fclose(writer->index);
+        writer->index = nullptr;
+    }
+}
+
+/**
+ * @brief Lee todos los registros del índice de un equipo.
+ *
+ * @param index_path Ruta del .tidx.
+ * @param chunks Destino, en el orden en que se escribieron.
+ *
+ * @return true si el archivo existe y tiene el formato esperado.
+ */
+bool sessionLogReadIndex(const char *index_path, std::vector<sessionChunk_t> *chunks){
+    FILE *file = fopen(index_path, "rb");
+    uint8_t header[INDEX_HEADER];
+    uint8_t record[SESSION_LOG_INDEX_RECORD];
+    sessionChunk_t chunk;
+
+    if(file == nullptr){
+        return false;
+    }
+
+    if(fread(header, 1, sizeof(header), file) != sizeof(header) or memcmp(header, INDEX_MAGIC, 4) != 0 or header[4] != INDEX_VERSION){
+        fclose(file);
+        return false;
+    }
+
+    // un registro incompleto al final (corte durante la escritura) se ignora
+    while(fread(record, 1, sizeof(record), file) == sizeof(record)){
+        sessionLogUnpackChunk(record, &chunk);
+        chunks->push_back(chunk);
+    }
+
+    fclose(file);
+
+    return true;
+}
+
+/**
+ * @brief Decodifica las filas de un bloque.
+ *
+ * @param log_path Ruta del .tlog.
+ * @param chunk Registro del índice del bloque.
+ * @param rows Destino, se agregan al final.
+ *
+ * @return true si el bloque es válido.
+ */
+bool sessionLogReadRows(const char *log_path, const sessionChunk_t *chunk, std::vector<sessionRow_t> *rows){
+    FILE *file;
+    std::vector<uint8_t> data(chunk->length);
+    std::vector<sessionRow_t> decoded(chunk->rows);
+    size_t position = 4;
+    int64_t value;
+
+    if(chunk->rows == 0){
+        return true;
+    }
+
+    file = fopen(log_path, "rb");
+
+    if(file == nullptr){
+        return false;
+    }
+
+    if(fseek(file, chunk->offset, SEEK_SET) != 0 or fread(data.data(), 1, data.size(), file) != data.size()){
+        fclose(file);
+        return false;
+    }
+
+    fclose(file);
+
+    if(data.size() < 4 or memcmp(data.data(), LOG_MAGIC, 4) != 0){
+        return false;
+    }
+
+    if(not sessionLogGetVarint(data.data(), data.size(), &position, &value) or value != chunk->rows){
+        return false;
+    }
+
+    memset(decoded.data(), 0, decoded.size() * sizeof(sessionRow_t));
+
+    for(int column = 0; column < SESSION_LOG_COLUMNS; column++){
+        int64_t previous = 0;
+
+        for(uint32_t i = 0; i < chunk->rows; i++){
+
+            if(not sessionLogGetVarint(data.data(), data.size(), &position, &value)){
+                return false;
+            }
+
+            previous = previous + value;
+            sessionLogColumnStore(&decoded[i], column, previous);
+        }
+    }
+
+    rows->insert(rows->end(), decoded.begin(), decoded.end());
+
+    return true;
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Reinicia el resumen del bloque en curso conservando los datos de la sesión.
+ *
+ * @param writer Escritor.
+ */
+static void sessionLogResetChunk(sessionLogWriter_t *writer){
+    sessionChunk_t *chunk = &writer->chunk;
+
+    chunk->offset = 0;
+    chunk->length = 0;
+    chunk->rows = 0;
+    chunk->first_ms = 0;
+    chunk->last_ms = 0;
+    chunk->min_centi = 0;
+    chunk->max_centi = 0;
+    chunk->temperature_sum = 0;
+    chunk->total_ms = 0;
+    chunk->heater_on_ms = 0;
+    chunk->above_ms = 0;
+    chunk->lost_frames = 0;
+    chunk->end = SESSION_END_OPEN;
+
+    writer->count = 0;
+}
+
+/**
+ * @brief Codifica las columnas del bloque en curso, lo agrega al .tlog y su resumen al .tidx.
+ *
+ * @param writer Escritor.
+ * @param end Cómo termina la sesión en este bloque.
+ */
+static void sessionLogFlush(sessionLogWriter_t *writer, sessionEnd_t end){
+    sessionChunk_t *chunk = &writer->chunk;
+    std::vector<uint8_t> block(LOG_MAGIC, LOG_MAGIC + 4);
+    uint8_t record[SESSION_LOG_INDEX_RECORD];
+
+    chunk->rows = writer->count;
+    chunk->end = end;
+
+    // columna por columna: valores parecidos juntos, las diferencias suelen ocupar un byte
+    sessionLogPutVarint(&block, writer->count);
+
+    for(int column = 0; column < SESSION_LOG_COLUMNS; column++){
+        int64_t previous = 0;
+
+        for(int i = 0; i < writer->count; i++){
+            int64_t value = sessionLogColumnValue(&writer->rows[i], column);
+
+            sessionLogPutVarint(&block, value - previous);
+            previous = value;
+        }
+    }
+
+    fseek(writer->log, 0, SEEK_END);
+    chunk->offset = ftell(writer->log);
+    chunk->length = block.size();
+
+    fwrite(block.data(), 1, block.size(), writer->log);
+    fflush(writer->log);
+
+    // el índice se escribe después del bloque, nunca apunta a columnas incompletas
+    sessionLogPackChunk(chunk, record);
+    fwrite(record, 1, sizeof(record), writer->index);
+    fflush(writer->index);
+
+    sessionLogResetChunk(writer);
+}
+
+/**
+ * @brief Valor de una columna de una fila.
+ *
+ * @param row Fila.
+ * @param column Número de columna.
+ *
+ * @return int64_t Valor.
+ */
+static int64_t sessionLogColumnValue(const sessionRow_t *row, const int column){
+
+    switch (column){
+        case 0: return row->elapsed_ms;
+        case 1: return row->temperature_centi;
+        case 2: return row->setpoint;
+        case 3: return row->heater;
+        default: return row->output_percent;
+    }
+}
+
+/**
+ * @brief Carga el valor de una columna en una fila.
+ *
+ * @param row Fila.
+ * @param column Número de columna.
+ * @param value Valor.
+ */
+static void sessionLogColumnStore(sessionRow_t *row, const int column, int64_t value){
+
+    switch (column){
+        case 0: row->elapsed_ms = value; break;
+        case 1: row->temperature_centi = value; break;
+        case 2: row->setpoint = value; break;
+        case 3: row->heater = value; break;
+        default: row->output_percent = value; break;
+    }
+}
+
+/**
+ * @brief Agrega un entero con signo en zigzag + varint.
+ *
+ * @param out Destino.
+ * @param value Valor.
+ */
+static void sessionLogPutVarint(std::vector<uint8_t> *out, int64_t value){
+    // zigzag: los negativos chicos también ocupan pocos bytes
+    uint64_t encoded = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+
+    while(encoded >= 0x80){
+        out->push_back((encoded & 0x7F) | 0x80);
+        encoded = encoded >> 7;
+    }
+
+    out->push_back(encoded);
+}
+
+/**
+ * @brief Lee un entero con signo en zigzag + varint.
+ *
+ * @param data Bytes.
+ * @param length Cantidad de bytes.
+ * @param position Posición, avanza lo leído.
+ * @param value Destino.
+ *
+ * @return true si había un varint completo.
+ */
+static bool sessionLogGetVarint(const uint8_t *data, const size_t length, size_t *position, int64_t *value){
+    uint64_t encoded = 0;
+
+    for(int i = 0; i < VARINT_MAX and *position < length; i++){
+        uint8_t byte = data[*position];
+
+        *position = *position + 1;
+        encoded = encoded | ((uint64_t)(byte & 0x7F) << (7 * i));
+
+        if((byte & 0x80) == 0){
+            *value = (int64_t)(encoded >> 1) ^ -(int64_t)(encoded & 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Serializa un registro del índice en little-endian.
+ *
+ * @param chunk Registro.
+ * @param out Destino de SESSION_LOG_INDEX_RECORD bytes.
+ */
+static void sessionLogPackChunk(const sessionChunk_t *chunk, uint8_t *out){
+    int position = 0;
+
+    auto put = [&](uint64_t value, const int bytes){
+        for(int i = 0; i < bytes; i++){
+            out[position] = value >> (8 * i);
+            position = position + 1;
+        }
+    };
+
+    put(chunk->session_id, 8);
+    put(chunk->offset, 8);
+    put(chunk->length, 4);
+    put(chunk->rows, 4);
+    put(chunk->first_ms, 4);
+    put(chunk->last_ms, 4);
+    put((uint16_t)chunk->min_centi, 2);
+    put((uint16_t)chunk->max_centi, 2);
+    put((uint64_t)chunk->temperature_sum, 8);
+    put(chunk->total_ms, 4);
+    put(chunk->heater_on_ms, 4);
+    put(chunk->above_ms, 4);
+    put(chunk->lost_frames, 4);
+    put(chunk->setpoint, 1);
+    put(chunk->target_hours, 1);
+    put(chunk->end, 1);
+    put(chunk->source, 1);
+}
+
+/**
+ * @brief Interpreta un registro del índice.
+ *
+ * @param data SESSION_LOG_INDEX_RECORD bytes.
+ * @param chunk Destino.
+ */
+static void sessionLogUnpackChunk(const uint8_t *data, sessionChunk_t *chunk){
+    int position = 0;
+
+    auto get = [&](const int bytes){
+        uint64_t value = 0;
+
+        for(int i = 0; i < bytes; i++){
+            value = value | ((uint64_t)data[position] << (8 * i));
+            position = position + 1;
+        }
+
+        return value;
+    };
+
+    chunk->session_id = get(8);
+    chunk->offset = get(8);
+    chunk->length = get(4);
+    chunk->rows = get(4);
+    chunk->first_ms = get(4);
+    chunk->last_ms = get(4);
+    chunk->min_centi = (int16_t)get(2);
+    chunk->max_centi = (int16_t)get(2);
+    chunk->temperature_sum = (int64_t)get(8);
+    chunk->total_ms = get(4);
+    chunk->heater_on_ms = get(4);
+    chunk->above_ms = get(4);
+    chunk->lost_frames = get(4);
+    chunk->setpoint = get(1);
+    chunk->target_hours = get(1);
+    chunk->end = get(1);
+    chunk->source = get(1);
+}
@@ -0,0 +1,188 @@
+/**
+* @file session_log.h
+* @brief Declaraciones del registro columnar de sesiones de secado (herramientas de PC).
+*
+* Cada equipo tiene dos archivos en el directorio del registro:
+*
+*   <equipo>.tlog   bloques de hasta SESSION_LOG_CHUNK_ROWS filas, una columna tras otra,
+*                   cada valor guardado como diferencia con el anterior (zigzag + varint)
+*   <equipo>.tidx   un registro de tamaño fijo por bloque con su ubicación y el resumen
+*                   (mínimo, máximo, suma para el promedio, tiempo con calentador y sobre la consigna)
+*
+* Las consultas por sesión leen solo el índice; las columnas se decodifican solo para ver las filas.
+* Los dos archivos se abren para agregar, un corte pierde a lo sumo el bloque en curso.
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _SESSION_LOG_H_
+#define _SESSION_LOG_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+//=====[Declaration of private defines]=================================
+#define SESSION_LOG_CHUNK_ROWS  4096    /**< Filas por bloque, unos 7 minutos a 10 Hz */
+#define SESSION_LOG_COLUMNS 5   /**< Columnas de cada fila */
+#define SESSION_LOG_INDEX_RECORD    64  /**< Bytes de cada registro del índice */
+#define SESSION_LOG_PATH_MAX    512 /**< Largo máximo de las rutas de los archivos */
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Cómo terminó una sesión.
+ */
+typedef enum{
+    SESSION_END_OPEN,   /**< Bloque intermedio, la sesión sigue */
+    SESSION_END_FINISHED,   /**< Secado completo */
+    SESSION_END_STOPPED,    /**< Detenido por el usuario */
+    SESSION_END_INTERRUPTED /**< Se cortó la recepción o el equipo se reinició */
+}sessionEnd_t;
+
+/**
+ * @brief Formato de la telemetría de la que salió la sesión.
+ */
+typedef enum{
+    SESSION_SOURCE_TEXT,    /**< Líneas de texto, 1 por segundo */
+    SESSION_SOURCE_BINARY   /**< Tramas de estado, 10 por segundo */
+}sessionSource_t;
+
+/**
+ * @brief Una fila del registro.
+ */
+typedef struct{
+    uint32_t elapsed_ms;    /**< Tiempo de secado informado por el equipo */
+    int16_t temperature_centi;  /**< Temperatura en centésimas de grado */
+    uint8_t setpoint;   /**< Consigna en grados */
+    uint8_t heater; /**< Calentador 0/1 */
+    uint8_t output_percent; /**< Salida del control */
+}sessionRow_t;
+
+/**
+ * @brief Registro del índice, un bloque de filas con su resumen.
+ *
+ * Los tiempos se ponderan por el intervalo hasta la fila siguiente.
+ */
+typedef struct{
+    uint64_t session_id;    /**< Hora de la PC al iniciar la sesión, en ms desde 1970 */
+    uint64_t offset;    /**< Posición del bloque en el .tlog */
+    uint32_t length;    /**< Bytes del bloque */
+    uint32_t rows;  /**< Filas del bloque */
+    uint32_t first_ms;  /**< Tiempo de secado de la primera fila */
+    uint32_t last_ms;   /**< Tiempo de secado de la última fila */
+    int16_t min_centi;  /**< Temperatura mínima */
+    int16_t max_centi;  /**< Temperatura máxima */
+    int64_t temperature_sum;    /**< Suma de temperatura (centésimas) por milisegundos */
+    uint32_t total_ms;  /**< Tiempo ponderado */
+    uint32_t heater_on_ms;  /**< Tiempo con el calentador encendido */
+    uint32_t above_ms;  /**< Tiempo con la temperatura sobre la consigna */
+    uint32_t lost_frames;   /**< Tramas perdidas según la secuencia */
+    uint8_t setpoint;   /**< Consigna de la última fila */
+    uint8_t target_hours;   /**< Horas de secado configuradas */
+    uint8_t end;    /**< sessionEnd_t */
+    uint8_t source; /**< sessionSource_t */
+}sessionChunk_t;
+
+/**
+ * @brief Escritor del registro de un equipo.
+ */
+typedef struct{
+    FILE *log;  /**< Archivo de columnas */
+    FILE *index;    /**< Archivo de índice */
+    bool open;  /**< Hay una sesión en curso */
+    uint64_t last_session_id;   /**< Para que los identificadores no se repitan */
+    sessionChunk_t chunk;   /**< Resumen del bloque en curso */
+    sessionRow_t rows[SESSION_LOG_CHUNK_ROWS];  /**< Filas del bloque en curso */
+    int count;  /**< Filas del bloque en curso */
+    bool has_previous;  /**< Hay una fila anterior en la sesión */
+    sessionRow_t previous;  /**< Fila anterior, su intervalo se cuenta al llegar la siguiente */
+}sessionLogWriter_t;
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Abre (o crea) el registro de un equipo para agregar sesiones.
+ *
+ * @param writer Escritor.
+ * @param directory Directorio del registro, debe existir.
+ * @param dryer Nombre del equipo.
+ *
+ * @return true si se pudieron abrir los dos archivos.
+ */
+bool sessionLogOpen(sessionLogWriter_t *writer, const char *directory, const char *dryer);
+
+/**
+ * @brief Inicia una sesión, si había una abierta la cierra como interrumpida.
+ *
+ * @param writer Escritor.
+ * @param session_id Hora de la PC en ms desde 1970.
+ * @param target_hours Horas de secado configuradas.
+ * @param source Formato de la telemetría.
+ */
+void sessionLogBegin(sessionLogWriter_t *writer, uint64_t session_id, const int target_hours, sessionSource_t source);
+
+/**
+ * @brief Indica si hay una sesión en curso.
+ *
+ * @param writer Escritor.
+ *
+ * @return true si hay una sesión abierta.
+ */
+bool sessionLogIsOpen(const sessionLogWriter_t *writer);
+
+/**
+ * @brief Agrega una fila a la sesión en curso.
+ *
+ * @param writer Escritor.
+ * @param row Fila.
+ * @param target_hours Horas de secado configuradas (pueden cambiar durante la sesión).
+ */
+void sessionLogAppend(sessionLogWriter_t *writer, const sessionRow_t *row, const int target_hours);
+
+/**
+ * @brief Cuenta tramas perdidas en la sesión en curso.
+ *
+ * @param writer Escritor.
+ * @param frames Tramas perdidas.
+ */
+void sessionLogLost(sessionLogWriter_t *writer, const uint32_t frames);
+
+/**
+ * @brief Termina la sesión en curso y escribe su último bloque.
+ *
+ * @param writer Escritor.
+ * @param end Cómo terminó.
+ */
+void sessionLogEnd(sessionLogWriter_t *writer, sessionEnd_t end);
+
+/**
+ * @brief Cierra el registro, la sesión abierta queda como interrumpida.
+ *
+ * @param writer Escritor.
+ */
+void sessionLogClose(sessionLogWriter_t *writer);
+
+/**
+ * @brief Lee todos los registros del índice de un equipo.
+ *
+ * @param index_path Ruta del .tidx.
+ * @param chunks Destino, en el orden en que se escribieron.
+ *
+ * @return true si el archivo existe y tiene el formato esperado.
+ */
+bool sessionLogReadIndex(const char *index_path, std::vector<sessionChunk_t> *chunks);
+
+/**
+ * @brief Decodifica las filas de un bloque.
+ *
+ * @param log_path Ruta del .tlog.
+ * @param chunk Registro del índice del bloque.
+ * @param rows Destino, se agregan al final.
+ *
+ * @return true si el bloque es válido.
+ */
+bool sessionLogReadRows(const char *log_path, const sessionChunk_t *chunk, std::vector<sessionRow_t> *rows);
+
+//=====[#include guards - end]==========================================
+#endif
@@ -0,0 +1,171 @@
+/**
+* @file simulation_main.cpp
+* @brief Ejecuta un ciclo de secado completo en una PC con el modelo térmico y reloj virtual.
+*
+* Reemplaza a main.cpp en la compilación para host. Presiona los botones simulados
+* (o envía el comando "start" por la uart simulada) para configurar horas y temperatura, corre filamentDryerUpdate() hasta que termina
+* el secado e informa el resumen. La salida uart va a stdout.
+*
+* Compilación (desde la raíz del repositorio):
+*
+*   g++ -std=gnu++17 -O2 -Ihost -I. host/simulation_main.cpp $(find modules -name '*.cpp') -o filament_dryer_sim
+*
+* Uso: ./filament_dryer_sim [temperatura] [horas] [ambiente] [teclado|uart]
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]====================================================
+#include "mbed.h"
+#include <stdlib.h>
+#include <string.h>
+#include "modules/filament_dryer_system/filament_dryer_system.h"
+#include "modules/thermal_simulator/thermal_simulator.h"
+#include "modules/rtc/rtc.h"
+
+//=====[Declaration of private defines]===============================
+#define PRESS_MS    100 /**< Duración de cada pulsación y de la pausa siguiente, supera el antirrebote */
+#define REPORT_MS   1000    /**< Tiempo que sigue corriendo al terminar para que la uart informe el final */
+#define US_PER_MS   1000ULL
+#define US_PER_HOUR 3600000000ULL
+
+//=====[Declaration and Initialization of public global Objects]======
+
+//=====[Declaration and Initialization of public global Variables]====
+
+//=====[Declarations (prototypes) of private functions]===============
+/**
+ * @brief Una vuelta del bucle principal con el sensor simulado.
+ */
+static void simulationLoop();
+
+/**
+ * @brief Corre el bucle principal durante un tiempo virtual.
+ *
+ * @param ms Milisegundos virtuales.
+ */
+static void simulationRun(const int ms);
+
+/**
+ * @brief Presiona y suelta un botón.
+ *
+ * @param pin Pin del botón.
+ */
+static void simulationPress(PinName pin);
+
+//=====[Main function]================================================
+/**
+ * @brief Punto de entrada de la simulación.
+ */
+int main(int argc, char *argv[]){
+    int temperature = (argc > 1) ? atoi(argv[1]) : 60;
+    int hours = (argc > 2) ? atoi(argv[2]) : 4;
+    bool by_uart = (argc > 4) and strcmp(argv[4], "uart") == 0;
+    thermalPlant_t plant = thermalSimulatorDefaultPlant();
+
+    if(argc > 3){
+        plant.ambient_c = atof(argv[3]);
+    }
+
+    uint64_t real_start_us = hostClockUs();
+
+    thermalSimulatorInit(&plant);
+    hostAnalogWrite(PIN_AMBIENT_SENSOR, thermalSimulatorSensorSample()); // el sensor ya responde al encender
+    filamentDryerInit();
+    thermalSimulatorStart();
+    hostTimeoutClock = rtcNowUs; // el antirrebote del teclado con el reloj virtual
+
+    simulationRun(PRESS_MS); // pasa a detenido
+
+    if(by_uart){
+        char command[32];
+
+        snprintf(command, sizeof(command), "start %d %d\nstatus\n", temperature, hours);
+        hostSerialReceive(command);
+        simulationRun(PRESS_MS); // la tarea de comandos lo ejecuta en el próximo tick
+    }else{
+        // los valores se ajustan secando, en detenido se restablecen a los mínimos
+        simulationPress(PIN_BUTTON_RUN);
+
+        for(int h = MIN_TIME; h < hours; h = h + INCREMENT_TIME){
+            simulationPress(PIN_BUTTON_UP);
+        }
+
+        simulationPress(PIN_BUTTON_MODE); // modo temperatura
+
+        for(int t = MIN_TEMP; t < temperature; t = t + INCREMENT_TEMP){
+            simulationPress(PIN_BUTTON_UP);
+        }
+    }
+
+    uint64_t work_start_us = rtcNowUs();
+    float hotbed_max = 0;
+    float spool_max = 0;
+
+    while(filamentDryerReadState() == SYSTEM_WORK){
+        simulationLoop();
+
+        thermalState_t state = thermalSimulatorRead();
+
+        if(state.hotbed_c > hotbed_max){
+            hotbed_max = state.hotbed_c;
+        }
+
+        if(state.spool_c > spool_max){
+            spool_max = state.spool_c;
+        }
+    }
+
+    simulationRun(REPORT_MS);
+
+    thermalState_t state = thermalSimulatorRead();
+    uint64_t real_us = hostClockUs() - real_start_us;
+
+    printf("\n=== Simulación: %d C, %d h, ambiente %.1f C ===\n", temperature, hours, plant.ambient_c);
+    printf("tiempo virtual: %.2f h  tiempo real: %.2f s\n", (double)(rtcNowUs() - work_start_us) / US_PER_HOUR, real_us / 1e6);
+    printf("hotbed: final %.2f C  máxima %.2f C\n", state.hotbed_c, hotbed_max);
+    printf("aire: final %.2f C\n", state.air_c);
+    printf("bobina: final %.2f C  máxima %.2f C\n", state.spool_c, spool_max);
+    printf("energía: %.1f Wh\n", thermalSimulatorEnergyWh());
+
+    return 0;
+}
+
+//=====[Implementations of private functions]=========================
+/**
+ * @brief Una vuelta del bucle principal con el sensor simulado.
+ */
+static void simulationLoop(){
+    // con adquisición por consultas el sensor lee el pin analógico
+    hostAnalogWrite(PIN_AMBIENT_SENSOR, thermalSimulatorSensorSample());
+
+    hostTimeoutsRun(); // vencen los temporizadores del teclado
+
+    filamentDryerUpdate();
+}
+
+/**
+ * @brief Corre el bucle principal durante un tiempo virtual.
+ *
+ * @param ms Milisegundos virtuales.
+ */
+static void simulationRun(const int ms){
+    uint64_t end_us = rtcNowUs() + ms * US_PER_MS;
+
+    while(rtcNowUs() < end_us){
+        simulationLoop();
+    }
+}
+
+/**
+ * @brief Presiona y suelta un botón.
+ *
+ * @param pin Pin del botón.
+ */
+static void simulationPress(PinName pin){
+    hostPinWrite(pin, 1);
+    simulationRun(PRESS_MS);
+    hostPinWrite(pin, 0);
+    simulationRun(PRESS_MS);
+}
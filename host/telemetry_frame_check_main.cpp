@@ -0,0 +1,381 @@
+/**
+* @file telemetry_frame_check_main.cpp
+* @brief Prueba de ida y vuelta del códec de tramas de telemetría (COBS + CRC-16).
+*
+* Reemplaza a main.cpp en la compilación para host. Codifica cargas pseudoaleatorias (con
+* ceros, sin ceros, solo ceros y con corridas de 254 bytes distintos de 0, el límite de un
+* bloque COBS) y verifica que no quede ningún 0 y que la decodificación devuelva lo mismo.
+* Con cargas hasta el máximo de una trama arma y recupera tramas completas (COBS + CRC),
+* que deben terminar en un único 0x00, y también las tramas de estado y de muestras campo
+* por campo. Es el mismo códec que usa telemetry_ingest. Termina con código 1 si alguna falla.
+*
+* Compilación (desde la raíz del repositorio):
+*
+*   g++ -std=gnu++17 -O2 -Ihost -I. host/telemetry_frame_check_main.cpp modules/telemetry_frame/telemetry_frame.cpp -o telemetry_frame_check
+*
+* Uso: ./telemetry_frame_check [tramas] [semilla]
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]====================================================
+#include "mbed.h"
+#include <stdlib.h>
+#include "modules/telemetry_frame/telemetry_frame.h"
+
+//=====[Declaration of private defines]===============================
+#define DEFAULT_FRAMES  200000  /**< Tramas por prueba */
+#define DEFAULT_SEED    1   /**< Semilla del generador, la misma corrida se repite */
+#define MAX_COBS_INPUT  600 /**< Entrada COBS más larga, abarca varios bloques de 254 bytes */
+#define COBS_BLOCK  254 /**< Bytes distintos de 0 que entran en un bloque COBS */
+#define MAX_PAYLOAD TELEMETRY_FRAME_SAMPLES_MAX_LENGTH  /**< Carga más larga que acepta telemetryFrameWrap() */
+#define MAX_REPORTED    10  /**< Fallas que se detallan, el resto solo se cuenta */
+
+//=====[Declaration of private data types]============================
+/**
+ * @brief Forma de la carga de prueba.
+ */
+typedef enum{
+    PAYLOAD_RANDOM, /**< Bytes cualquiera, con ceros */
+    PAYLOAD_NON_ZERO,   /**< Sin ningún 0 */
+    PAYLOAD_BLOCK_RUN,  /**< Corridas de 254 bytes distintos de 0, con o sin un 0 entre ellas */
+    PAYLOAD_ZEROS,  /**< Solo ceros */
+    PAYLOAD_KINDS   /**< Cantidad de formas */
+}payloadKind_t;
+
+//=====[Declaration and Initialization of public global Variables]====
+
+//=====[Declaration and Initialization of private global Variables]===
+static uint32_t random_state = DEFAULT_SEED; /**< Estado del generador xorshift32 */
+static int failures = 0; /**< Fallas encontradas */
+
+//=====[Declarations (prototypes) of private functions]===============
+/**
+ * @brief Próximo número pseudoaleatorio (xorshift32).
+ *
+ * @return uint32_t Número.
+ */
+static uint32_t checkRandom();
+
+/**
+ * @brief Llena una carga de prueba.
+ *
+ * @param payload Destino de max_length bytes.
+ * @param kind Forma de la carga.
+ * @param max_length Largo máximo, las corridas de bloque necesitan MAX_COBS_INPUT.
+ *
+ * @return int Bytes de carga.
+ */
+static int checkFillPayload(uint8_t *payload, payloadKind_t kind, const int max_length);
+
+/**
+ * @brief Codifica y decodifica con COBS, cuenta una falla si no vuelve igual.
+ *
+ * @param input Bytes.
+ * @param length Cantidad de bytes.
+ * @param frame_number Número de trama, para el informe.
+ */
+static void checkCobs(const uint8_t *input, const int length, const int frame_number);
+
+/**
+ * @brief Arma y recupera una carga, cuenta una falla si no vuelve igual.
+ *
+ * @param payload Carga.
+ * @param length Bytes de carga.
+ * @param frame_number Número de trama, para el informe.
+ */
+static void checkWrap(const uint8_t *payload, const int length, const int frame_number);
+
+/**
+ * @brief Arma e interpreta una trama de estado pseudoaleatoria.
+ *
+ * @param frame_number Número de trama, para el informe.
+ */
+static void checkStatus(const int frame_number);
+
+/**
+ * @brief Arma e interpreta una trama de muestras pseudoaleatoria.
+ *
+ * @param frame_number Número de trama, para el informe.
+ */
+static void checkSamples(const int frame_number);
+
+/**
+ * @brief Cuenta una falla y la informa si no se superó MAX_REPORTED.
+ *
+ * @param frame_number Número de trama.
+ * @param reason Motivo.
+ */
+static void checkFail(const int frame_number, const char *reason);
+
+//=====[Main function]================================================
+/**
+ * @brief Punto de entrada de la prueba.
+ */
+int main(int argc, char *argv[]){
+    int frames = (argc > 1) ? atoi(argv[1]) : DEFAULT_FRAMES;
+    uint8_t payload[MAX_COBS_INPUT] = {0};
+    uint8_t frame[TELEMETRY_FRAME_ENCODED_MAX(MAX_PAYLOAD)];
+
+    random_state = (argc > 2) ? (uint32_t)strtoul(argv[2], nullptr, 0) : DEFAULT_SEED;
+
+    // xorshift no sale de 0
+    if(random_state == 0){
+        random_state = DEFAULT_SEED;
+    }
+
+    // una carga más larga que la máxima no se arma
+    if(telemetryFrameWrap(payload, MAX_PAYLOAD + 1, frame) != 0){
+        checkFail(-1, "carga demasiado larga aceptada");
+    }
+
+    for(int i = 0; i < frames; i++){
+        payloadKind_t kind = (payloadKind_t)(i % PAYLOAD_KINDS);
+        int length = checkFillPayload(payload, kind, MAX_COBS_INPUT);
+
+        checkCobs(payload, length, i);
+
+        // las corridas de bloque no entran en una trama, ahí van cargas sin ceros
+        length = checkFillPayload(payload, (kind == PAYLOAD_BLOCK_RUN) ? PAYLOAD_NON_ZERO : kind, MAX_PAYLOAD);
+
+        checkWrap(payload, length, i);
+        checkStatus(i);
+        checkSamples(i);
+    }
+
+    printf("# %d tramas de cada tipo, %d fallas\n", frames, failures);
+
+    return (failures > 0) ? 1 : 0;
+}
+
+//=====[Implementations of private functions]=========================
+/**
+ * @brief Próximo número pseudoaleatorio (xorshift32).
+ *
+ * @return uint32_t Número.
+ */
+static uint32_t checkRandom(){
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+
+    return random_state;
+}
+
+/**
+ * @brief Llena una carga de prueba.
+ *
+ * @param payload Destino de max_length bytes.
+ * @param kind Forma de la carga.
+ * @param max_length Largo máximo, las corridas de bloque necesitan MAX_COBS_INPUT.
+ *
+ * @return int Bytes de carga.
+ */
+static int checkFillPayload(uint8_t *payload, payloadKind_t kind, const int max_length){
+    int length = checkRandom() % (max_length + 1);
+
+    switch(kind){
+        case PAYLOAD_NON_ZERO:
+            for(int i = 0; i < length; i++){
+                payload[i] = 1 + checkRandom() % 255;
+            }
+        break;
+
+        case PAYLOAD_BLOCK_RUN:{
+            // dos corridas del largo de un bloque: el 0 en el límite o corrido un byte para
+            // cada lado, o sin 0 y un largo múltiplo exacto de 254
+            int zero = COBS_BLOCK - 1 + checkRandom() % 4;
+
+            if(zero > COBS_BLOCK + 1){
+                zero = -1;
+                length = COBS_BLOCK * (1 + checkRandom() % 2);
+            }
+            else{
+                length = zero + 1 + COBS_BLOCK + checkRandom() % 3;
+            }
+
+            for(int i = 0; i < length; i++){
+                payload[i] = (i == zero) ? 0 : 1 + checkRandom() % 255;
+            }
+        }
+        break;
+
+        case PAYLOAD_ZEROS:
+            memset(payload, 0, length);
+        break;
+
+        case PAYLOAD_RANDOM:
+        default:
+            for(int i = 0; i < length; i++){
+                payload[i] = checkRandom();
+            }
+        break;
+    }
+
+    return length;
+}
+
+/**
+ * @brief Codifica y decodifica con COBS, cuenta una falla si no vuelve igual.
+ *
+ * @param input Bytes.
+ * @param length Cantidad de bytes.
+ * @param frame_number Número de trama, para el informe.
+ */
+static void checkCobs(const uint8_t *input, const int length, const int frame_number){
+    uint8_t encoded[MAX_COBS_INPUT + MAX_COBS_INPUT / COBS_BLOCK + 1];
+    uint8_t decoded[sizeof(encoded)];
+    int encoded_length = telemetryFrameCobsEncode(input, length, encoded);
+
+    if(encoded_length < 1 or encoded_length > length + length / COBS_BLOCK + 1){
+        checkFail(frame_number, "largo COBS");
+        return;
+    }
+
+    if(memchr(encoded, TELEMETRY_FRAME_DELIMITER, encoded_length) != nullptr){
+        checkFail(frame_number, "0 en la codificación COBS");
+        return;
+    }
+
+    int decoded_length = telemetryFrameCobsDecode(encoded, encoded_length, decoded);
+
+    if(decoded_length != length or memcmp(decoded, input, length) != 0){
+        checkFail(frame_number, "COBS distinto");
+    }
+}
+
+/**
+ * @brief Arma y recupera una carga, cuenta una falla si no vuelve igual.
+ *
+ * @param payload Carga.
+ * @param length Bytes de carga.
+ * @param frame_number Número de trama, para el informe.
+ */
+static void checkWrap(const uint8_t *payload, const int length, const int frame_number){
+    uint8_t frame[TELEMETRY_FRAME_ENCODED_MAX(MAX_PAYLOAD)];
+    uint8_t decoded[TELEMETRY_FRAME_ENCODED_MAX(MAX_PAYLOAD)];
+    int frame_length = telemetryFrameWrap(payload, length, frame);
+
+    if(frame_length < 2 or frame_length > TELEMETRY_FRAME_ENCODED_MAX(length)){
+        checkFail(frame_number, "largo de trama");
+        return;
+    }
+
+    // el delimitador es el único 0 de la trama
+    if(frame[frame_length - 1] != TELEMETRY_FRAME_DELIMITER or memchr(frame, TELEMETRY_FRAME_DELIMITER, frame_length - 1) != nullptr){
+        checkFail(frame_number, "delimitador");
+        return;
+    }
+
+    int decoded_length = telemetryFrameUnwrap(frame, frame_length - 1, decoded);
+
+    if(decoded_length != length or memcmp(decoded, payload, length) != 0){
+        checkFail(frame_number, "carga distinta");
+    }
+}
+
+/**
+ * @brief Arma e interpreta una trama de estado pseudoaleatoria.
+ *
+ * @param frame_number Número de trama, para el informe.
+ */
+static void checkStatus(const int frame_number){
+    uint8_t frame[TELEMETRY_FRAME_ENCODED_MAX(TELEMETRY_FRAME_STATUS_LENGTH)];
+    uint8_t payload[TELEMETRY_FRAME_ENCODED_MAX(TELEMETRY_FRAME_STATUS_LENGTH)];
+    telemetryStatus_t status;
+    telemetryStatus_t decoded;
+
+    status.sequence = checkRandom();
+    status.temperature_centi = checkRandom();
+    status.setpoint = checkRandom();
+    status.elapsed_ms = checkRandom();
+    status.target_hours = checkRandom();
+    status.system_state = checkRandom();
+    status.adjust_mode = checkRandom();
+    status.heater = checkRandom();
+    status.output_percent = checkRandom();
+
+    int frame_length = telemetryFrameEncodeStatus(&status, frame);
+    int length = telemetryFrameUnwrap(frame, frame_length - 1, payload);
+
+    if(not telemetryFrameDecodeStatus(payload, length, &decoded)){
+        checkFail(frame_number, "trama de estado");
+        return;
+    }
+
+    if(decoded.sequence != status.sequence or decoded.temperature_centi != status.temperature_centi
+       or decoded.setpoint != status.setpoint or decoded.elapsed_ms != status.elapsed_ms
+       or decoded.target_hours != status.target_hours or decoded.system_state != status.system_state
+       or decoded.adjust_mode != status.adjust_mode or decoded.heater != status.heater
+       or decoded.output_percent != status.output_percent){
+        checkFail(frame_number, "campos de estado");
+    }
+}
+
+/**
+ * @brief Arma e interpreta una trama de muestras pseudoaleatoria.
+ *
+ * @param frame_number Número de trama, para el informe.
+ */
+static void checkSamples(const int frame_number){
+    uint8_t frame[TELEMETRY_FRAME_ENCODED_MAX(TELEMETRY_FRAME_SAMPLES_MAX_LENGTH)];
+    uint8_t payload[TELEMETRY_FRAME_ENCODED_MAX(TELEMETRY_FRAME_SAMPLES_MAX_LENGTH)];
+    telemetrySamples_t block;
+    telemetrySamples_t decoded;
+    bool equal;
+
+    block.sequence = checkRandom();
+    block.timestamp_us = checkRandom();
+    block.period_us = checkRandom();
+    block.decimation = checkRandom();
+    block.sample_count = checkRandom() % (TELEMETRY_FRAME_MAX_SAMPLES + 1);
+    block.event_count = checkRandom() % (TELEMETRY_FRAME_MAX_EVENTS + 1);
+
+    for(int i = 0; i < block.sample_count; i++){
+        block.samples[i] = checkRandom();
+    }
+
+    for(int i = 0; i < block.event_count; i++){
+        block.events[i].timestamp_us = checkRandom();
+        block.events[i].heater = checkRandom() % 2;
+    }
+
+    int frame_length = telemetryFrameEncodeSamples(&block, frame);
+    int length = telemetryFrameUnwrap(frame, frame_length - 1, payload);
+
+    if(not telemetryFrameDecodeSamples(payload, length, &decoded)){
+        checkFail(frame_number, "trama de muestras");
+        return;
+    }
+
+    equal = decoded.sequence == block.sequence and decoded.timestamp_us == block.timestamp_us
+        and decoded.period_us == block.period_us and decoded.decimation == block.decimation
+        and decoded.sample_count == block.sample_count and decoded.event_count == block.event_count;
+
+    for(int i = 0; equal and i < block.sample_count; i++){
+        equal = decoded.samples[i] == block.samples[i];
+    }
+
+    for(int i = 0; equal and i < block.event_count; i++){
+        equal = decoded.events[i].timestamp_us == block.events[i].timestamp_us and decoded.events[i].heater == block.events[i].heater;
+    }
+
+    if(not equal){
+        checkFail(frame_number, "campos de muestras");
+    }
+}
+
+/**
+ * @brief Cuenta una falla y la informa si no se superó MAX_REPORTED.
+ *
+ * @param frame_number Número de trama.
+ * @param reason Motivo.
+ */
+static void checkFail(const int frame_number, const char *reason){
+    failures = failures + 1;
+
+    if(failures <= MAX_REPORTED){
+        printf("FALLA trama %d: %s\n", frame_number, reason);
+    }
+}
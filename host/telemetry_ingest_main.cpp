@@ -0,0 +1,450 @@
+/**
+* @file telemetry_ingest_main.cpp
+* @brief Recibe la telemetría de una secadora por su puerto serie y la guarda en el registro de sesiones.
+*
+* Acepta las dos salidas del equipo en el mismo flujo: las líneas de texto de estado
+* ("temperature_now: ...", "-> Secado iniciado", ...) y las tramas binarias de estado
+* (COBS + CRC-16). Las tramas de muestras crudas se validan y se cuentan pero no se guardan.
+*
+* Compilación (desde la raíz del repositorio):
+*
+*   g++ -std=gnu++17 -O2 -Ihost -I. host/telemetry_ingest_main.cpp host/session_log.cpp modules/telemetry_frame/telemetry_frame.cpp -o telemetry_ingest
+*
+* Uso: ./telemetry_ingest <puerto|-> <directorio> <equipo>
+*
+* Con "-" lee la entrada estándar (por ejemplo la salida del simulador). Un puerto serie
+* se configura en modo crudo a 115200 baudios. Ctrl+C cierra la sesión en curso como interrumpida.
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]====================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <chrono>
+#include "session_log.h"
+#include "modules/telemetry_frame/telemetry_frame.h"
+#include "modules/filament_dryer_system/filament_dryer_system.h"
+
+//=====[Declaration of private defines]===============================
+#define INGEST_PENDING_MAX  256 /**< Bytes acumulados hasta un delimitador, más es basura */
+#define INGEST_READ_SIZE    512 /**< Bytes por lectura del puerto */
+#define MS_PER_SECOND   1000
+#define SECONDS_PER_MINUTE  60
+#define MINUTES_PER_HOUR    60
+
+//=====[Declaration of private data types]============================
+/**
+ * @brief Contadores de lo recibido, se informan al salir.
+ */
+typedef struct{
+    uint32_t text_rows; /**< Líneas de estado de texto guardadas */
+    uint32_t status_frames; /**< Tramas de estado válidas */
+    uint32_t sample_frames; /**< Tramas de muestras válidas (no se guardan) */
+    uint32_t bad_frames;    /**< Tramas con CRC o formato inválido */
+    uint32_t lost_frames;   /**< Huecos en la secuencia de las tramas de estado */
+    uint32_t sessions;  /**< Sesiones iniciadas */
+}ingestStats_t;
+
+//=====[Declaration and Initialization of public global Objects]======
+
+//=====[Declaration and Initialization of public global Variables]====
+
+//=====[Declaration and Initialization of private global Variables]===
+static volatile sig_atomic_t stop_requested = 0;    /**< Ctrl+C */
+static sessionLogWriter_t writer;   /**< Registro del equipo, grande para la pila */
+static ingestStats_t stats; /**< Contadores */
+static uint8_t pending[INGEST_PENDING_MAX]; /**< Bytes desde el último delimitador */
+static int pending_length = 0;  /**< Bytes en pending */
+static bool has_sequence = false;   /**< Se recibió al menos una trama de estado */
+static uint16_t last_sequence = 0;  /**< Secuencia de la última trama de estado */
+static uint32_t last_elapsed_ms = 0;    /**< Tiempo de secado de la última fila guardada */
+
+//=====[Declarations (prototypes) of private functions]===============
+/**
+ * @brief Marca el pedido de salida.
+ *
+ * @param signal_number Señal recibida.
+ */
+static void ingestOnSignal(int signal_number);
+
+/**
+ * @brief Abre el puerto y si es una terminal la pasa a modo crudo a 115200.
+ *
+ * @param path Ruta del puerto o "-".
+ *
+ * @return int Descriptor o -1.
+ */
+static int ingestOpenInput(const char *path);
+
+/**
+ * @brief Hora de la PC en ms desde 1970, identifica a las sesiones.
+ *
+ * @return uint64_t Milisegundos.
+ */
+static uint64_t ingestNowMs();
+
+/**
+ * @brief Separa los bytes recibidos en tramas binarias y líneas de texto.
+ *
+ * @param byte Byte recibido.
+ */
+static void ingestByte(const uint8_t byte);
+
+/**
+ * @brief Procesa una trama binaria completa (sin el delimitador).
+ *
+ * Si no es válida desde el comienzo se prueba después de cada fin de línea: antes de la
+ * trama pueden haber quedado líneas de texto que no se reconocieron.
+ */
+static void ingestFrame();
+
+/**
+ * @brief Intenta decodificar una trama.
+ *
+ * @param frame Bytes codificados.
+ * @param length Cantidad de bytes.
+ *
+ * @return true si era una trama válida.
+ */
+static bool ingestDecodeFrame(const uint8_t *frame, const int length);
+
+/**
+ * @brief Procesa una línea de texto completa (sin el fin de línea).
+ *
+ * @return true si era una línea conocida.
+ */
+static bool ingestLine();
+
+/**
+ * @brief Guarda una trama de estado, abre y cierra sesiones según el estado del equipo.
+ *
+ * @param status Trama decodificada.
+ */
+static void ingestStatus(const telemetryStatus_t *status);
+
+//=====[Main function]================================================
+/**
+ * @brief Punto de entrada del receptor.
+ */
+int main(int argc, char *argv[]){
+    struct sigaction action;
+    uint8_t buffer[INGEST_READ_SIZE];
+    int input;
+
+    if(argc != 4){
+        fprintf(stderr, "uso: %s <puerto|-> <directorio> <equipo>\n", argv[0]);
+        return 2;
+    }
+
+    input = ingestOpenInput(argv[1]);
+
+    if(input < 0){
+        fprintf(stderr, "no se pudo abrir %s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+
+    if(not sessionLogOpen(&writer, argv[2], argv[3])){
+        fprintf(stderr, "no se pudo abrir el registro de %s en %s\n", argv[3], argv[2]);
+        return 1;
+    }
+
+    // sin SA_RESTART para que read() vuelva al recibir Ctrl+C
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = ingestOnSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    while(not stop_requested){
+        ssize_t count = read(input, buffer, sizeof(buffer));
+
+        if(count == 0){
+            break;
+        }
+
+        if(count < 0){
+
+            if(errno == EINTR){
+                continue;
+            }
+
+            fprintf(stderr, "error de lectura: %s\n", strerror(errno));
+            break;
+        }
+
+        for(ssize_t i = 0; i < count; i++){
+            ingestByte(buffer[i]);
+        }
+    }
+
+    sessionLogClose(&writer);
+
+    if(input != STDIN_FILENO){
+        close(input);
+    }
+
+    fprintf(stderr, "sesiones: %u  filas de texto: %u  tramas de estado: %u  de muestras: %u  inválidas: %u  perdidas: %u\n",
+            stats.sessions, stats.text_rows, stats.status_frames, stats.sample_frames, stats.bad_frames, stats.lost_frames);
+
+    return 0;
+}
+
+//=====[Implementations of private functions]=========================
+/**
+ * @brief Marca el pedido de salida.
+ *
+ * @param signal_number Señal recibida.
+ */
+static void ingestOnSignal(int signal_number){
+    stop_requested = 1;
+}
+
+/**
+ * @brief Abre el puerto y si es una terminal la pasa a modo crudo a 115200.
+ *
+ * @param path Ruta del puerto o "-".
+ *
+ * @return int Descriptor o -1.
+ */
+static int ingestOpenInput(const char *path){
+    struct termios settings;
+    int input;
+
+    if(strcmp(path, "-") == 0){
+        return STDIN_FILENO;
+    }
+
+    input = open(path, O_RDONLY | O_NOCTTY);
+
+    if(input < 0 or not isatty(input)){
+        return input;
+    }
+
+    // los bytes binarios no deben pasar por la disciplina de línea
+    if(tcgetattr(input, &settings) == 0){
+        cfmakeraw(&settings);
+        cfsetispeed(&settings, B115200);
+        cfsetospeed(&settings, B115200);
+        settings.c_cflag = settings.c_cflag | CLOCAL | CREAD;
+        settings.c_cc[VMIN] = 1;
+        settings.c_cc[VTIME] = 0;
+        tcsetattr(input, TCSANOW, &settings);
+    }
+
+    return input;
+}
+
+/**
+ * @brief Hora de la PC en ms desde 1970, identifica a las sesiones.
+ *
+ * @return uint64_t Milisegundos.
+ */
+static uint64_t ingestNowMs(){
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Separa los bytes recibidos en tramas binarias y líneas de texto.
+ *
+ * @param byte Byte recibido.
+ */
+static void ingestByte(const uint8_t byte){
+
+    // el texto nunca tiene ceros y COBS nunca tiene ceros dentro de la trama
+    if(byte == TELEMETRY_FRAME_DELIMITER){
+        ingestFrame();
+        pending_length = 0;
+        return;
+    }
+
+    // una trama binaria puede tener un '\n' precedido de bytes imprimibles: solo se
+    // descartan las líneas reconocidas, el resto queda por si era parte de una trama
+    if(byte == '\n'){
+        bool printable = true;
+
+        for(int i = 0; i < pending_length and printable; i++){
+            printable = isprint(pending[i]) or isspace(pending[i]);
+        }
+
+        if(printable and ingestLine()){
+            pending_length = 0;
+            return;
+        }
+    }
+
+    // texto desconocido sin tramas, no hay nada que recuperar
+    if(pending_length == INGEST_PENDING_MAX){
+        pending_length = 0;
+    }
+
+    pending[pending_length] = byte;
+    pending_length = pending_length + 1;
+}
+
+/**
+ * @brief Procesa una trama binaria completa (sin el delimitador).
+ */
+static void ingestFrame(){
+
+    if(pending_length == 0 or ingestDecodeFrame(pending, pending_length)){
+        return;
+    }
+
+    for(int i = 0; i < pending_length - 1; i++){
+
+        if(pending[i] == '\n' and ingestDecodeFrame(pending + i + 1, pending_length - i - 1)){
+            return;
+        }
+    }
+
+    stats.bad_frames = stats.bad_frames + 1;
+}
+
+/**
+ * @brief Intenta decodificar una trama.
+ *
+ * @param frame Bytes codificados.
+ * @param length Cantidad de bytes.
+ *
+ * @return true si era una trama válida.
+ */
+static bool ingestDecodeFrame(const uint8_t *frame, const int length){
+    uint8_t payload[INGEST_PENDING_MAX];
+    telemetryStatus_t status;
+    telemetrySamples_t block;
+    int payload_length = telemetryFrameUnwrap(frame, length, payload);
+
+    if(telemetryFrameDecodeStatus(payload, payload_length, &status)){
+        stats.status_frames = stats.status_frames + 1;
+        ingestStatus(&status);
+        return true;
+    }
+
+    if(telemetryFrameDecodeSamples(payload, payload_length, &block)){
+        stats.sample_frames = stats.sample_frames + 1;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Procesa una línea de texto completa (sin el fin de línea).
+ *
+ * @return true si era una línea conocida.
+ */
+static bool ingestLine(){
+    char line[INGEST_PENDING_MAX + 1];
+    int temperature;
+    int setpoint;
+    int hours;
+    int minutes;
+    int seconds;
+    int target_hours;
+    int heater;
+    sessionRow_t row;
+    int start = pending_length;
+
+    // las líneas anteriores no reconocidas siguen en pending, se toma solo la última
+    while(start > 0 and pending[start - 1] != '\n'){
+        start = start - 1;
+    }
+
+    memcpy(line, pending + start, pending_length - start);
+    line[pending_length - start] = '\0';
+
+    if(strncmp(line, "-> Secado iniciado", 18) == 0){
+        sessionLogBegin(&writer, ingestNowMs(), 0, SESSION_SOURCE_TEXT);
+        stats.sessions = stats.sessions + 1;
+        last_elapsed_ms = 0;
+        return true;
+    }
+
+    if(strncmp(line, "-> Secado detenido", 18) == 0){
+        sessionLogEnd(&writer, SESSION_END_STOPPED);
+        return true;
+    }
+
+    if(strncmp(line, "-> Secado finalizado", 20) == 0){
+        sessionLogEnd(&writer, SESSION_END_FINISHED);
+        return true;
+    }
+
+    if(sscanf(line, "temperature_now: %d temperature_user: %d hour: %d minutes: %d seconds: %d hour_user: %d heater: %d",
+              &temperature, &setpoint, &hours, &minutes, &seconds, &target_hours, &heater) != 7){
+        return false;
+    }
+
+    row.elapsed_ms = ((hours * MINUTES_PER_HOUR + minutes) * SECONDS_PER_MINUTE + seconds) * MS_PER_SECOND;
+    row.temperature_centi = temperature * 100;
+    row.setpoint = setpoint;
+    row.heater = heater;
+    row.output_percent = heater ? 100 : 0;
+
+    // se empezó a escuchar con el secado en curso, o el equipo se reinició
+    if(not sessionLogIsOpen(&writer) or row.elapsed_ms < last_elapsed_ms){
+        sessionLogBegin(&writer, ingestNowMs(), target_hours, SESSION_SOURCE_TEXT);
+        stats.sessions = stats.sessions + 1;
+    }
+
+    sessionLogAppend(&writer, &row, target_hours);
+    last_elapsed_ms = row.elapsed_ms;
+    stats.text_rows = stats.text_rows + 1;
+
+    return true;
+}
+
+/**
+ * @brief Guarda una trama de estado, abre y cierra sesiones según el estado del equipo.
+ *
+ * @param status Trama decodificada.
+ */
+static void ingestStatus(const telemetryStatus_t *status){
+    sessionRow_t row;
+
+    // los huecos de la secuencia son tramas perdidas en el enlace, la secuencia 0 es un reinicio del equipo
+    if(has_sequence and status->sequence != 0){
+        uint16_t gap = status->sequence - last_sequence - 1;
+
+        if(gap != 0 and gap < 0x8000){
+            stats.lost_frames = stats.lost_frames + gap;
+            sessionLogLost(&writer, gap);
+        }
+    }
+
+    has_sequence = true;
+    last_sequence = status->sequence;
+
+    if(status->system_state != SYSTEM_WORK){
+
+        if(status->system_state == SYSTEM_FINISH or status->system_state == SYSTEM_FINISH_AWAIT){
+            sessionLogEnd(&writer, SESSION_END_FINISHED);
+        }else{
+            sessionLogEnd(&writer, SESSION_END_STOPPED);
+        }
+
+        return;
+    }
+
+    row.elapsed_ms = status->elapsed_ms;
+    row.temperature_centi = status->temperature_centi;
+    row.setpoint = status->setpoint;
+    row.heater = status->heater;
+    row.output_percent = status->output_percent;
+
+    if(not sessionLogIsOpen(&writer) or row.elapsed_ms < last_elapsed_ms){
+        sessionLogBegin(&writer, ingestNowMs(), status->target_hours, SESSION_SOURCE_BINARY);
+        stats.sessions = stats.sessions + 1;
+    }
+
+    sessionLogAppend(&writer, &row, status->target_hours);
+    last_elapsed_ms = row.elapsed_ms;
+}
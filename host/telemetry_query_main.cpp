@@ -0,0 +1,315 @@
+/**
+* @file telemetry_query_main.cpp
+* @brief Consulta el registro de sesiones de secado generado por telemetry_ingest.
+*
+* El resumen por sesión sale solo del índice (.tidx), sin decodificar las columnas,
+* por lo que semanas de registro de varios equipos se recorren en milisegundos.
+*
+* Compilación (desde la raíz del repositorio):
+*
+*   g++ -std=gnu++17 -O2 -Ihost -I. host/telemetry_query_main.cpp host/session_log.cpp -o telemetry_query
+*
+* Uso: ./telemetry_query <directorio> [equipo]            resumen CSV de cada sesión
+*      ./telemetry_query <directorio> <equipo> <sesion>   filas CSV de una sesión
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]====================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "session_log.h"
+
+//=====[Declaration of private defines]===============================
+#define INDEX_EXTENSION ".tidx" /**< Extensión del índice de cada equipo */
+
+//=====[Declaration of private data types]============================
+/**
+ * @brief Resumen de una sesión armado con sus bloques.
+ */
+typedef struct{
+    uint64_t session_id;    /**< Hora de la PC al iniciar */
+    uint8_t end;    /**< sessionEnd_t del último bloque */
+    uint8_t setpoint;   /**< Consigna del último bloque */
+    uint8_t target_hours;   /**< Horas configuradas del último bloque */
+    uint32_t rows;  /**< Filas */
+    uint32_t first_ms;  /**< Tiempo de secado de la primera fila */
+    uint32_t last_ms;   /**< Tiempo de secado de la última fila */
+    int16_t min_centi;  /**< Temperatura mínima */
+    int16_t max_centi;  /**< Temperatura máxima */
+    int64_t temperature_sum;    /**< Suma de temperatura por milisegundos */
+    uint64_t total_ms;  /**< Tiempo ponderado */
+    uint64_t heater_on_ms;  /**< Tiempo con el calentador encendido */
+    uint64_t above_ms;  /**< Tiempo sobre la consigna */
+    uint32_t lost_frames;   /**< Tramas perdidas */
+}querySession_t;
+
+//=====[Declaration and Initialization of public global Objects]======
+
+//=====[Declaration and Initialization of public global Variables]====
+
+//=====[Declarations (prototypes) of private functions]===============
+/**
+ * @brief Imprime el resumen de las sesiones de un equipo.
+ *
+ * @param directory Directorio del registro.
+ * @param dryer Nombre del equipo.
+ *
+ * @return true si se pudo leer el índice.
+ */
+static bool querySummary(const char *directory, const char *dryer);
+
+/**
+ * @brief Imprime las filas de una sesión.
+ *
+ * @param directory Directorio del registro.
+ * @param dryer Nombre del equipo.
+ * @param session_id Identificador de la sesión.
+ *
+ * @return true si la sesión existe y sus bloques son válidos.
+ */
+static bool queryRows(const char *directory, const char *dryer, const uint64_t session_id);
+
+/**
+ * @brief Agrega un bloque al resumen de su sesión.
+ *
+ * @param session Resumen.
+ * @param chunk Bloque del índice.
+ */
+static void queryAccumulate(querySession_t *session, const sessionChunk_t *chunk);
+
+/**
+ * @brief Nombre de cómo terminó una sesión.
+ *
+ * @param end sessionEnd_t.
+ *
+ * @return const char* Nombre.
+ */
+static const char *queryEndName(const uint8_t end);
+
+//=====[Main function]================================================
+/**
+ * @brief Punto de entrada de las consultas.
+ */
+int main(int argc, char *argv[]){
+    std::vector<std::string> dryers;
+    bool ok = true;
+
+    if(argc < 2 or argc > 4){
+        fprintf(stderr, "uso: %s <directorio> [equipo [sesion]]\n", argv[0]);
+        return 2;
+    }
+
+    if(argc == 4){
+        return queryRows(argv[1], argv[2], strtoull(argv[3], nullptr, 10)) ? 0 : 1;
+    }
+
+    if(argc == 3){
+        dryers.push_back(argv[2]);
+    }else{
+        DIR *directory = opendir(argv[1]);
+        struct dirent *entry;
+
+        if(directory == nullptr){
+            fprintf(stderr, "no se pudo abrir %s\n", argv[1]);
+            return 1;
+        }
+
+        // cada equipo tiene su índice
+        while((entry = readdir(directory)) != nullptr){
+            std::string name = entry->d_name;
+            size_t extension = strlen(INDEX_EXTENSION);
+
+            if(name.size() > extension and name.compare(name.size() - extension, extension, INDEX_EXTENSION) == 0){
+                dryers.push_back(name.substr(0, name.size() - extension));
+            }
+        }
+
+        closedir(directory);
+    }
+
+    printf("equipo,sesion,inicio,fin,consigna_c,horas,duracion_s,minima_c,maxima_c,media_c,calentador_pct,sobre_consigna_s,tramas_perdidas,filas\n");
+
+    for(const std::string &dryer : dryers){
+        ok = querySummary(argv[1], dryer.c_str()) and ok;
+    }
+
+    return ok ? 0 : 1;
+}
+
+//=====[Implementations of private functions]=========================
+/**
+ * @brief Imprime el resumen de las sesiones de un equipo.
+ *
+ * @param directory Directorio del registro.
+ * @param dryer Nombre del equipo.
+ *
+ * @return true si se pudo leer el índice.
+ */
+static bool querySummary(const char *directory, const char *dryer){
+    char path[SESSION_LOG_PATH_MAX];
+    std::vector<sessionChunk_t> chunks;
+    std::map<uint64_t, querySession_t> sessions;
+
+    snprintf(path, sizeof(path), "%s/%s.tidx", directory, dryer);
+
+    if(not sessionLogReadIndex(path, &chunks)){
+        fprintf(stderr, "índice inválido: %s\n", path);
+        return false;
+    }
+
+    for(const sessionChunk_t &chunk : chunks){
+        auto found = sessions.find(chunk.session_id);
+
+        if(found == sessions.end()){
+            querySession_t session;
+
+            memset(&session, 0, sizeof(session));
+            session.session_id = chunk.session_id;
+            found = sessions.emplace(chunk.session_id, session).first;
+        }
+
+        queryAccumulate(&found->second, &chunk);
+    }
+
+    for(const auto &entry : sessions){
+        const querySession_t &session = entry.second;
+        time_t start = session.session_id / 1000;
+        struct tm local;
+        char start_text[32];
+        double mean = 0;
+        double duty = 0;
+
+        localtime_r(&start, &local);
+        strftime(start_text, sizeof(start_text), "%Y-%m-%d %H:%M:%S", &local);
+
+        if(session.total_ms > 0){
+            mean = (double)session.temperature_sum / session.total_ms / 100.0;
+            duty = 100.0 * session.heater_on_ms / session.total_ms;
+        }
+
+        printf("%s,%llu,%s,%s,%u,%u,%.1f,%.2f,%.2f,%.2f,%.1f,%.1f,%u,%u\n",
+               dryer, (unsigned long long)session.session_id, start_text, queryEndName(session.end),
+               session.setpoint, session.target_hours, (session.last_ms - session.first_ms) / 1000.0,
+               session.min_centi / 100.0, session.max_centi / 100.0, mean, duty,
+               session.above_ms / 1000.0, session.lost_frames, session.rows);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Imprime las filas de una sesión.
+ *
+ * @param directory Directorio del registro.
+ * @param dryer Nombre del equipo.
+ * @param session_id Identificador de la sesión.
+ *
+ * @return true si la sesión existe y sus bloques son válidos.
+ */
+static bool queryRows(const char *directory, const char *dryer, const uint64_t session_id){
+    char index_path[SESSION_LOG_PATH_MAX];
+    char log_path[SESSION_LOG_PATH_MAX];
+    std::vector<sessionChunk_t> chunks;
+    std::vector<sessionRow_t> rows;
+    bool found = false;
+
+    snprintf(index_path, sizeof(index_path), "%s/%s.tidx", directory, dryer);
+    snprintf(log_path, sizeof(log_path), "%s/%s.tlog", directory, dryer);
+
+    if(not sessionLogReadIndex(index_path, &chunks)){
+        fprintf(stderr, "índice inválido: %s\n", index_path);
+        return false;
+    }
+
+    // solo se decodifican los bloques de la sesión pedida
+    for(const sessionChunk_t &chunk : chunks){
+
+        if(chunk.session_id != session_id){
+            continue;
+        }
+
+        found = true;
+
+        if(not sessionLogReadRows(log_path, &chunk, &rows)){
+            fprintf(stderr, "bloque inválido en %s, posición %llu\n", log_path, (unsigned long long)chunk.offset);
+            return false;
+        }
+    }
+
+    if(not found){
+        fprintf(stderr, "no existe la sesión %llu de %s\n", (unsigned long long)session_id, dryer);
+        return false;
+    }
+
+    printf("tiempo_s,temperatura_c,consigna_c,calentador,salida_pct\n");
+
+    for(const sessionRow_t &row : rows){
+        printf("%.1f,%.2f,%u,%u,%u\n", row.elapsed_ms / 1000.0, row.temperature_centi / 100.0, row.setpoint, row.heater, row.output_percent);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Agrega un bloque al resumen de su sesión.
+ *
+ * @param session Resumen.
+ * @param chunk Bloque del índice.
+ */
+static void queryAccumulate(querySession_t *session, const sessionChunk_t *chunk){
+
+    // el bloque que marca el final puede no tener filas
+    if(chunk->rows > 0){
+
+        if(session->rows == 0){
+            session->first_ms = chunk->first_ms;
+            session->min_centi = chunk->min_centi;
+            session->max_centi = chunk->max_centi;
+        }
+
+        if(chunk->min_centi < session->min_centi){
+            session->min_centi = chunk->min_centi;
+        }
+
+        if(chunk->max_centi > session->max_centi){
+            session->max_centi = chunk->max_centi;
+        }
+
+        session->last_ms = chunk->last_ms;
+        session->setpoint = chunk->setpoint;
+        session->target_hours = chunk->target_hours;
+    }
+
+    session->rows = session->rows + chunk->rows;
+    session->temperature_sum = session->temperature_sum + chunk->temperature_sum;
+    session->total_ms = session->total_ms + chunk->total_ms;
+    session->heater_on_ms = session->heater_on_ms + chunk->heater_on_ms;
+    session->above_ms = session->above_ms + chunk->above_ms;
+    session->lost_frames = session->lost_frames + chunk->lost_frames;
+    session->end = chunk->end;
+}
+
+/**
+ * @brief Nombre de cómo terminó una sesión.
+ *
+ * @param end sessionEnd_t.
+ *
+ * @return const char* Nombre.
+ */
+static const char *queryEndName(const uint8_t end){
+
+    switch (end){
+        case SESSION_END_FINISHED: return "finalizada";
+        case SESSION_END_STOPPED: return "detenida";
+        case SESSION_END_INTERRUPTED: return "interrumpida";
+        default: return "abierta";
+    }
+}
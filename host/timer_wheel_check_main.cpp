@@ -0,0 +1,372 @@
+/**
+* @file timer_wheel_check_main.cpp
+* @brief Prueba de la rueda de temporizadores contra un modelo de referencia.
+*
+* Reemplaza a main.cpp en la compilación para host. Avanza un reloj virtual de a un tick y
+* compara cada vencimiento con el tick que predice un modelo simple (vencimiento absoluto y
+* periodo por temporizador). Primero prueba periodos de justo 64 * k ticks (la vuelta de una
+* ranura de cada nivel) y vecinos, y temporizadores que se rearman desde su callback o
+* rearman a otro con 63 ticks (630 ms). Después los callbacks arrancan y detienen
+* temporizadores al azar, también los que vencen en el mismo tick y todavía no se
+* ejecutaron. Termina con código 1 si algún temporizador vence fuera de su tick o no vence, o si la
+* rueda no termina un tick.
+*
+* Compilación (desde la raíz del repositorio):
+*
+*   g++ -std=gnu++17 -O2 -Ihost -I. host/timer_wheel_check_main.cpp modules/timer_wheel/timer_wheel.cpp modules/rtc/rtc.cpp -o timer_wheel_check
+*
+* Uso: ./timer_wheel_check [ticks] [semilla]
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]====================================================
+#include "mbed.h"
+#include <stdlib.h>
+#include "modules/rtc/rtc.h"
+#include "modules/timer_wheel/timer_wheel.h"
+
+//=====[Declaration of private defines]===============================
+#define TICK_MS 10  /**< Duración de un tick de la rueda (TIME_MS) */
+#define TICK_US (TICK_MS * 1000ULL) /**< Duración de un tick en microsegundos */
+#define DEFAULT_TICKS   2000000 /**< Ticks de la prueba al azar (5,5 horas virtuales) */
+#define DEFAULT_SEED    1   /**< Semilla del generador, la misma corrida se repite */
+#define CHECK_TIMERS    8   /**< Temporizadores de la prueba */
+#define SLOT_TICKS  64  /**< Ticks de una vuelta del primer nivel */
+#define FIXED_PERIODS   20  /**< Vueltas que se prueban con el periodo más largo */
+#define MAX_DELAY_TICKS 300000  /**< Retardo más largo al azar, llega al cuarto nivel */
+#define MAX_FIRED_PER_TICK  (4 * CHECK_TIMERS)  /**< Vencimientos en un tick que indican que la rueda quedó en un ciclo */
+#define NOT_ARMED   -1  /**< El modelo no espera ningún vencimiento */
+#define MAX_REPORTED    10  /**< Fallas que se detallan, el resto solo se cuenta */
+
+//=====[Declaration of private data types]============================
+/**
+ * @brief Lo que hace el callback de un temporizador al vencer.
+ */
+typedef enum{
+    ACTION_NONE,    /**< Nada */
+    ACTION_REARM,   /**< Se rearma de un solo disparo con rearm_ticks */
+    ACTION_START_NEXT,  /**< Arranca al temporizador siguiente de un solo disparo con rearm_ticks */
+    ACTION_RANDOM   /**< Arranca o detiene temporizadores al azar */
+}checkAction_t;
+
+/**
+ * @brief Modelo de un temporizador.
+ */
+typedef struct{
+    int id; /**< Identificador en la rueda */
+    int64_t expires;    /**< Tick en que debe vencer, NOT_ARMED si está detenido */
+    uint32_t period;    /**< Periodo en ticks, 0 para un solo disparo */
+    checkAction_t action;   /**< Lo que hace al vencer */
+    uint32_t rearm_ticks;   /**< Retardo de ACTION_REARM y ACTION_START_NEXT */
+    int fired;  /**< Vencimientos */
+}checkTimer_t;
+
+//=====[Declaration and Initialization of public global Variables]====
+
+//=====[Declaration and Initialization of private global Variables]===
+static checkTimer_t model[CHECK_TIMERS]; /**< Modelo de cada temporizador */
+static uint64_t virtual_us = 0; /**< Reloj virtual */
+static int64_t tick = 0; /**< Tick que se está procesando */
+static int fired_in_tick = 0; /**< Vencimientos en el tick que se está procesando */
+static uint32_t random_state = DEFAULT_SEED; /**< Estado del generador xorshift32 */
+static int failures = 0; /**< Fallas encontradas */
+
+//=====[Declarations (prototypes) of private functions]===============
+/**
+ * @brief Reloj virtual para la rueda.
+ *
+ * @return uint64_t Microsegundos.
+ */
+static uint64_t checkClock();
+
+/**
+ * @brief Próximo número pseudoaleatorio (xorshift32).
+ *
+ * @return uint32_t Número.
+ */
+static uint32_t checkRandom();
+
+/**
+ * @brief Arranca un temporizador en la rueda y en el modelo.
+ *
+ * @param timer Temporizador del modelo.
+ * @param delay_ticks Ticks hasta el vencimiento.
+ * @param period_ticks Periodo en ticks, 0 para un solo disparo.
+ */
+static void checkStart(const int timer, const uint32_t delay_ticks, const uint32_t period_ticks);
+
+/**
+ * @brief Detiene un temporizador en la rueda y en el modelo.
+ *
+ * @param timer Temporizador del modelo.
+ */
+static void checkStop(const int timer);
+
+/**
+ * @brief Compara un vencimiento con el modelo y ejecuta la acción del temporizador.
+ *
+ * @param timer Temporizador del modelo que venció.
+ */
+static void checkFired(const int timer);
+
+/**
+ * @brief Callback de cada temporizador, la rueda no pasa argumentos.
+ */
+template<int TIMER> static void checkCallback(){
+    checkFired(TIMER);
+}
+
+/**
+ * @brief Avanza el reloj virtual de a un tick y procesa cada uno.
+ *
+ * @param ticks Ticks a avanzar.
+ */
+static void checkRun(const int64_t ticks);
+
+/**
+ * @brief Detiene todos los temporizadores y vuelve a ACTION_NONE.
+ */
+static void checkReset();
+
+/**
+ * @brief Cuenta una falla y la informa si no se superó MAX_REPORTED.
+ *
+ * @param timer Temporizador del modelo.
+ * @param reason Motivo.
+ */
+static void checkFail(const int timer, const char *reason);
+
+//=====[Main function]================================================
+/**
+ * @brief Punto de entrada de la prueba.
+ */
+int main(int argc, char *argv[]){
+    int64_t ticks = (argc > 1) ? atoll(argv[1]) : DEFAULT_TICKS;
+    const timerWheelCallback_t callbacks[CHECK_TIMERS] = {
+        checkCallback<0>, checkCallback<1>, checkCallback<2>, checkCallback<3>,
+        checkCallback<4>, checkCallback<5>, checkCallback<6>, checkCallback<7>
+    };
+    const uint32_t periods[CHECK_TIMERS] = {SLOT_TICKS - 1, SLOT_TICKS, SLOT_TICKS + 1, 2 * SLOT_TICKS, 3 * SLOT_TICKS, SLOT_TICKS * SLOT_TICKS, SLOT_TICKS * SLOT_TICKS + SLOT_TICKS};
+
+    random_state = (argc > 2) ? (uint32_t)strtoul(argv[2], nullptr, 0) : DEFAULT_SEED;
+
+    // xorshift no sale de 0
+    if(random_state == 0){
+        random_state = DEFAULT_SEED;
+    }
+
+    rtcSetClockSource(checkClock);
+    timerWheelInit();
+
+    for(int i = 0; i < CHECK_TIMERS; i++){
+        model[i].id = timerWheelCreate(callbacks[i]);
+        model[i].expires = NOT_ARMED;
+    }
+
+    tick = -1; // la rueda procesa primero el tick 0
+
+    // periodos de 64 * k ticks: el siguiente vencimiento cae en la ranura que se está vaciando
+    for(int i = 0; i < CHECK_TIMERS - 1; i++){
+        checkStart(i, periods[i], periods[i]);
+    }
+
+    checkRun((int64_t)FIXED_PERIODS * SLOT_TICKS * SLOT_TICKS);
+
+    for(int i = 0; i < CHECK_TIMERS - 1; i++){
+        if(model[i].fired != tick / periods[i]){
+            checkFail(i, "periodo de 64 * k ticks");
+        }
+    }
+
+    checkReset();
+
+    // rearmados desde el callback con 630 ms, el nuevo vencimiento también cae en esa ranura
+    model[0].action = ACTION_REARM;
+    model[0].rearm_ticks = SLOT_TICKS - 1;
+    model[1].action = ACTION_START_NEXT;
+    model[1].rearm_ticks = SLOT_TICKS - 1;
+    model[3].action = ACTION_REARM;
+    model[3].rearm_ticks = SLOT_TICKS * SLOT_TICKS - 1;
+
+    checkStart(0, 1, 0);
+    checkStart(1, 5, 3 * SLOT_TICKS);
+    checkStart(3, 7, 0);
+
+    checkRun((int64_t)FIXED_PERIODS * SLOT_TICKS * SLOT_TICKS);
+
+    if(model[0].fired < FIXED_PERIODS or model[2].fired < FIXED_PERIODS or model[3].fired < FIXED_PERIODS){
+        checkFail(-1, "rearmado desde el callback");
+    }
+
+    checkReset();
+
+    // al azar, los callbacks arrancan y detienen a cualquiera
+    for(int i = 0; i < CHECK_TIMERS; i++){
+        model[i].action = ACTION_RANDOM;
+        checkStart(i, 1 + checkRandom() % (2 * SLOT_TICKS), (i % 2) ? 1 + checkRandom() % (2 * SLOT_TICKS) : 0);
+    }
+
+    checkRun(ticks);
+
+    printf("# %lld ticks, %d fallas\n", (long long)tick, failures);
+
+    return (failures > 0) ? 1 : 0;
+}
+
+//=====[Implementations of private functions]=========================
+/**
+ * @brief Reloj virtual para la rueda.
+ *
+ * @return uint64_t Microsegundos.
+ */
+static uint64_t checkClock(){
+    return virtual_us;
+}
+
+/**
+ * @brief Próximo número pseudoaleatorio (xorshift32).
+ *
+ * @return uint32_t Número.
+ */
+static uint32_t checkRandom(){
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+
+    return random_state;
+}
+
+/**
+ * @brief Arranca un temporizador en la rueda y en el modelo.
+ *
+ * @param timer Temporizador del modelo.
+ * @param delay_ticks Ticks hasta el vencimiento.
+ * @param period_ticks Periodo en ticks, 0 para un solo disparo.
+ */
+static void checkStart(const int timer, const uint32_t delay_ticks, const uint32_t period_ticks){
+
+    // la rueda cuenta el retardo desde el próximo tick a procesar
+    model[timer].expires = tick + 1 + delay_ticks;
+    model[timer].period = period_ticks;
+
+    timerWheelStart(model[timer].id, delay_ticks * TICK_MS, period_ticks * TICK_MS);
+}
+
+/**
+ * @brief Detiene un temporizador en la rueda y en el modelo.
+ *
+ * @param timer Temporizador del modelo.
+ */
+static void checkStop(const int timer){
+    model[timer].expires = NOT_ARMED;
+
+    timerWheelStop(model[timer].id);
+}
+
+/**
+ * @brief Compara un vencimiento con el modelo y ejecuta la acción del temporizador.
+ *
+ * @param timer Temporizador del modelo que venció.
+ */
+static void checkFired(const int timer){
+
+    fired_in_tick = fired_in_tick + 1;
+
+    // un temporizador que vuelve a la ranura que se está vaciando vence sin fin
+    if(fired_in_tick > MAX_FIRED_PER_TICK){
+        checkFail(timer, "la rueda no termina el tick");
+        printf("# %d fallas\n", failures);
+        exit(1);
+    }
+
+    if(model[timer].expires != tick){
+        checkFail(timer, (model[timer].expires == NOT_ARMED) ? "vence detenido" : "vence fuera de su tick");
+    }
+
+    model[timer].fired = model[timer].fired + 1;
+    model[timer].expires = (model[timer].period > 0) ? tick + model[timer].period : NOT_ARMED;
+
+    if(timerWheelIsActive(model[timer].id) != (model[timer].expires != NOT_ARMED)){
+        checkFail(timer, "estado activo");
+    }
+
+    switch(model[timer].action){
+        case ACTION_REARM:
+            checkStart(timer, model[timer].rearm_ticks, 0);
+        break;
+
+        case ACTION_START_NEXT:
+            checkStart(timer + 1, model[timer].rearm_ticks, 0);
+        break;
+
+        case ACTION_RANDOM:{
+            int other = checkRandom() % CHECK_TIMERS;
+            uint32_t choice = checkRandom() % 8;
+
+            // retardos cortos que vuelven a la misma ranura o a la del nivel superior, y alguno largo
+            if(choice < 3){
+                checkStart(other, (choice == 0) ? SLOT_TICKS - 1 : (choice == 1) ? SLOT_TICKS * SLOT_TICKS - 1 : 1 + checkRandom() % MAX_DELAY_TICKS, (checkRandom() % 2) ? SLOT_TICKS : 0);
+            }else if(choice < 5){
+                checkStart(other, 1 + checkRandom() % (2 * SLOT_TICKS), 0);
+            }else if(choice < 6){
+                checkStop(other);
+            }
+        }
+        break;
+
+        default:
+        break;
+    }
+}
+
+/**
+ * @brief Avanza el reloj virtual de a un tick y procesa cada uno.
+ *
+ * @param ticks Ticks a avanzar.
+ */
+static void checkRun(const int64_t ticks){
+
+    for(int64_t i = 0; i < ticks; i++){
+        tick = tick + 1;
+        virtual_us = tick * TICK_US;
+        fired_in_tick = 0;
+
+        timerWheelUpdate();
+
+        // ningún temporizador puede quedar vencido sin ejecutarse
+        for(int timer = 0; timer < CHECK_TIMERS; timer++){
+            if(model[timer].expires != NOT_ARMED and model[timer].expires <= tick){
+                checkFail(timer, "no vence");
+                model[timer].expires = NOT_ARMED;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Detiene todos los temporizadores y vuelve a ACTION_NONE.
+ */
+static void checkReset(){
+
+    for(int timer = 0; timer < CHECK_TIMERS; timer++){
+        checkStop(timer);
+        model[timer].action = ACTION_NONE;
+        model[timer].fired = 0;
+    }
+}
+
+/**
+ * @brief Cuenta una falla y la informa si no se superó MAX_REPORTED.
+ *
+ * @param timer Temporizador del modelo.
+ * @param reason Motivo.
+ */
+static void checkFail(const int timer, const char *reason){
+    failures = failures + 1;
+
+    if(failures <= MAX_REPORTED){
+        printf("FALLA tick %lld temporizador %d: %s\n", (long long)tick, timer, reason);
+    }
+}
@@ -37,6 +37,9 @@ int main(){
         //filamentDryerTestingKeyPad();
         //filamentDryerTestingHeaterManual();
         //filamentDryerTestingHeaterAutomatic();
+        //filamentDryerTestingHeaterAutotune();
+        //filamentDryerTestingSensorBenchmark();
+        //filamentDryerTestingFormatBenchmark();
     }
 
 }
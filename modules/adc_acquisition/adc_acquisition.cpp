@@ -0,0 +1,427 @@
+/**
+* @file adc_acquisition.cpp
+* @brief Implementación de la adquisición continua del ADC en doble buffer.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "adc_acquisition.h"
+#include "modules/rtc/rtc.h"
+#include "hal/analogin_api.h"
+
+// En STM32F4 el muestreo lo hacen TIM2 + ADC1 + DMA2 sin intervención de la CPU
+#if defined(TARGET_STM32F4) && !defined(ADC_ACQUISITION_NO_DMA)
+#define ADC_ACQUISITION_DMA 1
+#include "stm32f4xx_hal.h"
+#else
+#define ADC_ACQUISITION_DMA 0
+#endif
+
+//=====[Declaration of private defines]=================================
+#define BLOCK   ADC_ACQUISITION_BLOCK_SAMPLES /**< Muestras en cada mitad del doble buffer */
+
+#define DMA_IRQ_PRIORITY    2   /**< Prioridad de la interrupción del DMA */
+#define ADC_IRQ_PRIORITY    2   /**< Prioridad de la interrupción del ADC (desborde) */
+
+#define BURST_POLL_MAX  10000   /**< Consultas máximas esperando el fin de una conversión por software */
+#define ADC_STABILIZATION_US    3   /**< Espera desde que se enciende el ADC hasta la primera conversión */
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration and initialization of public global objects]========
+#if !ADC_ACQUISITION_DMA
+Ticker* adcTicker = nullptr; /** Dispara cada conversión cuando no hay DMA */
+#endif
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+static analogin_t adcPin; /**< Canal analógico (objeto del HAL de mbed) */
+static uint16_t buffer[2 * BLOCK]; /**< Doble buffer, el DMA escribe una mitad mientras se procesa la otra */
+static int period_us = 0; /**< Periodo de muestreo */
+static adcBlockCallback_t block_callback = nullptr; /**< Receptor de los bloques */
+static volatile int overruns = 0; /**< Desbordes del ADC */
+static bool running = false; /**< Adquisición real en marcha */
+
+static adcFakeSource_t fake_source = nullptr; /**< Fuente simulada, nullptr usa el ADC */
+static uint64_t fake_next_us = 0; /**< Próxima muestra de la fuente simulada */
+static int buffer_position = 0; /**< Próxima posición a escribir sin DMA */
+
+#if ADC_ACQUISITION_DMA
+static DMA_HandleTypeDef dmaHandle; /**< DMA2 Stream0 canal 0 (ADC1) */
+static TIM_HandleTypeDef timHandle; /**< TIM2, genera el TRGO que dispara cada conversión */
+#endif
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Guarda una muestra sin DMA y entrega la mitad del buffer al completarse.
+ *
+ * @param sample Muestra con escala de read_u16().
+ */
+static void adcAcquisitionStore(uint16_t sample);
+
+#if ADC_ACQUISITION_DMA
+/**
+ * @brief Configura TIM2, ADC1 y DMA2 para el muestreo continuo.
+ */
+static void adcDmaInit();
+
+/**
+ * @brief Interrupción del DMA2 Stream0.
+ */
+static void adcDmaIrqHandler();
+
+/**
+ * @brief Interrupción del ADC, atiende el desborde (OVR).
+ */
+static void adcIrqHandler();
+#else
+/**
+ * @brief Interrupción del Ticker, toma una conversión.
+ */
+static void adcTickerHandler();
+#endif
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Inicializa la adquisición continua.
+ *
+ * En STM32F4 el TIM2 dispara el ADC1 y el DMA2 copia las conversiones a un doble buffer
+ * circular; en otros targets un Ticker toma las muestras. No arranca la adquisición.
+ *
+ * @param pin Pin analógico a muestrear.
+ * @param sample_period_us Periodo de muestreo en microsegundos.
+ * @param callback Función que recibe cada bloque completo.
+ */
+void adcAcquisitionInit(PinName pin, const int sample_period_us, adcBlockCallback_t callback){
+
+    period_us = sample_period_us;
+    block_callback = callback;
+    overruns = 0;
+    buffer_position = 0;
+    running = false;
+
+    // configura el pin, el reloj del ADC y el canal
+    analogin_init(&adcPin, pin);
+
+#if ADC_ACQUISITION_DMA
+    adcDmaInit();
+#else
+    if(adcTicker == nullptr){
+        adcTicker = new Ticker();
+    }
+#endif
+}
+
+/**
+ * @brief Arranca la adquisición continua.
+ */
+void adcAcquisitionStart(){
+
+    // sin inicializar, ya corriendo o reemplazado por la fuente simulada
+    if(block_callback == nullptr or running or fake_source != nullptr){
+        return;
+    }
+
+    running = true;
+    buffer_position = 0;
+
+#if ADC_ACQUISITION_DMA
+    HAL_ADC_Start_DMA(&adcPin.handle, (uint32_t*)buffer, 2 * BLOCK);
+    HAL_TIM_Base_Start(&timHandle);
+#else
+    adcTicker->attach(adcTickerHandler, std::chrono::microseconds(period_us));
+#endif
+}
+
+/**
+ * @brief Detiene la adquisición continua.
+ */
+void adcAcquisitionStop(){
+
+    if(running == false){
+        return;
+    }
+
+    running = false;
+
+#if ADC_ACQUISITION_DMA
+    HAL_TIM_Base_Stop(&timHandle);
+    HAL_ADC_Stop_DMA(&adcPin.handle);
+#else
+    adcTicker->detach();
+#endif
+}
+
+/**
+ * @brief Reemplaza el ADC por una fuente simulada.
+ *
+ * Detiene el ADC real; las muestras se toman de la fuente cada sample_period_us
+ * del reloj (rtcNowUs) al llamar a adcAcquisitionUpdate(), así funciona con reloj virtual.
+ * Con nullptr vuelve al ADC real.
+ *
+ * @param source Función que retorna cada muestra.
+ */
+void adcAcquisitionSetFakeSource(adcFakeSource_t source){
+
+    adcAcquisitionStop();
+
+    fake_source = source;
+    fake_next_us = rtcNowUs();
+    buffer_position = 0;
+
+    if(fake_source == nullptr){
+        adcAcquisitionStart();
+    }
+}
+
+/**
+ * @brief Toma las muestras vencidas de la fuente simulada.
+ *
+ * Con el ADC real no hace nada, las muestras llegan por interrupción.
+ */
+void adcAcquisitionUpdate(){
+
+    if(fake_source == nullptr){
+        return;
+    }
+
+    uint64_t now = rtcNowUs();
+
+    // mismo periodo que el muestreo real, medido con el reloj inyectado
+    while(fake_next_us <= now){
+        adcAcquisitionStore(fake_source());
+        fake_next_us = fake_next_us + period_us;
+    }
+}
+
+/**
+ * @brief Toma conversiones seguidas sin esperar al periodo de muestreo.
+ *
+ * Bloquea unos microsegundos por muestra. Solo con la adquisición detenida (por ejemplo
+ * entre adcAcquisitionInit() y adcAcquisitionStart()); con la fuente simulada toma sus muestras.
+ *
+ * @param samples Destino, con escala de read_u16().
+ * @param count Cantidad de muestras.
+ *
+ * @return int Muestras tomadas, 0 si la adquisición está en marcha.
+ */
+int adcAcquisitionReadBurst(uint16_t *samples, const int count){
+
+    if(running){
+        return 0;
+    }
+
+    if(fake_source != nullptr){
+
+        for(int i = 0; i < count; i++){
+            samples[i] = fake_source();
+        }
+
+        return count;
+    }
+
+#if ADC_ACQUISITION_DMA
+    ADC_TypeDef *adc = adcPin.handle.Instance;
+    uint32_t exten = adc->CR2 & ADC_CR2_EXTEN;
+
+    // el ADC quedó esperando el TRGO del TIM2, se lo pasa a disparo por software mientras dura la ráfaga
+    CLEAR_BIT(adc->CR2, ADC_CR2_EXTEN);
+
+    if((adc->CR2 & ADC_CR2_ADON) == 0){
+        SET_BIT(adc->CR2, ADC_CR2_ADON);
+        wait_us(ADC_STABILIZATION_US);
+    }
+
+    for(int i = 0; i < count; i++){
+        int polls = 0;
+
+        SET_BIT(adc->CR2, ADC_CR2_SWSTART);
+
+        while((adc->SR & ADC_SR_EOC) == 0 and polls < BURST_POLL_MAX){
+            polls = polls + 1;
+        }
+
+        // leer DR limpia EOC, con 480 ciclos de muestreo cada conversión tarda unos 25 us
+        samples[i] = adc->DR;
+    }
+
+    SET_BIT(adc->CR2, exten);
+#else
+    for(int i = 0; i < count; i++){
+        samples[i] = analogin_read_u16(&adcPin);
+    }
+#endif
+
+    return count;
+}
+
+/**
+ * @brief Cantidad de errores de desborde del ADC.
+ *
+ * @return int Conversiones perdidas informadas por el periférico.
+ */
+int adcAcquisitionGetOverruns(){
+    return overruns;
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Guarda una muestra sin DMA y entrega la mitad del buffer al completarse.
+ *
+ * @param sample Muestra con escala de read_u16().
+ */
+static void adcAcquisitionStore(uint16_t sample){
+
+    buffer[buffer_position] = sample;
+    buffer_position = buffer_position + 1;
+
+    // mitad completa
+    if(buffer_position == BLOCK){
+        block_callback(&buffer[0], BLOCK);
+    }
+
+    // buffer completo
+    if(buffer_position >= 2 * BLOCK){
+        buffer_position = 0;
+        block_callback(&buffer[BLOCK], BLOCK);
+    }
+}
+
+#if ADC_ACQUISITION_DMA
+/**
+ * @brief Configura TIM2, ADC1 y DMA2 para el muestreo continuo.
+ */
+static void adcDmaInit(){
+    ADC_HandleTypeDef *adc = &adcPin.handle;
+    ADC_ChannelConfTypeDef channel = {0};
+    TIM_MasterConfigTypeDef master = {0};
+    uint32_t timer_clock = HAL_RCC_GetPCLK1Freq();
+
+    __HAL_RCC_DMA2_CLK_ENABLE();
+    __HAL_RCC_TIM2_CLK_ENABLE();
+
+    // los timers de APB1 van al doble de PCLK1 si el bus tiene divisor
+    if((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_HCLK_DIV1){
+        timer_clock = timer_clock * 2;
+    }
+
+    // TIM2 cuenta a 1 MHz y genera TRGO cada period_us
+    timHandle.Instance = TIM2;
+    timHandle.Init.Prescaler = (timer_clock / 1000000) - 1;
+    timHandle.Init.CounterMode = TIM_COUNTERMODE_UP;
+    timHandle.Init.Period = period_us - 1;
+    timHandle.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    timHandle.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+    HAL_TIM_Base_Init(&timHandle);
+
+    master.MasterOutputTrigger = TIM_TRGO_UPDATE;
+    master.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    HAL_TIMEx_MasterConfigSynchronization(&timHandle, &master);
+
+    // DMA2 Stream0 canal 0 es el pedido del ADC1, modo circular sobre el doble buffer
+    dmaHandle.Instance = DMA2_Stream0;
+    dmaHandle.Init.Channel = DMA_CHANNEL_0;
+    dmaHandle.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    dmaHandle.Init.PeriphInc = DMA_PINC_DISABLE;
+    dmaHandle.Init.MemInc = DMA_MINC_ENABLE;
+    dmaHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    dmaHandle.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    dmaHandle.Init.Mode = DMA_CIRCULAR;
+    dmaHandle.Init.Priority = DMA_PRIORITY_HIGH;
+    dmaHandle.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(&dmaHandle);
+    __HAL_LINKDMA(adc, DMA_Handle, dmaHandle);
+
+    // ADC1 de 12 bits alineado a izquierda, misma escala que read_u16()
+    adc->Init.ClockPrescaler = ADC_CLOCK_SYNC_PCLK_DIV4;
+    adc->Init.Resolution = ADC_RESOLUTION_12B;
+    adc->Init.DataAlign = ADC_DATAALIGN_LEFT;
+    adc->Init.ScanConvMode = DISABLE;
+    adc->Init.ContinuousConvMode = DISABLE;
+    adc->Init.DiscontinuousConvMode = DISABLE;
+    adc->Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+    adc->Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T2_TRGO;
+    adc->Init.NbrOfConversion = 1;
+    adc->Init.DMAContinuousRequests = ENABLE;
+    adc->Init.EOCSelection = ADC_EOC_SINGLE_CONV;
+    HAL_ADC_Init(adc);
+
+    // el LM35 tiene salida de alta impedancia, se usa el mayor tiempo de muestreo
+    channel.Channel = adcPin.channel;
+    channel.Rank = 1;
+    channel.SamplingTime = ADC_SAMPLETIME_480CYCLES;
+    HAL_ADC_ConfigChannel(adc, &channel);
+
+    NVIC_SetVector(DMA2_Stream0_IRQn, (uint32_t)adcDmaIrqHandler);
+    HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, DMA_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+
+    // HAL_ADC_Start_DMA() habilita la interrupción de desborde, sin vector nunca llega a HAL_ADC_ErrorCallback()
+    NVIC_SetVector(ADC_IRQn, (uint32_t)adcIrqHandler);
+    HAL_NVIC_SetPriority(ADC_IRQn, ADC_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(ADC_IRQn);
+}
+
+/**
+ * @brief Interrupción del DMA2 Stream0.
+ */
+static void adcDmaIrqHandler(){
+    HAL_DMA_IRQHandler(&dmaHandle);
+}
+
+/**
+ * @brief Interrupción del ADC, atiende el desborde (OVR).
+ */
+static void adcIrqHandler(){
+    HAL_ADC_IRQHandler(&adcPin.handle);
+}
+
+/**
+ * @brief El DMA completó la primera mitad del buffer.
+ *
+ * @param hadc ADC que generó el evento.
+ */
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc){
+    if(hadc == &adcPin.handle and fake_source == nullptr){
+        block_callback(&buffer[0], BLOCK);
+    }
+}
+
+/**
+ * @brief El DMA completó la segunda mitad del buffer.
+ *
+ * @param hadc ADC que generó el evento.
+ */
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc){
+    if(hadc == &adcPin.handle and fake_source == nullptr){
+        block_callback(&buffer[BLOCK], BLOCK);
+    }
+}
+
+/**
+ * @brief El ADC informó un error (desborde).
+ *
+ * Se reinicia la transferencia para no quedar detenido.
+ *
+ * @param hadc ADC que generó el evento.
+ */
+void HAL_ADC_ErrorCallback(ADC_HandleTypeDef *hadc){
+    if(hadc == &adcPin.handle and running){
+        overruns = overruns + 1;
+        HAL_ADC_Stop_DMA(hadc);
+        HAL_ADC_Start_DMA(hadc, (uint32_t*)buffer, 2 * BLOCK);
+    }
+}
+#else
+/**
+ * @brief Interrupción del Ticker, toma una conversión.
+ */
+static void adcTickerHandler(){
+    // el HAL de C no toma el mutex de AnalogIn, se puede usar en la interrupción
+    adcAcquisitionStore(analogin_read_u16(&adcPin));
+}
+#endif
@@ -0,0 +1,96 @@
+/**
+* @file adc_acquisition.h
+* @brief Declaraciones de funciones para la adquisición continua del ADC en doble buffer.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _ADC_ACQUISITION_H_
+#define _ADC_ACQUISITION_H_
+
+#include "mbed.h"
+
+//=====[Declaration of private defines]=================================
+// Si no esta declarado el tamaño de cada mitad del doble buffer
+#ifndef ADC_ACQUISITION_BLOCK_SAMPLES
+#define ADC_ACQUISITION_BLOCK_SAMPLES   10
+#endif
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Recibe un bloque de muestras completo (mitad del doble buffer).
+ *
+ * Con el ADC real se llama desde la interrupción de DMA/Ticker, debe ser breve.
+ * Las muestras tienen la escala de AnalogIn::read_u16() (0 a 65535).
+ */
+typedef void (*adcBlockCallback_t)(const uint16_t *samples, const int count);
+
+/**
+ * @brief Fuente de muestras simulada, retorna una muestra con escala de read_u16().
+ */
+typedef uint16_t (*adcFakeSource_t)();
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Inicializa la adquisición continua.
+ *
+ * En STM32F4 el TIM2 dispara el ADC1 y el DMA2 copia las conversiones a un doble buffer
+ * circular; en otros targets un Ticker toma las muestras. No arranca la adquisición.
+ *
+ * @param pin Pin analógico a muestrear.
+ * @param sample_period_us Periodo de muestreo en microsegundos.
+ * @param callback Función que recibe cada bloque completo.
+ */
+void adcAcquisitionInit(PinName pin, const int sample_period_us, adcBlockCallback_t callback);
+
+/**
+ * @brief Arranca la adquisición continua.
+ */
+void adcAcquisitionStart();
+
+/**
+ * @brief Detiene la adquisición continua.
+ */
+void adcAcquisitionStop();
+
+/**
+ * @brief Toma conversiones seguidas sin esperar al periodo de muestreo.
+ *
+ * Bloquea unos microsegundos por muestra. Solo con la adquisición detenida (por ejemplo
+ * entre adcAcquisitionInit() y adcAcquisitionStart()); con la fuente simulada toma sus muestras.
+ *
+ * @param samples Destino, con escala de read_u16().
+ * @param count Cantidad de muestras.
+ *
+ * @return int Muestras tomadas, 0 si la adquisición está en marcha.
+ */
+int adcAcquisitionReadBurst(uint16_t *samples, const int count);
+
+/**
+ * @brief Reemplaza el ADC por una fuente simulada.
+ *
+ * Detiene el ADC real; las muestras se toman de la fuente cada sample_period_us
+ * del reloj (rtcNowUs) al llamar a adcAcquisitionUpdate(), así funciona con reloj virtual.
+ * Con nullptr vuelve al ADC real.
+ *
+ * @param source Función que retorna cada muestra.
+ */
+void adcAcquisitionSetFakeSource(adcFakeSource_t source);
+
+/**
+ * @brief Toma las muestras vencidas de la fuente simulada.
+ *
+ * Con el ADC real no hace nada, las muestras llegan por interrupción.
+ */
+void adcAcquisitionUpdate();
+
+/**
+ * @brief Cantidad de errores de desborde del ADC.
+ *
+ * @return int Conversiones perdidas informadas por el periférico.
+ */
+int adcAcquisitionGetOverruns();
+
+//=====[#include guards - end]==========================================
+#endif
@@ -7,6 +7,7 @@
 */
 //=====[Libraries]======================================================
 #include "buzzer.h"
+#include "modules/timer_wheel/timer_wheel.h"
 
 //=====[Declaration of private defines]=================================
 #ifndef TIME_MS
@@ -16,6 +17,8 @@
 #define BUZZER_ON   1   /**< Valor con el que el buzzer enciende */
 #define BUZZER_OFF  !BUZZER_ON  /**< Valor para apagar el buzzer */
 
+#define BEEP_ON_MS  TIME_MS /**< Duración de cada pitido */
+
 //=====[Declaration of private data types]==============================
 
 //=====[Declaration and initialization of public global objects]========
@@ -27,8 +30,23 @@ DigitalOut* alertBuzzer;    /** Objeto para el buzzer */
 
 //=====[Declaration and initialization of private global variables]=====
 static int seconds_to_beep; /**< Tiempo en segundos para que el buzzer emita sonido */
+static int beep_timer = TIMER_WHEEL_INVALID; /**< Temporizador periódico de los pitidos */
+static int beep_off_timer = TIMER_WHEEL_INVALID; /**< Temporizador que corta cada pitido */
 
 //=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Enciende el buzzer y programa su apagado.
+ *
+ * Callback del temporizador de pitidos.
+ */
+static void buzzerBeep();
+
+/**
+ * @brief Periodo de los pitidos en milisegundos.
+ *
+ * @return int Periodo, como mínimo 1 segundo.
+ */
+static int buzzerBeepPeriodMs();
 
 //=====[Implementations of public functions]============================
 /**
@@ -40,6 +58,10 @@ static int seconds_to_beep; /**< Tiempo en segundos para que el buzzer emita son
  */
 void buzzerInit(PinName buzzerPin){
     alertBuzzer = new DigitalOut(buzzerPin);
+
+    beep_timer = timerWheelCreate(buzzerBeep);
+    beep_off_timer = timerWheelCreate(buzzerOff);
+
     buzzerOff();
     buzzerSetTimeBeep(0);
 }
@@ -86,7 +108,28 @@ int buzzerGetTimeBeep(){
  * @param seconds Tiempo en segundos para el beep del buzzer.
  */
 void buzzerSetTimeBeep(int seconds){
+
+    if(seconds == seconds_to_beep){
+        return;
+    }
+
     seconds_to_beep = seconds;
+
+    // si estaba sonando se aplica el nuevo periodo
+    if(timerWheelIsActive(beep_timer)){
+        timerWheelStart(beep_timer, buzzerBeepPeriodMs(), buzzerBeepPeriodMs());
+    }
+}
+
+/**
+ * @brief Detiene los pitidos.
+ * 
+ * Detiene los temporizadores y apaga el buzzer, el próximo buzzerUpdate() vuelve a contar desde cero.
+ */
+void buzzerStop(){
+    timerWheelStop(beep_timer);
+    timerWheelStop(beep_off_timer);
+    buzzerOff();
 }
 
 /**
@@ -96,40 +139,33 @@ void buzzerSetTimeBeep(int seconds){
  */
 void buzzerUpdate(){
 
-    static int elapsed_seconds = 0;  /**< Contador de segundos transcurridos */
-    static int previous_second = 0;  /**< Último segundo registrado */
-    static int count_seconds = 0;    /**< Contador para el tiempo de beep */
-    static int delay_count = 0;      /**< Contador para los retardos de 10 ms */
-
-    delay_count = delay_count + 1;
-
-    // si se alcanzo 100 retardos de 10 ms paso 1 segundo
-    if(delay_count >= 100){
-        delay_count = 0;
-        
-        if(elapsed_seconds<60){
-            elapsed_seconds = elapsed_seconds + 1;
-        }else{
-            elapsed_seconds = 0;
-        }
+    // el temporizador sigue corriendo entre llamadas
+    if(timerWheelIsActive(beep_timer) == false){
+        timerWheelStart(beep_timer, buzzerBeepPeriodMs(), buzzerBeepPeriodMs());
     }
+}
 
-    // si ya paso 1 segundo
-    if(previous_second != elapsed_seconds){
-        previous_second = elapsed_seconds;
-        
-        count_seconds = count_seconds + 1;
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Enciende el buzzer y programa su apagado.
+ *
+ * Callback del temporizador de pitidos.
+ */
+static void buzzerBeep(){
+    buzzerOn(); // enciende el zumbador
+    timerWheelStart(beep_off_timer, BEEP_ON_MS, 0);
+}
 
-        // se alcanzo los seconds_to_beep
-        if(count_seconds >= seconds_to_beep){
-            count_seconds = 0;
-            buzzerOn(); // enciende el zumbador
-        }
+/**
+ * @brief Periodo de los pitidos en milisegundos.
+ *
+ * @return int Periodo, como mínimo 1 segundo.
+ */
+static int buzzerBeepPeriodMs(){
 
-    }else{ // aún no paso 1 segundo
-        buzzerOff();
+    if(seconds_to_beep < 1){
+        return 1000;
     }
-}
-
 
-//=====[Implementations of private functions]===========================
\ No newline at end of file
+    return seconds_to_beep * 1000;
+}
\ No newline at end of file
@@ -60,6 +60,13 @@ int buzzerGetTimeBeep();
  */
 void buzzerSetTimeBeep(int seconds);
 
+/**
+ * @brief Detiene los pitidos.
+ * 
+ * Detiene los temporizadores y apaga el buzzer, el próximo buzzerUpdate() vuelve a contar desde cero.
+ */
+void buzzerStop();
+
 /**
  * @brief Actualiza el estado del buzzer basándose en el tiempo configurado.
  * 
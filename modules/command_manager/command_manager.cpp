@@ -0,0 +1,747 @@
+/**
+* @file command_manager.cpp
+* @brief Implementación de las funciones para el manejo de comandos recibidos por UART.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "command_manager.h"
+#include "modules/rtc/rtc.h"
+#include "modules/heater/heater.h"
+#include "modules/temperature_sensor/temperature_sensor.h"
+#include "modules/uart_manager/uart_manager.h"
+#include "modules/sample_stream/sample_stream.h"
+#include "modules/system_actions/system_actions.h"
+#include "modules/system_fsm/system_fsm.h"
+#include "modules/event_log/event_log.h"
+#include "modules/session_journal/session_journal.h"
+
+//=====[Declaration of private defines]=================================
+#define COMMAND_MAX_WORDS   3   /**< Nombre del comando más dos argumentos */
+#define COMMAND_MAX_DIGITS  4   /**< Dígitos de un argumento numérico, evita desbordes */
+#define COMMAND_DUMP_LINE_MAX   UART_LINE_MAX   /**< Lugar libre en la uart para enviar otra línea de un volcado */
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Resultado de un comando.
+ */
+typedef enum{
+    COMMAND_OK, /**< Se ejecutó, se responde "ok" */
+    COMMAND_REPLIED,    /**< Se ejecutó y ya respondió */
+    COMMAND_BAD_ARGUMENT,   /**< Argumento inválido o fuera de rango */
+    COMMAND_BAD_STATE   /**< No se puede ejecutar en el estado actual del sistema */
+}commandResult_t;
+
+/**
+ * @brief Función que ejecuta un comando.
+ *
+ * @param args Argumentos, apuntan dentro de la línea recibida.
+ * @param count Cantidad de argumentos.
+ */
+typedef commandResult_t (*commandHandler_t)(char **args, const int count);
+
+/**
+ * @brief Entrada de la tabla de comandos.
+ */
+typedef struct{
+    const char *name;   /**< Primera palabra de la línea */
+    int min_args;   /**< Argumentos obligatorios */
+    int max_args;   /**< Argumentos aceptados */
+    commandHandler_t handler;   /**< Función que lo ejecuta */
+}commandEntry_t;
+
+/**
+ * @brief Qué se está volcando por la uart.
+ */
+typedef enum{
+    COMMAND_DUMP_EVENTS,    /**< Registro de eventos en RAM */
+    COMMAND_DUMP_JOURNAL    /**< Diario de sesiones en flash */
+}commandDump_t;
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+static char line[COMMAND_LINE_MAX + 1]; /**< Línea en recepción, los bytes se leen directo acá */
+static int line_length = 0; /**< Bytes de la línea */
+static bool line_overflow = false; /**< La línea superó COMMAND_LINE_MAX, se descarta hasta el fin */
+
+static bool dump_active = false;    /**< Hay un volcado en curso */
+static commandDump_t dump_source = COMMAND_DUMP_EVENTS; /**< Qué se vuelca */
+static uint32_t dump_next = 0;  /**< Próximo evento o sesión a enviar */
+static uint32_t dump_end = 0;   /**< Eventos o sesiones registrados cuando se pidió el volcado */
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Comando "start [temperatura [horas]]", arranca el secado.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandStart(char **args, const int count);
+
+/**
+ * @brief Comando "stop", detiene el secado.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandStop(char **args, const int count);
+
+/**
+ * @brief Comando "temp <grados>", temperatura de secado.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandTemperature(char **args, const int count);
+
+/**
+ * @brief Comando "hours <horas>", horas de secado.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandHours(char **args, const int count);
+
+/**
+ * @brief Comando "status", responde una línea con el estado.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandStatus(char **args, const int count);
+
+/**
+ * @brief Comando "control onoff|pid|autotune", modo de control del calentador.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandControl(char **args, const int count);
+
+/**
+ * @brief Comando "telemetry text|binary", formato de la telemetría.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandTelemetry(char **args, const int count);
+
+/**
+ * @brief Comando "stream start|stop", transmisión de muestras crudas.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandStream(char **args, const int count);
+
+/**
+ * @brief Comando "log [clear]", envía o borra el registro de eventos.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandLog(char **args, const int count);
+
+/**
+ * @brief Comando "journal", envía el diario de sesiones de secado.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandJournal(char **args, const int count);
+
+/**
+ * @brief Envía las líneas del volcado en curso que entran en la uart.
+ *
+ * Los registros no entran completos en el buffer de transmisión, se envían de a partes en cada llamada.
+ */
+static void commandDumpUpdate();
+
+/**
+ * @brief Envía el próximo evento del volcado del registro de eventos.
+ */
+static void commandDumpEvent();
+
+/**
+ * @brief Envía la próxima sesión del volcado del diario.
+ */
+static void commandDumpSession();
+
+/**
+ * @brief Separa la línea en palabras sin copiarla.
+ *
+ * Reemplaza los espacios por '\0' y apunta cada palabra dentro de la línea.
+ *
+ * @param text Línea terminada en '\0'.
+ * @param words Destino de los punteros a las palabras.
+ * @param max_words Cantidad máxima de palabras.
+ *
+ * @return int Cantidad de palabras o -1 si hay más de max_words.
+ */
+static int commandSplit(char *text, char **words, const int max_words);
+
+/**
+ * @brief Convierte una palabra en un entero positivo.
+ *
+ * @param word Palabra.
+ * @param value Destino del valor.
+ *
+ * @return true si la palabra son solo dígitos (hasta COMMAND_MAX_DIGITS).
+ */
+static bool commandParseInt(const char *word, int *value);
+
+/**
+ * @brief Busca y ejecuta el comando de una línea completa.
+ */
+static void commandExecute();
+
+/**
+ * @brief Responde una línea, solo con la telemetría en texto.
+ *
+ * @param text Respuesta sin el fin de línea.
+ */
+static void commandReply(const char *text);
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Inicializa el intérprete de comandos.
+ *
+ * Requiere uartManagerInit().
+ */
+void commandManagerInit(){
+    line_length = 0;
+    line_overflow = false;
+    dump_active = false;
+}
+
+/**
+ * @brief Lee los bytes recibidos y ejecuta los comandos completos.
+ *
+ * Usa las mismas transiciones y valores de secado que el teclado (system_actions.h).
+ */
+void commandManagerUpdate(){
+
+    // con la línea llena se sigue leyendo sobre el último byte hasta encontrar el fin
+    while(uartManagerRead(&line[line_length], 1) == 1){
+        char byte = line[line_length];
+
+        if(byte == '\n' or byte == '\r'){
+            line[line_length] = '\0';
+
+            if(line_overflow){
+                commandReply("err largo");
+            }else if(line_length > 0){
+                commandExecute();
+            }
+
+            line_length = 0;
+            line_overflow = false;
+        }else if(line_length < COMMAND_LINE_MAX){
+            line_length = line_length + 1;
+        }else{
+            line_overflow = true;
+        }
+    }
+
+    commandDumpUpdate();
+}
+
+/**
+ * @brief Indica si el intérprete puede esperar a que lleguen bytes.
+ *
+ * Durante un volcado ("log" o "journal") hay que seguir llamando a commandManagerUpdate()
+ * periódicamente para enviar las líneas a medida que se libera la uart.
+ *
+ * @return true si solo hace falta llamarlo cuando avisa uartManagerSetRxWake().
+ */
+bool commandManagerIsIdle(){
+    return not dump_active;
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Comando "start [temperatura [horas]]", arranca el secado.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandStart(char **args, const int count){
+    int temperature = systemActionGetTemperature();
+    int hours = systemActionGetHours();
+
+    // se valida todo antes de cambiar algo
+    if(count > 0 and not commandParseInt(args[0], &temperature)){
+        return COMMAND_BAD_ARGUMENT;
+    }
+
+    if(count > 1 and not commandParseInt(args[1], &hours)){
+        return COMMAND_BAD_ARGUMENT;
+    }
+
+    if(temperature < MIN_TEMP or temperature > MAX_TEMP or hours < MIN_TIME or hours > MAX_TIME){
+        return COMMAND_BAD_ARGUMENT;
+    }
+
+    if(not systemActionStart()){
+        return COMMAND_BAD_STATE;
+    }
+
+    // después del arranque, la entrada a SYSTEM_WORK no toca los valores
+    systemActionSetTemperature(temperature);
+    systemActionSetHours(hours);
+
+    return COMMAND_OK;
+}
+
+/**
+ * @brief Comando "stop", detiene el secado.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandStop(char **args, const int count){
+    return systemActionStop() ? COMMAND_OK : COMMAND_BAD_STATE;
+}
+
+/**
+ * @brief Comando "temp <grados>", temperatura de secado.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandTemperature(char **args, const int count){
+    int temperature;
+
+    // detenido el sistema vuelve la temperatura a MIN_TEMP al entrar en SYSTEM_STOP, se usa start
+    if(not systemActionCanAdjust()){
+        return COMMAND_BAD_STATE;
+    }
+
+    if(not commandParseInt(args[0], &temperature) or not systemActionSetTemperature(temperature)){
+        return COMMAND_BAD_ARGUMENT;
+    }
+
+    return COMMAND_OK;
+}
+
+/**
+ * @brief Comando "hours <horas>", horas de secado.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandHours(char **args, const int count){
+    int hours;
+
+    // detenido el sistema vuelve las horas a MIN_TIME al entrar en SYSTEM_STOP, se usa start
+    if(not systemActionCanAdjust()){
+        return COMMAND_BAD_STATE;
+    }
+
+    if(not commandParseInt(args[0], &hours) or not systemActionSetHours(hours)){
+        return COMMAND_BAD_ARGUMENT;
+    }
+
+    return COMMAND_OK;
+}
+
+/**
+ * @brief Comando "status", responde una línea con el estado.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandStatus(char **args, const int count){
+
+    if(uartManagerGetTelemetryMode() != UART_TELEMETRY_TEXT){
+        return COMMAND_REPLIED; // la trama de estado ya lleva todo
+    }
+
+    uartManagerPrint("status state: ", systemFsmReadState(), " temperature_centi: ", temperatureSensorReadCentiCelsius(),
+        " temperature_user: ", systemActionGetTemperature(), " hour_user: ", systemActionGetHours(),
+        " elapsed_s: ", (int)(rtcElapsedMs() / 1000), " heater: ", heaterStatus(),
+        " output: ", heaterGetOutputPercent(), " control: ", heaterGetControlMode(), "\n");
+
+    return COMMAND_REPLIED;
+}
+
+/**
+ * @brief Comando "control onoff|pid|autotune", modo de control del calentador.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandControl(char **args, const int count){
+
+    if(strcmp(args[0], "onoff") == 0){
+        heaterSetControlMode(HEATER_CONTROL_ON_OFF);
+    }else if(strcmp(args[0], "pid") == 0){
+        heaterSetControlMode(HEATER_CONTROL_PID);
+    }else if(strcmp(args[0], "autotune") == 0){
+
+        // el autoajuste usa la temperatura de trabajo como consigna
+        if(systemFsmReadState() != SYSTEM_WORK){
+            return COMMAND_BAD_STATE;
+        }
+
+        heaterAutotuneStart();
+    }else{
+        return COMMAND_BAD_ARGUMENT;
+    }
+
+    return COMMAND_OK;
+}
+
+/**
+ * @brief Comando "telemetry text|binary", formato de la telemetría.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandTelemetry(char **args, const int count){
+
+    if(strcmp(args[0], "text") == 0){
+        sampleStreamStop(); // las muestras son tramas binarias
+        uartManagerSetTelemetryMode(UART_TELEMETRY_TEXT);
+    }else if(strcmp(args[0], "binary") == 0){
+        uartManagerSetTelemetryMode(UART_TELEMETRY_BINARY);
+    }else{
+        return COMMAND_BAD_ARGUMENT;
+    }
+
+    return COMMAND_OK;
+}
+
+/**
+ * @brief Comando "stream start|stop", transmisión de muestras crudas.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandStream(char **args, const int count){
+
+    if(strcmp(args[0], "start") == 0){
+        sampleStreamStart();
+    }else if(strcmp(args[0], "stop") == 0){
+        sampleStreamStop();
+    }else{
+        return COMMAND_BAD_ARGUMENT;
+    }
+
+    return COMMAND_OK;
+}
+
+/**
+ * @brief Comando "log [clear]", envía o borra el registro de eventos.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandLog(char **args, const int count){
+
+    if(count > 0){
+
+        if(strcmp(args[0], "clear") != 0){
+            return COMMAND_BAD_ARGUMENT;
+        }
+
+        dump_active = false;
+        eventLogClear();
+
+        return COMMAND_OK;
+    }
+
+    // el volcado es texto, no se mezcla con las tramas
+    if(uartManagerGetTelemetryMode() != UART_TELEMETRY_TEXT){
+        return COMMAND_BAD_STATE;
+    }
+
+    dump_source = COMMAND_DUMP_EVENTS;
+    dump_next = eventLogGetOldest();
+    dump_end = eventLogGetCount();
+    dump_active = true;
+
+    uartManagerPrint("log eventos: ", dump_end, " guardados: ", dump_end - dump_next, " arranques: ", eventLogGetBoots(), "\n");
+
+    return COMMAND_REPLIED;
+}
+
+/**
+ * @brief Comando "journal", envía el diario de sesiones de secado.
+ *
+ * @param args Argumentos.
+ * @param count Cantidad de argumentos.
+ *
+ * @return commandResult_t Resultado.
+ */
+static commandResult_t commandJournal(char **args, const int count){
+
+    if(uartManagerGetTelemetryMode() != UART_TELEMETRY_TEXT){
+        return COMMAND_BAD_STATE;
+    }
+
+    dump_source = COMMAND_DUMP_JOURNAL;
+    dump_next = sessionJournalGetOldest();
+    dump_end = sessionJournalGetCount();
+    dump_active = true;
+
+    uartManagerPrint("journal sesiones: ", dump_end, " guardadas: ", dump_end - dump_next, "\n");
+
+    return COMMAND_REPLIED;
+}
+
+/**
+ * @brief Envía las líneas del volcado en curso que entran en la uart.
+ *
+ * Los registros no entran completos en el buffer de transmisión, se envían de a partes en cada llamada.
+ */
+static void commandDumpUpdate(){
+
+    while(dump_active and uartManagerGetTxFree() >= COMMAND_DUMP_LINE_MAX){
+
+        if(dump_next >= dump_end or uartManagerGetTelemetryMode() != UART_TELEMETRY_TEXT){
+            commandReply((dump_source == COMMAND_DUMP_EVENTS) ? "log fin" : "journal fin");
+            dump_active = false;
+            return;
+        }
+
+        if(dump_source == COMMAND_DUMP_EVENTS){
+            commandDumpEvent();
+        }else{
+            commandDumpSession();
+        }
+    }
+}
+
+/**
+ * @brief Envía el próximo evento del volcado del registro de eventos.
+ */
+static void commandDumpEvent(){
+    eventLogEntry_t entry;
+
+    // los eventos nuevos pisaron los que faltaban enviar, se sigue por el más viejo
+    if(not eventLogRead(dump_next, &entry)){
+        dump_next = eventLogGetOldest();
+        return;
+    }
+
+    // número, arranque, milisegundos desde ese arranque, tipo y dato
+    if(entry.type == EVENT_LOG_STATE){
+        uartManagerPrint("log ", dump_next, " ", entry.boot, " ", eventLogTimeMs(&entry), " ", eventLogTypeName(entry.type),
+            " ", entry.value >> 8, " ", entry.value & 0xFF, "\n");
+    }else{
+        uartManagerPrint("log ", dump_next, " ", entry.boot, " ", eventLogTimeMs(&entry), " ", eventLogTypeName(entry.type),
+            " ", entry.value, "\n");
+    }
+
+    dump_next = dump_next + 1;
+}
+
+/**
+ * @brief Envía la próxima sesión del volcado del diario.
+ */
+static void commandDumpSession(){
+    static const char *const end_names[] = {"", "finalizada", "detenida", "corte"};
+    sessionJournalRecord_t record;
+
+    // un registro cortado por falta de energía no se envía
+    if(sessionJournalRead(dump_next, &record) and record.end <= SESSION_JOURNAL_POWER_LOSS){
+        uartManagerPrint("journal ", dump_next, " ", record.boot, " ", record.start_s, " ", record.duration_s,
+            " ", record.setpoint, " ", record.target_hours, " ", textFixed(record.mean_centi, 2), " ", textFixed(record.max_centi, 2),
+            " ", record.heater_on_s, " ", record.energy_wh, " ", end_names[record.end], "\n");
+    }
+
+    dump_next = dump_next + 1;
+}
+
+/**
+ * @brief Separa la línea en palabras sin copiarla.
+ *
+ * Reemplaza los espacios por '\0' y apunta cada palabra dentro de la línea.
+ *
+ * @param text Línea terminada en '\0'.
+ * @param words Destino de los punteros a las palabras.
+ * @param max_words Cantidad máxima de palabras.
+ *
+ * @return int Cantidad de palabras o -1 si hay más de max_words.
+ */
+static int commandSplit(char *text, char **words, const int max_words){
+    int count = 0;
+
+    while(true){
+
+        while(*text == ' ' or *text == '\t'){
+            *text = '\0';
+            text = text + 1;
+        }
+
+        if(*text == '\0'){
+            return count;
+        }
+
+        if(count == max_words){
+            return -1;
+        }
+
+        words[count] = text;
+        count = count + 1;
+
+        while(*text != '\0' and *text != ' ' and *text != '\t'){
+            text = text + 1;
+        }
+    }
+}
+
+/**
+ * @brief Convierte una palabra en un entero positivo.
+ *
+ * @param word Palabra.
+ * @param value Destino del valor.
+ *
+ * @return true si la palabra son solo dígitos (hasta COMMAND_MAX_DIGITS).
+ */
+static bool commandParseInt(const char *word, int *value){
+    int result = 0;
+    int digits = 0;
+
+    while(word[digits] != '\0'){
+
+        if(word[digits] < '0' or word[digits] > '9' or digits == COMMAND_MAX_DIGITS){
+            return false;
+        }
+
+        result = result * 10 + (word[digits] - '0');
+        digits = digits + 1;
+    }
+
+    if(digits == 0){
+        return false;
+    }
+
+    *value = result;
+
+    return true;
+}
+
+/**
+ * @brief Busca y ejecuta el comando de una línea completa.
+ */
+static void commandExecute(){
+    static const commandEntry_t commands[] = {
+        {"start", 0, 2, commandStart},
+        {"stop", 0, 0, commandStop},
+        {"temp", 1, 1, commandTemperature},
+        {"hours", 1, 1, commandHours},
+        {"status", 0, 0, commandStatus},
+        {"control", 1, 1, commandControl},
+        {"telemetry", 1, 1, commandTelemetry},
+        {"stream", 1, 1, commandStream},
+        {"log", 0, 1, commandLog},
+        {"journal", 0, 0, commandJournal}
+    };
+    char *words[COMMAND_MAX_WORDS];
+    int count = commandSplit(line, words, COMMAND_MAX_WORDS);
+    commandResult_t result;
+
+    if(count == 0){
+        return; // solo espacios
+    }
+
+    if(count < 0){
+        commandReply("err argumento");
+        return;
+    }
+
+    for(unsigned int i = 0; i < sizeof(commands) / sizeof(commands[0]); i++){
+
+        if(strcmp(words[0], commands[i].name) != 0){
+            continue;
+        }
+
+        if(count - 1 < commands[i].min_args or count - 1 > commands[i].max_args){
+            commandReply("err argumento");
+            return;
+        }
+
+        result = commands[i].handler(&words[1], count - 1);
+
+        switch (result){
+            case COMMAND_OK:
+                commandReply("ok");
+            break;
+
+            case COMMAND_BAD_ARGUMENT:
+                commandReply("err argumento");
+            break;
+
+            case COMMAND_BAD_STATE:
+                commandReply("err estado");
+            break;
+
+            default:
+            break;
+        }
+
+        return;
+    }
+
+    commandReply("err comando");
+}
+
+/**
+ * @brief Responde una línea, solo con la telemetría en texto.
+ *
+ * @param text Respuesta sin el fin de línea.
+ */
+static void commandReply(const char *text){
+
+    if(uartManagerGetTelemetryMode() != UART_TELEMETRY_TEXT){
+        return;
+    }
+
+    uartManagerPrint(text, "\n");
+}
@@ -0,0 +1,66 @@
+/**
+* @file command_manager.h
+* @brief Declaraciones de funciones para el manejo de comandos recibidos por UART.
+*
+* Cada comando es una línea de texto terminada en '\n' o '\r', con palabras separadas por espacios:
+*
+*   start [temperatura [horas]]     arranca el secado, opcionalmente con temperatura y horas
+*   stop                            detiene el secado
+*   temp <grados>                   temperatura de secado (MIN_TEMP a MAX_TEMP)
+*   hours <horas>                   horas de secado (MIN_TIME a MAX_TIME)
+*   status                          responde una línea con el estado
+*   control onoff|pid|autotune      modo de control del calentador
+*   telemetry text|binary           formato de la telemetría
+*   stream start|stop               transmisión de muestras crudas
+*   log [clear]                     envía (o borra) el registro de eventos, "log <n> <arranque> <ms> <tipo> <dato>"
+*   journal                         envía el diario de sesiones guardado en flash
+*
+* En telemetría de texto se responde "ok" o "err <motivo>"; en binario no se responde para no
+* mezclar texto con las tramas, el resultado se ve en la trama de estado.
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _COMMAND_MANAGER_H_
+#define _COMMAND_MANAGER_H_
+
+#include "mbed.h"
+#include "modules/filament_dryer_system/filament_dryer_system.h"
+
+//=====[Declaration of private defines]=================================
+// Si no esta declarado el largo máximo de una línea de comando
+#ifndef COMMAND_LINE_MAX
+#define COMMAND_LINE_MAX    32
+#endif
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Inicializa el intérprete de comandos.
+ *
+ * Requiere uartManagerInit().
+ */
+void commandManagerInit();
+
+/**
+ * @brief Lee los bytes recibidos y ejecuta los comandos completos.
+ *
+ * Usa las mismas transiciones y valores de secado que el teclado (system_actions.h).
+ */
+void commandManagerUpdate();
+
+/**
+ * @brief Indica si el intérprete puede esperar a que lleguen bytes.
+ *
+ * Durante un volcado ("log" o "journal") hay que seguir llamando a commandManagerUpdate()
+ * periódicamente para enviar las líneas a medida que se libera la uart.
+ *
+ * @return true si solo hace falta llamarlo cuando avisa uartManagerSetRxWake().
+ */
+bool commandManagerIsIdle();
+
+//=====[#include guards - end]==========================================
+#endif
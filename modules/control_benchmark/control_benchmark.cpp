@@ -0,0 +1,220 @@
+/**
+* @file control_benchmark.cpp
+* @brief Implementación del banco de pruebas de lazo cerrado del calentador.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "control_benchmark.h"
+#include "modules/filament_dryer_system/filament_dryer_system.h"
+#include "modules/heater_manager/heater_manager.h"
+#include "modules/rtc/rtc.h"
+
+//=====[Declaration of private defines]=================================
+#define TICK_US (HEATER_MANAGER_PERIOD_MS * 1000ULL) /**< Periodo de la tarea del calentador */
+#define US_PER_SECOND   1000000.0f
+
+#define SETTLE_MS   2000    /**< Espera con el calentador apagado para llenar la ventana del sensor */
+#define AUTOTUNE_MAX_MS (3 * 3600 * 1000)   /**< Límite del autoajuste previo, mayor al tiempo máximo de heater.cpp */
+
+#define RISE_LOW    0.1f    /**< Inicio del tiempo de subida, fracción del escalón */
+#define RISE_HIGH   0.9f    /**< Fin del tiempo de subida, fracción del escalón */
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+static float firmware_kp; /**< Ganancias con las que arrancó el firmware */
+static float firmware_ki;
+static float firmware_kd;
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Corre la tarea del calentador durante un tiempo virtual.
+ *
+ * @param state estado del sistema que recibe heaterManagerUpdate()
+ * @param setpoint temperatura de trabajo
+ * @param ms milisegundos virtuales
+ */
+static void controlBenchmarkRunFor(systemState_t state, const int setpoint, const int ms);
+
+/**
+ * @brief Lleva la planta a temperatura ambiente con el calentador apagado.
+ *
+ * @param test caso de prueba
+ */
+static void controlBenchmarkSettle(const controlBenchmarkCase_t *test);
+
+/**
+ * @brief Autoajusta el PID sobre la planta del caso.
+ *
+ * @param test caso de prueba
+ *
+ * @return true si el autoajuste terminó bien
+ */
+static bool controlBenchmarkAutotune(const controlBenchmarkCase_t *test);
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Inicializa el calentador, el sensor y el reloj virtual del simulador.
+ */
+void controlBenchmarkInit(){
+    thermalPlant_t plant = thermalSimulatorDefaultPlant();
+
+    rtcInit();
+    heaterManagerInit(PIN_HEATER, PIN_AMBIENT_SENSOR);
+
+    thermalSimulatorInit(&plant);
+    thermalSimulatorStart();
+
+    heaterGetGains(&firmware_kp, &firmware_ki, &firmware_kd);
+}
+
+/**
+ * @brief Ejecuta un caso con heaterManagerUpdate() en lazo cerrado con la planta simulada.
+ *
+ * @param test caso de prueba
+ *
+ * @return controlBenchmarkResult_t métricas de la corrida
+ */
+controlBenchmarkResult_t controlBenchmarkRun(const controlBenchmarkCase_t *test){
+    controlBenchmarkResult_t result = {};
+
+    heaterSetGains(firmware_kp, firmware_ki, firmware_kd);
+
+    if(test->mode == HEATER_CONTROL_AUTOTUNE){
+        result.tuned = controlBenchmarkAutotune(test);
+    }else{
+        heaterSetControlMode(test->mode);
+    }
+
+    controlBenchmarkSettle(test);
+
+    float initial_c = thermalSimulatorRead().hotbed_c;
+    float step_c = test->setpoint - initial_c;
+    uint64_t start_us = rtcNowUs();
+    uint64_t steady_us = start_us + (uint64_t)test->duration_s * 750000ULL; // último cuarto
+    uint64_t end_us = start_us + (uint64_t)test->duration_s * 1000000ULL;
+    uint64_t low_us = 0;
+    float peak_c = initial_c;
+    float steady_sum = 0;
+    float steady_min = 0;
+    float steady_max = 0;
+    int steady_count = 0;
+    bool previous_heater = heaterStatus();
+
+    while(rtcNowUs() < end_us){
+        heaterManagerUpdate(SYSTEM_WORK, test->setpoint);
+
+        if(heaterStatus() != previous_heater){
+            previous_heater = heaterStatus();
+            result.switches = result.switches + 1;
+        }
+
+        thermalSimulatorAdvance(rtcNowUs() + TICK_US);
+
+        float hotbed_c = thermalSimulatorRead().hotbed_c;
+        float progress = (step_c > 0) ? (hotbed_c - initial_c) / step_c : 0;
+
+        if(low_us == 0 and progress >= RISE_LOW){
+            low_us = rtcNowUs();
+        }
+
+        if(not result.reached and progress >= RISE_HIGH){
+            result.reached = true;
+            result.rise_time_s = (rtcNowUs() - low_us) / US_PER_SECOND;
+        }
+
+        if(hotbed_c > peak_c){
+            peak_c = hotbed_c;
+        }
+
+        if(rtcNowUs() >= steady_us){
+            if(steady_count == 0 or hotbed_c < steady_min){
+                steady_min = hotbed_c;
+            }
+
+            if(steady_count == 0 or hotbed_c > steady_max){
+                steady_max = hotbed_c;
+            }
+
+            steady_sum = steady_sum + hotbed_c;
+            steady_count = steady_count + 1;
+        }
+    }
+
+    heaterManagerStop();
+
+    result.overshoot_c = (peak_c > test->setpoint) ? peak_c - test->setpoint : 0;
+    result.steady_error_c = (steady_count > 0) ? steady_sum / steady_count - test->setpoint : 0;
+    result.ripple_c = steady_max - steady_min;
+    result.energy_wh = thermalSimulatorEnergyWh();
+
+    return result;
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Corre la tarea del calentador durante un tiempo virtual.
+ *
+ * @param state estado del sistema que recibe heaterManagerUpdate()
+ * @param setpoint temperatura de trabajo
+ * @param ms milisegundos virtuales
+ */
+static void controlBenchmarkRunFor(systemState_t state, const int setpoint, const int ms){
+    uint64_t end_us = rtcNowUs() + ms * 1000ULL;
+
+    while(rtcNowUs() < end_us){
+        heaterManagerUpdate(state, setpoint);
+        thermalSimulatorAdvance(rtcNowUs() + TICK_US);
+    }
+}
+
+/**
+ * @brief Lleva la planta a temperatura ambiente con el calentador apagado.
+ *
+ * @param test caso de prueba
+ */
+static void controlBenchmarkSettle(const controlBenchmarkCase_t *test){
+    thermalSimulatorInit(&test->plant);
+
+    // con el calentador apagado y el control limpio el sensor llena su ventana
+    heaterManagerStop();
+    controlBenchmarkRunFor(SYSTEM_STOP, test->setpoint, SETTLE_MS);
+}
+
+/**
+ * @brief Autoajusta el PID sobre la planta del caso.
+ *
+ * @param test caso de prueba
+ *
+ * @return true si el autoajuste terminó bien
+ */
+static bool controlBenchmarkAutotune(const controlBenchmarkCase_t *test){
+    uint64_t end_us;
+
+    controlBenchmarkSettle(test);
+
+    heaterSetTemperature(test->setpoint);
+    heaterAutotuneStart();
+
+    end_us = rtcNowUs() + AUTOTUNE_MAX_MS * 1000ULL;
+
+    while(heaterAutotuneRead().state == HEATER_AUTOTUNE_RUNNING and rtcNowUs() < end_us){
+        controlBenchmarkRunFor(SYSTEM_WORK, test->setpoint, HEATER_MANAGER_PERIOD_MS);
+    }
+
+    // al terminar bien queda en PID con las ganancias calculadas, si falla se mide el PID del firmware
+    if(heaterAutotuneRead().state != HEATER_AUTOTUNE_DONE){
+        heaterSetControlMode(HEATER_CONTROL_PID);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,62 @@
+/**
+* @file control_benchmark.h
+* @brief Declaraciones de funciones del banco de pruebas de lazo cerrado del calentador.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _CONTROL_BENCHMARK_H_
+#define _CONTROL_BENCHMARK_H_
+
+#include "mbed.h"
+#include "modules/heater/heater.h"
+#include "modules/thermal_simulator/thermal_simulator.h"
+
+//=====[Declaration of private defines]=================================
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Caso de prueba.
+ *
+ * Con HEATER_CONTROL_AUTOTUNE primero se autoajusta sobre la misma planta (no se mide)
+ * y luego se mide el PID con las ganancias obtenidas.
+ */
+typedef struct{
+    int setpoint;   /**< Temperatura de trabajo en grados */
+    heaterControlMode_t mode;   /**< Modo de control */
+    thermalPlant_t plant;   /**< Planta térmica */
+    int duration_s; /**< Duración de la corrida medida */
+}controlBenchmarkCase_t;
+
+/**
+ * @brief Métricas de la corrida, sobre la temperatura real de la hotbed.
+ */
+typedef struct{
+    bool reached;   /**< Se alcanzó el 90% del escalón */
+    float rise_time_s;  /**< Tiempo de subida 10% a 90% del escalón */
+    float overshoot_c;  /**< Máximo por encima de la consigna */
+    float steady_error_c;   /**< Error medio en el último cuarto de la corrida */
+    float ripple_c; /**< Pico a pico en el último cuarto de la corrida */
+    int switches;   /**< Conmutaciones del relé */
+    float energy_wh;    /**< Energía entregada por la hotbed */
+    bool tuned; /**< Solo HEATER_CONTROL_AUTOTUNE: el autoajuste terminó bien */
+}controlBenchmarkResult_t;
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Inicializa el calentador, el sensor y el reloj virtual del simulador.
+ */
+void controlBenchmarkInit();
+
+/**
+ * @brief Ejecuta un caso con heaterManagerUpdate() en lazo cerrado con la planta simulada.
+ *
+ * @param test caso de prueba
+ *
+ * @return controlBenchmarkResult_t métricas de la corrida
+ */
+controlBenchmarkResult_t controlBenchmarkRun(const controlBenchmarkCase_t *test);
+
+//=====[#include guards - end]==========================================
+#endif
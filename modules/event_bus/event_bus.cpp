@@ -0,0 +1,212 @@
+/**
+* @file event_bus.cpp
+* @brief Implementación del bus de eventos entre los gestores.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "event_bus.h"
+#include "modules/rtc/rtc.h"
+
+//=====[Declaration of private defines]=================================
+#define US_PER_MS   1000    /**< Microsegundos en un milisegundo */
+#define EVENT_BUS_QUEUE_MASK    (EVENT_BUS_QUEUE_MESSAGES - 1)  /**< Índice dentro de la cola */
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Un suscriptor con su cola.
+ */
+typedef struct{
+    uint32_t topics;    /**< Máscara de temas, 0 si el lugar está libre */
+    eventBusWake_t wake;    /**< Aviso de mensajes nuevos */
+    eventBusMessage_t queue[EVENT_BUS_QUEUE_MESSAGES];  /**< Mensajes pendientes */
+    uint32_t head;  /**< Próximo a escribir, crece sin límite */
+    uint32_t tail;  /**< Próximo a leer, crece sin límite */
+    uint32_t dropped;   /**< Mensajes descartados con la cola llena */
+}eventBusSubscriber_t;
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+static eventBusSubscriber_t subscribers[EVENT_BUS_SUBSCRIBERS];    /**< Suscriptores */
+static eventBusMessage_t last[EVENT_BUS_TOPICS];    /**< Último mensaje de cada tema */
+static uint32_t published = 0;  /**< Un bit por tema que ya tiene último mensaje */
+
+static_assert((EVENT_BUS_QUEUE_MESSAGES & (EVENT_BUS_QUEUE_MESSAGES - 1)) == 0, "EVENT_BUS_QUEUE_MESSAGES debe ser potencia de 2");
+static_assert(EVENT_BUS_TOPICS <= 32, "los temas no entran en la máscara de suscripción");
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Indica si un número de suscriptor está en uso.
+ *
+ * @param subscriber Número de suscriptor.
+ *
+ * @return true si es válido y está suscripto.
+ */
+static bool eventBusValid(const int subscriber);
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Vacía las suscripciones, las colas y los últimos valores.
+ *
+ * Se llama antes que los módulos que publican o se suscriben.
+ */
+void eventBusInit(){
+    memset(subscribers, 0, sizeof(subscribers));
+    memset(last, 0, sizeof(last));
+    published = 0;
+}
+
+/**
+ * @brief Agrega un suscriptor.
+ *
+ * @param topics Temas, con EVENT_BUS_TOPIC_BIT().
+ * @param wake Función a llamar en cada mensaje encolado, nullptr si el suscriptor consulta solo.
+ *
+ * @return int Número de suscriptor o EVENT_BUS_INVALID_SUBSCRIBER si no hay lugar.
+ */
+int eventBusSubscribe(const uint32_t topics, eventBusWake_t wake){
+
+    if(topics == 0){
+        return EVENT_BUS_INVALID_SUBSCRIBER;
+    }
+
+    for(int i = 0; i < EVENT_BUS_SUBSCRIBERS; i++){
+
+        if(subscribers[i].topics == 0){
+            memset(&subscribers[i], 0, sizeof(eventBusSubscriber_t));
+            subscribers[i].topics = topics;
+            subscribers[i].wake = wake;
+
+            return i;
+        }
+    }
+
+    return EVENT_BUS_INVALID_SUBSCRIBER;
+}
+
+/**
+ * @brief Cambia la función que despierta a un suscriptor.
+ *
+ * @param subscriber Número de suscriptor.
+ * @param wake Función a llamar, nullptr para quitarla.
+ */
+void eventBusSetWake(const int subscriber, eventBusWake_t wake){
+
+    if(eventBusValid(subscriber)){
+        subscribers[subscriber].wake = wake;
+    }
+}
+
+/**
+ * @brief Publica un mensaje.
+ *
+ * Lo guarda como el último del tema y lo encola en cada suscriptor del tema. Si la cola
+ * de un suscriptor está llena el mensaje se descarta para ese suscriptor y se cuenta.
+ *
+ * @param topic Tema.
+ * @param value Dato principal.
+ * @param detail Dato secundario.
+ */
+void eventBusPublish(eventBusTopic_t topic, const int32_t value, const int32_t detail){
+    eventBusMessage_t message;
+
+    if(topic >= EVENT_BUS_TOPICS){
+        return;
+    }
+
+    message.time_ms = rtcNowUs() / US_PER_MS;
+    message.value = value;
+    message.detail = detail;
+    message.topic = topic;
+
+    last[topic] = message;
+    published = published | EVENT_BUS_TOPIC_BIT(topic);
+
+    for(int i = 0; i < EVENT_BUS_SUBSCRIBERS; i++){
+        eventBusSubscriber_t *subscriber = &subscribers[i];
+
+        if((subscriber->topics & EVENT_BUS_TOPIC_BIT(topic)) == 0){
+            continue;
+        }
+
+        if(subscriber->head - subscriber->tail >= EVENT_BUS_QUEUE_MESSAGES){
+            subscriber->dropped = subscriber->dropped + 1;
+            continue;
+        }
+
+        subscriber->queue[subscriber->head & EVENT_BUS_QUEUE_MASK] = message;
+        subscriber->head = subscriber->head + 1;
+
+        if(subscriber->wake != nullptr){
+            subscriber->wake();
+        }
+    }
+}
+
+/**
+ * @brief Toma el próximo mensaje de un suscriptor.
+ *
+ * @param subscriber Número de suscriptor.
+ * @param message Destino.
+ *
+ * @return true si había un mensaje.
+ */
+bool eventBusRead(const int subscriber, eventBusMessage_t *message){
+
+    if(not eventBusValid(subscriber) or subscribers[subscriber].head == subscribers[subscriber].tail){
+        return false;
+    }
+
+    *message = subscribers[subscriber].queue[subscribers[subscriber].tail & EVENT_BUS_QUEUE_MASK];
+    subscribers[subscriber].tail = subscribers[subscriber].tail + 1;
+
+    return true;
+}
+
+/**
+ * @brief Último mensaje publicado en un tema.
+ *
+ * @param topic Tema.
+ * @param message Destino.
+ *
+ * @return true si ya se publicó alguno.
+ */
+bool eventBusLast(eventBusTopic_t topic, eventBusMessage_t *message){
+
+    if(topic >= EVENT_BUS_TOPICS or (published & EVENT_BUS_TOPIC_BIT(topic)) == 0){
+        return false;
+    }
+
+    *message = last[topic];
+
+    return true;
+}
+
+/**
+ * @brief Mensajes descartados por tener la cola llena.
+ *
+ * @param subscriber Número de suscriptor.
+ *
+ * @return uint32_t Mensajes perdidos desde eventBusInit().
+ */
+uint32_t eventBusDropped(const int subscriber){
+    return eventBusValid(subscriber) ? subscribers[subscriber].dropped : 0;
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Indica si un número de suscriptor está en uso.
+ *
+ * @param subscriber Número de suscriptor.
+ *
+ * @return true si es válido y está suscripto.
+ */
+static bool eventBusValid(const int subscriber){
+    return subscriber >= 0 and subscriber < EVENT_BUS_SUBSCRIBERS and subscribers[subscriber].topics != 0;
+}
@@ -0,0 +1,140 @@
+/**
+* @file event_bus.h
+* @brief Declaraciones del bus de eventos entre los gestores.
+*
+* Publicación/suscripción con memoria estática: un conjunto fijo de temas, a lo sumo
+* EVENT_BUS_SUBSCRIBERS suscriptores y una cola de EVENT_BUS_QUEUE_MESSAGES mensajes por
+* suscriptor. Quien produce un dato lo publica una vez y solo lo reciben los suscriptores
+* de ese tema; cada suscriptor puede registrar una función que lo despierte (por ejemplo
+* schedulerRelease() de su tarea) en lugar de consultar en cada tick.
+*
+* El bus guarda además el último mensaje de cada tema, así un consumidor que solo necesita
+* el valor actual (la temperatura para un informe periódico) lo lee sin encolar cada cambio.
+*
+* Se publica y se lee desde las tareas del planificador, no desde interrupciones.
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _EVENT_BUS_H_
+#define _EVENT_BUS_H_
+
+#include "mbed.h"
+
+//=====[Declaration of private defines]=================================
+// Si no esta declarada la cantidad máxima de suscriptores
+#ifndef EVENT_BUS_SUBSCRIBERS
+#define EVENT_BUS_SUBSCRIBERS   4
+#endif
+
+// Si no esta declarada la cola de cada suscriptor (potencia de 2, el resultado del autoajuste son 6 mensajes juntos)
+#ifndef EVENT_BUS_QUEUE_MESSAGES
+#define EVENT_BUS_QUEUE_MESSAGES    16
+#endif
+
+#define EVENT_BUS_INVALID_SUBSCRIBER    -1  /**< Retorno de eventBusSubscribe() sin lugar */
+#define EVENT_BUS_TOPIC_BIT(topic)  (1 << (topic))  /**< Bit de un tema en la máscara de suscripción */
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Temas del bus.
+ */
+typedef enum{
+    EVENT_BUS_STATE,    /**< Cambio de estado del sistema, valor: nuevo, detalle: anterior */
+    EVENT_BUS_SETTINGS, /**< Consigna o horas de secado, valor: grados, detalle: horas */
+    EVENT_BUS_ADJUST,   /**< Modo de ajuste del teclado, valor: adjustState_t */
+    EVENT_BUS_BUTTON,   /**< Evento del teclado, valor: buttonTemplate_t, detalle: keypadManagerButton_t */
+    EVENT_BUS_TEMPERATURE,  /**< Lectura del sensor que cambió, valor: centésimas de grado */
+    EVENT_BUS_HEATER,   /**< Calentador, valor: 1 encendido, 0 apagado, detalle: salida en % */
+    EVENT_BUS_AUTOTUNE, /**< Estado del autoajuste que cambió, valor: heaterAutotuneState_t, detalle: ciclos medidos */
+    EVENT_BUS_AUTOTUNE_GAIN,    /**< Resultado del autoajuste, antes de HEATER_AUTOTUNE_DONE, valor: heaterManagerGain_t, detalle: centésimas */
+    EVENT_BUS_ELAPSED,  /**< Tiempo de secado transcurrido, una vez por segundo, valor: segundos */
+    EVENT_BUS_TOPICS    /**< Cantidad de temas */
+}eventBusTopic_t;
+
+/**
+ * @brief Un mensaje del bus.
+ */
+typedef struct{
+    uint32_t time_ms;   /**< rtcNowUs() / 1000 al publicar */
+    int32_t value;  /**< Dato principal según el tema */
+    int32_t detail; /**< Dato secundario según el tema */
+    uint8_t topic;  /**< eventBusTopic_t */
+}eventBusMessage_t;
+
+/**
+ * @brief Función que despierta a un suscriptor cuando recibe un mensaje.
+ */
+typedef void (*eventBusWake_t)();
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Vacía las suscripciones, las colas y los últimos valores.
+ *
+ * Se llama antes que los módulos que publican o se suscriben.
+ */
+void eventBusInit();
+
+/**
+ * @brief Agrega un suscriptor.
+ *
+ * @param topics Temas, con EVENT_BUS_TOPIC_BIT().
+ * @param wake Función a llamar en cada mensaje encolado, nullptr si el suscriptor consulta solo.
+ *
+ * @return int Número de suscriptor o EVENT_BUS_INVALID_SUBSCRIBER si no hay lugar.
+ */
+int eventBusSubscribe(const uint32_t topics, eventBusWake_t wake);
+
+/**
+ * @brief Cambia la función que despierta a un suscriptor.
+ *
+ * @param subscriber Número de suscriptor.
+ * @param wake Función a llamar, nullptr para quitarla.
+ */
+void eventBusSetWake(const int subscriber, eventBusWake_t wake);
+
+/**
+ * @brief Publica un mensaje.
+ *
+ * Lo guarda como el último del tema y lo encola en cada suscriptor del tema. Si la cola
+ * de un suscriptor está llena el mensaje se descarta para ese suscriptor y se cuenta.
+ *
+ * @param topic Tema.
+ * @param value Dato principal.
+ * @param detail Dato secundario.
+ */
+void eventBusPublish(eventBusTopic_t topic, const int32_t value, const int32_t detail);
+
+/**
+ * @brief Toma el próximo mensaje de un suscriptor.
+ *
+ * @param subscriber Número de suscriptor.
+ * @param message Destino.
+ *
+ * @return true si había un mensaje.
+ */
+bool eventBusRead(const int subscriber, eventBusMessage_t *message);
+
+/**
+ * @brief Último mensaje publicado en un tema.
+ *
+ * @param topic Tema.
+ * @param message Destino.
+ *
+ * @return true si ya se publicó alguno.
+ */
+bool eventBusLast(eventBusTopic_t topic, eventBusMessage_t *message);
+
+/**
+ * @brief Mensajes descartados por tener la cola llena.
+ *
+ * @param subscriber Número de suscriptor.
+ *
+ * @return uint32_t Mensajes perdidos desde eventBusInit().
+ */
+uint32_t eventBusDropped(const int subscriber);
+
+//=====[#include guards - end]==========================================
+#endif
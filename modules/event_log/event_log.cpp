@@ -0,0 +1,211 @@
+/**
+* @file event_log.cpp
+* @brief Implementación del registro de eventos en RAM que sobrevive a los reinicios.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "event_log.h"
+#include "modules/rtc/rtc.h"
+
+//=====[Declaration of private defines]=================================
+#define EVENT_LOG_MAGIC 0x45564C47  /**< "EVLG", la RAM tiene un registro válido */
+#define EVENT_LOG_MASK  (EVENT_LOG_SIZE - 1)    /**< Posición en el anillo sin división */
+#define US_PER_TICK (1UL << EVENT_LOG_TIME_SHIFT)   /**< Microsegundos por unidad de la marca de tiempo */
+#define US_PER_MS   1000
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Contenido de la RAM sin inicializar.
+ */
+typedef struct{
+    uint32_t magic; /**< EVENT_LOG_MAGIC */
+    uint32_t head;  /**< Eventos escritos desde el último borrado */
+    uint32_t head_check;    /**< ~head, detecta un corte a mitad de una escritura */
+    uint16_t boots; /**< Arranques desde el último borrado */
+    eventLogEntry_t entries[EVENT_LOG_SIZE];    /**< Anillo */
+}eventLogRam_t;
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+#ifdef EVENT_LOG_ADDRESS
+/** Fuera de la región RAM del linker: el arranque no la toca y conserva lo del reinicio anterior */
+static eventLogRam_t &event_ram = *reinterpret_cast<eventLogRam_t *>(EVENT_LOG_ADDRESS);
+
+static_assert(sizeof(eventLogRam_t) <= EVENT_LOG_RESERVED, "el registro no entra en EVENT_LOG_RESERVED");
+
+// las herramientas de mbed definen la región RAM a partir de target.mbed_ram_size
+#if defined(MBED_RAM_START) && defined(MBED_RAM_SIZE)
+static_assert(MBED_RAM_START + MBED_RAM_SIZE <= EVENT_LOG_ADDRESS, "la región RAM del linker se superpone con el registro de eventos");
+#endif
+#else
+/** Sin inicializador: el arranque no la toca y conserva lo del reinicio anterior */
+MBED_SECTION(EVENT_LOG_SECTION) static eventLogRam_t event_ram;
+#endif
+
+static bool ready = false;  /**< eventLogInit() validó la RAM, antes no se registra nada */
+
+static_assert((EVENT_LOG_SIZE & (EVENT_LOG_SIZE - 1)) == 0, "EVENT_LOG_SIZE debe ser potencia de 2");
+
+//=====[Declaration (prototypes) of private functions]==================
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Valida el registro que quedó en RAM, cuenta el arranque y lo registra con su causa.
+ *
+ * Requiere rtcInit(). Los eventos anteriores a la inicialización se descartan.
+ */
+void eventLogInit(){
+
+    // encendido en frío o corte a mitad de una escritura: se empieza de cero
+    if(event_ram.magic != EVENT_LOG_MAGIC or event_ram.head_check != ~event_ram.head){
+        event_ram.head = 0;
+        event_ram.head_check = ~event_ram.head;
+        event_ram.boots = 0;
+        event_ram.magic = EVENT_LOG_MAGIC;
+    }
+
+    event_ram.boots = event_ram.boots + 1;
+    ready = true;
+
+    eventLogWrite(EVENT_LOG_BOOT, ResetReason::get());
+}
+
+/**
+ * @brief Registra un evento.
+ *
+ * Unas pocas escrituras dentro de una sección crítica, se puede llamar desde interrupciones.
+ *
+ * @param type Tipo.
+ * @param value Dato según el tipo.
+ */
+void eventLogWrite(eventLogType_t type, const uint16_t value){
+
+    if(not ready){
+        return;
+    }
+
+    // desplazamiento en lugar de división por 1000
+    uint32_t ticks = rtcNowUs() >> EVENT_LOG_TIME_SHIFT;
+
+    core_util_critical_section_enter();
+
+    eventLogEntry_t *entry = &event_ram.entries[event_ram.head & EVENT_LOG_MASK];
+
+    entry->ticks = ticks;
+    entry->value = value;
+    entry->type = type;
+    entry->boot = event_ram.boots;
+
+    event_ram.head = event_ram.head + 1;
+    event_ram.head_check = ~event_ram.head;
+
+    core_util_critical_section_exit();
+}
+
+/**
+ * @brief Eventos registrados desde el último borrado, también los que ya se pisaron.
+ *
+ * @return uint32_t Número que tendrá el próximo evento.
+ */
+uint32_t eventLogGetCount(){
+    return event_ram.head;
+}
+
+/**
+ * @brief Número del evento más viejo que sigue en el anillo.
+ *
+ * @return uint32_t Número de evento.
+ */
+uint32_t eventLogGetOldest(){
+    uint32_t head = event_ram.head;
+
+    return (head > EVENT_LOG_SIZE) ? head - EVENT_LOG_SIZE : 0;
+}
+
+/**
+ * @brief Arranques contados desde el último borrado.
+ *
+ * @return uint16_t Arranques.
+ */
+uint16_t eventLogGetBoots(){
+    return event_ram.boots;
+}
+
+/**
+ * @brief Lee un evento por su número.
+ *
+ * @param number Número de evento, de eventLogGetOldest() a eventLogGetCount() - 1.
+ * @param entry Destino.
+ *
+ * @return true si el evento sigue en el anillo.
+ */
+bool eventLogRead(const uint32_t number, eventLogEntry_t *entry){
+    bool valid;
+
+    // la copia y la validación juntas, una interrupción podría pisar el evento en el medio
+    core_util_critical_section_enter();
+
+    valid = number < event_ram.head and event_ram.head - number <= EVENT_LOG_SIZE;
+
+    if(valid){
+        *entry = event_ram.entries[number & EVENT_LOG_MASK];
+    }
+
+    core_util_critical_section_exit();
+
+    return valid;
+}
+
+/**
+ * @brief Milisegundos desde el arranque de un evento.
+ *
+ * @param entry Evento.
+ *
+ * @return uint32_t Milisegundos.
+ */
+uint32_t eventLogTimeMs(const eventLogEntry_t *entry){
+    return (uint64_t)entry->ticks * US_PER_TICK / US_PER_MS;
+}
+
+/**
+ * @brief Nombre corto de un tipo de evento.
+ *
+ * @param type eventLogType_t.
+ *
+ * @return const char* Nombre.
+ */
+const char *eventLogTypeName(const uint8_t type){
+
+    switch (type){
+        case EVENT_LOG_BOOT: return "arranque";
+        case EVENT_LOG_STATE: return "estado";
+        case EVENT_LOG_BUTTON: return "boton";
+        case EVENT_LOG_HEATER: return "calentador";
+        case EVENT_LOG_SENSOR_FAULT: return "sensor_falla";
+        case EVENT_LOG_SENSOR_OK: return "sensor_ok";
+        case EVENT_LOG_SENSOR_STALE: return "sensor_sin_muestras";
+        default: return "desconocido";
+    }
+}
+
+/**
+ * @brief Borra el registro, el arranque actual pasa a ser el primero.
+ */
+void eventLogClear(){
+    core_util_critical_section_enter();
+
+    event_ram.head = 0;
+    event_ram.head_check = ~event_ram.head;
+    event_ram.boots = 1;
+
+    core_util_critical_section_exit();
+}
+
+//=====[Implementations of private functions]===========================
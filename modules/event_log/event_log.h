@@ -0,0 +1,146 @@
+/**
+* @file event_log.h
+* @brief Declaraciones del registro de eventos en RAM que sobrevive a los reinicios.
+*
+* Anillo binario de EVENT_LOG_SIZE eventos de 8 bytes (cambios de estado del sistema,
+* botones, calentador y fallas del sensor) con la marca de tiempo y el número de arranque.
+* Está en RAM que el arranque no pone en cero: después de un reset por watchdog, pin o falla
+* los eventos previos siguen ahí y se pueden pedir por uart con el comando "log". Si la
+* cabecera no es válida (encendido en frío) el registro empieza vacío.
+*
+* En el STM32F401RE ocupa los últimos EVENT_LOG_RESERVED bytes de la RAM, que mbed_app.json
+* deja fuera de la región RAM del linker (target.mbed_ram_size): ni .data, ni .bss, ni el
+* heap, ni la pila llegan ahí. En otro destino sin EVENT_LOG_ADDRESS se usa la sección
+* EVENT_LOG_SECTION, que el script del linker debe ubicar en RAM como NOLOAD, fuera de .bss.
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _EVENT_LOG_H_
+#define _EVENT_LOG_H_
+
+#include "mbed.h"
+
+//=====[Declaration of private defines]=================================
+// Si no esta declarada la cantidad de eventos del anillo (potencia de 2)
+#ifndef EVENT_LOG_SIZE
+#define EVENT_LOG_SIZE  128
+#endif
+
+// Si no esta declarada la dirección fija del registro (final de la RAM del STM32F401RE, debe coincidir con mbed_app.json)
+#if !defined(EVENT_LOG_ADDRESS) && defined(TARGET_STM32F401xE)
+#define EVENT_LOG_ADDRESS   0x20017800
+#endif
+
+// Si no esta declarado el tamaño reservado en EVENT_LOG_ADDRESS
+#ifndef EVENT_LOG_RESERVED
+#define EVENT_LOG_RESERVED  0x800
+#endif
+
+// Si no esta declarada la sección de RAM sin inicializar, sin EVENT_LOG_ADDRESS
+#ifndef EVENT_LOG_SECTION
+#define EVENT_LOG_SECTION   ".noinit"
+#endif
+
+#define EVENT_LOG_TIME_SHIFT    10  /**< La marca de tiempo es rtcNowUs() >> 10, unidades de 1.024 ms */
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Tipos de evento.
+ */
+typedef enum{
+    EVENT_LOG_BOOT, /**< Arranque, valor: reset_reason_t */
+    EVENT_LOG_STATE,    /**< Cambio de estado del sistema, valor: anterior << 8 | nuevo */
+    EVENT_LOG_BUTTON,   /**< Botón aceptado por el antirrebote, valor: buttonTemplate_t */
+    EVENT_LOG_HEATER,   /**< Calentador, valor: 1 encendido, 0 apagado */
+    EVENT_LOG_SENSOR_FAULT, /**< Muestra del sensor fuera de rango, valor: muestra cruda */
+    EVENT_LOG_SENSOR_OK,    /**< El sensor volvió al rango o a entregar muestras, valor: muestra cruda */
+    EVENT_LOG_SENSOR_STALE  /**< La adquisición dejó de entregar bloques, valor: ms desde el último (hasta 65535) */
+}eventLogType_t;
+
+/**
+ * @brief Un evento del registro.
+ */
+typedef struct{
+    uint32_t ticks; /**< rtcNowUs() >> EVENT_LOG_TIME_SHIFT desde el arranque */
+    uint16_t value; /**< Dato según el tipo */
+    uint8_t type;   /**< eventLogType_t */
+    uint8_t boot;   /**< Número de arranque (8 bits bajos) en que se registró */
+}eventLogEntry_t;
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Valida el registro que quedó en RAM, cuenta el arranque y lo registra con su causa.
+ *
+ * Requiere rtcInit(). Los eventos anteriores a la inicialización se descartan.
+ */
+void eventLogInit();
+
+/**
+ * @brief Registra un evento.
+ *
+ * Unas pocas escrituras dentro de una sección crítica, se puede llamar desde interrupciones.
+ *
+ * @param type Tipo.
+ * @param value Dato según el tipo.
+ */
+void eventLogWrite(eventLogType_t type, const uint16_t value);
+
+/**
+ * @brief Eventos registrados desde el último borrado, también los que ya se pisaron.
+ *
+ * @return uint32_t Número que tendrá el próximo evento.
+ */
+uint32_t eventLogGetCount();
+
+/**
+ * @brief Número del evento más viejo que sigue en el anillo.
+ *
+ * @return uint32_t Número de evento.
+ */
+uint32_t eventLogGetOldest();
+
+/**
+ * @brief Arranques contados desde el último borrado.
+ *
+ * @return uint16_t Arranques.
+ */
+uint16_t eventLogGetBoots();
+
+/**
+ * @brief Lee un evento por su número.
+ *
+ * @param number Número de evento, de eventLogGetOldest() a eventLogGetCount() - 1.
+ * @param entry Destino.
+ *
+ * @return true si el evento sigue en el anillo.
+ */
+bool eventLogRead(const uint32_t number, eventLogEntry_t *entry);
+
+/**
+ * @brief Milisegundos desde el arranque de un evento.
+ *
+ * @param entry Evento.
+ *
+ * @return uint32_t Milisegundos.
+ */
+uint32_t eventLogTimeMs(const eventLogEntry_t *entry);
+
+/**
+ * @brief Nombre corto de un tipo de evento.
+ *
+ * @param type eventLogType_t.
+ *
+ * @return const char* Nombre.
+ */
+const char *eventLogTypeName(const uint8_t type);
+
+/**
+ * @brief Borra el registro, el arranque actual pasa a ser el primero.
+ */
+void eventLogClear();
+
+//=====[#include guards - end]==========================================
+#endif
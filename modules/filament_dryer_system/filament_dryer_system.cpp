@@ -8,12 +8,31 @@
 //=====[Libraries]====================================================
 #include "filament_dryer_system.h"
 #include "modules/rtc/rtc.h"
+#include "modules/event_log/event_log.h"
+#include "modules/session_journal/session_journal.h"
+#include "modules/power_resume/power_resume.h"
 #include "modules/heater_manager/heater_manager.h"
 #include "modules/keypad_manager/keypad_manager.h"
+#include "modules/command_manager/command_manager.h"
 #include "modules/indicator_manager/indicator_manager.h"
 #include "modules/uart_manager/uart_manager.h"
+#include "modules/sample_stream/sample_stream.h"
+#include "modules/scheduler/scheduler.h"
+#include "modules/system_fsm/system_fsm.h"
+#include "modules/system_actions/system_actions.h"
+#include "modules/timer_wheel/timer_wheel.h"
+#include "modules/event_bus/event_bus.h"
 
 //=====[Declaration of private defines]===============================
+// Si no esta declarado TIME_MS 
+#ifndef TIME_MS
+#define TIME_MS 10
+#endif
+
+#define UART_TASK_PERIOD_MS 100 /**< Periodo de la tarea de informes por uart */
+#define HOLD_TASK_PERIOD_MS TIME_MS /**< Periodo del teclado con un botón mantenido y de los comandos durante un volcado */
+#define STREAM_TASK_PERIOD_MS   TIME_MS /**< Periodo de la transmisión de muestras, el de las muestras crudas */
+#define US_PER_SECOND   1000000 /**< Microsegundos en un segundo */
 
 //=====[Declaration of private data types]============================
 
@@ -24,52 +43,205 @@
 //=====[Declaration and initialization of public global variables]====
 
 //=====[Declaration and initialization of private global variables]===
-static systemState_t system_mode; /**< Modo de trabajo del sistema */
-
-static adjustState_t adjust_mode; /**< Para cambiar entre tiempo y temperatura */
-
-static int activity_time; /**< Horas especificadas para trabajar */
-static int work_temperature; /**< Temperatura especificada de trabajo */
+static int keypad_task = SCHEDULER_INVALID_TASK; /**< Tarea del teclado, la libera la interrupción del teclado */
+static int command_task = SCHEDULER_INVALID_TASK; /**< Tarea de los comandos, la libera la recepción de la uart */
+static int uart_task = SCHEDULER_INVALID_TASK; /**< Tarea de informes por uart, la liberan sus mensajes del bus */
+static int stream_task = SCHEDULER_INVALID_TASK; /**< Tarea de la transmisión de muestras, periódica solo transmitiendo */
+static int32_t published_elapsed_s = -1; /**< Último tiempo transcurrido publicado, en segundos */
 
 //=====[Declaration (prototypes) of private functions]================
 /**
 * @brief Se encendio el sistema.
 *
-* Al encender queda en estado de espera de comandos
+* Entrada a SYSTEM_ON, queda a la espera de que termine el encendido
 * 
+* @param from Estado anterior.
+* @param to SYSTEM_ON.
+*/
+static void systemOn(systemState_t from, systemState_t to);
+
+/**
+* @brief Terminó el encendido.
+*
+* Mientras está en SYSTEM_ON, pasa a detenido en el primer tick del sistema
+*
+* @param from SYSTEM_ON.
+* @param to SYSTEM_ON.
 */
-static void systemOn();
+static void systemBooted(systemState_t from, systemState_t to);
 
 /**
  * @brief Detiene el sistema de secado.
  * 
- * Esta función se encarga de detener el funcionamiento del sistema de secado,
- * asegurando que todos los componentes relacionados se apaguen o se pongan en un
- * estado seguro.
+ * Entrada a SYSTEM_STOP: vuelve la temperatura y las horas a los mínimos y el
+ * contador de tiempo a 0.
+ *
+ * @param from Estado anterior.
+ * @param to SYSTEM_STOP.
+ */
+static void systemStop(systemState_t from, systemState_t to);
+
+/**
+ * @brief Comienza a secar.
+ *
+ * Entrada a SYSTEM_WORK.
+ *
+ * @param from Estado anterior.
+ * @param to SYSTEM_WORK.
  */
-static void systemStop();
+static void systemWork(systemState_t from, systemState_t to);
 
 /**
  * @brief Activa el sistema de secado.
  * 
- * Esta función se encarga de monitorear el proceso de secado y finalizarlo al completarse el tiempo de trabajo.
+ * Mientras está en SYSTEM_WORK finaliza el secado al completarse el tiempo de trabajo.
+ *
+ * @param from SYSTEM_WORK.
+ * @param to SYSTEM_WORK.
  */
-static void systemWorking();
+static void systemWorking(systemState_t from, systemState_t to);
+
+/**
+ * @brief Deja de secar.
+ *
+ * Salida de SYSTEM_WORK, apaga el calentador.
+ *
+ * @param from SYSTEM_WORK.
+ * @param to Estado siguiente.
+ */
+static void systemWorkExit(systemState_t from, systemState_t to);
 
 /**
  * @brief Finaliza el proceso de secado.
  * 
- * Esta función se encarga mantener el sistema en el estado de fin de secado
+ * Entrada a SYSTEM_FINISH, lleva el contador de tiempo a 0.
+ *
+ * @param from SYSTEM_WORK.
+ * @param to SYSTEM_FINISH.
+ */
+static void systemEndWorking(systemState_t from, systemState_t to);
+
+/**
+ * @brief Avisó el fin del secado.
+ *
+ * Mientras está en SYSTEM_FINISH, pasa a esperar en el tick siguiente.
+ *
+ * @param from SYSTEM_FINISH.
+ * @param to SYSTEM_FINISH.
  */
-static void systemEndWorking();
+static void systemEndWorkingDone(systemState_t from, systemState_t to);
 
 /**
  * @brief Administra lo que sucede mientras se aguardan comandos.
  * 
- * Luego de finalizar el secado "aguarda" a recibir comandos
+ * Entrada a SYSTEM_FINISH_AWAIT, luego de finalizar el secado "aguarda" a recibir comandos
+ *
+ * @param from SYSTEM_FINISH.
+ * @param to SYSTEM_FINISH_AWAIT.
+ */
+static void systemEndWorkingAwait(systemState_t from, systemState_t to);
+
+/**
+ * @brief Sale de un estado sin secado.
+ *
+ * Salida de SYSTEM_STOP y SYSTEM_FINISH_AWAIT, el secado empieza a contar desde 0.
+ *
+ * @param from Estado que deja.
+ * @param to Estado siguiente.
+ */
+static void systemIdleExit(systemState_t from, systemState_t to);
+
+/**
+ * @brief Hay eventos nuevos del teclado, libera su tarea sin esperar al periodo.
+ *
+ * Se llama desde la interrupción del teclado.
+ */
+static void systemKeypadWake();
+
+/**
+ * @brief Hay mensajes nuevos del bus para los informes por uart, libera su tarea.
+ */
+static void systemUartWake();
+
+/**
+ * @brief Llegaron bytes por la uart, libera la tarea de los comandos.
+ *
+ * Se llama desde la interrupción de recepción.
+ */
+static void systemCommandWake();
+
+/**
+ * @brief Ajusta los periodos de las tareas que no siempre tienen trabajo.
+ *
+ * El teclado corre periódicamente solo con un botón mantenido, los comandos durante un
+ * volcado y la transmisión de muestras mientras está activa; si no, esperan su aviso.
+ */
+static void systemSchedulePeriods();
+
+/**
+ * @brief Tarea periódica de la rueda de temporizadores.
+ */
+static void taskTimers();
+
+/**
+ * @brief Tarea del teclado, la libera su interrupción.
+ */
+static void taskKeypad();
+
+/**
+ * @brief Tarea de los comandos por uart, la libera la recepción.
+ */
+static void taskCommands();
+
+/**
+ * @brief Tarea periódica de informes por uart.
+ */
+static void taskUart();
+
+/**
+ * @brief Tarea periódica de la máquina de estados del sistema.
+ */
+static void taskSystem();
+
+/**
+ * @brief Tarea periódica del calentador.
+ */
+static void taskHeater();
+
+/**
+ * @brief Tarea de la transmisión de muestras crudas, periódica solo transmitiendo.
+ */
+static void taskStream();
+
+/**
+ * @brief Transiciones del sistema, cualquier otro par de estado y evento se descarta.
+ */
+static constexpr systemFsmTransition_t system_transitions[] = {
+    {SYSTEM_ON,             SYSTEM_EVENT_BOOTED,    SYSTEM_STOP,            nullptr},
+    {SYSTEM_ON,             SYSTEM_EVENT_RESUME,    SYSTEM_WORK,            nullptr},
+    {SYSTEM_STOP,           SYSTEM_EVENT_START,     SYSTEM_WORK,            nullptr},
+    {SYSTEM_WORK,           SYSTEM_EVENT_STOP,      SYSTEM_STOP,            nullptr},
+    {SYSTEM_WORK,           SYSTEM_EVENT_TIME_UP,   SYSTEM_FINISH,          nullptr},
+    {SYSTEM_FINISH,         SYSTEM_EVENT_FINISHED,  SYSTEM_FINISH_AWAIT,    nullptr},
+    {SYSTEM_FINISH_AWAIT,   SYSTEM_EVENT_START,     SYSTEM_WORK,            nullptr}
+};
+
+/**
+ * @brief Acciones de cada estado: entrada, salida y mientras está activo.
  */
-static void systemEndWorkingAwait();
+static constexpr systemFsmState_t system_states[] = {
+    {SYSTEM_ON,             systemOn,               nullptr,            systemBooted},
+    {SYSTEM_STOP,           systemStop,             systemIdleExit,     nullptr},
+    {SYSTEM_WORK,           systemWork,             systemWorkExit,     systemWorking},
+    {SYSTEM_FINISH,         systemEndWorking,       nullptr,            systemEndWorkingDone},
+    {SYSTEM_FINISH_AWAIT,   systemEndWorkingAwait,  systemIdleExit,     nullptr}
+};
 
+#define SYSTEM_TRANSITIONS  (int)(sizeof(system_transitions) / sizeof(system_transitions[0]))   /**< Filas de system_transitions */
+#define SYSTEM_STATES   (int)(sizeof(system_states) / sizeof(system_states[0])) /**< Filas de system_states */
+
+static_assert(systemFsmIsDeterministic(system_transitions, SYSTEM_TRANSITIONS), "dos transiciones para el mismo estado y evento");
+static_assert(systemFsmStatesInOrder(system_states, SYSTEM_STATES), "falta un estado o no sigue el orden de systemState_t");
 
 //=====[Implementations of public functions]==========================
 /**
@@ -81,6 +253,18 @@ void filamentDryerInit(){
 
     rtcInit();
 
+    eventLogInit(); // primero, los demás módulos ya registran eventos al inicializarse
+
+    eventBusInit(); // antes de los módulos que publican o se suscriben
+
+    systemActionInit(); // temperatura y horas mínimas, antes de sus suscriptores
+
+    sessionJournalInit();
+
+    powerResumeInit();
+
+    timerWheelInit(); // antes de los módulos que reservan temporizadores
+
     heaterManagerInit(PIN_HEATER, PIN_AMBIENT_SENSOR);
 
     keypadManagerInit(PIN_BUTTON_RUN, PIN_BUTTON_MODE, PIN_BUTTON_DOWN, PIN_BUTTON_UP);
@@ -88,8 +272,35 @@ void filamentDryerInit(){
     indicatorManagerInit(PIN_ACTIVITY_LED, PIN_RUN_LED, PIN_BUZZER);
 
     uartManagerInit(USBTX, USBRX, 115200);
+
+    commandManagerInit();
+
+    sampleStreamInit();
     
-    systemOn();
+    systemFsmInit(system_transitions, SYSTEM_TRANSITIONS, system_states, SYSTEM_ON); // con los módulos ya inicializados
+
+    // un corte de energía durante el secado: se sigue donde quedó sin esperar al usuario
+    powerResumeRestore();
+
+    // mismo orden que el recorrido original del bucle principal, cada una con el periodo que necesita
+    schedulerInit();
+    schedulerAddTask(taskTimers, TIMER_WHEEL_TICK_MS, TIMER_WHEEL_TICK_MS);
+    keypad_task = schedulerAddTask(taskKeypad, SCHEDULER_NO_PERIOD, HOLD_TASK_PERIOD_MS);
+    command_task = schedulerAddTask(taskCommands, SCHEDULER_NO_PERIOD, HOLD_TASK_PERIOD_MS); // mismas transiciones que el teclado, antes del sistema
+    uart_task = schedulerAddTask(taskUart, UART_TASK_PERIOD_MS, UART_TASK_PERIOD_MS);
+    schedulerAddTask(taskSystem, HEATER_MANAGER_PERIOD_MS, HEATER_MANAGER_PERIOD_MS); // termina el secado y publica el tiempo, al ritmo del calentador
+    schedulerAddTask(taskHeater, HEATER_MANAGER_PERIOD_MS, HEATER_MANAGER_PERIOD_MS);
+    stream_task = schedulerAddTask(taskStream, SCHEDULER_NO_PERIOD, STREAM_TASK_PERIOD_MS); // después del calentador para ver sus cambios en el mismo tick
+
+    keypadManagerSetWake(systemKeypadWake); // con las tareas ya registradas
+    uartManagerSetWake(systemUartWake);
+    uartManagerSetRxWake(systemCommandWake);
+
+    systemSchedulePeriods(); // teclado por consulta o transmisión que arranca con el sistema
+
+    // lo que llegó antes de registrar los avisos
+    schedulerRelease(keypad_task);
+    schedulerRelease(command_task);
 }
 
 /**
@@ -98,110 +309,255 @@ void filamentDryerInit(){
  * Debe ser llamada periódicamente para manejar el estado del sistema.
  */
 void filamentDryerUpdate(){
+    schedulerUpdate(); // ejecuta las tareas vencidas y duerme hasta la próxima
+}
 
-    keypadManagerUpdate( &system_mode , &activity_time, &work_temperature);
-
-    indicatorManagerUpdate(system_mode); //estado de los leds y buzzer
-
-    uartManagerUpdate(system_mode, adjust_mode, activity_time);
-
-    switch (system_mode)
-    {
-        case SYSTEM_ON:
-        case SYSTEM_STOP:
-            systemStop();
-        break;
-
-        case SYSTEM_WORK:
-            systemWorking();
-        break;
-        
-        case SYSTEM_FINISH:
-            systemEndWorking();            
-        break;
-        
-        case SYSTEM_FINISH_AWAIT:
-            systemEndWorkingAwait();
-        break;
-
-        default:
-        break;
-    }
-
-    heaterManagerUpdate(system_mode, work_temperature);
-
-    rtcUpdate(); // actualiza el estado del reloj
-
+/**
+ * @brief Retorna el estado actual del sistema de secado.
+ *
+ * @return systemState_t Estado del sistema.
+ */
+systemState_t filamentDryerReadState(){
+    return systemFsmReadState();
 }
 
 //=====[Implementations of private functions]=========================
 /**
 * @brief Se encendio el sistema.
 *
-* Al encender queda en estado de espera de comandos
+* Entrada a SYSTEM_ON, queda a la espera de que termine el encendido
 * 
+* @param from Estado anterior.
+* @param to SYSTEM_ON.
 */
-static void systemOn(){
-    system_mode = SYSTEM_ON;
+static void systemOn(systemState_t from, systemState_t to){
+    indicatorManagerEnter(to);
+}
+
+/**
+* @brief Terminó el encendido.
+*
+* Mientras está en SYSTEM_ON, pasa a detenido en el primer tick del sistema
+*
+* @param from SYSTEM_ON.
+* @param to SYSTEM_ON.
+*/
+static void systemBooted(systemState_t from, systemState_t to){
+    systemFsmDispatch(SYSTEM_EVENT_BOOTED);
 }
 
 /**
  * @brief Detiene el sistema de secado.
  * 
- * Esta función se encarga de detener el funcionamiento del sistema de secado,
- * asegurando que todos los componentes relacionados se apaguen o se pongan en un
- * estado seguro.
+ * Entrada a SYSTEM_STOP: vuelve la temperatura y las horas a los mínimos y el
+ * contador de tiempo a 0.
+ *
+ * @param from Estado anterior.
+ * @param to SYSTEM_STOP.
  */
-static void systemStop(){
-
-    system_mode = SYSTEM_STOP; // trabajando no
-
-    activity_time = MIN_TIME; // tiempo minimo de secado
-    work_temperature = MIN_TEMP; // temperatura minima de secado
+static void systemStop(systemState_t from, systemState_t to){
 
-    adjust_mode = TIME;
+    systemActionResetSettings(); // tiempo y temperatura minimos de secado
     
     rtcRestart();
+
+    indicatorManagerEnter(to);
+}
+
+/**
+ * @brief Comienza a secar.
+ *
+ * Entrada a SYSTEM_WORK.
+ *
+ * @param from Estado anterior.
+ * @param to SYSTEM_WORK.
+ */
+static void systemWork(systemState_t from, systemState_t to){
+    indicatorManagerEnter(to); // el contador de tiempo lo reinicia la salida del estado anterior
 }
 
 /**
  * @brief Activa el sistema de secado.
  * 
- * Esta función se encarga de monitorear el proceso de secado y finalizarlo al completarse el tiempo de trabajo.
+ * Mientras está en SYSTEM_WORK finaliza el secado al completarse el tiempo de trabajo.
+ *
+ * @param from SYSTEM_WORK.
+ * @param to SYSTEM_WORK.
  */
-static void systemWorking(){
-
-    static int previous_second = 0;
+static void systemWorking(systemState_t from, systemState_t to){
 
     rtcTime_t realTime = rtcRead();
 
     // se alcanzo el tiempo de secado?
-    if(realTime.hours >= activity_time){
-
-        system_mode = SYSTEM_FINISH;
-
-        rtcRestart(); // lleva el contador de tiempo a 0
+    if(realTime.hours >= systemActionGetHours()){
+        systemFsmDispatch(SYSTEM_EVENT_TIME_UP);
     }
 
 }
 
+/**
+ * @brief Deja de secar.
+ *
+ * Salida de SYSTEM_WORK, apaga el calentador.
+ *
+ * @param from SYSTEM_WORK.
+ * @param to Estado siguiente.
+ */
+static void systemWorkExit(systemState_t from, systemState_t to){
+    heaterManagerStop();
+}
+
 /**
  * @brief Finaliza el proceso de secado.
  * 
- * Esta función se encarga mantener el sistema en el estado de fin de secado
+ * Entrada a SYSTEM_FINISH, lleva el contador de tiempo a 0.
+ *
+ * @param from SYSTEM_WORK.
+ * @param to SYSTEM_FINISH.
  */
-static void systemEndWorking(){
+static void systemEndWorking(systemState_t from, systemState_t to){
 
-    adjust_mode = TIME;
-    system_mode = SYSTEM_FINISH_AWAIT;
+    rtcRestart(); // lleva el contador de tiempo a 0
 
+    indicatorManagerEnter(to);
+}
+
+/**
+ * @brief Avisó el fin del secado.
+ *
+ * Mientras está en SYSTEM_FINISH, pasa a esperar en el tick siguiente.
+ *
+ * @param from SYSTEM_FINISH.
+ * @param to SYSTEM_FINISH.
+ */
+static void systemEndWorkingDone(systemState_t from, systemState_t to){
+    systemFsmDispatch(SYSTEM_EVENT_FINISHED);
 }
 
 /**
  * @brief Administra lo que sucede mientras se aguardan comandos.
  * 
- * Luego de finalizar el secado "aguarda" a recibir comandos
+ * Entrada a SYSTEM_FINISH_AWAIT, luego de finalizar el secado "aguarda" a recibir comandos
+ *
+ * @param from SYSTEM_FINISH.
+ * @param to SYSTEM_FINISH_AWAIT.
+ */
+static void systemEndWorkingAwait(systemState_t from, systemState_t to){
+    indicatorManagerEnter(to);
+}
+
+/**
+ * @brief Sale de un estado sin secado.
+ *
+ * Salida de SYSTEM_STOP y SYSTEM_FINISH_AWAIT, el secado empieza a contar desde 0.
+ *
+ * @param from Estado que deja.
+ * @param to Estado siguiente.
  */
-static void systemEndWorkingAwait(){
+static void systemIdleExit(systemState_t from, systemState_t to){
     rtcRestart();
+}
+
+/**
+ * @brief Hay eventos nuevos del teclado, libera su tarea sin esperar al periodo.
+ *
+ * Se llama desde la interrupción del teclado.
+ */
+static void systemKeypadWake(){
+    schedulerRelease(keypad_task);
+}
+
+/**
+ * @brief Hay mensajes nuevos del bus para los informes por uart, libera su tarea.
+ */
+static void systemUartWake(){
+    schedulerRelease(uart_task);
+}
+
+/**
+ * @brief Llegaron bytes por la uart, libera la tarea de los comandos.
+ *
+ * Se llama desde la interrupción de recepción.
+ */
+static void systemCommandWake(){
+    schedulerRelease(command_task);
+}
+
+/**
+ * @brief Ajusta los periodos de las tareas que no siempre tienen trabajo.
+ *
+ * El teclado corre periódicamente solo con un botón mantenido, los comandos durante un
+ * volcado y la transmisión de muestras mientras está activa; si no, esperan su aviso.
+ */
+static void systemSchedulePeriods(){
+    schedulerSetPeriod(keypad_task, keypadManagerIsIdle() ? SCHEDULER_NO_PERIOD : HOLD_TASK_PERIOD_MS);
+    schedulerSetPeriod(command_task, commandManagerIsIdle() ? SCHEDULER_NO_PERIOD : HOLD_TASK_PERIOD_MS);
+    schedulerSetPeriod(stream_task, sampleStreamIsActive() ? STREAM_TASK_PERIOD_MS : SCHEDULER_NO_PERIOD);
+}
+
+/**
+ * @brief Tarea periódica de la rueda de temporizadores.
+ */
+static void taskTimers(){
+    timerWheelUpdate(); // ejecuta los temporizadores vencidos
+}
+
+/**
+ * @brief Tarea del teclado, la libera su interrupción.
+ */
+static void taskKeypad(){
+    keypadManagerUpdate();
+
+    systemSchedulePeriods(); // un botón mantenido sigue contando repeticiones
+}
+
+/**
+ * @brief Tarea de los comandos por uart, la libera la recepción.
+ */
+static void taskCommands(){
+    commandManagerUpdate();
+
+    systemSchedulePeriods(); // un volcado sigue enviando, "stream" arranca o detiene la transmisión
+}
+
+/**
+ * @brief Tarea periódica de informes por uart.
+ */
+static void taskUart(){
+    uartManagerUpdate();
+}
+
+/**
+ * @brief Tarea periódica de la máquina de estados del sistema.
+ */
+static void taskSystem(){
+    systemFsmUpdate(); // solo el estado activo, los cambios del teclado y los comandos ya se aplicaron
+
+    systemState_t state = systemFsmReadState();
+
+    sessionJournalUpdate(state, systemActionGetTemperature(), systemActionGetHours());
+
+    powerResumeUpdate(state, systemActionGetTemperature(), systemActionGetHours()); // con el resumen de la sesión ya actualizado
+
+    // en segundos no da la vuelta en int32 y se publica solo cuando cambia
+    int32_t elapsed_s = rtcElapsedUs() / US_PER_SECOND;
+
+    if(elapsed_s != published_elapsed_s){
+        published_elapsed_s = elapsed_s;
+        eventBusPublish(EVENT_BUS_ELAPSED, elapsed_s, 0);
+    }
+}
+
+/**
+ * @brief Tarea periódica del calentador.
+ */
+static void taskHeater(){
+    heaterManagerUpdate(systemFsmReadState(), systemActionGetTemperature());
+}
+
+/**
+ * @brief Tarea de la transmisión de muestras crudas, periódica solo transmitiendo.
+ */
+static void taskStream(){
+    sampleStreamUpdate();
 }
\ No newline at end of file
@@ -80,5 +80,12 @@ void filamentDryerInit();
  */
 void filamentDryerUpdate();
 
+/**
+ * @brief Retorna el estado actual del sistema de secado.
+ *
+ * @return systemState_t Estado del sistema.
+ */
+systemState_t filamentDryerReadState();
+
 //=====[#include guards - end]==========================================
 #endif
\ No newline at end of file
@@ -14,6 +14,70 @@
 #include "modules/temperature_sensor/temperature_sensor.h"
 #include "modules/heater/heater.h"
 #include "modules/led/led.h"
+#include "modules/timer_wheel/timer_wheel.h"
+#include "modules/adc_acquisition/adc_acquisition.h"
+#include "modules/uart_manager/uart_manager.h"
+#include "modules/text_format/text_format.h"
+
+// Si no esta declarado TIME_MS 
+#ifndef TIME_MS
+#define TIME_MS 10
+#endif
+
+#define delay(ms)   thread_sleep_for( ms ) /**< Pseudonimo delay para thread_sleep_for */
+
+#define BENCHMARK_ITERATIONS    1000    /**< Repeticiones promediadas en cada micro benchmark */
+#define LEGACY_SAMPLES  100 /**< Ventana del promedio anterior a la suma acumulada */
+
+/** Línea de estado de uart_manager en formato de printf, para comparar con textFormat() */
+#define STATUS_LINE_PRINTF  "temperature_now: %d temperature_user: %d hour: %d  minutes: %d seconds: %d hour_user: %d heater: %d\n"
+
+static volatile float legacyVoltageSensorAVG = 0; /**< Resultado del promedio anterior, volatile para que no se descarte */
+
+/**
+ * @brief Habilita el contador de ciclos del núcleo (DWT).
+ */
+static void cycleCounterInit(){
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief Ciclos de CPU transcurridos.
+ *
+ * @return uint32_t Valor del contador de ciclos.
+ */
+static uint32_t cycleCounterRead(){
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief Promedio del sensor tal como estaba antes de la suma acumulada.
+ *
+ * Guarda la muestra y vuelve a sumar toda la ventana en cada llamada.
+ *
+ * @param sample Muestra con escala de read_u16().
+ */
+static void legacyTemperatureSensorUpdate(uint16_t sample){
+    static float voltageSensorValue[LEGACY_SAMPLES];
+    static int index = 0;
+    float samples_sum = 0;
+
+    voltageSensorValue[index] = (sample / 65535.0f) * 3.3f;
+
+    index++;
+
+    if(index >= LEGACY_SAMPLES){
+        index = 0;
+    }
+
+    for(int i = 0; i < LEGACY_SAMPLES; i++){
+        samples_sum = samples_sum + voltageSensorValue[i];
+    }
+
+    legacyVoltageSensorAVG = samples_sum / LEGACY_SAMPLES;
+}
 
 /**
 * @brief Función de prueba para el teclado.
@@ -24,12 +88,12 @@ void filamentDryerTestingKeyPad(){
     keypadUpdate();
 
     if(keypadReadButton() != NONE){
-        printf("*** Keypressed.\n");
+        uartManagerPrint("*** Keypressed.\n");
     }else{
-        printf("*** None pressed.\n");
+        uartManagerPrint("*** None pressed.\n");
     }
 
-    rtcUpdate(); // actualiza el estado del reloj
+    delay(TIME_MS);
 }
 
 /**
@@ -51,17 +115,17 @@ void filamentDryerTestingBuzzerManual(){
     
             if(buzzerStatus() == ON){
                 buzzerOff();
-                printf("*** Buzzer OFF.\n");
+                uartManagerPrint("*** Buzzer OFF.\n");
             }else{
                 buzzerOn();
-                printf("*** Buzzer ON.\n");
+                uartManagerPrint("*** Buzzer ON.\n");
             }
         }
     }else{ // si se solto el botón o se presiono cualquier otro
         last_button = NONE;
     }
 
-    rtcUpdate(); // actualiza el estado del reloj
+    delay(TIME_MS);
 }
 
 /**
@@ -75,7 +139,9 @@ void filamentDryerTestingBuzzerAutomatic(){
 
     buzzerUpdate();
 
-    rtcUpdate();
+    timerWheelUpdate(); // los pitidos los generan los temporizadores
+
+    delay(TIME_MS);
 }
 
 /**
@@ -101,10 +167,10 @@ void filamentDryerTestingHeaterManual(){
     
             if(heaterStatus() == ON){
                 heaterOff();
-                printf("*** Heater OFF.\n");
+                uartManagerPrint("*** Heater OFF.\n");
             }else{
                 heaterOn();
-                printf("*** Heater ON.\n");
+                uartManagerPrint("*** Heater ON.\n");
             }
         }
     }else{ // si se solto el botón o se presiono cualquier otro
@@ -119,15 +185,15 @@ void filamentDryerTestingHeaterManual(){
         if(temperatureSensorReadCelsius() >= 100){
             if(heaterStatus() == ON){
                 heaterOff();
-                printf("----> Heater OFF to prevent overheating (100°C LIMIT)\n");
+                uartManagerPrint("----> Heater OFF to prevent overheating (100°C LIMIT)\n");
             }
         }
 
         // muestra la temperatura por uart
-        printf("*** Heater Temperature: %d.\n", temperatureSensorReadCelsius());
+        uartManagerPrint("*** Heater Temperature: ", temperatureSensorReadCelsius(), ".\n");
     }
 
-    rtcUpdate(); // actualiza el estado del reloj
+    delay(TIME_MS);
 }
 
 /**
@@ -146,15 +212,142 @@ void filamentDryerTestingHeaterAutomatic(){
 
     temperatureSensorUpdate();
     
-    heaterUpdate(temperatureSensorReadCelsius());
+    heaterUpdate(temperatureSensorReadCentiCelsius());
 
     // cuando pasa 1 segundo
     if(last_second != actual_second){
         last_second = actual_second;
 
         // muestra la temperatura por uart
-        printf("*** Heater Temperature: %d Temperature Test: %d Heater Status: %d.\n", temperatureSensorReadCelsius(), heaterGetTemperatureWork(), heaterStatus());
+        uartManagerPrint("*** Heater Temperature: ", temperatureSensorReadCelsius(), " Temperature Test: ", heaterGetTemperatureWork(), " Heater Status: ", heaterStatus(), ".\n");
+    }
+
+    delay(TIME_MS);
+}
+
+/**
+ * @brief Función de prueba del autoajuste del PID.
+ * 
+ * Ejecuta el autoajuste por relé a 60°C, cada 1 segundo informa por uart temperatura y estado
+ * del calentador y al terminar las ganancias calculadas.
+ */
+void filamentDryerTestingHeaterAutotune(){
+
+    static bool started = false;
+    static int last_second = 0;
+    int actual_second = rtcRead().seconds;
+    heaterAutotuneResult_t autotune;
+
+    heaterSetTemperature(60);
+
+    if(started == false){
+        started = true;
+        heaterAutotuneStart();
     }
 
-    rtcUpdate();
-}
\ No newline at end of file
+    temperatureSensorUpdate();
+
+    heaterUpdate(temperatureSensorReadCentiCelsius());
+
+    autotune = heaterAutotuneRead();
+
+    // cuando pasa 1 segundo
+    if(last_second != actual_second){
+        last_second = actual_second;
+
+        switch (autotune.state){
+            case HEATER_AUTOTUNE_RUNNING:
+                uartManagerPrint("*** Autotune Temperature: ", temperatureSensorReadCelsius(), " Heater Status: ", heaterStatus(), " Cycles: ", autotune.cycles, ".\n");
+            break;
+
+            case HEATER_AUTOTUNE_DONE:
+                // ganancias en milésimas para no imprimir punto flotante
+                uartManagerPrint("*** Autotune done kp_x1000: ", static_cast<int>(autotune.kp * 1000), " ki_x1000: ", static_cast<int>(autotune.ki * 1000), " kd_x1000: ", static_cast<int>(autotune.kd * 1000), ".\n");
+            break;
+
+            default:
+                uartManagerPrint("*** Autotune failed, heater OFF.\n");
+            break;
+        }
+    }
+
+    delay(TIME_MS);
+}
+
+/**
+ * @brief Micro benchmark del promedio del sensor de temperatura.
+ * 
+ * Mide en ciclos de CPU el promedio anterior (suma de toda la ventana en cada muestra) y la
+ * suma acumulada de temperatureSensorFeed(), sin la conversión del ADC. Detiene la adquisición
+ * continua mientras mide para que sus interrupciones no se sumen a los ciclos y guarda el estado
+ * del sensor alrededor de las muestras de prueba, la lectura y la salida de muestras crudas no
+ * las ven. Cada 1 segundo informa por uart los ciclos por muestra.
+ */
+void filamentDryerTestingSensorBenchmark(){
+    uint32_t start;
+    uint32_t legacy_cycles;
+    uint32_t running_sum_cycles;
+    uint16_t sample = 20000; // ~1 V, 100 °C, en rango
+    static temperatureSensorState_t sensor_state; // fuera de la pila del hilo
+
+    cycleCounterInit();
+
+    adcAcquisitionStop();
+
+    start = cycleCounterRead();
+    for(int i = 0; i < BENCHMARK_ITERATIONS; i++){
+        legacyTemperatureSensorUpdate(sample);
+    }
+    legacy_cycles = (cycleCounterRead() - start) / BENCHMARK_ITERATIONS;
+
+    temperatureSensorSaveState(&sensor_state);
+
+    start = cycleCounterRead();
+    for(int i = 0; i < BENCHMARK_ITERATIONS; i++){
+        temperatureSensorFeed(&sample, 1);
+    }
+    running_sum_cycles = (cycleCounterRead() - start) / BENCHMARK_ITERATIONS;
+
+    temperatureSensorRestoreState(&sensor_state);
+
+    adcAcquisitionStart();
+
+    uartManagerPrint("*** Cycles per sample -> legacy average: ", (unsigned long)legacy_cycles, " running sum: ", (unsigned long)running_sum_cycles, ".\n");
+
+    delay(1000);
+}
+
+/**
+ * @brief Micro benchmark del formateo de la línea de estado.
+ * 
+ * Mide en ciclos de CPU la línea de estado de uart_manager armada con snprintf() y con
+ * textFormat(), verifica que den el mismo texto y cada 1 segundo informa por uart. Es la única
+ * función que usa snprintf: la diferencia de flash se obtiene compilando con esta prueba
+ * comentada y descomentada en main.cpp y comparando el .text de mbed compile --stats-depth.
+ */
+void filamentDryerTestingFormatBenchmark(){
+    char printf_line[UART_LINE_MAX];
+    char format_line[UART_LINE_MAX];
+    static volatile int sink = 0; // evita que se descarten las llamadas
+    uint32_t start;
+    uint32_t printf_cycles;
+    uint32_t format_cycles;
+
+    cycleCounterInit();
+
+    start = cycleCounterRead();
+    for(int i = 0; i < BENCHMARK_ITERATIONS; i++){
+        sink = sink + snprintf(printf_line, sizeof(printf_line), STATUS_LINE_PRINTF, 20 + i % 80, 60, i % 24, i % 60, (i * 7) % 60, 4, i & 1);
+    }
+    printf_cycles = (cycleCounterRead() - start) / BENCHMARK_ITERATIONS;
+
+    start = cycleCounterRead();
+    for(int i = 0; i < BENCHMARK_ITERATIONS; i++){
+        sink = sink + textFormat(format_line, sizeof(format_line), "temperature_now: ", 20 + i % 80, " temperature_user: ", 60, " hour: ", i % 24, "  minutes: ", i % 60, " seconds: ", (i * 7) % 60, " hour_user: ", 4, " heater: ", i & 1, "\n");
+    }
+    format_cycles = (cycleCounterRead() - start) / BENCHMARK_ITERATIONS;
+
+    uartManagerPrint("*** Cycles per status line -> snprintf: ", (unsigned long)printf_cycles, " textFormat: ", (unsigned long)format_cycles, strcmp(printf_line, format_line) == 0 ? " (same text).\n" : " (TEXT MISMATCH).\n");
+
+    delay(1000);
+}
@@ -52,5 +52,34 @@ void filamentDryerTestingHeaterManual();
  */
 void filamentDryerTestingHeaterAutomatic();
 
+/**
+ * @brief Función de prueba del autoajuste del PID.
+ * 
+ * Ejecuta el autoajuste por relé a 60°C, cada 1 segundo informa por uart temperatura y estado
+ * del calentador y al terminar las ganancias calculadas.
+ */
+void filamentDryerTestingHeaterAutotune();
+
+/**
+ * @brief Micro benchmark del promedio del sensor de temperatura.
+ * 
+ * Mide en ciclos de CPU el promedio anterior (suma de toda la ventana en cada muestra) y la
+ * suma acumulada de temperatureSensorFeed(), sin la conversión del ADC. Las dos usan ventanas
+ * propias, el filtro real y la salida de muestras crudas no ven las muestras de prueba. Detiene
+ * la adquisición continua mientras mide para que sus interrupciones no se sumen a los ciclos,
+ * cada 1 segundo informa por uart los ciclos por muestra.
+ */
+void filamentDryerTestingSensorBenchmark();
+
+/**
+ * @brief Micro benchmark del formateo de la línea de estado.
+ * 
+ * Mide en ciclos de CPU la línea de estado de uart_manager armada con snprintf() y con
+ * textFormat(), verifica que den el mismo texto y cada 1 segundo informa por uart. Es la única
+ * función que usa snprintf: la diferencia de flash se obtiene compilando con esta prueba
+ * comentada y descomentada en main.cpp y comparando el .text de mbed compile --stats-depth.
+ */
+void filamentDryerTestingFormatBenchmark();
+
 //=====[#include guards - end]==========================================
 #endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+/**
+* @file flash_record.cpp
+* @brief Implementación de las funciones comunes a los registros de tamaño fijo en la flash interna.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "flash_record.h"
+
+//=====[Declaration of private defines]=================================
+#define ERASED_CHUNK    32  /**< Bytes que se leen por vez al revisar un lugar */
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+
+//=====[Declaration (prototypes) of private functions]==================
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Agrega los bytes de un entero en little-endian.
+ *
+ * @param data Destino.
+ * @param value Valor.
+ * @param bytes Cantidad de bytes.
+ */
+void flashRecordPut(uint8_t *data, const uint32_t value, const int bytes){
+
+    for(int i = 0; i < bytes; i++){
+        data[i] = value >> (8 * i);
+    }
+}
+
+/**
+ * @brief Lee un entero en little-endian.
+ *
+ * @param data Origen.
+ * @param bytes Cantidad de bytes.
+ *
+ * @return uint32_t Valor.
+ */
+uint32_t flashRecordGet(const uint8_t *data, const int bytes){
+    uint32_t value = 0;
+
+    for(int i = 0; i < bytes; i++){
+        value = value | ((uint32_t)data[i] << (8 * i));
+    }
+
+    return value;
+}
+
+/**
+ * @brief Indica si un lugar está completo en el valor de borrado.
+ *
+ * @param flash Flash interna, ya inicializada.
+ * @param address Dirección del lugar.
+ * @param size Bytes del lugar.
+ *
+ * @return true si nunca se programó.
+ */
+bool flashRecordErased(FlashIAP *flash, const uint32_t address, const uint32_t size){
+    uint8_t data[ERASED_CHUNK];
+    uint8_t erased = flash->get_erase_value();
+
+    // todo el lugar: un corte pudo dejar programados solo los primeros bytes
+    for(uint32_t offset = 0; offset < size; offset = offset + ERASED_CHUNK){
+        uint32_t length = (size - offset < ERASED_CHUNK) ? size - offset : ERASED_CHUNK;
+
+        if(flash->read(data, address + offset, length) != 0){
+            return false;
+        }
+
+        for(uint32_t i = 0; i < length; i++){
+
+            if(data[i] != erased){
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Busca por bisección el primer lugar libre de una región.
+ *
+ * @param flash Flash interna, ya inicializada.
+ * @param address Dirección del lugar 0.
+ * @param size Bytes de cada lugar.
+ * @param first Primer lugar de registros (el diario reserva el 0 para la cabecera).
+ * @param slots Lugares de la región.
+ *
+ * @return uint32_t Lugar, slots si está llena.
+ */
+uint32_t flashRecordFindTail(FlashIAP *flash, const uint32_t address, const uint32_t size, const uint32_t first, const uint32_t slots){
+    uint32_t low = first;
+    uint32_t high = slots;
+
+    // los lugares programados (válidos o cortados) van antes que los borrados
+    while(low < high){
+        uint32_t middle = low + (high - low) / 2;
+
+        if(flashRecordErased(flash, address + middle * size, size)){
+            high = middle;
+        }else{
+            low = middle + 1;
+        }
+    }
+
+    return low;
+}
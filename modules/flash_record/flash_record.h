@@ -0,0 +1,70 @@
+/**
+* @file flash_record.h
+* @brief Declaraciones de las funciones comunes a los registros de tamaño fijo en la flash interna.
+*
+* El diario de sesiones y los puntos de control de la reanudación guardan registros de
+* tamaño fijo agregados uno tras otro sobre sectores borrados, con los enteros en
+* little-endian. Como ningún lugar se reprograma, los lugares programados (válidos o
+* cortados por un corte de energía) quedan antes que los borrados y el primero libre se
+* encuentra por bisección.
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _FLASH_RECORD_H_
+#define _FLASH_RECORD_H_
+
+#include "mbed.h"
+
+//=====[Declaration of private defines]=================================
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Agrega los bytes de un entero en little-endian.
+ *
+ * @param data Destino.
+ * @param value Valor.
+ * @param bytes Cantidad de bytes.
+ */
+void flashRecordPut(uint8_t *data, const uint32_t value, const int bytes);
+
+/**
+ * @brief Lee un entero en little-endian.
+ *
+ * @param data Origen.
+ * @param bytes Cantidad de bytes.
+ *
+ * @return uint32_t Valor.
+ */
+uint32_t flashRecordGet(const uint8_t *data, const int bytes);
+
+/**
+ * @brief Indica si un lugar está completo en el valor de borrado.
+ *
+ * @param flash Flash interna, ya inicializada.
+ * @param address Dirección del lugar.
+ * @param size Bytes del lugar.
+ *
+ * @return true si nunca se programó.
+ */
+bool flashRecordErased(FlashIAP *flash, const uint32_t address, const uint32_t size);
+
+/**
+ * @brief Busca por bisección el primer lugar libre de una región.
+ *
+ * @param flash Flash interna, ya inicializada.
+ * @param address Dirección del lugar 0.
+ * @param size Bytes de cada lugar.
+ * @param first Primer lugar de registros (el diario reserva el 0 para la cabecera).
+ * @param slots Lugares de la región.
+ *
+ * @return uint32_t Lugar, slots si está llena.
+ */
+uint32_t flashRecordFindTail(FlashIAP *flash, const uint32_t address, const uint32_t size, const uint32_t first, const uint32_t slots);
+
+//=====[#include guards - end]==========================================
+#endif
@@ -7,12 +7,34 @@
 */
 //=====[Libraries]======================================================
 #include "heater.h"
+#include "modules/rtc/rtc.h"
+#include "modules/event_log/event_log.h"
+#include <math.h>
 
 //=====[Declaration of private defines]=================================
 #define ON  1   /**< Valor que se usa para encender leds/calentador */
 #define OFF !ON /**< Valor que se usa para apagar leds/calentador */
 
 #define HYSTERESIS  2 /**< Para evitar conmutaciones de relé rápidas */
+#define CENTI_PER_DEGREE    100 /**< Centésimas de grado en un grado */
+
+// Si no esta declarado el modo de control con el que arranca
+#ifndef HEATER_DEFAULT_CONTROL
+#define HEATER_DEFAULT_CONTROL  HEATER_CONTROL_ON_OFF
+#endif
+
+#define PID_OUTPUT_MAX  255.0f  /**< Salida máxima del PID, escala de las ganancias */
+#define PID_WINDOW_MS   12000   /**< Ventana de tiempo proporcional del relé, también periodo de cálculo del PID */
+#define PID_MIN_PULSE_MS    1000    /**< Encendidos/apagados más cortos se descartan para cuidar el relé */
+#define PID_TRACKING_GAIN   1.0f    /**< Ganancia del cálculo inverso (back-calculation) del integrador */
+#define US_PER_MS   1000ULL /**< Microsegundos en un milisegundo */
+
+#define AUTOTUNE_HYSTERESIS_CENTI   50  /**< Histéresis del relé del autoajuste, evita conmutar por ruido */
+#define AUTOTUNE_SKIP_CYCLES    1   /**< Ciclos iniciales descartados (incluyen el calentamiento desde frío) */
+#define AUTOTUNE_CYCLES 5   /**< Ciclos límite promediados para calcular las ganancias */
+#define AUTOTUNE_TIMEOUT_MS (2 * 3600 * 1000ULL)    /**< Tiempo máximo del autoajuste */
+#define AUTOTUNE_MAX_OVERSHOOT_CENTI    2000    /**< Sobrepaso que aborta el autoajuste */
+#define PI_F    3.14159265f /**< Número pi */
 
 //=====[Declaration of private data types]==============================
 
@@ -26,12 +48,34 @@ DigitalOut* heater;   /** Objeto para el calentador */
 //=====[Declaration and initialization of private global variables]=====
 static int heaterWorkTemperature;  // temperatura de trabajo del calentador
 
-static float kp = 72.63f;  // Ganancia proporcional
-static float ki = 14.19f;  // Ganancia integral
-static float kd = 247.56f; // Ganancia derivativa
+static float kp = 45.0f;  // Ganancia proporcional (salida/°C)
+static float ki = 0.5f;  // Ganancia integral (salida/(°C*s))
+static float kd = 100.0f; // Ganancia derivativa (salida*s/°C)
 
-static float integral = 0.0f;
-static float last_error = 0.0f;
+static heaterControlMode_t control_mode = HEATER_DEFAULT_CONTROL; /**< Modo de control activo */
+
+static bool pid_started = false; /**< Ya se tomó la primera muestra */
+static float integral = 0.0f; /**< Término integral en unidades de salida */
+static float last_measure = 0.0f; /**< Medición anterior en °C, para la derivada sobre la medición */
+static float pid_output = 0.0f; /**< Última salida del PID entre 0 y PID_OUTPUT_MAX */
+static float window_measure_sum = 0.0f; /**< Suma de las mediciones de la ventana actual en °C */
+static int window_measure_count = 0; /**< Mediciones sumadas en la ventana actual */
+static uint64_t window_start_us = 0; /**< Inicio de la ventana de tiempo proporcional */
+static uint64_t window_on_us = 0; /**< Tiempo encendido dentro de la ventana actual */
+
+static heaterAutotuneResult_t autotune; /**< Estado y resultado del autoajuste */
+static uint64_t autotune_start_us = 0; /**< Inicio del autoajuste */
+static uint64_t autotune_last_on_us = 0; /**< Último encendido del relé (inicio de ciclo) */
+static uint64_t autotune_off_us = 0; /**< Último apagado del relé */
+static int autotune_max_centi = 0; /**< Máximo del ciclo en curso */
+static int autotune_min_centi = 0; /**< Mínimo del ciclo en curso */
+static uint64_t autotune_max_us = 0; /**< Instante del máximo del ciclo en curso */
+static uint64_t autotune_min_us = 0; /**< Instante del mínimo del ciclo en curso */
+static int autotune_seen_cycles = 0; /**< Ciclos completos, incluidos los descartados */
+static float autotune_amplitude_sum = 0.0f; /**< Suma de amplitudes (°C) de los ciclos medidos */
+static float autotune_period_sum = 0.0f; /**< Suma de periodos (s) de los ciclos medidos */
+static float autotune_slope_sum = 0.0f; /**< Suma de pendientes (°C/s por unidad de salida) de los ciclos medidos */
+static float autotune_dead_sum = 0.0f; /**< Suma de retardos (s) de los ciclos medidos */
 
 //=====[Declaration (prototypes) of private functions]==================
 /**
@@ -39,18 +83,58 @@ static float last_error = 0.0f;
 * 
 * Hace que el calentador trabaje a la temperatura especificada por medio de la función heaterSetTemperature
 *
-* @param int heaterTemperature temperatura actual
+* @param int heaterTemperatureCenti temperatura actual en centésimas de grado
 */
-static void heaterControlOnOff(int heaterTemperature);
+static void heaterControlOnOff(int heaterTemperatureCenti);
 
 /**
 * @brief Gestiona el estado del calentador por medio de control PID.
 * 
-* Hace que el calentador trabaje a la temperatura especificada por medio de la función heaterSetTemperature
+* Calcula el PID una vez por ventana de PID_WINDOW_MS con el promedio de la temperatura de
+* la ventana y reparte la salida en la ventana siguiente.
 *
-* @param int heaterTemperature temperatura actual
+* @param int heaterTemperatureCenti temperatura actual en centésimas de grado
+*/
+static void heaterControlPID(int heaterTemperatureCenti);
+
+/**
+* @brief Calcula una muestra del PID.
+* 
+* Integra con el dt real, limita el integrador por cálculo inverso y deriva la medición.
+*
+* @param measure temperatura actual en grados
+* @param dt segundos desde la muestra anterior
+*/
+static void heaterPIDCompute(float measure, float dt);
+
+/**
+* @brief Convierte la salida del PID en tiempo encendido de la ventana.
+* 
+* @return uint64_t microsegundos encendido dentro de PID_WINDOW_MS
+*/
+static uint64_t heaterPIDWindowOnUs();
+
+/**
+* @brief Autoajuste por relé (Åström–Hägglund).
+* 
+* Conmuta el calentador alrededor de la consigna, mide amplitud y periodo de los ciclos límite
+* y al terminar calcula las ganancias del PID (SIMC sobre un integrador con retardo) y pasa a control PID.
+*
+* @param int heaterTemperatureCenti temperatura actual en centésimas de grado
+*/
+static void heaterControlAutotune(int heaterTemperatureCenti);
+
+/**
+* @brief Termina el autoajuste.
+* 
+* @param state HEATER_AUTOTUNE_DONE o HEATER_AUTOTUNE_FAILED
+*/
+static void heaterAutotuneFinish(heaterAutotuneState_t state);
+
+/**
+* @brief Descarta las mediciones del autoajuste (relé, ciclos y extremos).
 */
-static void heaterControlPID(int heaterTemperature);
+static void heaterAutotuneClear();
 
 //=====[Implementations of public functions]============================
 /**
@@ -72,6 +156,12 @@ void heaterInit(PinName heaterPin){
 * Configura el calentador para que esté encendido.
 */
 void heaterOff(){
+
+    // se llama en cada tick, solo se registra el cambio
+    if(*heater != OFF){
+        eventLogWrite(EVENT_LOG_HEATER, OFF);
+    }
+
     *heater = OFF;
 }
 
@@ -81,6 +171,11 @@ void heaterOff(){
 * Configura el calentador para que esté apagado.
 */
 void heaterOn(){
+
+    if(*heater != ON){
+        eventLogWrite(EVENT_LOG_HEATER, ON);
+    }
+
     *heater = ON;
 }
 
@@ -122,12 +217,150 @@ int heaterGetTemperatureWork(){
 * 
 * Hace que el calentador trabaje a la temperatura especificada por medio de la función heaterSetTemperature
 *
-* @param int heaterTemperature temperatura actual
+* @param int heaterTemperatureCenti temperatura actual en centésimas de grado
 */
-void heaterUpdate(int heaterTemperature){
+void heaterUpdate(int heaterTemperatureCenti){
+
+    switch (control_mode){
+        case HEATER_CONTROL_PID:
+            heaterControlPID(heaterTemperatureCenti);
+        break;
+
+        case HEATER_CONTROL_AUTOTUNE:
+            heaterControlAutotune(heaterTemperatureCenti);
+        break;
 
-    //heaterControlPID(heaterTemperature);
-    heaterControlOnOff(heaterTemperature);
+        case HEATER_CONTROL_ON_OFF:
+        default:
+            heaterControlOnOff(heaterTemperatureCenti);
+        break;
+    }
+}
+
+/**
+* @brief Selecciona el modo de control.
+* 
+* Reinicia el estado del control para que el nuevo modo arranque limpio.
+*
+* @param mode modo de control
+*/
+void heaterSetControlMode(heaterControlMode_t mode){
+    control_mode = mode;
+    heaterControlReset();
+}
+
+/**
+* @brief Modo de control activo.
+* 
+* @return heaterControlMode_t modo de control
+*/
+heaterControlMode_t heaterGetControlMode(){
+    return control_mode;
+}
+
+/**
+* @brief Arranca el autoajuste de las ganancias del PID.
+* 
+* Usa la temperatura de trabajo actual como consigna. Al terminar bien aplica las
+* ganancias y queda en HEATER_CONTROL_PID; si falla vuelve a HEATER_CONTROL_ON_OFF.
+*/
+void heaterAutotuneStart(){
+    autotune.state = HEATER_AUTOTUNE_RUNNING;
+    autotune.cycles = 0;
+    autotune.ku = 0.0f;
+    autotune.tu = 0.0f;
+    autotune.kp = kp;
+    autotune.ki = ki;
+    autotune.kd = kd;
+
+    autotune_start_us = rtcNowUs();
+    heaterAutotuneClear();
+
+    heaterOff();
+    heaterSetControlMode(HEATER_CONTROL_AUTOTUNE);
+}
+
+/**
+* @brief Estado y resultado del autoajuste.
+* 
+* @return heaterAutotuneResult_t estado, ciclos medidos y ganancias calculadas
+*/
+heaterAutotuneResult_t heaterAutotuneRead(){
+    return autotune;
+}
+
+/**
+* @brief Interrumpe el autoajuste en curso.
+* 
+* Lo da por fallido (vuelve a HEATER_CONTROL_ON_OFF con el relé apagado) y descarta los
+* ciclos medidos; sin autoajuste en curso no hace nada. Se usa al dejar de secar y con el
+* sensor en falla, cuando los máximos y mínimos medidos dejan de valer.
+*/
+void heaterAutotuneAbort(){
+
+    if(autotune.state != HEATER_AUTOTUNE_RUNNING){
+        return;
+    }
+
+    heaterAutotuneFinish(HEATER_AUTOTUNE_FAILED);
+}
+
+/**
+* @brief Reemplaza las ganancias del PID.
+* 
+* @param new_kp ganancia proporcional (salida/°C)
+* @param new_ki ganancia integral (salida/(°C*s))
+* @param new_kd ganancia derivativa (salida*s/°C)
+*/
+void heaterSetGains(float new_kp, float new_ki, float new_kd){
+    kp = new_kp;
+    ki = new_ki;
+    kd = new_kd;
+    heaterControlReset();
+}
+
+/**
+* @brief Ganancias actuales del PID.
+* 
+* @param current_kp ganancia proporcional (salida/°C)
+* @param current_ki ganancia integral (salida/(°C*s))
+* @param current_kd ganancia derivativa (salida*s/°C)
+*/
+void heaterGetGains(float *current_kp, float *current_ki, float *current_kd){
+    *current_kp = kp;
+    *current_ki = ki;
+    *current_kd = kd;
+}
+
+/**
+* @brief Reinicia el estado del control.
+* 
+* Vacía el integrador y arranca una ventana nueva en la próxima llamada a heaterUpdate(),
+* se usa cuando el calentador deja de estar controlado.
+*/
+void heaterControlReset(){
+    pid_started = false;
+    integral = 0.0f;
+    pid_output = 0.0f;
+    window_on_us = 0;
+    window_measure_sum = 0.0f;
+    window_measure_count = 0;
+}
+
+/**
+* @brief Salida del control en porcentaje.
+* 
+* En PID es el ciclo de trabajo de la ventana; en ON/OFF es 0 o 100 según el relé.
+*
+* @return int salida entre 0 y 100
+*/
+int heaterGetOutputPercent(){
+
+    if(control_mode == HEATER_CONTROL_PID){
+        return static_cast<int>(pid_output * 100.0f / PID_OUTPUT_MAX + 0.5f);
+    }
+
+    return heaterStatus() ? 100 : 0;
 }
 
 //=====[Implementations of private functions]===========================
@@ -136,16 +369,18 @@ void heaterUpdate(int heaterTemperature){
 * 
 * Hace que el calentador trabaje a la temperatura especificada por medio de la función heaterSetTemperature
 *
-* @param int heaterTemperature temperatura actual
+* @param int heaterTemperatureCenti temperatura actual en centésimas de grado
 */
-static void heaterControlOnOff(int heaterTemperature){
-    if(heaterTemperature >= (heaterWorkTemperature + HYSTERESIS)){
+static void heaterControlOnOff(int heaterTemperatureCenti){
+    int workTemperatureCenti = heaterWorkTemperature * CENTI_PER_DEGREE;
+
+    if(heaterTemperatureCenti >= (workTemperatureCenti + HYSTERESIS * CENTI_PER_DEGREE)){
         heaterOff(); // calentador apagado
     }else{
         // calentador apagado por haber alcanzado temp de trabajo
         if(heaterStatus() == OFF){
             // temperatura paso del margen de mantener apagado
-            if(heaterTemperature < (heaterWorkTemperature - HYSTERESIS)){
+            if(heaterTemperatureCenti < (workTemperatureCenti - HYSTERESIS * CENTI_PER_DEGREE)){
                 heaterOn();
             }
         }
@@ -155,22 +390,255 @@ static void heaterControlOnOff(int heaterTemperature){
 /**
 * @brief Gestiona el estado del calentador por medio de control PID.
 * 
-* Hace que el calentador trabaje a la temperatura especificada por medio de la función heaterSetTemperature
+* Calcula el PID una vez por ventana de PID_WINDOW_MS con el promedio de la temperatura de
+* la ventana y reparte la salida en la ventana siguiente: el relé queda encendido la
+* fracción de la ventana que indica la salida.
 *
-* @param int heaterTemperature temperatura actual
+* @param int heaterTemperatureCenti temperatura actual en centésimas de grado
 */
-static void heaterControlPID(int heaterTemperature){
-    float error = heaterWorkTemperature - heaterTemperature;
+static void heaterControlPID(int heaterTemperatureCenti){
+    uint64_t now = rtcNowUs();
+    float measure = heaterTemperatureCenti / (float)CENTI_PER_DEGREE;
+
+    // primera muestra, no hay dt ni derivada todavía
+    if(pid_started == false){
+        pid_started = true;
+        last_measure = measure;
+        window_start_us = now;
+
+        heaterPIDCompute(measure, 0.0f);
+        window_on_us = heaterPIDWindowOnUs();
+    }
 
-    integral += error;
-    float derivative = error - last_error;
-    float controlOutput = kp * error + ki * integral + kd * derivative;
+    // el promedio de una ventana completa cancela el diente de sierra que deja el propio relé,
+    // con una muestra suelta la derivada y la saturación en 0 lo convierten en error estacionario
+    window_measure_sum = window_measure_sum + measure;
+    window_measure_count = window_measure_count + 1;
 
-    last_error = error;
+    // nueva ventana, calcula el PID con la ventana que termina
+    if(now - window_start_us >= PID_WINDOW_MS * US_PER_MS){
+        float dt = (now - window_start_us) / 1000000.0f;
+
+        window_start_us = window_start_us + PID_WINDOW_MS * US_PER_MS;
+
+        // si se perdieron ventanas enteras se realinea
+        if(now - window_start_us >= PID_WINDOW_MS * US_PER_MS){
+            window_start_us = now;
+        }
+
+        heaterPIDCompute(window_measure_sum / window_measure_count, dt);
+        window_on_us = heaterPIDWindowOnUs();
+
+        window_measure_sum = 0.0f;
+        window_measure_count = 0;
+    }
 
-    if (controlOutput > 0.0f) {
+    if(now - window_start_us < window_on_us){
         heaterOn();
-    } else {
+    }else{
+        heaterOff();
+    }
+}
+
+/**
+* @brief Calcula una muestra del PID.
+* 
+* Integra con el dt real, limita el integrador por cálculo inverso y deriva la medición.
+*
+* @param measure temperatura actual en grados
+* @param dt segundos desde la muestra anterior
+*/
+static void heaterPIDCompute(float measure, float dt){
+    float error = heaterWorkTemperature - measure;
+    float derivative = 0.0f;
+    float output;
+    float output_saturated;
+
+    integral = integral + ki * error * dt;
+
+    // derivada sobre la medición: un cambio de consigna no genera un pico
+    if(dt > 0.0f){
+        derivative = -kd * (measure - last_measure) / dt;
+    }
+
+    last_measure = measure;
+
+    output = kp * error + integral + derivative;
+
+    output_saturated = output;
+
+    if(output_saturated > PID_OUTPUT_MAX){
+        output_saturated = PID_OUTPUT_MAX;
+    }else if(output_saturated < 0.0f){
+        output_saturated = 0.0f;
+    }
+
+    // cálculo inverso: el integrador se descarga lo que la salida excede el límite
+    integral = integral + PID_TRACKING_GAIN * (output_saturated - output);
+
+    // el integrador solo nunca supera el rango de la salida
+    if(integral > PID_OUTPUT_MAX){
+        integral = PID_OUTPUT_MAX;
+    }else if(integral < 0.0f){
+        integral = 0.0f;
+    }
+
+    pid_output = output_saturated;
+}
+
+/**
+* @brief Convierte la salida del PID en tiempo encendido de la ventana.
+* 
+* @return uint64_t microsegundos encendido dentro de PID_WINDOW_MS
+*/
+static uint64_t heaterPIDWindowOnUs(){
+    uint64_t on_ms = static_cast<uint64_t>(pid_output * PID_WINDOW_MS / PID_OUTPUT_MAX);
+
+    // pulsos demasiado cortos desgastan el relé sin aportar energía
+    if(on_ms < PID_MIN_PULSE_MS){
+        on_ms = 0;
+    }else if(on_ms > PID_WINDOW_MS - PID_MIN_PULSE_MS){
+        on_ms = PID_WINDOW_MS;
+    }
+
+    return on_ms * US_PER_MS;
+}
+
+/**
+* @brief Autoajuste por relé (Åström–Hägglund).
+* 
+* Conmuta el calentador alrededor de la consigna, mide amplitud y periodo de los ciclos límite
+* y al terminar calcula las ganancias del PID (SIMC sobre un integrador con retardo) y pasa a control PID.
+*
+* @param int heaterTemperatureCenti temperatura actual en centésimas de grado
+*/
+static void heaterControlAutotune(int heaterTemperatureCenti){
+    uint64_t now = rtcNowUs();
+    int workTemperatureCenti = heaterWorkTemperature * CENTI_PER_DEGREE;
+
+    if(autotune.state != HEATER_AUTOTUNE_RUNNING){
         heaterOff();
+        return;
+    }
+
+    // protección: no converge o se pasa de temperatura
+    if(now - autotune_start_us >= AUTOTUNE_TIMEOUT_MS * US_PER_MS or
+       heaterTemperatureCenti >= workTemperatureCenti + AUTOTUNE_MAX_OVERSHOOT_CENTI){
+        heaterAutotuneFinish(HEATER_AUTOTUNE_FAILED);
+        return;
+    }
+
+    if(heaterTemperatureCenti > autotune_max_centi){
+        autotune_max_centi = heaterTemperatureCenti;
+        autotune_max_us = now;
+    }
+
+    if(heaterTemperatureCenti < autotune_min_centi){
+        autotune_min_centi = heaterTemperatureCenti;
+        autotune_min_us = now;
+    }
+
+    if(heaterStatus() == ON){
+        if(heaterTemperatureCenti > workTemperatureCenti + AUTOTUNE_HYSTERESIS_CENTI){
+            heaterOff();
+            autotune_off_us = now;
+        }
+        return;
     }
-}
\ No newline at end of file
+
+    if(heaterTemperatureCenti >= workTemperatureCenti - AUTOTUNE_HYSTERESIS_CENTI){
+        return;
+    }
+
+    // encendido del relé: cierra un ciclo límite (un máximo y un mínimo)
+    heaterOn();
+
+    if(autotune_last_on_us != 0){
+        autotune_seen_cycles = autotune_seen_cycles + 1;
+
+        if(autotune_seen_cycles > AUTOTUNE_SKIP_CYCLES){
+            float swing = (autotune_max_centi - autotune_min_centi) / (float)CENTI_PER_DEGREE;
+            float on_s = (autotune_off_us - autotune_last_on_us) / 1000000.0f;
+            float off_s = (now - autotune_off_us) / 1000000.0f;
+
+            autotune_amplitude_sum = autotune_amplitude_sum + swing / 2.0f;
+            autotune_period_sum = autotune_period_sum + (now - autotune_last_on_us) / 1000000.0f;
+
+            // el mínimo llega un retardo después de encender y el máximo un retardo después de apagar,
+            // entre ellos sube lo que duró encendido y baja lo que duró apagado
+            autotune_dead_sum = autotune_dead_sum + ((autotune_min_us - autotune_last_on_us) + (autotune_max_us - autotune_off_us)) / 2000000.0f;
+            autotune_slope_sum = autotune_slope_sum + swing * (1.0f / on_s + 1.0f / off_s) / PID_OUTPUT_MAX;
+            autotune.cycles = autotune.cycles + 1;
+        }
+    }
+
+    autotune_last_on_us = now;
+    autotune_max_centi = heaterTemperatureCenti;
+    autotune_min_centi = heaterTemperatureCenti;
+    autotune_max_us = now;
+    autotune_min_us = now;
+
+    if(autotune.cycles >= AUTOTUNE_CYCLES){
+        float amplitude = autotune_amplitude_sum / autotune.cycles;
+        float hysteresis = AUTOTUNE_HYSTERESIS_CENTI / (float)CENTI_PER_DEGREE;
+        float relay = PID_OUTPUT_MAX / 2.0f;
+
+        // con histéresis en el relé la amplitud efectiva es sqrt(a² - h²)
+        if(amplitude <= hysteresis){
+            heaterAutotuneFinish(HEATER_AUTOTUNE_FAILED);
+            return;
+        }
+
+        autotune.ku = 4.0f * relay / (PI_F * sqrtf(amplitude * amplitude - hysteresis * hysteresis));
+        autotune.tu = autotune_period_sum / autotune.cycles;
+
+        // cerca de la consigna la planta es un integrador con retardo; Ziegler–Nichols sobre ku y tu
+        // no ve el retardo que agrega la ventana y con el relé asimétrico (consignas altas) sobreestima tu
+        float slope = autotune_slope_sum / autotune.cycles;
+        float loop_dead_s = autotune_dead_sum / autotune.cycles + PID_WINDOW_MS / 1000.0f;
+
+        // SIMC para integrador con retardo, con la constante de lazo cerrado igual al retardo del lazo;
+        // la derivada sobre el promedio de la ventana no mejora la respuesta y amplifica el ruido
+        autotune.kp = 1.0f / (2.0f * slope * loop_dead_s);
+        autotune.ki = autotune.kp / (8.0f * loop_dead_s);
+        autotune.kd = 0.0f;
+
+        heaterAutotuneFinish(HEATER_AUTOTUNE_DONE);
+    }
+}
+
+/**
+* @brief Termina el autoajuste.
+* 
+* @param state HEATER_AUTOTUNE_DONE o HEATER_AUTOTUNE_FAILED
+*/
+static void heaterAutotuneFinish(heaterAutotuneState_t state){
+    autotune.state = state;
+
+    heaterOff();
+    heaterAutotuneClear(); // un autoajuste nuevo no parte de ciclos viejos
+
+    if(state == HEATER_AUTOTUNE_DONE){
+        heaterSetGains(autotune.kp, autotune.ki, autotune.kd);
+        heaterSetControlMode(HEATER_CONTROL_PID);
+    }else{
+        heaterSetControlMode(HEATER_CONTROL_ON_OFF);
+    }
+}
+
+/**
+* @brief Descarta las mediciones del autoajuste (relé, ciclos y extremos).
+*/
+static void heaterAutotuneClear(){
+    autotune_last_on_us = 0;
+    autotune_off_us = 0;
+    autotune_max_centi = 0;
+    autotune_min_centi = 0;
+    autotune_max_us = 0;
+    autotune_min_us = 0;
+    autotune_seen_cycles = 0;
+    autotune_amplitude_sum = 0.0f;
+    autotune_period_sum = 0.0f;
+    autotune_slope_sum = 0.0f;
+    autotune_dead_sum = 0.0f;
+}
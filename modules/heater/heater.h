@@ -14,6 +14,37 @@
 //=====[Declaration of private defines]=================================
 
 //=====[Declaration of private data types]==============================
+/**
+ * @brief Modos de control del calentador.
+ */
+typedef enum{
+    HEATER_CONTROL_ON_OFF,  /**< Encendido/apagado con histéresis */
+    HEATER_CONTROL_PID,     /**< PID con ventana de tiempo proporcional sobre el relé */
+    HEATER_CONTROL_AUTOTUNE /**< Autoajuste por relé de las ganancias del PID */
+}heaterControlMode_t;
+
+/**
+ * @brief Estados del autoajuste.
+ */
+typedef enum{
+    HEATER_AUTOTUNE_IDLE,   /**< Nunca se ejecutó */
+    HEATER_AUTOTUNE_RUNNING,    /**< Midiendo ciclos límite */
+    HEATER_AUTOTUNE_DONE,   /**< Terminó, ganancias aplicadas */
+    HEATER_AUTOTUNE_FAILED  /**< Abortado por tiempo, sobrepaso o amplitud insuficiente */
+}heaterAutotuneState_t;
+
+/**
+ * @brief Estado y resultado del autoajuste.
+ */
+typedef struct{
+    heaterAutotuneState_t state;    /**< Estado */
+    int cycles; /**< Ciclos límite medidos */
+    float ku;   /**< Ganancia última */
+    float tu;   /**< Periodo último en segundos */
+    float kp;   /**< Ganancia proporcional calculada */
+    float ki;   /**< Ganancia integral calculada */
+    float kd;   /**< Ganancia derivativa calculada */
+}heaterAutotuneResult_t;
 
 //=====[Declaration (prototypes) of public functions]===================
 /**
@@ -71,9 +102,84 @@ int heaterGetTemperatureWork();
 * 
 * Hace que el calentador trabaje a la temperatura especificada por medio de la función heaterSetTemperature
 *
-* @param int heaterTemperature temperatura actual
+* @param int heaterTemperatureCenti temperatura actual en centésimas de grado
+*/
+void heaterUpdate(int heaterTemperatureCenti);
+
+/**
+* @brief Selecciona el modo de control.
+* 
+* Reinicia el estado del control para que el nuevo modo arranque limpio.
+*
+* @param mode modo de control
+*/
+void heaterSetControlMode(heaterControlMode_t mode);
+
+/**
+* @brief Modo de control activo.
+* 
+* @return heaterControlMode_t modo de control
+*/
+heaterControlMode_t heaterGetControlMode();
+
+/**
+* @brief Arranca el autoajuste de las ganancias del PID.
+* 
+* Usa la temperatura de trabajo actual como consigna. Al terminar bien aplica las
+* ganancias y queda en HEATER_CONTROL_PID; si falla vuelve a HEATER_CONTROL_ON_OFF.
+*/
+void heaterAutotuneStart();
+
+/**
+* @brief Estado y resultado del autoajuste.
+* 
+* @return heaterAutotuneResult_t estado, ciclos medidos y ganancias calculadas
+*/
+heaterAutotuneResult_t heaterAutotuneRead();
+
+/**
+* @brief Interrumpe el autoajuste en curso.
+* 
+* Lo da por fallido (vuelve a HEATER_CONTROL_ON_OFF con el relé apagado) y descarta los
+* ciclos medidos; sin autoajuste en curso no hace nada. Se usa al dejar de secar y con el
+* sensor en falla, cuando los máximos y mínimos medidos dejan de valer.
+*/
+void heaterAutotuneAbort();
+
+/**
+* @brief Reemplaza las ganancias del PID.
+* 
+* @param new_kp ganancia proporcional (salida/°C)
+* @param new_ki ganancia integral (salida/(°C*s))
+* @param new_kd ganancia derivativa (salida*s/°C)
+*/
+void heaterSetGains(float new_kp, float new_ki, float new_kd);
+
+/**
+* @brief Ganancias actuales del PID.
+* 
+* @param current_kp ganancia proporcional (salida/°C)
+* @param current_ki ganancia integral (salida/(°C*s))
+* @param current_kd ganancia derivativa (salida*s/°C)
+*/
+void heaterGetGains(float *current_kp, float *current_ki, float *current_kd);
+
+/**
+* @brief Reinicia el estado del control.
+* 
+* Vacía el integrador y arranca una ventana nueva en la próxima llamada a heaterUpdate(),
+* se usa cuando el calentador deja de estar controlado.
+*/
+void heaterControlReset();
+
+/**
+* @brief Salida del control en porcentaje.
+* 
+* En PID es el ciclo de trabajo de la ventana; en ON/OFF es 0 o 100 según el relé.
+*
+* @return int salida entre 0 y 100
 */
-void heaterUpdate(int heaterTemperature);
+int heaterGetOutputPercent();
 
 //=====[#include guards - end]==========================================
 #endif
\ No newline at end of file
@@ -7,8 +7,8 @@
 */
 //=====[Libraries]======================================================
 #include "heater_manager.h"
-#include "modules/heater/heater.h"
 #include "modules/temperature_sensor/temperature_sensor.h"
+#include "modules/event_bus/event_bus.h"
 
 //=====[Declaration of private defines]=================================
 
@@ -21,8 +21,31 @@
 //=====[Declaration and initialization of public global variables]======
 
 //=====[Declaration and initialization of private global variables]=====
+static bool published = false;  // ya se publicó la primera lectura
+static int published_temperature = 0;   // última temperatura publicada en centésimas
+static bool published_heater = false;   // último estado del calentador publicado
+static int published_output = 0;    // última salida publicada en %
+static heaterAutotuneState_t published_autotune = HEATER_AUTOTUNE_IDLE; // último estado del autoajuste publicado
 
 //=====[Declaration (prototypes) of private functions]==================
+/**
+* @brief Publica la temperatura y el estado del calentador si cambiaron
+*/
+static void heaterManagerPublish();
+
+/**
+* @brief Publica el estado del autoajuste si cambió y su resultado al terminar
+*/
+static void heaterManagerPublishAutotune();
+
+/**
+* @brief Centésimas de un valor, para publicarlo como entero
+*
+* @param value valor a convertir
+*
+* @return int valor en centésimas
+*/
+static int heaterManagerHundredths(float value);
 
 //=====[Implementations of public functions]============================
 /**
@@ -36,12 +59,20 @@
 void heaterManagerInit(PinName heaterPin, PinName heaterSensorPin){
     temperatureSensorInit(heaterSensorPin);
     heaterInit(heaterPin);
+    heaterSetTemperature(MIN_TEMP);
+
+    published = false;
+    published_autotune = heaterAutotuneRead().state;
 }
 
 /**
 * @brief Gestiona el funcionamiento del calentador
 *
-* Gestiona el encendido/apagado del calentador dependiendo del modo de trabajo y temperatura de trabajo
+* Actualiza el sensor en cada llamada y regula la temperatura solo secando; al dejar de
+* secar se llama a heaterManagerStop(). Con el sensor en falla (fuera de rango o sin
+* muestras nuevas) el calentador queda apagado y un autoajuste en curso se interrumpe.
+* Publica en el bus la temperatura, el calentador y el estado del autoajuste solo cuando
+* cambian; al terminar el autoajuste, antes su resultado.
 *
 * @param state modo de trabajo
 * @param work_temperature temperatura a la cual debe mantener el calentador
@@ -50,25 +81,89 @@ void heaterManagerUpdate(systemState_t state, const int work_temperature){
 
     temperatureSensorUpdate(); // actualiza el estado del sensor de temperatura
 
-    switch (state){
-        case SYSTEM_ON:
-            heaterSetTemperature(MIN_TEMP);
-        break;
-
-        case SYSTEM_WORK:
-            heaterSetTemperature(work_temperature);
-            heaterUpdate(temperatureSensorReadCelsius());
-        break;
-
-        case SYSTEM_STOP:
-        case SYSTEM_FINISH:
-        case SYSTEM_FINISH_AWAIT:
-            heaterOff();
-        break;
-
-        default:
-        break;
-    }    
+    // sin una lectura confiable no se regula sobre un valor viejo o falso
+    if(state == SYSTEM_WORK and temperatureSensorIsFaulty()){
+        heaterAutotuneAbort(); // los extremos medidos dejan de valer
+        heaterOff();
+        heaterControlReset();
+    }else if(state == SYSTEM_WORK){
+        heaterSetTemperature(work_temperature);
+        heaterUpdate(temperatureSensorReadCentiCelsius());
+    }
+
+    heaterManagerPublish();
+}
+
+/**
+* @brief Apaga el calentador y limpia el control
+*
+* Al volver a secar el control arranca limpio. Un autoajuste en curso se interrumpe y
+* queda fallido (control ON/OFF); el estado se publica en el bus.
+*/
+void heaterManagerStop(){
+    heaterAutotuneAbort(); // no queda en autoajuste con los ciclos de este secado
+    heaterOff();
+    heaterControlReset(); // al volver a secar el control arranca limpio
+
+    heaterManagerPublish();
 }
 
-//=====[Implementations of private functions]===========================
\ No newline at end of file
+//=====[Implementations of private functions]===========================
+/**
+* @brief Publica la temperatura y el estado del calentador si cambiaron
+*/
+static void heaterManagerPublish(){
+    int temperature = temperatureSensorReadCentiCelsius();
+    bool heater = heaterStatus();
+    int output = heaterGetOutputPercent();
+
+    if(not published or temperature != published_temperature){
+        published_temperature = temperature;
+        eventBusPublish(EVENT_BUS_TEMPERATURE, temperature, 0);
+    }
+
+    if(not published or heater != published_heater or output != published_output){
+        published_heater = heater;
+        published_output = output;
+        eventBusPublish(EVENT_BUS_HEATER, heater, output);
+    }
+
+    heaterManagerPublishAutotune();
+
+    published = true;
+}
+
+/**
+* @brief Publica el estado del autoajuste si cambió y su resultado al terminar
+*/
+static void heaterManagerPublishAutotune(){
+    heaterAutotuneResult_t autotune = heaterAutotuneRead();
+
+    if(autotune.state == published_autotune){
+        return;
+    }
+
+    published_autotune = autotune.state;
+
+    // el resultado antes que el estado, el suscriptor ya lo tiene al ver que terminó
+    if(autotune.state == HEATER_AUTOTUNE_DONE){
+        eventBusPublish(EVENT_BUS_AUTOTUNE_GAIN, HEATER_MANAGER_KU, heaterManagerHundredths(autotune.ku));
+        eventBusPublish(EVENT_BUS_AUTOTUNE_GAIN, HEATER_MANAGER_TU, heaterManagerHundredths(autotune.tu));
+        eventBusPublish(EVENT_BUS_AUTOTUNE_GAIN, HEATER_MANAGER_KP, heaterManagerHundredths(autotune.kp));
+        eventBusPublish(EVENT_BUS_AUTOTUNE_GAIN, HEATER_MANAGER_KI, heaterManagerHundredths(autotune.ki));
+        eventBusPublish(EVENT_BUS_AUTOTUNE_GAIN, HEATER_MANAGER_KD, heaterManagerHundredths(autotune.kd));
+    }
+
+    eventBusPublish(EVENT_BUS_AUTOTUNE, autotune.state, autotune.cycles);
+}
+
+/**
+* @brief Centésimas de un valor, para publicarlo como entero
+*
+* @param value valor a convertir
+*
+* @return int valor en centésimas
+*/
+static int heaterManagerHundredths(float value){
+    return static_cast<int>(value * 100.0f + 0.5f);
+}
@@ -11,10 +11,33 @@
 
 #include "mbed.h"
 #include "modules/filament_dryer_system/filament_dryer_system.h"
+#include "modules/heater/heater.h"
+#include "modules/temperature_sensor/temperature_sensor.h"
 
 //=====[Declaration of private defines]=================================
+// Si no esta declarado TIME_MS
+#ifndef TIME_MS
+#define TIME_MS 10
+#endif
+
+#if TEMPERATURE_SENSOR_CONTINUOUS
+#define HEATER_MANAGER_PERIOD_MS    100 /**< Periodo de heaterManagerUpdate(), sobra para el promedio de 1 s del sensor y los pulsos del PID */
+#else
+#define HEATER_MANAGER_PERIOD_MS    TIME_MS /**< Periodo de heaterManagerUpdate(): por consultas cada llamada toma una muestra del sensor */
+#endif
 
 //=====[Declaration of private data types]==============================
+/**
+ * @brief Ganancia del resultado del autoajuste en EVENT_BUS_AUTOTUNE_GAIN.
+ */
+typedef enum{
+    HEATER_MANAGER_KU,  /**< Ganancia última */
+    HEATER_MANAGER_TU,  /**< Periodo último en segundos */
+    HEATER_MANAGER_KP,  /**< Ganancia proporcional */
+    HEATER_MANAGER_KI,  /**< Ganancia integral */
+    HEATER_MANAGER_KD,  /**< Ganancia derivativa */
+    HEATER_MANAGER_GAINS    /**< Cantidad de ganancias */
+}heaterManagerGain_t;
 
 //=====[Declaration (prototypes) of public functions]===================
 
@@ -31,12 +54,24 @@ void heaterManagerInit(PinName heaterPin, PinName heaterSensorPin);
 /**
 * @brief Gestiona el funcionamiento del calentador
 *
-* Gestiona el encendido/apagado del calentador dependiendo del modo de trabajo y temperatura de trabajo
+* Actualiza el sensor en cada llamada y regula la temperatura solo secando; al dejar de
+* secar se llama a heaterManagerStop(). Con el sensor en falla (fuera de rango o sin
+* muestras nuevas) el calentador queda apagado y un autoajuste en curso se interrumpe.
+* Publica en el bus la temperatura, el calentador y el estado del autoajuste solo cuando
+* cambian; al terminar el autoajuste, antes su resultado.
 *
 * @param state modo de trabajo
 * @param work_temperature temperatura a la cual debe mantener el calentador
 */
 void heaterManagerUpdate(systemState_t state, const int work_temperature);
 
+/**
+* @brief Apaga el calentador y limpia el control
+*
+* Al volver a secar el control arranca limpio. Un autoajuste en curso se interrumpe y
+* queda fallido (control ON/OFF); el estado se publica en el bus.
+*/
+void heaterManagerStop();
+
 //=====[#include guards - end]==========================================
 #endif
\ No newline at end of file
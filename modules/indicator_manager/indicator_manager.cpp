@@ -38,11 +38,13 @@ void indicatorManagerInit(PinName activityLedPin, PinName runLedPin, PinName buz
 }
 
 /**
- * @brief Actualiza el estado de los indicadores LED y Buzzer basado en el estado del sistema.
+ * @brief Cambia los indicadores LED y Buzzer al entrar el sistema en un estado.
+ *
+ * Se llama solo en las transiciones, el parpadeo y los pitidos siguen con sus temporizadores.
  * 
- * @param state Estado actual del sistema.
+ * @param state Estado al que entró el sistema.
  */
-void indicatorManagerUpdate(systemState_t state){
+void indicatorManagerEnter(systemState_t state){
     switch (state){
         case SYSTEM_ON:
             ledsRun();
@@ -50,12 +52,12 @@ void indicatorManagerUpdate(systemState_t state){
 
         case SYSTEM_STOP:    /**< Estado de sistema detenido */
             ledsStop(); // led de actividad apagado
-            buzzerOff(); // zumbador apagado
+            buzzerStop(); // zumbador apagado
         break;
 
         case SYSTEM_WORK:    /**< Estado de sistema secando */
             ledsWorking();
-            buzzerOff();
+            buzzerStop();
         break;
         
         case SYSTEM_FINISH:   /**< Estado de sistema secado finalizado */
@@ -63,7 +65,7 @@ void indicatorManagerUpdate(systemState_t state){
         break;
 
         case SYSTEM_FINISH_AWAIT:
-            buzzerUpdate(); // Emite los pitidos si corresponde
+            buzzerUpdate(); // Arranca los pitidos periódicos
         break;
 
         default:
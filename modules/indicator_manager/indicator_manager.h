@@ -30,11 +30,13 @@
 void indicatorManagerInit(PinName activityLedPin, PinName runLedPin, PinName buzzerPin);
 
 /**
- * @brief Actualiza el estado de los indicadores LED y Buzzer basado en el estado del sistema.
+ * @brief Cambia los indicadores LED y Buzzer al entrar el sistema en un estado.
+ *
+ * Se llama solo en las transiciones, el parpadeo y los pitidos siguen con sus temporizadores.
  * 
- * @param state Estado actual del sistema.
+ * @param state Estado al que entró el sistema.
  */
-void indicatorManagerUpdate(systemState_t state);
+void indicatorManagerEnter(systemState_t state);
 
 //=====[#include guards - end]==========================================
 #endif
\ No newline at end of file
@@ -7,46 +7,114 @@
 */
 //=====[Libraries]====================================================
 #include "keypad.h"
+#include "modules/rtc/rtc.h"
+#include "modules/ring_buffer/ring_buffer.h"
+#include "modules/event_log/event_log.h"
 
 //=====[Declaration of private defines]===============================
-#define DEBOUNCE_TIME_MS   30   // ms para evitar BOUNCE and GLITCH
+#define DEBOUNCE_TIME_MS   30   // ms para evitar BOUNCE and GLITCH (con interrupciones, por consulta son 4 lecturas iguales)
 
 // Si no esta declarado TIME_MS 
 #ifndef TIME_MS
 #define TIME_MS 10
 #endif
 
-//=====[Declaration of private data types]============================
-// Estados para la FSM de teclado
-typedef enum{
-    DOWN,           /**< Botón presionado */
-    UP,             /**< Botón suelto*/
-    FALLING,        /**< Botón en proceso de presionado*/
-    RISING          /**< Botón en proceso de suelto*/
-}buttonState_t;
+#define US_PER_MS   1000    /**< Microsegundos en un milisegundo */
+#define KEYPAD_BUTTONS  4   /**< Botones del teclado */
+#define KEYPAD_ALL_MASK (KEYPAD_BIT(RUN_STOP) | KEYPAD_BIT(MODE) | KEYPAD_BIT(PLUS) | KEYPAD_BIT(LESS))  /**< Bits de los botones */
 
+//=====[Declaration of private data types]============================
+#if KEYPAD_INTERRUPTS
+/**
+ * @brief Un botón con su interrupción y su temporizador de antirrebote.
+ */
+typedef struct{
+    InterruptIn* pin;   /**< Interrupción en ambos flancos */
+    Timeout* debounce;  /**< Vence DEBOUNCE_TIME_MS después del último flanco */
+    buttonTemplate_t button;    /**< Botón que representa */
+    volatile bool settling; /**< Hubo flancos y se espera que el nivel quede quieto */
+    volatile uint32_t edge_ms;  /**< Tiempo del primer flanco del cambio */
+    bool pressed;   /**< Último nivel aceptado */
+}keypadKey_t;
+#endif
 
 //=====[Declaration and initialization of public global objects]======
-DigitalIn* upButton;    /** Objeto para el botón de incrementar */
-DigitalIn* downButton;  /** Objeto para el botón de disminuir */
-DigitalIn* modeButton;  /** Objeto para el botón de modo */
-DigitalIn* runButton;   /** Objeto para el botón de run/stop */
+#if !KEYPAD_INTERRUPTS
+BusIn* keypadPins;  /** Los cuatro botones, el bit n es el botón n de buttonTemplate_t */
+#endif
 
 //=====[Declaration of external public global variables]===============
 
 //=====[Declaration and initialization of public global variables]======
 
 //=====[Declaration and initialization of private global variables]======
-static buttonState_t keypadStatus;  /**< Se usa para almacenar el estado del teclado en la FSM */
+#if KEYPAD_INTERRUPTS
+static keypadKey_t keys[KEYPAD_BUTTONS];    /**< Botones con sus interrupciones */
+static uint8_t settled_mask = 0;    /**< Botones presionados según el antirrebote, lo usan las interrupciones */
+#else
+static uint8_t debounced = 0;   /**< Botones presionados según el antirrebote, un bit por botón */
+static uint8_t counter0 = 0xFF; /**< Bit 0 del contador vertical de cada botón */
+static uint8_t counter1 = 0xFF; /**< Bit 1 del contador vertical de cada botón */
+#endif
+
 static buttonTemplate_t button; /**< botón valor del teclado  */
+static uint8_t pressed_mask = 0;    /**< Botones presionados según los eventos tomados, un bit por buttonTemplate_t */
+
+static uint8_t queue_storage[KEYPAD_QUEUE_EVENTS * sizeof(keypadEvent_t)]; /**< Memoria de la cola de eventos */
+static ringBuffer_t queue;  /**< Cola de eventos, la llena la interrupción y la vacía keypadReadEvent() */
+static volatile keypadWake_t wake_callback = nullptr;   /**< Aviso de eventos nuevos */
 
 //=====[Declaration (prototypes) of private functions]==================
 /**
-* @brief Retorna el estado del teclado
+* @brief Agrega un evento a la cola y avisa
+*
+* Si la cola está llena el evento se descarta.
+*
+* @param pressed_button Botón
+* @param pressed true si se presionó
+* @param time_ms Tiempo del cambio
+* @param mask Botones presionados después del cambio
+*/
+static void keypadPost(buttonTemplate_t pressed_button, const bool pressed, const uint32_t time_ms, const uint8_t mask);
+
+/**
+* @brief Botón de mayor prioridad de un grupo presionado a la vez
+*
+* @param mask Botones presionados
+*
+* @return buttonTemplate_t Botón
+*/
+static buttonTemplate_t keypadPriority(const uint8_t mask);
+
+#if KEYPAD_INTERRUPTS
+/**
+* @brief Configura un botón con interrupción en ambos flancos
 *
-* @return buttonTemplate_t Boton presionado o no
+* @param key Botón
+* @param pin Pin
+* @param key_button Botón que representa
 */
-static buttonTemplate_t buttonPress();
+static void keypadKeyInit(keypadKey_t *key, PinName pin, buttonTemplate_t key_button);
+
+/**
+* @brief Interrupción de flanco, reinicia la espera del antirrebote
+*
+* @param key Botón
+*/
+static void keypadEdge(keypadKey_t *key);
+
+/**
+* @brief Venció el antirrebote, el nivel está quieto
+*
+* @param key Botón
+*/
+static void keypadSettle(keypadKey_t *key);
+#else
+/**
+* @brief Lee todos los botones juntos y los filtra con contadores verticales
+*/
+static void keypadPoll();
+#endif
 
 //=====[Implementations of public functions]============================
 /**
@@ -61,18 +129,28 @@ static buttonTemplate_t buttonPress();
 */
 void keypadInit(PinName runButtonPin, PinName modeButtonPin, PinName downButtonPin, PinName upButtonPin){
 
-    upButton = new DigitalIn(upButtonPin);
-    downButton = new DigitalIn(downButtonPin);
-    modeButton = new DigitalIn(modeButtonPin);
-    runButton = new DigitalIn(runButtonPin);
-
-    upButton->mode(PullDown);
-    downButton->mode(PullDown);
-    modeButton->mode(PullDown);
-    runButton->mode(PullDown);
+    // la cola antes que las interrupciones
+    ringBufferInit(&queue, queue_storage, sizeof(queue_storage));
 
     button = NONE;
-    keypadStatus = UP;
+    pressed_mask = 0;
+
+#if KEYPAD_INTERRUPTS
+    settled_mask = 0;
+
+    keypadKeyInit(&keys[0], runButtonPin, RUN_STOP);
+    keypadKeyInit(&keys[1], modeButtonPin, MODE);
+    keypadKeyInit(&keys[2], downButtonPin, LESS);
+    keypadKeyInit(&keys[3], upButtonPin, PLUS);
+#else
+    // en el orden de buttonTemplate_t, NONE no tiene pin
+    keypadPins = new BusIn(NC, runButtonPin, modeButtonPin, upButtonPin, downButtonPin);
+    keypadPins->mode(PullDown);
+
+    debounced = 0;
+    counter0 = 0xFF;
+    counter1 = 0xFF;
+#endif
 }
 
 /**
@@ -89,101 +167,265 @@ buttonTemplate_t keypadReadButton(){
 /**
 * @brief Actualiza el estado de los botones
 *
-* filtra bounce y glitch del teclado
+* Con interrupciones toma los eventos de la cola; por consulta lee los pines y
+* filtra bounce y glitch del teclado.
 */
 void keypadUpdate(){
+    keypadEvent_t event;
+
+    keypadScan();
 
-    static int reboundTime = 0;
-    static buttonTemplate_t lastButton = NONE;
-    buttonTemplate_t actualButton = buttonPress(); 
-
-    switch(keypadStatus){
-        case DOWN: // Hay algún presionado presionado
-            
-            // se soltaron los botones
-            if(actualButton == NONE){
-                keypadStatus = RISING;   // el botón esta subiendo
-            }else{
-                keypadStatus = DOWN; // sigue estando presionado algun botón
-                
-                // Solo acepta que el botón sea otro si efectivamente antes se solto el que estaba presionado
-                if(lastButton == NONE){
-                    lastButton = actualButton;
-                    button = actualButton;
-                }
-                
-            }
-        break;
-
-        case FALLING:
-
-            if(reboundTime >= DEBOUNCE_TIME_MS){
-                keypadStatus = DOWN;
-                reboundTime = 0;
-            }
-
-            if(actualButton != NONE){
-                reboundTime = reboundTime + TIME_MS;
-            }else{
-                keypadStatus = UP;
-                reboundTime = 0;
-            }
-        break;
- 
-        case UP: // ningun botón presionado
-
-            // se presiono alguno botón
-            if(actualButton != NONE){
-                keypadStatus = FALLING;
-            }else{  // sigue sin presionarse algun botón
-                keypadStatus = UP;
-                button = NONE;
-                lastButton = NONE;
-            }
-        break;
-
-        case RISING:
-
-            // se alcanzo el tiempo para considerar que se solto el botón
-            if(reboundTime >= DEBOUNCE_TIME_MS){
-                keypadStatus = UP;
-                reboundTime = 0;
-            }
-
-            // sigue sin presionarse algun botón 
-            if(actualButton == NONE){
-                reboundTime = reboundTime + TIME_MS;
-            }else{ // algún botón sigue presionado
-                keypadStatus = DOWN;
-                reboundTime = 0;
-            }
-
-        break;
+    while(keypadReadEvent(&event)){
     }
 }
 
+/**
+* @brief Lee los botones sin tomar los eventos
+*
+* Por consulta lee todos los botones juntos y agrega a la cola los cambios filtrados;
+* con interrupciones no hace nada. Se usa antes de keypadReadEvent().
+*/
+void keypadScan(){
+#if !KEYPAD_INTERRUPTS
+    keypadPoll();
+#endif
+}
+
+/**
+* @brief Toma el próximo evento de la cola y actualiza el botón presionado
+*
+* keypadUpdate() los toma todos, usar keypadScan() y esta en su lugar para ver cada evento con su tiempo.
+*
+* @param event Destino
+*
+* @return true si había un evento
+*/
+bool keypadReadEvent(keypadEvent_t *event){
+    uint8_t data[sizeof(keypadEvent_t)];
+
+    if(ringBufferUsed(&queue) < sizeof(keypadEvent_t)){
+        return false;
+    }
+
+    for(uint32_t i = 0; i < sizeof(keypadEvent_t); i++){
+        ringBufferReadByte(&queue, &data[i]);
+    }
+
+    memcpy(event, data, sizeof(keypadEvent_t));
+
+    // Solo acepta que el botón sea otro si efectivamente antes se soltaron todos
+    if(pressed_mask == 0 and event->mask != 0){
+        button = keypadPriority(event->mask);
+        eventLogWrite(EVENT_LOG_BUTTON, button);
+    }
+
+    pressed_mask = event->mask;
+
+    if(pressed_mask == 0){
+        button = NONE;
+    }
+
+    return true;
+}
+
+/**
+* @brief Botones presionados a la vez
+*
+* Según los eventos ya tomados, permite reconocer combinaciones de botones.
+*
+* @return uint8_t Un bit por botón, KEYPAD_BIT(button)
+*/
+uint8_t keypadReadMask(){
+    return pressed_mask;
+}
+
+/**
+* @brief Demora entre el tiempo de un evento y su llegada a la cola
+*
+* Con interrupciones el evento lleva el tiempo del primer flanco y llega al terminar el
+* antirrebote; por consulta lleva el tiempo en que se aceptó. Hasta ahora menos esta
+* demora no puede aparecer un evento con un tiempo anterior.
+*
+* @return uint32_t Milisegundos
+*/
+uint32_t keypadEventDelayMs(){
+#if KEYPAD_INTERRUPTS
+    return DEBOUNCE_TIME_MS;
+#else
+    return 0;
+#endif
+}
+
+/**
+* @brief Registra la función que avisa que hay eventos nuevos
+*
+* Permite dormir mientras no se toca el teclado y atender la pulsación enseguida.
+*
+* @param wake Función a llamar, nullptr para quitarla
+*/
+void keypadSetWake(keypadWake_t wake){
+    wake_callback = wake;
+}
+
 //=====[Implementations of private functions]=============================
 /**
-* @brief Retorna el estado del teclado
+* @brief Botón de mayor prioridad de un grupo presionado a la vez
 *
-* @return buttonTemplate_t Boton presionado o no
+* @param mask Botones presionados
+*
+* @return buttonTemplate_t Botón
 */
-static buttonTemplate_t buttonPress(){
-    
-    // fue el botón de cambio de modo
-    if(*modeButton)
+static buttonTemplate_t keypadPriority(const uint8_t mask){
+
+    // mismo orden que la lectura de a un botón: modo, subir, bajar, inicio/parada
+    if(mask & KEYPAD_BIT(MODE))
         return MODE;
-        
-    if(*upButton) // solo fue el botón de subir
+
+    if(mask & KEYPAD_BIT(PLUS))
         return PLUS;
 
-    if(*downButton)
-        return LESS; // solo fue el botón de bajar
+    if(mask & KEYPAD_BIT(LESS))
+        return LESS;
 
-    if(*runButton) // fue el botón de inicio/parada
+    if(mask & KEYPAD_BIT(RUN_STOP))
         return RUN_STOP;
 
-    // si no se presiono ningun botón
     return NONE;
+}
+
+/**
+* @brief Agrega un evento a la cola y avisa
+*
+* Si la cola está llena el evento se descarta.
+*
+* @param pressed_button Botón
+* @param pressed true si se presionó
+* @param time_ms Tiempo del cambio
+* @param mask Botones presionados después del cambio
+*/
+static void keypadPost(buttonTemplate_t pressed_button, const bool pressed, const uint32_t time_ms, const uint8_t mask){
+    keypadEvent_t event;
+
+    event.time_ms = time_ms;
+    event.button = pressed_button;
+    event.pressed = pressed ? 1 : 0;
+    event.mask = mask;
+
+    // el evento entra completo o no entra, el lector nunca ve uno a medias
+    if(ringBufferFree(&queue) >= sizeof(event)){
+        ringBufferWrite(&queue, (const uint8_t*)&event, sizeof(event));
+    }
+
+    keypadWake_t wake = wake_callback;
+
+    if(wake != nullptr){
+        wake();
+    }
+}
+
+#if KEYPAD_INTERRUPTS
+/**
+* @brief Configura un botón con interrupción en ambos flancos
+*
+* @param key Botón
+* @param pin Pin
+* @param key_button Botón que representa
+*/
+static void keypadKeyInit(keypadKey_t *key, PinName pin, buttonTemplate_t key_button){
+
+    key->pin = new InterruptIn(pin);
+    key->debounce = new Timeout();
+
+    key->pin->mode(PullDown);
+
+    key->button = key_button;
+    key->settling = false;
+    key->edge_ms = 0;
+    key->pressed = key->pin->read(); // presionado al encender no genera evento
+
+    // la máscara acompaña a pressed, un botón presionado al encender figura en los eventos de los demás
+    if(key->pressed){
+        settled_mask = settled_mask | KEYPAD_BIT(key_button);
+    }
 
-}
\ No newline at end of file
+    key->pin->rise(callback(keypadEdge, key));
+    key->pin->fall(callback(keypadEdge, key));
+}
+
+/**
+* @brief Interrupción de flanco, reinicia la espera del antirrebote
+*
+* @param key Botón
+*/
+static void keypadEdge(keypadKey_t *key){
+
+    // el evento lleva el tiempo del primer flanco, no el del fin del rebote
+    if(not key->settling){
+        key->settling = true;
+        key->edge_ms = rtcNowUs() / US_PER_MS;
+    }
+
+    // cada rebote vuelve a armar el temporizador, vence cuando el nivel quedó quieto
+    key->debounce->attach(callback(keypadSettle, key), std::chrono::milliseconds(DEBOUNCE_TIME_MS));
+}
+
+/**
+* @brief Venció el antirrebote, el nivel está quieto
+*
+* Un pulso más corto que DEBOUNCE_TIME_MS (glitch) vuelve al nivel anterior y no genera evento.
+*
+* @param key Botón
+*/
+static void keypadSettle(keypadKey_t *key){
+    bool level = key->pin->read();
+
+    key->settling = false;
+
+    if(level != key->pressed){
+        key->pressed = level;
+
+        // todos los temporizadores tienen la misma prioridad, no se interrumpen entre sí
+        if(level){
+            settled_mask = settled_mask | KEYPAD_BIT(key->button);
+        }else{
+            settled_mask = settled_mask & ~KEYPAD_BIT(key->button);
+        }
+
+        keypadPost(key->button, level, key->edge_ms, settled_mask);
+    }
+}
+#else
+/**
+* @brief Lee todos los botones juntos y los filtra con contadores verticales
+*
+* Cada botón tiene un contador de 2 bits repartido en counter0 y counter1: avanza
+* mientras la lectura difiere del estado aceptado y vuelve a empezar si coincide. Al cuarto
+* tick seguido con el otro nivel el estado cambia; un rebote o glitch más corto no.
+* Los cuatro botones se procesan con las mismas operaciones, sin recorrerlos.
+*/
+static void keypadPoll(){
+    uint8_t sample = keypadPins->read() & KEYPAD_ALL_MASK;
+    uint8_t changed = debounced ^ sample;
+
+    counter0 = ~(counter0 & changed);
+    counter1 = counter0 ^ (counter1 & changed);
+
+    // los que completaron la cuenta
+    changed = changed & counter0 & counter1;
+
+    if(changed == 0){
+        return;
+    }
+
+    debounced = debounced ^ changed;
+
+    uint32_t now_ms = rtcNowUs() / US_PER_MS;
+
+    for(int b = RUN_STOP; b <= LESS; b++){
+
+        if(changed & KEYPAD_BIT(b)){
+            keypadPost((buttonTemplate_t)b, debounced & KEYPAD_BIT(b), now_ms, debounced);
+        }
+    }
+}
+#endif
@@ -12,6 +12,17 @@
 #include "mbed.h"
 
 //=====[Declaration of private defines]================================
+// Si no esta declarado el modo del teclado: 1 interrupciones y temporizadores, 0 lectura de todos los botones en cada keypadUpdate()
+#ifndef KEYPAD_INTERRUPTS
+#define KEYPAD_INTERRUPTS   1
+#endif
+
+// Si no esta declarada la capacidad de la cola de eventos
+#ifndef KEYPAD_QUEUE_EVENTS
+#define KEYPAD_QUEUE_EVENTS 16
+#endif
+
+#define KEYPAD_BIT(button)  (1 << (button))   /**< Bit de un buttonTemplate_t en las máscaras de botones */
 
 //=====[Declaration of private data types]=============================
 
@@ -24,6 +35,21 @@ typedef enum{
     LESS    /**< Botón de disminuir presionado */
 }buttonTemplate_t;
 
+/**
+ * @brief Un botón que se presionó o soltó, ya sin rebote.
+ */
+typedef struct{
+    uint32_t time_ms;   /**< rtcNowUs() / 1000 del primer flanco del cambio */
+    uint8_t button; /**< buttonTemplate_t */
+    uint8_t pressed;    /**< 1 presionado, 0 soltado */
+    uint8_t mask;   /**< Botones presionados después del cambio, KEYPAD_BIT(), más de uno es una combinación */
+}keypadEvent_t;
+
+/**
+ * @brief Se llama (desde la interrupción) cuando hay eventos nuevos en la cola.
+ */
+typedef void (*keypadWake_t)();
+
 //=====[Declaration (prototypes) of public functions]==================
 /**
 * @brief Inicializa los botones
@@ -46,12 +72,61 @@ void keypadInit(PinName runButtonPin, PinName modeButtonPin, PinName downButtonP
 */
 buttonTemplate_t keypadReadButton();
 
+/**
+* @brief Botones presionados a la vez
+*
+* Según los eventos ya tomados, permite reconocer combinaciones de botones.
+*
+* @return uint8_t Un bit por botón, KEYPAD_BIT(button)
+*/
+uint8_t keypadReadMask();
+
 /**
 * @brief Actualiza el estado de los botones
 *
-* filtra bounce y glitch del teclado
+* Con interrupciones toma los eventos de la cola; por consulta lee todos los botones
+* juntos y filtra bounce y glitch del teclado.
 */
 void keypadUpdate();
 
+/**
+* @brief Lee los botones sin tomar los eventos
+*
+* Por consulta lee todos los botones juntos y agrega a la cola los cambios filtrados;
+* con interrupciones no hace nada. Se usa antes de keypadReadEvent().
+*/
+void keypadScan();
+
+/**
+* @brief Toma el próximo evento de la cola y actualiza el botón presionado
+*
+* keypadUpdate() los toma todos, usar keypadScan() y esta en su lugar para ver cada evento con su tiempo.
+*
+* @param event Destino
+*
+* @return true si había un evento
+*/
+bool keypadReadEvent(keypadEvent_t *event);
+
+/**
+* @brief Demora entre el tiempo de un evento y su llegada a la cola
+*
+* Con interrupciones el evento lleva el tiempo del primer flanco y llega al terminar el
+* antirrebote; por consulta lleva el tiempo en que se aceptó. Hasta ahora menos esta
+* demora no puede aparecer un evento con un tiempo anterior.
+*
+* @return uint32_t Milisegundos
+*/
+uint32_t keypadEventDelayMs();
+
+/**
+* @brief Registra la función que avisa que hay eventos nuevos
+*
+* Permite dormir mientras no se toca el teclado y atender la pulsación enseguida.
+*
+* @param wake Función a llamar, nullptr para quitarla
+*/
+void keypadSetWake(keypadWake_t wake);
+
 //=====[#include guards - end]=======================================
 #endif
\ No newline at end of file
@@ -8,8 +8,12 @@
 //=====[Libraries]======================================================
 #include "keypad_manager.h"
 #include "modules/keypad/keypad.h"
+#include "modules/rtc/rtc.h"
+#include "modules/system_actions/system_actions.h"
+#include "modules/event_bus/event_bus.h"
 
 //=====[Declaration of private defines]=================================
+#define US_PER_MS   1000    /**< Microsegundos en un milisegundo */
 
 //=====[Declaration of private data types]==============================
 
@@ -21,6 +25,13 @@
 
 //=====[Declaration and initialization of private global variables]=====
 static adjustState_t adjust_mode; // modo temperatura o tiempo
+static keypadLongPress_t long_press_action = KEYPAD_MANAGER_LONG_PRESS; // acción larga de inicio/parada
+
+static buttonTemplate_t held_button = NONE; // botón de la pulsación en curso
+static uint32_t press_ms = 0;   // tiempo del evento de la presión
+static uint32_t next_repeat_ms = 0; // tiempo de la próxima repetición de subir/bajar
+static uint32_t repeat_ms = KEYPAD_MANAGER_REPEAT_MS;   // intervalo actual de repetición
+static bool long_press_done = false;    // ya se ejecutó la acción larga de esta pulsación
 
 //=====[Declaration (prototypes) of private functions]==================
 /**
@@ -29,35 +40,47 @@ static adjustState_t adjust_mode; // modo temperatura o tiempo
  * Esta función maneja la lógica de control del teclado, incluyendo el cambio
  * de estados del sistema y los ajustes de tiempo y temperatura.
  * 
- * @param state Puntero al estado actual del sistema.
- * @param actity_time Puntero al tiempo de actividad (secado) en horas.
- * @param work_temperature Puntero a la temperatura de trabajo en grados Celsius.
+ * @param time_ms Tiempo del evento del teclado.
  */
-static void keypadTask(systemState_t *state, int *actity_time, int *work_temperature);
+static void keypadTask(const uint32_t time_ms);
 
 /**
- * @brief Incrementa el valor actual dentro de un límite especificado.
- * 
- * Incrementa el valor actual por un valor de incremento dado,
- * asegurándose de que no se exceda el valor límite.
- * 
- * @param actualValue Puntero al valor actual que se va a incrementar.
- * @param incrementValue Valor de incremento.
- * @param limitValue Valor límite máximo.
+ * @brief Repeticiones y acción larga del botón mantenido hasta un tiempo.
+ *
+ * Ejecuta todas las que vencieron hasta time_ms, aunque sean varias en una llamada.
+ *
+ * @param time_ms Tiempo hasta el que se cuenta.
  */
-static void adjustButtonUp(int *actualValue, const int incrementValue, const int limitValue);
+static void keypadHold(const uint32_t time_ms);
 
 /**
- * @brief Decrementa el valor actual dentro de un límite especificado.
- * 
- * Decrementa el valor actual por un valor de decremento dado,
- * asegurándose de que no se baje del valor límite.
- * 
- * @param actualValue Puntero al valor actual que se va a decrementar.
- * @param incrementValue Valor de decremento.
- * @param limitValue Valor límite mínimo.
+ * @brief Sube o baja la temperatura o las horas según el modo de ajuste.
+ *
+ * @param user_button PLUS o LESS.
+ */
+static void keypadAdjust(buttonTemplate_t user_button);
+
+/**
+ * @brief Ejecuta la acción larga de inicio/parada.
+ */
+static void keypadLongPress();
+
+/**
+ * @brief Cambia el modo de ajuste y lo publica en el bus.
+ *
+ * @param mode TEMPERATURE o TIME.
  */
-static void adjustButtonDown(int *actualValue, const int incrementValue, const int limitValue);
+static void keypadSetAdjust(adjustState_t mode);
+
+/**
+ * @brief Indica si ya se alcanzó un tiempo, aunque el contador de ms haya dado la vuelta.
+ *
+ * @param now_ms Tiempo actual.
+ * @param deadline_ms Tiempo a alcanzar.
+ *
+ * @return true si now_ms es igual o posterior a deadline_ms.
+ */
+static bool keypadReached(const uint32_t now_ms, const uint32_t deadline_ms);
 
 //=====[Implementations of public functions]============================
 /**
@@ -74,24 +97,80 @@ static void adjustButtonDown(int *actualValue, const int incrementValue, const i
 void keypadManagerInit(PinName runButtonPin, PinName modeButtonPin, PinName downButtonPin, PinName upButtonPin){
     keypadInit(runButtonPin, modeButtonPin, downButtonPin, upButtonPin);
 
-    adjust_mode = TIME;
+    held_button = NONE;
+
+    keypadSetAdjust(TIME);
 }
 
+/**
+ * @brief Registra la función que avisa que el teclado tiene eventos nuevos.
+ *
+ * Se llama desde la interrupción del teclado, debe ser breve.
+ *
+ * @param wake Función a llamar, nullptr para quitarla.
+ */
+void keypadManagerSetWake(keypadWake_t wake){
+    keypadSetWake(wake);
+}
+
+/**
+ * @brief Elige la acción al mantener presionado inicio/parada.
+ *
+ * @param action Acción, KEYPAD_MANAGER_LONG_PRESS al iniciar.
+ */
+void keypadManagerSetLongPress(keypadLongPress_t action){
+    long_press_action = action;
+}
 
 /**
  * @brief Actualiza el estado del gestor del teclado.
  * 
  * Esta función actualiza el estado del teclado y ejecuta las acciones correspondientes
- * en función de las entradas del usuario y el estado actual del sistema.
- * 
- * @param state Puntero al estado actual del sistema.
- * @param activity_time Puntero al tiempo de actividad (secado) en horas.
- * @param work_temperature Puntero a la temperatura de trabajo en grados Celsius.
- */
-void keypadManagerUpdate(systemState_t *state, int *actity_time, int *work_temperature){
-    keypadUpdate(); // Actualiza el estado del teclado
-    // se pasan los punteros
-    keypadTask( state, actity_time, work_temperature);
+ * en función de las entradas del usuario y el estado actual del sistema. Las repeticiones
+ * de subir/bajar y la acción larga se cuentan desde el tiempo de cada evento del teclado,
+ * por lo que no dependen de cada cuánto se llame. Publica en el bus de eventos cada
+ * presión, soltada, repetición y acción larga de los botones y el modo de ajuste.
+ */
+void keypadManagerUpdate(){
+    keypadEvent_t event;
+
+    keypadScan(); // Lee el teclado si no usa interrupciones
+
+    // cada evento en orden, con lo mantenido hasta su tiempo antes
+    while(keypadReadEvent(&event)){
+        keypadHold(event.time_ms);
+        keypadTask(event.time_ms);
+    }
+
+    // solo hasta donde ya no pueden llegar eventos anteriores, así soltar corta las repeticiones a tiempo
+    keypadHold(rtcNowUs() / US_PER_MS - keypadEventDelayMs());
+}
+
+/**
+ * @brief Indica si el gestor puede esperar al próximo evento del teclado.
+ *
+ * Con un botón mantenido que todavía tiene repeticiones o acción larga por delante, o con
+ * el teclado por consulta, hay que seguir llamando a keypadManagerUpdate() periódicamente.
+ *
+ * @return true si solo hace falta llamarlo cuando avisa keypadManagerSetWake().
+ */
+bool keypadManagerIsIdle(){
+
+#if !KEYPAD_INTERRUPTS
+    return false;
+#else
+    switch(held_button){
+        case PLUS:
+        case LESS:
+            return false;
+
+        case RUN_STOP:
+            return long_press_action == KEYPAD_LONG_PRESS_NONE or long_press_done;
+
+        default:
+            return true;
+    }
+#endif
 }
 
 //=====[Implementations of private functions]===========================
@@ -101,130 +180,165 @@ void keypadManagerUpdate(systemState_t *state, int *actity_time, int *work_tempe
  * Esta función maneja la lógica de control del teclado, incluyendo el cambio
  * de estados del sistema y los ajustes de tiempo y temperatura.
  * 
- * @param state Puntero al estado actual del sistema.
- * @param actity_time Puntero al tiempo de actividad (secado) en horas.
- * @param work_temperature Puntero a la temperatura de trabajo en grados Celsius.
+ * @param time_ms Tiempo del evento del teclado.
  */
-static void keypadTask(systemState_t *state, int *activity_time, int *work_temperature){
-    // estado de botones
-    static buttonTemplate_t past_button = NONE;
+static void keypadTask(const uint32_t time_ms){
     buttonTemplate_t user_button = keypadReadButton();
 
     // si no se mantiene presionado el botón
-    if(user_button != past_button){
-        past_button = user_button;
-
-        switch(user_button){
-            case RUN_STOP: // presiono arranque/parada
-
-                switch (*state){
-                    case SYSTEM_ON:
-                    break;
-
-                    case SYSTEM_FINISH:
-                    break;
-
-                    case SYSTEM_WORK: // Esta secando
-                        *state = SYSTEM_STOP;
-                        
-                    break;
-                    
-                    case SYSTEM_FINISH_AWAIT: // Termino de secar y esta a la espera de reiniciar el secado
-                    case SYSTEM_STOP: // Se detuvo el secado
-                        *state = SYSTEM_WORK;
-                        
-                    break;
-
-                    default:
-                    break;
-                }
-            break;
-
-            case MODE: // cambio de modo
-
-                switch (adjust_mode){
-                    case TEMPERATURE:
-                        // estaba en modo temperatura cambia a tiempo
-                        adjust_mode = TIME;
-                        
-                    break;
-
-                    case TIME:
-                        // estaba en modo de tiempo cambia a temperatura
-                        adjust_mode = TEMPERATURE; 
-                        
-                    break;
-                }
-            break;
+    if(user_button == held_button){
+        return;
+    }
 
-            case PLUS: // aumenta temperatura o tiempo
-                switch (adjust_mode){
-                    case TEMPERATURE:   
-                        adjustButtonUp(work_temperature, INCREMENT_TEMP, MAX_TEMP);
-                    break;
+    // se soltaron todos, la presión corta de inicio/parada con acción larga actúa ahora
+    if(user_button == NONE){
 
-                    case TIME:
-                        adjustButtonUp(activity_time, INCREMENT_TIME, MAX_TIME);
-                    break; 
-                }
+        if(held_button == RUN_STOP and long_press_action != KEYPAD_LONG_PRESS_NONE and not long_press_done){
+
+            if(long_press_action == KEYPAD_LONG_PRESS_STOP){
+                systemActionStart();
+            }else{
+                systemActionRunStop();
+            }
+        }
+
+        eventBusPublish(EVENT_BUS_BUTTON, held_button, KEYPAD_MANAGER_RELEASED);
+
+        held_button = NONE;
+        return;
+    }
+
+    eventBusPublish(EVENT_BUS_BUTTON, user_button, KEYPAD_MANAGER_PRESSED);
+
+    held_button = user_button;
+    press_ms = time_ms;
+    next_repeat_ms = time_ms + KEYPAD_MANAGER_REPEAT_DELAY_MS;
+    repeat_ms = KEYPAD_MANAGER_REPEAT_MS;
+    long_press_done = false;
 
-            break;
+    switch(user_button){
+        case RUN_STOP: // presiono arranque/parada
 
-            case LESS: // disminuye temperatura o tiempo
+            if(long_press_action == KEYPAD_LONG_PRESS_NONE){
+                systemActionRunStop();
+            }
+        break;
 
-                switch (adjust_mode){
-                    case TEMPERATURE:   
-                        adjustButtonDown(work_temperature, INCREMENT_TEMP, MIN_TEMP);
-                    break;
+        case MODE: // cambio de modo
+
+            // estaba en modo temperatura cambia a tiempo y al revés
+            keypadSetAdjust(adjust_mode == TEMPERATURE ? TIME : TEMPERATURE);
+        break;
+
+        case PLUS: // aumenta temperatura o tiempo
+        case LESS: // disminuye temperatura o tiempo
+            keypadAdjust(user_button);
+        break;
+
+        case NONE:
+        break;
+    }
+}
 
-                    case TIME:
-                        adjustButtonDown(activity_time, INCREMENT_TIME, MIN_TIME);
-                    break; 
+/**
+ * @brief Repeticiones y acción larga del botón mantenido hasta un tiempo.
+ *
+ * Ejecuta todas las que vencieron hasta time_ms, aunque sean varias en una llamada.
+ *
+ * @param time_ms Tiempo hasta el que se cuenta.
+ */
+static void keypadHold(const uint32_t time_ms){
+
+    switch(held_button){
+        case PLUS:
+        case LESS:
+
+            // cada repetición acorta el intervalo de la siguiente un cuarto, hasta el mínimo
+            while(keypadReached(time_ms, next_repeat_ms)){
+                eventBusPublish(EVENT_BUS_BUTTON, held_button, KEYPAD_MANAGER_REPEATED);
+                keypadAdjust(held_button);
+
+                next_repeat_ms = next_repeat_ms + repeat_ms;
+                repeat_ms = repeat_ms - repeat_ms / 4;
+
+                if(repeat_ms < KEYPAD_MANAGER_REPEAT_MIN_MS){
+                    repeat_ms = KEYPAD_MANAGER_REPEAT_MIN_MS;
                 }
-            
-            break;
+            }
+        break;
 
-            case NONE:
-                past_button = NONE;
-            break;
-        
-        }
+        case RUN_STOP:
+
+            if(long_press_action != KEYPAD_LONG_PRESS_NONE and not long_press_done
+               and keypadReached(time_ms, press_ms + KEYPAD_MANAGER_LONG_PRESS_MS)){
+                long_press_done = true;
+                eventBusPublish(EVENT_BUS_BUTTON, held_button, KEYPAD_MANAGER_LONG_PRESSED);
+                keypadLongPress();
+            }
+        break;
+
+        default:
+        break;
     }
+}
 
+/**
+ * @brief Sube o baja la temperatura o las horas según el modo de ajuste.
+ *
+ * @param user_button PLUS o LESS.
+ */
+static void keypadAdjust(buttonTemplate_t user_button){
+
+    // detenido quedan los mínimos hasta arrancar, como con los comandos
+    if(not systemActionCanAdjust()){
+        return;
+    }
+
+    systemActionStep(adjust_mode, user_button == PLUS);
 }
 
 /**
- * @brief Incrementa el valor actual dentro de un límite especificado.
- * 
- * Incrementa el valor actual por un valor de incremento dado,
- * asegurándose de que no se exceda el valor límite.
- * 
- * @param actualValue Puntero al valor actual que se va a incrementar.
- * @param incrementValue Valor de incremento.
- * @param limitValue Valor límite máximo.
- */
-static void adjustButtonUp(int *actualValue, const int incrementValue, const int limitValue){
-    
-    if(*actualValue < limitValue){
-        *actualValue = *actualValue + incrementValue;
-    }                
-    
+ * @brief Ejecuta la acción larga de inicio/parada.
+ */
+static void keypadLongPress(){
+
+    switch(long_press_action){
+        case KEYPAD_LONG_PRESS_STOP:
+            systemActionStop();
+        break;
+
+        case KEYPAD_LONG_PRESS_RESET:
+            systemActionStop();
+
+            // mismos valores que al encender
+            systemActionResetSettings();
+            keypadSetAdjust(TIME);
+        break;
+
+        case KEYPAD_LONG_PRESS_NONE:
+        break;
+    }
 }
 
 /**
- * @brief Decrementa el valor actual dentro de un límite especificado.
- * 
- * Decrementa el valor actual por un valor de decremento dado,
- * asegurándose de que no se baje del valor límite.
- * 
- * @param actualValue Puntero al valor actual que se va a decrementar.
- * @param incrementValue Valor de decremento.
- * @param limitValue Valor límite mínimo.
+ * @brief Cambia el modo de ajuste y lo publica en el bus.
+ *
+ * @param mode TEMPERATURE o TIME.
  */
-static void adjustButtonDown(int *actualValue, const int incrementValue, const int limitValue){
+static void keypadSetAdjust(adjustState_t mode){
+    adjust_mode = mode;
 
-    if(*actualValue > limitValue){
-        *actualValue = *actualValue - incrementValue;
-    }     
-    
-}
\ No newline at end of file
+    eventBusPublish(EVENT_BUS_ADJUST, adjust_mode, 0);
+}
+
+/**
+ * @brief Indica si ya se alcanzó un tiempo, aunque el contador de ms haya dado la vuelta.
+ *
+ * @param now_ms Tiempo actual.
+ * @param deadline_ms Tiempo a alcanzar.
+ *
+ * @return true si now_ms es igual o posterior a deadline_ms.
+ */
+static bool keypadReached(const uint32_t now_ms, const uint32_t deadline_ms){
+    return (int32_t)(now_ms - deadline_ms) >= 0;
+}
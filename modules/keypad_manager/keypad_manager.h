@@ -11,10 +11,55 @@
 
 #include "mbed.h"
 #include "modules/filament_dryer_system/filament_dryer_system.h"
+#include "modules/keypad/keypad.h"
 
 //=====[Declaration of private defines]=================================
+// Si no esta declarado el tiempo presionado para que subir/bajar empiece a repetir
+#ifndef KEYPAD_MANAGER_REPEAT_DELAY_MS
+#define KEYPAD_MANAGER_REPEAT_DELAY_MS  500
+#endif
+
+// Si no esta declarado el intervalo de la primera repetición
+#ifndef KEYPAD_MANAGER_REPEAT_MS
+#define KEYPAD_MANAGER_REPEAT_MS    250
+#endif
+
+// Si no esta declarado el intervalo más corto al que acelera la repetición
+#ifndef KEYPAD_MANAGER_REPEAT_MIN_MS
+#define KEYPAD_MANAGER_REPEAT_MIN_MS    100
+#endif
+
+// Si no esta declarado el tiempo presionado de inicio/parada para la acción larga
+#ifndef KEYPAD_MANAGER_LONG_PRESS_MS
+#define KEYPAD_MANAGER_LONG_PRESS_MS    3000
+#endif
+
+// Si no esta declarada la acción larga de inicio/parada al encender
+#ifndef KEYPAD_MANAGER_LONG_PRESS
+#define KEYPAD_MANAGER_LONG_PRESS   KEYPAD_LONG_PRESS_NONE
+#endif
 
 //=====[Declaration of private data types]==============================
+/**
+ * @brief Acción al mantener presionado inicio/parada KEYPAD_MANAGER_LONG_PRESS_MS.
+ *
+ * Con una acción larga la presión corta actúa al soltar el botón.
+ */
+typedef enum{
+    KEYPAD_LONG_PRESS_NONE, /**< Sin acción larga, inicia o detiene al presionar */
+    KEYPAD_LONG_PRESS_STOP, /**< La presión corta solo inicia, para detener hay que mantenerlo */
+    KEYPAD_LONG_PRESS_RESET /**< Detiene y vuelve temperatura y horas a los mínimos */
+}keypadLongPress_t;
+
+/**
+ * @brief Evento de un botón en EVENT_BUS_BUTTON.
+ */
+typedef enum{
+    KEYPAD_MANAGER_RELEASED,    /**< Se soltaron todos, valor: el botón que estaba presionado */
+    KEYPAD_MANAGER_PRESSED, /**< Se presionó el botón */
+    KEYPAD_MANAGER_REPEATED,    /**< Repetición de subir/bajar mantenido */
+    KEYPAD_MANAGER_LONG_PRESSED /**< Inicio/parada mantenido KEYPAD_MANAGER_LONG_PRESS_MS, con acción larga */
+}keypadManagerButton_t;
 
 //=====[Declaration (prototypes) of public functions]===================
 /**
@@ -30,17 +75,42 @@
  */
 void keypadManagerInit(PinName runButtonPin, PinName modeButtonPin, PinName downButtonPin, PinName upButtonPin);
 
+/**
+ * @brief Registra la función que avisa que el teclado tiene eventos nuevos.
+ *
+ * Se llama desde la interrupción del teclado, debe ser breve.
+ *
+ * @param wake Función a llamar, nullptr para quitarla.
+ */
+void keypadManagerSetWake(keypadWake_t wake);
+
+/**
+ * @brief Elige la acción al mantener presionado inicio/parada.
+ *
+ * @param action Acción, KEYPAD_MANAGER_LONG_PRESS al iniciar.
+ */
+void keypadManagerSetLongPress(keypadLongPress_t action);
+
 /**
  * @brief Actualiza el estado del gestor del teclado.
  * 
  * Esta función actualiza el estado del teclado y ejecuta las acciones correspondientes
- * en función de las entradas del usuario y el estado actual del sistema.
- * 
- * @param state Puntero al estado actual del sistema.
- * @param activity_time Puntero al tiempo de actividad (secado) en horas.
- * @param work_temperature Puntero a la temperatura de trabajo en grados Celsius.
+ * en función de las entradas del usuario y el estado actual del sistema. Las repeticiones
+ * de subir/bajar y la acción larga se cuentan desde el tiempo de cada evento del teclado,
+ * por lo que no dependen de cada cuánto se llame. Publica en el bus de eventos cada
+ * presión, soltada, repetición y acción larga de los botones y el modo de ajuste.
+ */
+void keypadManagerUpdate();
+
+/**
+ * @brief Indica si el gestor puede esperar al próximo evento del teclado.
+ *
+ * Con un botón mantenido que todavía tiene repeticiones o acción larga por delante, o con
+ * el teclado por consulta, hay que seguir llamando a keypadManagerUpdate() periódicamente.
+ *
+ * @return true si solo hace falta llamarlo cuando avisa keypadManagerSetWake().
  */
-void keypadManagerUpdate(systemState_t *state, int *activity_time, int *work_temperature);
+bool keypadManagerIsIdle();
 
 //=====[#include guards - end]==========================================
 #endif
\ No newline at end of file
@@ -7,6 +7,7 @@
 */
 //=====[Libraries]======================================================
 #include "led.h"
+#include "modules/timer_wheel/timer_wheel.h"
 
 //=====[Declaration of private defines]=================================
 #ifndef TIME_MS
@@ -17,6 +18,7 @@
 #define OFF  !ON  /**< Valor para apagar el led */
 
 #define BLINK_EVERY_SECONDS 1 /**< Cada cuantos segundos parpadea el led*/
+#define BLINK_ON_MS TIME_MS /**< Tiempo que permanece encendido el led en cada parpadeo */
 
 //=====[Declaration of private data types]==============================
 
@@ -29,10 +31,8 @@ DigitalOut* runLed;   /** Objeto para el LED de máquina encendida */
 //=====[Declaration and initialization of public global variables]======
 
 //=====[Declaration and initialization of private global variables]=====
-static int elapsed_seconds = 0;
-static int previous_second = 0;
-static int count_seconds = 0;
-static int delay_count = 0;
+static int blink_timer = TIMER_WHEEL_INVALID; /**< Temporizador periódico del parpadeo */
+static int blink_off_timer = TIMER_WHEEL_INVALID; /**< Temporizador que apaga el led tras el parpadeo */
 
 //=====[Declaration (prototypes) of private functions]==================
 /**
@@ -74,6 +74,13 @@ static void activityLedOff();
  */
 static void activityLedBlink(int seconds_to_blink);
 
+/**
+ * @brief Enciende el led de actividad y programa su apagado.
+ *
+ * Callback del temporizador de parpadeo.
+ */
+static void activityLedBlinkOn();
+
 //=====[Implementations of public functions]============================
 /**
  * @brief Inicializa los LEDs con los pines especificados.
@@ -88,6 +95,9 @@ void ledsInit( PinName activityLedPin, PinName runLedPin ){
     activityLed = new DigitalOut(activityLedPin);
     runLed = new DigitalOut(runLedPin);
 
+    blink_timer = timerWheelCreate(activityLedBlinkOn);
+    blink_off_timer = timerWheelCreate(activityLedOff);
+
     ledsStop();
 }
 
@@ -115,12 +125,10 @@ void ledsWorking(){
  * Enciende LEDs para indicar que el sistema esta detenido.
  */
 void ledsStop(){
-    activityLedOff();
+    timerWheelStop(blink_timer);
+    timerWheelStop(blink_off_timer);
 
-    elapsed_seconds = 0;
-    previous_second = 0;
-    count_seconds = 0;
-    delay_count = 0;
+    activityLedOff();
 }
 
 /**
@@ -129,6 +137,9 @@ void ledsStop(){
  * Enciende LEDs para indicar que el sistema termino de trabajar.
  */
 void ledsEndWorking(){
+    timerWheelStop(blink_timer);
+    timerWheelStop(blink_off_timer);
+
     activityLedOn();
 }
 
@@ -179,32 +190,19 @@ static void activityLedOff(){
  * @return void
  */
 static void activityLedBlink(int seconds_to_blink){
-    
-    delay_count = delay_count + 1;
-
-    // si se alcanzo 100 retardos de 10 ms paso 1 segundo
-    if(delay_count >= 100){
-        delay_count = 0;
-        
-        if(elapsed_seconds<60){
-            elapsed_seconds = elapsed_seconds + 1;
-        }else{
-            elapsed_seconds = 0;
-        }
-    }
 
-    // si ya paso 1 segundo
-    if(previous_second != elapsed_seconds){
-        previous_second = elapsed_seconds;
-        
-        count_seconds = count_seconds + 1;
-        
-        //alcanzo los seconds_to_blink
-        if(count_seconds >= seconds_to_blink){
-            count_seconds = 0;
-            activityLedOn(); // enciende el led de actividad
-        }
-    }else{ // aún no paso 1 segundo
-        activityLedOff(); // apaga el led de actividad
+    // el temporizador sigue corriendo entre llamadas
+    if(timerWheelIsActive(blink_timer) == false){
+        timerWheelStart(blink_timer, seconds_to_blink * 1000, seconds_to_blink * 1000);
     }
+}
+
+/**
+ * @brief Enciende el led de actividad y programa su apagado.
+ *
+ * Callback del temporizador de parpadeo.
+ */
+static void activityLedBlinkOn(){
+    activityLedOn(); // enciende el led de actividad
+    timerWheelStart(blink_off_timer, BLINK_ON_MS, 0);
 }
\ No newline at end of file
@@ -0,0 +1,304 @@
+/**
+* @file power_resume.cpp
+* @brief Implementación de la reanudación del secado después de un corte de energía.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "power_resume.h"
+#include "modules/rtc/rtc.h"
+#include "modules/session_journal/session_journal.h"
+#include "modules/system_actions/system_actions.h"
+#include "modules/system_fsm/system_fsm.h"
+#include "modules/telemetry_frame/telemetry_frame.h"
+#include "modules/flash_record/flash_record.h"
+
+//=====[Declaration of private defines]=================================
+#define RESUME_VERSION  1   /**< Versión del formato de los registros */
+#define RESUME_CRC_OFFSET   (POWER_RESUME_RECORD_SIZE - 2)  /**< El CRC-16 va al final */
+#define RESUME_RUN_SLOTS    (MAX_TIME * 3600 / POWER_RESUME_CHECKPOINT_S + 64)  /**< Registros de un secado de MAX_TIME horas con margen para cambios */
+#define US_PER_SECOND   1000000ULL
+
+// las herramientas de mbed definen la región del programa a partir de target.restrict_size
+#if defined(MBED_APP_START) && defined(MBED_APP_SIZE)
+static_assert(MBED_APP_START + MBED_APP_SIZE <= POWER_RESUME_SECTOR, "el programa se superpone con los puntos de control");
+#endif
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Contenido de un punto de control.
+ */
+typedef struct{
+    bool working;   /**< Había un secado en curso */
+    uint8_t setpoint;   /**< Consigna en grados */
+    uint8_t target_hours;   /**< Horas de secado */
+    uint32_t elapsed_s; /**< rtcElapsedUs() en segundos */
+    sessionJournalRecord_t session; /**< Resumen de la sesión hasta el punto de control */
+}resumeCheckpoint_t;
+
+//=====[Declaration and initialization of public global objects]========
+FlashIAP* resumeFlash = nullptr;   /** Flash interna */
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+static uint32_t slots = 0;  /**< Registros que entran en el sector */
+static uint32_t next_slot = 0;  /**< Primer lugar libre */
+static bool ready = false;  /**< La región se abrió */
+static bool saved_working = false;  /**< El último registro guardado indica un secado en curso */
+static uint64_t saved_us = 0;   /**< rtcNowUs() del último registro guardado */
+static int saved_setpoint = 0;  /**< Consigna del último registro guardado */
+static int saved_hours = 0; /**< Horas del último registro guardado */
+static resumeCheckpoint_t last;    /**< Último punto de control encontrado al arrancar */
+static bool last_valid = false; /**< Se encontró un punto de control válido */
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Lee y valida un punto de control.
+ *
+ * @param slot Lugar.
+ * @param checkpoint Destino.
+ *
+ * @return true si el CRC es válido.
+ */
+static bool resumeReadSlot(const uint32_t slot, resumeCheckpoint_t *checkpoint);
+
+/**
+ * @brief Agrega un punto de control, borra el sector antes si está lleno.
+ *
+ * @param checkpoint Punto de control.
+ */
+static void resumeSave(const resumeCheckpoint_t *checkpoint);
+
+/**
+ * @brief Guarda el estado del secado en curso.
+ *
+ * @param work_temperature Temperatura de secado.
+ * @param activity_time Horas de secado.
+ */
+static void resumeSaveWorking(const int work_temperature, const int activity_time);
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Abre la región de los puntos de control y busca el último.
+ *
+ * @return true si la flash responde.
+ */
+bool powerResumeInit(){
+    ready = false;
+    last_valid = false;
+    saved_working = false;
+
+    if(resumeFlash == nullptr){
+        resumeFlash = new FlashIAP();
+    }
+
+    if(resumeFlash->init() != 0 or POWER_RESUME_RECORD_SIZE % resumeFlash->get_page_size() != 0){
+        return false;
+    }
+
+    slots = resumeFlash->get_sector_size(POWER_RESUME_SECTOR) / POWER_RESUME_RECORD_SIZE;
+
+    if(slots == 0){
+        return false;
+    }
+
+    next_slot = flashRecordFindTail(resumeFlash, POWER_RESUME_SECTOR, POWER_RESUME_RECORD_SIZE, 0, slots);
+
+    // el último puede estar cortado, se usa el anterior válido
+    for(uint32_t slot = next_slot; slot > 0 and not last_valid; slot--){
+        last_valid = resumeReadSlot(slot - 1, &last);
+    }
+
+    ready = true;
+
+    return true;
+}
+
+/**
+ * @brief Reanuda el secado si quedó en curso al cortarse la energía.
+ *
+ * Requiere powerResumeInit() y sessionJournalInit(). Restablece el tiempo transcurrido
+ * del rtc y agrega al diario el tramo anterior al corte.
+ *
+ * El sistema pasa de SYSTEM_ON a SYSTEM_WORK con el evento SYSTEM_EVENT_RESUME, con
+ * la temperatura y las horas guardadas en system_actions.
+ *
+ * @return true si se reanudó.
+ */
+bool powerResumeRestore(){
+
+    if(not ready or not last_valid or not last.working or not systemFsmAccepts(SYSTEM_EVENT_RESUME)){
+        return false;
+    }
+
+    last_valid = false; // una sola vez por arranque
+
+    // mismos límites que los botones y los comandos
+    if(not systemActionSetTemperature(last.setpoint) or not systemActionSetHours(last.target_hours)){
+        return false;
+    }
+
+    sessionJournalAppend(&last.session);
+
+    rtcSetElapsedUs(last.elapsed_s * US_PER_SECOND);
+    systemFsmDispatch(SYSTEM_EVENT_RESUME); // después del rtc, la entrada a SYSTEM_WORK no lo reinicia
+
+    return true;
+}
+
+/**
+ * @brief Guarda los puntos de control del secado en curso.
+ *
+ * Se llama en cada tick del sistema, después de sessionJournalUpdate().
+ *
+ * @param state Estado del sistema.
+ * @param work_temperature Temperatura de secado.
+ * @param activity_time Horas de secado.
+ */
+void powerResumeUpdate(systemState_t state, const int work_temperature, const int activity_time){
+    resumeCheckpoint_t checkpoint;
+
+    if(not ready){
+        return;
+    }
+
+    if(state != SYSTEM_WORK){
+
+        // terminó o se detuvo: al arrancar no hay nada que reanudar
+        if(saved_working){
+            memset(&checkpoint, 0, sizeof(checkpoint));
+            checkpoint.working = false;
+            resumeSave(&checkpoint);
+            saved_working = false;
+        }
+
+        return;
+    }
+
+    uint64_t since_save_us = rtcNowUs() - saved_us;
+
+    if(not saved_working){
+
+        // el borrado bloquea, se hace al empezar y no a mitad del secado
+        if(slots - next_slot < RESUME_RUN_SLOTS){
+            next_slot = slots;
+        }
+
+        resumeSaveWorking(work_temperature, activity_time);
+
+    }else if(since_save_us >= POWER_RESUME_CHECKPOINT_S * US_PER_SECOND){
+        resumeSaveWorking(work_temperature, activity_time);
+
+    }else if((work_temperature != saved_setpoint or activity_time != saved_hours) and since_save_us >= POWER_RESUME_CHANGE_S * US_PER_SECOND){
+        resumeSaveWorking(work_temperature, activity_time);
+    }
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Lee y valida un punto de control.
+ *
+ * @param slot Lugar.
+ * @param checkpoint Destino.
+ *
+ * @return true si el CRC es válido.
+ */
+static bool resumeReadSlot(const uint32_t slot, resumeCheckpoint_t *checkpoint){
+    uint8_t data[POWER_RESUME_RECORD_SIZE];
+
+    if(resumeFlash->read(data, POWER_RESUME_SECTOR + slot * POWER_RESUME_RECORD_SIZE, sizeof(data)) != 0){
+        return false;
+    }
+
+    if(flashRecordGet(&data[RESUME_CRC_OFFSET], 2) != telemetryFrameCrc16(data, RESUME_CRC_OFFSET) or flashRecordGet(&data[3], 1) != RESUME_VERSION){
+        return false;
+    }
+
+    checkpoint->working = flashRecordGet(&data[0], 1) != 0;
+    checkpoint->setpoint = flashRecordGet(&data[1], 1);
+    checkpoint->target_hours = flashRecordGet(&data[2], 1);
+    checkpoint->elapsed_s = flashRecordGet(&data[4], 4);
+    checkpoint->session.number = 0;
+    checkpoint->session.boot = flashRecordGet(&data[8], 2);
+    checkpoint->session.end = SESSION_JOURNAL_POWER_LOSS;
+    checkpoint->session.setpoint = checkpoint->setpoint;
+    checkpoint->session.target_hours = checkpoint->target_hours;
+    checkpoint->session.start_s = flashRecordGet(&data[10], 4);
+    checkpoint->session.duration_s = flashRecordGet(&data[14], 4);
+    checkpoint->session.heater_on_s = flashRecordGet(&data[18], 4);
+    checkpoint->session.mean_centi = (int16_t)flashRecordGet(&data[22], 2);
+    checkpoint->session.max_centi = (int16_t)flashRecordGet(&data[24], 2);
+    checkpoint->session.energy_wh = flashRecordGet(&data[26], 2);
+
+    return true;
+}
+
+/**
+ * @brief Agrega un punto de control, borra el sector antes si está lleno.
+ *
+ * @param checkpoint Punto de control.
+ */
+static void resumeSave(const resumeCheckpoint_t *checkpoint){
+    uint8_t data[POWER_RESUME_RECORD_SIZE];
+
+    saved_us = rtcNowUs();
+
+    if(next_slot >= slots){
+
+        if(resumeFlash->erase(POWER_RESUME_SECTOR, slots * POWER_RESUME_RECORD_SIZE) != 0){
+            return;
+        }
+
+        next_slot = 0;
+    }
+
+    memset(data, 0xFF, sizeof(data));
+    flashRecordPut(&data[0], checkpoint->working, 1);
+    flashRecordPut(&data[1], checkpoint->setpoint, 1);
+    flashRecordPut(&data[2], checkpoint->target_hours, 1);
+    flashRecordPut(&data[3], RESUME_VERSION, 1);
+    flashRecordPut(&data[4], checkpoint->elapsed_s, 4);
+    flashRecordPut(&data[8], checkpoint->session.boot, 2);
+    flashRecordPut(&data[10], checkpoint->session.start_s, 4);
+    flashRecordPut(&data[14], checkpoint->session.duration_s, 4);
+    flashRecordPut(&data[18], checkpoint->session.heater_on_s, 4);
+    flashRecordPut(&data[22], (uint16_t)checkpoint->session.mean_centi, 2);
+    flashRecordPut(&data[24], (uint16_t)checkpoint->session.max_centi, 2);
+    flashRecordPut(&data[26], checkpoint->session.energy_wh, 2);
+    flashRecordPut(&data[RESUME_CRC_OFFSET], telemetryFrameCrc16(data, RESUME_CRC_OFFSET), 2);
+
+    // el lugar se consume aunque falle, un registro a medias no se vuelve a programar encima
+    uint32_t address = POWER_RESUME_SECTOR + next_slot * POWER_RESUME_RECORD_SIZE;
+
+    next_slot = next_slot + 1;
+
+    resumeFlash->program(data, address, sizeof(data));
+}
+
+/**
+ * @brief Guarda el estado del secado en curso.
+ *
+ * @param work_temperature Temperatura de secado.
+ * @param activity_time Horas de secado.
+ */
+static void resumeSaveWorking(const int work_temperature, const int activity_time){
+    resumeCheckpoint_t checkpoint;
+
+    memset(&checkpoint, 0, sizeof(checkpoint));
+
+    checkpoint.working = true;
+    checkpoint.setpoint = work_temperature;
+    checkpoint.target_hours = activity_time;
+    checkpoint.elapsed_s = rtcElapsedUs() / US_PER_SECOND;
+    sessionJournalGetCurrent(&checkpoint.session);
+
+    resumeSave(&checkpoint);
+
+    saved_working = true;
+    saved_setpoint = work_temperature;
+    saved_hours = activity_time;
+}
@@ -0,0 +1,80 @@
+/**
+* @file power_resume.h
+* @brief Declaraciones de la reanudación del secado después de un corte de energía.
+*
+* Mientras se seca se guarda en la flash interna un punto de control con la consigna,
+* las horas, el tiempo transcurrido y el resumen de la sesión: al iniciar, cada
+* POWER_RESUME_CHECKPOINT_S segundos y poco después de cambiar la consigna o las horas.
+* Cada punto es un registro de POWER_RESUME_RECORD_SIZE bytes agregado con una sola
+* programación; al terminar el secado se agrega uno que indica que no hay nada en curso.
+*
+* Al arrancar se busca el último registro válido (bisección y CRC, como el diario de
+* sesiones). Si el secado estaba en curso el sistema vuelve a SYSTEM_WORK con los mismos
+* valores y el tiempo transcurrido, por lo que el calentador se enciende en el primer
+* ciclo del control, y el tramo anterior queda en el diario como cortado.
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _POWER_RESUME_H_
+#define _POWER_RESUME_H_
+
+#include "mbed.h"
+#include "modules/filament_dryer_system/filament_dryer_system.h"
+
+//=====[Declaration of private defines]=================================
+// Si no esta declarado el sector de los puntos de control (sector 5 del STM32F401RE, mbed_app.json limita el programa a los 128 KB anteriores)
+#ifndef POWER_RESUME_SECTOR
+#define POWER_RESUME_SECTOR 0x08020000
+#endif
+
+// Si no esta declarado cada cuántos segundos se guarda un punto de control
+#ifndef POWER_RESUME_CHECKPOINT_S
+#define POWER_RESUME_CHECKPOINT_S   60
+#endif
+
+// Si no esta declarada la espera mínima para guardar un cambio de consigna u horas
+#ifndef POWER_RESUME_CHANGE_S
+#define POWER_RESUME_CHANGE_S   5
+#endif
+
+#define POWER_RESUME_RECORD_SIZE    32  /**< Bytes de cada punto de control */
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Abre la región de los puntos de control y busca el último.
+ *
+ * @return true si la flash responde.
+ */
+bool powerResumeInit();
+
+/**
+ * @brief Reanuda el secado si quedó en curso al cortarse la energía.
+ *
+ * Requiere powerResumeInit() y sessionJournalInit(). Restablece el tiempo transcurrido
+ * del rtc y agrega al diario el tramo anterior al corte.
+ *
+ * El sistema pasa de SYSTEM_ON a SYSTEM_WORK con el evento SYSTEM_EVENT_RESUME, con
+ * la temperatura y las horas guardadas en system_actions.
+ *
+ * @return true si se reanudó.
+ */
+bool powerResumeRestore();
+
+/**
+ * @brief Guarda los puntos de control del secado en curso.
+ *
+ * Se llama en cada tick del sistema, después de sessionJournalUpdate().
+ *
+ * @param state Estado del sistema.
+ * @param work_temperature Temperatura de secado.
+ * @param activity_time Horas de secado.
+ */
+void powerResumeUpdate(systemState_t state, const int work_temperature, const int activity_time);
+
+//=====[#include guards - end]==========================================
+#endif
@@ -0,0 +1,148 @@
+/**
+* @file ring_buffer.cpp
+* @brief Implementación del buffer circular de bytes (un productor y un consumidor).
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "ring_buffer.h"
+#include <atomic>
+
+//=====[Declaration of private defines]=================================
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+
+//=====[Declaration (prototypes) of private functions]==================
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Inicializa el buffer vacío.
+ *
+ * @param buffer Buffer a inicializar.
+ * @param storage Almacenamiento de size bytes.
+ * @param size Tamaño, potencia de 2.
+ */
+void ringBufferInit(ringBuffer_t *buffer, uint8_t *storage, const uint32_t size){
+    buffer->data = storage;
+    buffer->mask = size - 1;
+    buffer->head = 0;
+    buffer->tail = 0;
+}
+
+/**
+ * @brief Capacidad del buffer.
+ *
+ * @param buffer Buffer.
+ *
+ * @return uint32_t Bytes que entran.
+ */
+uint32_t ringBufferSize(const ringBuffer_t *buffer){
+    return buffer->mask + 1;
+}
+
+/**
+ * @brief Bytes pendientes de leer.
+ *
+ * @param buffer Buffer.
+ *
+ * @return uint32_t Bytes ocupados.
+ */
+uint32_t ringBufferUsed(const ringBuffer_t *buffer){
+    // los índices crecen sin límite, la resta sin signo sigue siendo válida al desbordar
+    return buffer->head - buffer->tail;
+}
+
+/**
+ * @brief Bytes que se pueden escribir.
+ *
+ * @param buffer Buffer.
+ *
+ * @return uint32_t Bytes libres.
+ */
+uint32_t ringBufferFree(const ringBuffer_t *buffer){
+    return ringBufferSize(buffer) - ringBufferUsed(buffer);
+}
+
+/**
+ * @brief Escribe bytes, solo los que entran (lado productor).
+ *
+ * @param buffer Buffer.
+ * @param data Bytes a escribir.
+ * @param length Cantidad de bytes.
+ *
+ * @return uint32_t Bytes escritos.
+ */
+uint32_t ringBufferWrite(ringBuffer_t *buffer, const uint8_t *data, const uint32_t length){
+    uint32_t count = ringBufferFree(buffer);
+    uint32_t head = buffer->head;
+
+    if(count > length){
+        count = length;
+    }
+
+    for(uint32_t i = 0; i < count; i++){
+        buffer->data[(head + i) & buffer->mask] = data[i];
+    }
+
+    // se publica el índice después de copiar los datos
+    std::atomic_signal_fence(std::memory_order_release);
+    buffer->head = head + count;
+
+    return count;
+}
+
+/**
+ * @brief Lee un byte (lado consumidor).
+ *
+ * @param buffer Buffer.
+ * @param byte Destino del byte.
+ *
+ * @return true si había un byte.
+ */
+bool ringBufferReadByte(ringBuffer_t *buffer, uint8_t *byte){
+    uint32_t tail = buffer->tail;
+
+    if(tail == buffer->head){
+        return false;
+    }
+
+    *byte = buffer->data[tail & buffer->mask];
+
+    // se libera el lugar después de copiar el byte
+    std::atomic_signal_fence(std::memory_order_release);
+    buffer->tail = tail + 1;
+
+    return true;
+}
+
+/**
+ * @brief Descarta los bytes más viejos.
+ *
+ * Modifica el índice del consumidor: si el consumidor es una interrupción se debe
+ * llamar dentro de una sección crítica.
+ *
+ * @param buffer Buffer.
+ * @param length Cantidad de bytes a descartar.
+ *
+ * @return uint32_t Bytes descartados.
+ */
+uint32_t ringBufferDiscard(ringBuffer_t *buffer, const uint32_t length){
+    uint32_t count = ringBufferUsed(buffer);
+
+    if(count > length){
+        count = length;
+    }
+
+    buffer->tail = buffer->tail + count;
+
+    return count;
+}
@@ -0,0 +1,102 @@
+/**
+* @file ring_buffer.h
+* @brief Declaraciones de funciones del buffer circular de bytes (un productor y un consumidor).
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _RING_BUFFER_H_
+#define _RING_BUFFER_H_
+
+#include "mbed.h"
+
+//=====[Declaration of private defines]=================================
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Buffer circular de bytes.
+ *
+ * Sin bloqueos para un productor y un consumidor (por ejemplo el bucle principal y una
+ * interrupción): cada índice lo modifica un solo lado. El tamaño debe ser potencia de 2.
+ */
+typedef struct{
+    uint8_t *data;  /**< Almacenamiento provisto por el usuario */
+    uint32_t mask;  /**< Tamaño - 1 */
+    volatile uint32_t head; /**< Bytes escritos desde el inicio, lo modifica el productor */
+    volatile uint32_t tail; /**< Bytes leídos desde el inicio, lo modifica el consumidor */
+}ringBuffer_t;
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Inicializa el buffer vacío.
+ *
+ * @param buffer Buffer a inicializar.
+ * @param storage Almacenamiento de size bytes.
+ * @param size Tamaño, potencia de 2.
+ */
+void ringBufferInit(ringBuffer_t *buffer, uint8_t *storage, const uint32_t size);
+
+/**
+ * @brief Capacidad del buffer.
+ *
+ * @param buffer Buffer.
+ *
+ * @return uint32_t Bytes que entran.
+ */
+uint32_t ringBufferSize(const ringBuffer_t *buffer);
+
+/**
+ * @brief Bytes pendientes de leer.
+ *
+ * @param buffer Buffer.
+ *
+ * @return uint32_t Bytes ocupados.
+ */
+uint32_t ringBufferUsed(const ringBuffer_t *buffer);
+
+/**
+ * @brief Bytes que se pueden escribir.
+ *
+ * @param buffer Buffer.
+ *
+ * @return uint32_t Bytes libres.
+ */
+uint32_t ringBufferFree(const ringBuffer_t *buffer);
+
+/**
+ * @brief Escribe bytes, solo los que entran (lado productor).
+ *
+ * @param buffer Buffer.
+ * @param data Bytes a escribir.
+ * @param length Cantidad de bytes.
+ *
+ * @return uint32_t Bytes escritos.
+ */
+uint32_t ringBufferWrite(ringBuffer_t *buffer, const uint8_t *data, const uint32_t length);
+
+/**
+ * @brief Lee un byte (lado consumidor).
+ *
+ * @param buffer Buffer.
+ * @param byte Destino del byte.
+ *
+ * @return true si había un byte.
+ */
+bool ringBufferReadByte(ringBuffer_t *buffer, uint8_t *byte);
+
+/**
+ * @brief Descarta los bytes más viejos.
+ *
+ * Modifica el índice del consumidor: si el consumidor es una interrupción se debe
+ * llamar dentro de una sección crítica.
+ *
+ * @param buffer Buffer.
+ * @param length Cantidad de bytes a descartar.
+ *
+ * @return uint32_t Bytes descartados.
+ */
+uint32_t ringBufferDiscard(ringBuffer_t *buffer, const uint32_t length);
+
+//=====[#include guards - end]==========================================
+#endif
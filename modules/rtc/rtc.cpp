@@ -10,48 +10,58 @@
 #include "rtc.h"
 
 //=====[Declaration of private defines]=================================
-// Si no esta declarado TIME_MS 
-#ifndef TIME_MS
-#define TIME_MS 10
-#endif
-
-#define delay(ms)   thread_sleep_for( ms ) /**< Pseudonimo delay para thread_sleep_for */
+#define US_PER_SECOND   1000000ULL  /**< Microsegundos en un segundo */
+#define US_PER_MS   1000ULL /**< Microsegundos en un milisegundo */
 
 //=====[Declaration of private data types]==============================
 
 //=====[Declaration and initialization of public global objects]========
+Timer* rtcTimer = nullptr;  /** Contador monótono de hardware (us_ticker) */
 
 //=====[Declaration of external public global variables]================
 
 //=====[Declaration and initialization of public global variables]======
 
 //=====[Declaration and initialization of private global variables]=====
-static rtcTime_t time_module;   /**< Estructura para almacenar el tiempo. */
-static int delay_count = 0;    /**< Lleva el conteo de la cantidad de retardos */
+static rtcClockSource_t clock_source = nullptr; /**< Fuente de tiempo monótona en microsegundos */
+static uint64_t start_us = 0;   /**< Instante del último reinicio del contador */
 
 //=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Fuente de tiempo por defecto.
+ *
+ * @return uint64_t Microsegundos del contador de hardware.
+ */
+static uint64_t rtcHardwareClock();
 
 //=====[Implementations of public functions]============================
 /**
  * @brief Inicia el contador de tiempo.
  * 
- * Inicializa los contadores de segundos, minutos y horas a cero,
- * y reinicia el contador de retardos.
+ * Arranca el contador monótono de hardware si no hay otra fuente
+ * configurada y toma el instante actual como origen.
  */
 void rtcInit(){
-    time_module.seconds = 0;
-    time_module.minutes = 0;
-    time_module.hours = 0;
-    delay_count = 0;
+
+    if(rtcTimer == nullptr){
+        rtcTimer = new Timer();
+        rtcTimer->start();
+    }
+
+    if(clock_source == nullptr){
+        clock_source = rtcHardwareClock;
+    }
+
+    start_us = rtcNowUs();
 }
 
 /**
  * @brief Restablece los contadores de tiempo.
  * 
- * Reinicia el contador de tiempo llamando a la función rtcInit().
+ * Toma el instante actual como nuevo origen del tiempo transcurrido.
  */
 void rtcRestart(){
-    rtcInit();
+    start_us = rtcNowUs();
 }
 
 /**
@@ -60,39 +70,80 @@ void rtcRestart(){
  * @return rtcTime_t Estructura que contiene el tiempo transcurrido.
  */
 rtcTime_t rtcRead(){
+    rtcTime_t time_module;
+    uint64_t elapsed_seconds = rtcElapsedUs() / US_PER_SECOND;
+
+    time_module.seconds = elapsed_seconds % 60;
+    time_module.minutes = (elapsed_seconds / 60) % 60;
+    time_module.hours = elapsed_seconds / 3600;
+
     return time_module;
 }
 
 /**
- * @brief Lleva el control del tiempo.
- * 
- * Actualiza los contadores de tiempo cada vez que se alcanza un retraso de TIME_MS.
- * Incrementa los segundos, minutos y horas según sea necesario.
+ * @brief Tiempo monótono desde el arranque.
+ *
+ * No se ve afectado por rtcRestart().
+ *
+ * @return uint64_t Tiempo en microsegundos.
  */
-void rtcUpdate(){
-    
-    delay(TIME_MS);
+uint64_t rtcNowUs(){
+    return clock_source();
+}
 
-    delay_count = delay_count + 1;
+/**
+ * @brief Tiempo transcurrido desde el último reinicio.
+ *
+ * @return uint64_t Tiempo en microsegundos.
+ */
+uint64_t rtcElapsedUs(){
+    return rtcNowUs() - start_us;
+}
 
-    // si se alcanzo 100 retardos de 10 ms paso 1 segundo
-    if(delay_count >= 100){
-        delay_count = 0;
+/**
+ * @brief Tiempo transcurrido desde el último reinicio.
+ *
+ * @return uint64_t Tiempo en milisegundos.
+ */
+uint64_t rtcElapsedMs(){
+    return rtcElapsedUs() / US_PER_MS;
+}
 
-        if(time_module.seconds<60){
-            time_module.seconds = time_module.seconds + 1;
-        }else{
-            time_module.seconds = 0;
+/**
+ * @brief Fija el tiempo transcurrido.
+ *
+ * Mueve el origen hacia atrás, como si el último reinicio hubiera sido hace elapsed_us.
+ *
+ * @param elapsed_us Tiempo transcurrido en microsegundos.
+ */
+void rtcSetElapsedUs(const uint64_t elapsed_us){
+    start_us = rtcNowUs() - elapsed_us; // recién arrancado puede dar la vuelta, la resta de rtcElapsedUs() la compensa
+}
 
-            if(time_module.minutes<59){
-                time_module.minutes = time_module.minutes + 1;
-            }else{
+/**
+ * @brief Reemplaza la fuente de tiempo.
+ *
+ * Permite inyectar un reloj virtual (simulación o pruebas en host).
+ * Con nullptr vuelve al contador de hardware. Reinicia el tiempo transcurrido.
+ *
+ * @param source Función que retorna microsegundos monótonos.
+ */
+void rtcSetClockSource(rtcClockSource_t source){
 
-                time_module.minutes = 0;
-                time_module.hours = time_module.hours + 1;
-            }
-        }
+    if(source == nullptr){
+        source = rtcHardwareClock;
     }
+
+    clock_source = source;
+    start_us = rtcNowUs();
 }
 
-//=====[Implementations of private functions]===========================
\ No newline at end of file
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Fuente de tiempo por defecto.
+ *
+ * @return uint64_t Microsegundos del contador de hardware.
+ */
+static uint64_t rtcHardwareClock(){
+    return rtcTimer->elapsed_time().count();
+}
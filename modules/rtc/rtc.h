@@ -21,19 +21,24 @@ typedef struct{
     int hours;
 }rtcTime_t;
 
+/**
+ * @brief Fuente de tiempo monótona, retorna microsegundos.
+ */
+typedef uint64_t (*rtcClockSource_t)();
+
 //=====[Declaration (prototypes) of public functions]===================
 /**
  * @brief Inicia el contador de tiempo.
  * 
- * Inicializa los contadores de segundos, minutos y horas a cero,
- * y reinicia el contador de retardos.
+ * Arranca el contador monótono de hardware si no hay otra fuente
+ * configurada y toma el instante actual como origen.
  */
 void rtcInit();
 
 /**
  * @brief Restablece los contadores de tiempo.
  * 
- * Reinicia el contador de tiempo llamando a la función rtcInit().
+ * Toma el instante actual como nuevo origen del tiempo transcurrido.
  */
 void rtcRestart();
 
@@ -45,13 +50,44 @@ void rtcRestart();
 rtcTime_t rtcRead();
 
 /**
- * @brief Lleva el control del tiempo.
- * 
- * Actualiza los contadores de tiempo cada vez que se alcanza un retraso de TIME_MS.
- * Incrementa los segundos, minutos y horas según sea necesario.
+ * @brief Tiempo monótono desde el arranque.
+ *
+ * No se ve afectado por rtcRestart().
+ *
+ * @return uint64_t Tiempo en microsegundos.
+ */
+uint64_t rtcNowUs();
+
+/**
+ * @brief Tiempo transcurrido desde el último reinicio.
+ *
+ * @return uint64_t Tiempo en microsegundos.
+ */
+uint64_t rtcElapsedUs();
+
+/**
+ * @brief Tiempo transcurrido desde el último reinicio.
+ *
+ * @return uint64_t Tiempo en milisegundos.
+ */
+uint64_t rtcElapsedMs();
+
+/**
+ * @brief Fija el tiempo transcurrido.
+ * Mueve el origen hacia atrás, como si el último reinicio hubiera sido hace elapsed_us.
+ * @param elapsed_us Tiempo transcurrido en microsegundos.
+ */
+void rtcSetElapsedUs(const uint64_t elapsed_us);
+
+/**
+ * @brief Reemplaza la fuente de tiempo.
+ *
+ * Permite inyectar un reloj virtual (simulación o pruebas en host).
+ * Con nullptr vuelve al contador de hardware. Reinicia el tiempo transcurrido.
+ *
+ * @param source Función que retorna microsegundos monótonos.
  */
-void rtcUpdate();
-    
+void rtcSetClockSource(rtcClockSource_t source);
 
 //=====[#include guards - end]==========================================
-#endif
\ No newline at end of file
+#endif
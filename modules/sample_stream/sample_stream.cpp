@@ -0,0 +1,304 @@
+/**
+* @file sample_stream.cpp
+* @brief Implementación de la transmisión de muestras crudas del sensor por uart.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "sample_stream.h"
+#include "modules/rtc/rtc.h"
+#include "modules/heater/heater.h"
+#include "modules/temperature_sensor/temperature_sensor.h"
+#include "modules/uart_manager/uart_manager.h"
+#include "modules/telemetry_frame/telemetry_frame.h"
+#include <atomic>
+
+//=====[Declaration of private defines]=================================
+#define BLOCK_SAMPLES   TELEMETRY_FRAME_MAX_SAMPLES /**< Muestras por bloque, un bloque por trama */
+#define BLOCKS  2   /**< Doble buffer: uno se llena mientras el otro espera para enviarse */
+
+#define MAX_DECIMATION  16  /**< Decimación máxima ante un enlace saturado */
+#define RECOVER_BLOCKS  10  /**< Bloques seguidos con la uart holgada para bajar la decimación */
+#define TX_SLACK_DIVISOR    4   /**< La uart está holgada con más de 3/4 del buffer libre */
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Bloque de muestras.
+ */
+typedef struct{
+    uint16_t samples[BLOCK_SAMPLES];    /**< Cuentas crudas del ADC */
+    uint64_t first_us;  /**< Instante de la primera muestra */
+    int decimation; /**< Decimación con la que se llenó */
+    int count;  /**< Muestras cargadas */
+    volatile bool ready;    /**< Completo, esperando ser enviado */
+}sampleStreamBlock_t;
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+static sampleStreamBlock_t blocks[BLOCKS]; /**< Bloques de muestras */
+static int fill_block = 0; /**< Bloque que se llena, lo usa solo el productor */
+static int send_block = 0; /**< Próximo bloque a enviar, lo usa solo el bucle principal */
+static int decimation_phase = 0; /**< Muestras crudas descartadas desde la última tomada */
+
+static volatile bool active = false; /**< Transmisión activa */
+static volatile int decimation = 1; /**< Decimación para los bloques que empiecen */
+static int calm_blocks = 0; /**< Bloques seguidos enviados con la uart holgada */
+static uint16_t sequence = 0; /**< Número del próximo bloque */
+
+static telemetryEvent_t events[TELEMETRY_FRAME_MAX_EVENTS]; /**< Cambios del calentador pendientes */
+static int event_count = 0; /**< Cambios pendientes */
+static bool previous_heater = false; /**< Estado del calentador en el tick anterior */
+
+static sampleStreamStats_t stats; /**< Contadores */
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Recibe las muestras crudas del sensor, puede correr en interrupción.
+ *
+ * @param samples Muestras con escala de read_u16().
+ * @param count Cantidad de muestras.
+ */
+static void sampleStreamPush(const uint16_t *samples, const int count);
+
+/**
+ * @brief Registra un cambio del calentador.
+ */
+static void sampleStreamTrackHeater();
+
+/**
+ * @brief Envía o descarta el bloque completo y ajusta la decimación.
+ *
+ * @param block Bloque completo.
+ */
+static void sampleStreamSend(sampleStreamBlock_t *block);
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Inicializa la transmisión y se suscribe a las muestras crudas del sensor.
+ *
+ * Requiere temperatureSensorInit() y uartManagerInit(). Con SAMPLE_STREAM_AUTOSTART arranca.
+ */
+void sampleStreamInit(){
+    active = false;
+    memset(&stats, 0, sizeof(stats));
+
+    temperatureSensorSetRawTap(sampleStreamPush);
+
+#if SAMPLE_STREAM_AUTOSTART
+    sampleStreamStart();
+#endif
+}
+
+/**
+ * @brief Arranca la transmisión.
+ *
+ * Pasa la telemetría a binario para que las tramas no se mezclen con texto.
+ */
+void sampleStreamStart(){
+    active = false; // el productor no toca los bloques mientras se reinician
+
+    for(int i = 0; i < BLOCKS; i++){
+        blocks[i].count = 0;
+        blocks[i].ready = false;
+    }
+
+    fill_block = 0;
+    send_block = 0;
+    decimation_phase = 0;
+    decimation = 1;
+    calm_blocks = 0;
+    event_count = 0;
+    previous_heater = heaterStatus();
+
+    uartManagerSetTelemetryMode(UART_TELEMETRY_BINARY);
+
+    active = true;
+}
+
+/**
+ * @brief Detiene la transmisión.
+ */
+void sampleStreamStop(){
+    active = false;
+}
+
+/**
+ * @brief Indica si la transmisión está activa.
+ *
+ * @return true si está transmitiendo.
+ */
+bool sampleStreamIsActive(){
+    return active;
+}
+
+/**
+ * @brief Registra los cambios del calentador y envía los bloques completos.
+ *
+ * Llamar en cada tick, después de actualizar el calentador. Si la uart no tiene lugar
+ * descarta el bloque y duplica la decimación; con la uart holgada la vuelve a bajar.
+ */
+void sampleStreamUpdate(){
+
+    if(not active){
+        return;
+    }
+
+    sampleStreamTrackHeater();
+
+    if(blocks[send_block].ready){
+        sampleStreamSend(&blocks[send_block]);
+        send_block = (send_block + 1) % BLOCKS;
+    }
+}
+
+/**
+ * @brief Contadores de la transmisión.
+ *
+ * @return sampleStreamStats_t Bloques, pérdidas y decimación actual.
+ */
+sampleStreamStats_t sampleStreamGetStats(){
+    stats.decimation = decimation;
+
+    return stats;
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Recibe las muestras crudas del sensor, puede correr en interrupción.
+ *
+ * @param samples Muestras con escala de read_u16().
+ * @param count Cantidad de muestras.
+ */
+static void sampleStreamPush(const uint16_t *samples, const int count){
+    uint64_t now_us;
+    int period_us;
+
+    if(not active){
+        return;
+    }
+
+    // las muestras del grupo son consecutivas y la última es la de ahora
+    now_us = rtcNowUs();
+    period_us = temperatureSensorGetSamplePeriodUs();
+
+    for(int i = 0; i < count; i++){
+        sampleStreamBlock_t *block = &blocks[fill_block];
+
+        // el bucle principal no envió el bloque siguiente, se pierde la muestra
+        if(block->ready){
+            stats.samples_overrun = stats.samples_overrun + 1;
+            continue;
+        }
+
+        if(block->count == 0 and decimation_phase == 0){
+            block->decimation = decimation;
+        }
+
+        decimation_phase = decimation_phase + 1;
+
+        if(decimation_phase < block->decimation){
+            continue;
+        }
+
+        decimation_phase = 0;
+
+        if(block->count == 0){
+            block->first_us = now_us - (uint64_t)(count - 1 - i) * period_us;
+        }
+
+        block->samples[block->count] = samples[i];
+        block->count = block->count + 1;
+
+        if(block->count == BLOCK_SAMPLES){
+            std::atomic_signal_fence(std::memory_order_release);
+            block->ready = true;
+            fill_block = (fill_block + 1) % BLOCKS;
+        }
+    }
+}
+
+/**
+ * @brief Registra un cambio del calentador.
+ */
+static void sampleStreamTrackHeater(){
+    bool heater_on = heaterStatus();
+
+    if(heater_on == previous_heater){
+        return;
+    }
+
+    previous_heater = heater_on;
+
+    if(event_count >= TELEMETRY_FRAME_MAX_EVENTS){
+        stats.events_lost = stats.events_lost + 1;
+        return;
+    }
+
+    events[event_count].timestamp_us = rtcNowUs();
+    events[event_count].heater = heater_on;
+    event_count = event_count + 1;
+}
+
+/**
+ * @brief Envía o descarta el bloque completo y ajusta la decimación.
+ *
+ * @param block Bloque completo.
+ */
+static void sampleStreamSend(sampleStreamBlock_t *block){
+    telemetrySamples_t frame_data;
+    uint8_t frame[TELEMETRY_FRAME_ENCODED_MAX(TELEMETRY_FRAME_SAMPLES_MAX_LENGTH)];
+    int length;
+
+    frame_data.sequence = sequence;
+    frame_data.timestamp_us = block->first_us;
+    frame_data.period_us = (uint32_t)temperatureSensorGetSamplePeriodUs() * block->decimation;
+    frame_data.decimation = block->decimation;
+    frame_data.sample_count = block->count;
+    frame_data.event_count = event_count;
+    memcpy(frame_data.samples, block->samples, sizeof(frame_data.samples));
+    memcpy(frame_data.events, events, sizeof(frame_data.events));
+
+    // la secuencia avanza aunque se descarte, el receptor ve el hueco
+    sequence = sequence + 1;
+
+    length = telemetryFrameEncodeSamples(&frame_data, frame);
+
+    // se libera el bloque para el productor
+    std::atomic_signal_fence(std::memory_order_release);
+    block->count = 0;
+    block->ready = false;
+
+    if(uartManagerGetTxFree() < length){
+        // el enlace no da abasto: menos muestras por segundo, los eventos quedan para el próximo bloque
+        stats.blocks_dropped = stats.blocks_dropped + 1;
+        calm_blocks = 0;
+
+        if(decimation < MAX_DECIMATION){
+            decimation = decimation * 2;
+        }
+
+        return;
+    }
+
+    uartManagerWrite((const char *)frame, length);
+
+    stats.blocks_sent = stats.blocks_sent + 1;
+    event_count = 0;
+
+    if(uartManagerGetTxFree() > UART_TX_BUFFER_SIZE - UART_TX_BUFFER_SIZE / TX_SLACK_DIVISOR){
+        calm_blocks = calm_blocks + 1;
+    }else{
+        calm_blocks = 0;
+    }
+
+    if(calm_blocks >= RECOVER_BLOCKS and decimation > 1){
+        decimation = decimation / 2;
+        calm_blocks = 0;
+    }
+}
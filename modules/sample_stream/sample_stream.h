@@ -0,0 +1,75 @@
+/**
+* @file sample_stream.h
+* @brief Declaraciones de funciones de la transmisión de muestras crudas del sensor por uart.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _SAMPLE_STREAM_H_
+#define _SAMPLE_STREAM_H_
+
+#include "mbed.h"
+
+//=====[Declaration of private defines]=================================
+// Si no esta declarado si la transmisión arranca con el sistema
+#ifndef SAMPLE_STREAM_AUTOSTART
+#define SAMPLE_STREAM_AUTOSTART 0
+#endif
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Contadores de la transmisión de muestras.
+ */
+typedef struct{
+    uint32_t blocks_sent;   /**< Bloques encolados en la uart */
+    uint32_t blocks_dropped;    /**< Bloques descartados porque la uart no tenía lugar */
+    uint32_t samples_overrun;   /**< Muestras perdidas porque los dos bloques estaban llenos */
+    uint32_t events_lost;   /**< Cambios del calentador que no entraron en una trama */
+    int decimation; /**< Decimación actual */
+}sampleStreamStats_t;
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Inicializa la transmisión y se suscribe a las muestras crudas del sensor.
+ *
+ * Requiere temperatureSensorInit() y uartManagerInit(). Con SAMPLE_STREAM_AUTOSTART arranca.
+ */
+void sampleStreamInit();
+
+/**
+ * @brief Arranca la transmisión.
+ *
+ * Pasa la telemetría a binario para que las tramas no se mezclen con texto.
+ */
+void sampleStreamStart();
+
+/**
+ * @brief Detiene la transmisión.
+ */
+void sampleStreamStop();
+
+/**
+ * @brief Indica si la transmisión está activa.
+ *
+ * @return true si está transmitiendo.
+ */
+bool sampleStreamIsActive();
+
+/**
+ * @brief Registra los cambios del calentador y envía los bloques completos.
+ *
+ * Llamar en cada tick, después de actualizar el calentador. Si la uart no tiene lugar
+ * descarta el bloque y duplica la decimación; con la uart holgada la vuelve a bajar.
+ */
+void sampleStreamUpdate();
+
+/**
+ * @brief Contadores de la transmisión.
+ *
+ * @return sampleStreamStats_t Bloques, pérdidas y decimación actual.
+ */
+sampleStreamStats_t sampleStreamGetStats();
+
+//=====[#include guards - end]==========================================
+#endif
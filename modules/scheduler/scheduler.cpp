@@ -0,0 +1,264 @@
+/**
+* @file scheduler.cpp
+* @brief Implementación del planificador de tareas periódicas.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "scheduler.h"
+#include "modules/rtc/rtc.h"
+
+//=====[Declaration of private defines]=================================
+#define US_PER_MS   1000ULL /**< Microsegundos en un milisegundo */
+#define NO_RELEASE  UINT64_MAX  /**< Próxima liberación de una tarea sin periodo */
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Datos de una tarea registrada.
+ */
+typedef struct{
+    schedulerTask_t task;   /**< Función de la tarea */
+    uint64_t period_us;     /**< Periodo de liberación */
+    uint64_t deadline_us;   /**< Plazo relativo a la liberación */
+    uint64_t release_us;    /**< Instante de la próxima liberación */
+    int deadline_misses;    /**< Plazos incumplidos */
+}schedulerEntry_t;
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+static schedulerEntry_t tasks[SCHEDULER_MAX_TASKS]; /**< Tareas registradas */
+static int tasks_count = 0; /**< Cantidad de tareas registradas */
+static schedulerIdle_t idle_hook = nullptr; /**< Espera hasta la próxima liberación, nullptr duerme el hilo */
+static volatile uint32_t released_mask = 0; /**< Tareas liberadas por schedulerRelease(), un bit por tarea */
+static osThreadId_t scheduler_thread = nullptr;    /**< Hilo que llama a schedulerUpdate() */
+
+static_assert(SCHEDULER_MAX_TASKS <= 32, "released_mask tiene un bit por tarea");
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Espera por defecto, duerme el hilo hasta la próxima liberación.
+ *
+ * @param wake_us Instante (rtcNowUs) de la próxima liberación.
+ */
+static void schedulerSleep(uint64_t wake_us);
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Inicializa el planificador.
+ *
+ * Elimina todas las tareas registradas. Requiere rtcInit().
+ */
+void schedulerInit(){
+    tasks_count = 0;
+    released_mask = 0;
+    scheduler_thread = ThisThread::get_id();
+}
+
+/**
+ * @brief Registra una tarea periódica.
+ *
+ * La tarea se libera por primera vez en la próxima llamada a schedulerUpdate()
+ * y luego cada period_ms. Las tareas que vencen juntas se ejecutan en el orden
+ * en que fueron registradas.
+ *
+ * @param task Función a ejecutar.
+ * @param period_ms Periodo de la tarea en milisegundos, SCHEDULER_NO_PERIOD si solo corre
+ * al liberarla.
+ * @param deadline_ms Plazo máximo desde la liberación hasta que la tarea termina.
+ *
+ * @return int Identificador de la tarea o SCHEDULER_INVALID_TASK.
+ */
+int schedulerAddTask(schedulerTask_t task, const int period_ms, const int deadline_ms){
+
+    if(tasks_count >= SCHEDULER_MAX_TASKS or period_ms < 0){
+        return SCHEDULER_INVALID_TASK;
+    }
+
+    tasks[tasks_count].task = task;
+    tasks[tasks_count].period_us = period_ms * US_PER_MS;
+    tasks[tasks_count].deadline_us = deadline_ms * US_PER_MS;
+    tasks[tasks_count].release_us = (period_ms == SCHEDULER_NO_PERIOD) ? NO_RELEASE : rtcNowUs();
+    tasks[tasks_count].deadline_misses = 0;
+
+    tasks_count = tasks_count + 1;
+
+    return tasks_count - 1;
+}
+
+/**
+ * @brief Libera una tarea ya, sin esperar a su periodo.
+ *
+ * Se puede llamar desde interrupciones: despierta al planificador si estaba durmiendo y la
+ * tarea se ejecuta en la próxima schedulerUpdate(). Sus liberaciones periódicas no cambian.
+ *
+ * @param task_id Identificador devuelto por schedulerAddTask().
+ */
+void schedulerRelease(const int task_id){
+
+    if(task_id < 0 or task_id >= tasks_count){
+        return;
+    }
+
+    core_util_critical_section_enter();
+    released_mask = released_mask | (1UL << task_id);
+    core_util_critical_section_exit();
+
+    // si el hilo no estaba esperando el flag queda puesto y la próxima espera vuelve enseguida
+    osThreadFlagsSet(scheduler_thread, SCHEDULER_WAKE_FLAG);
+}
+
+/**
+ * @brief Cambia el periodo de una tarea.
+ *
+ * Se puede llamar desde la misma tarea. Con otro periodo la próxima liberación queda a
+ * period_ms de ahora; con el mismo no cambia nada.
+ *
+ * @param task_id Identificador devuelto por schedulerAddTask().
+ * @param period_ms Periodo en milisegundos, SCHEDULER_NO_PERIOD para que solo corra al liberarla.
+ */
+void schedulerSetPeriod(const int task_id, const int period_ms){
+
+    if(task_id < 0 or task_id >= tasks_count or period_ms < 0){
+        return;
+    }
+
+    uint64_t period_us = period_ms * US_PER_MS;
+
+    if(period_us == tasks[task_id].period_us){
+        return;
+    }
+
+    tasks[task_id].period_us = period_us;
+    tasks[task_id].release_us = (period_ms == SCHEDULER_NO_PERIOD) ? NO_RELEASE : rtcNowUs() + period_us;
+}
+
+/**
+ * @brief Ejecuta las tareas vencidas y duerme hasta la próxima liberación.
+ *
+ * Mientras duerme el RTOS deja al microcontrolador en reposo.
+ */
+void schedulerUpdate(){
+
+    uint64_t next_release;
+    uint32_t released;
+
+    core_util_critical_section_enter();
+    released = released_mask;
+    released_mask = 0;
+    core_util_critical_section_exit();
+
+    for(int i = 0; i < tasks_count; i++){
+
+        uint64_t now = rtcNowUs();
+
+        // liberada antes de tiempo: se ejecuta y su periodo sigue igual
+        if(now < tasks[i].release_us and (released & (1UL << i))){
+            tasks[i].task();
+        }
+
+        if(now >= tasks[i].release_us){
+            uint64_t release = tasks[i].release_us;
+
+            tasks[i].task();
+
+            // terminó fuera de plazo
+            if(rtcNowUs() > release + tasks[i].deadline_us){
+                tasks[i].deadline_misses = tasks[i].deadline_misses + 1;
+            }
+
+            // la tarea cambió su periodo, schedulerSetPeriod() ya puso la próxima liberación
+            if(tasks[i].release_us != release){
+                continue;
+            }
+
+            // las liberaciones son fijas, no acumulan el tiempo de ejecución
+            tasks[i].release_us = tasks[i].release_us + tasks[i].period_us;
+
+            // si se perdió más de un periodo no se recuperan en ráfaga
+            if(tasks[i].release_us <= now){
+                tasks[i].release_us = now + tasks[i].period_us;
+            }
+        }
+    }
+
+    if(tasks_count == 0){
+        return;
+    }
+
+    next_release = tasks[0].release_us;
+
+    for(int i = 1; i < tasks_count; i++){
+        if(tasks[i].release_us < next_release){
+            next_release = tasks[i].release_us;
+        }
+    }
+
+    // una liberación llegó mientras se ejecutaban las tareas
+    if(released_mask != 0){
+        return;
+    }
+
+    if(next_release > rtcNowUs()){
+        if(idle_hook != nullptr){
+            idle_hook(next_release);
+        }else{
+            schedulerSleep(next_release);
+        }
+    }
+}
+
+/**
+ * @brief Reemplaza la espera entre liberaciones.
+ *
+ * Con un reloj virtual (rtcSetClockSource) la espera debe avanzar ese reloj
+ * en lugar de dormir. Con nullptr vuelve a dormir el hilo.
+ *
+ * @param idle Función que espera hasta el instante indicado.
+ */
+void schedulerSetIdleHook(schedulerIdle_t idle){
+
+    idle_hook = idle;
+}
+
+/**
+ * @brief Cantidad de veces que la tarea terminó fuera de su plazo.
+ *
+ * @param task_id Identificador devuelto por schedulerAddTask().
+ *
+ * @return int Plazos incumplidos.
+ */
+int schedulerGetDeadlineMisses(const int task_id){
+
+    if(task_id < 0 or task_id >= tasks_count){
+        return 0;
+    }
+
+    return tasks[task_id].deadline_misses;
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Espera por defecto, duerme el hilo hasta la próxima liberación.
+ *
+ * @param wake_us Instante (rtcNowUs) de la próxima liberación.
+ */
+static void schedulerSleep(uint64_t wake_us){
+    uint64_t now = rtcNowUs();
+
+    // redondea hacia arriba para no despertar antes de la liberación
+    uint64_t sleep_ms = (wake_us - now + US_PER_MS - 1) / US_PER_MS;
+
+    // solo tareas sin periodo: la despierta schedulerRelease(), la espera se limita a lo que admite el RTOS
+    if(sleep_ms > UINT32_MAX){
+        sleep_ms = UINT32_MAX;
+    }
+
+    // el RTOS entra en reposo mientras tanto, schedulerRelease() lo despierta antes
+    ThisThread::flags_wait_any_for(SCHEDULER_WAKE_FLAG, Kernel::Clock::duration_u32(sleep_ms));
+}
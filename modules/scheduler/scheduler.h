@@ -0,0 +1,103 @@
+/**
+* @file scheduler.h
+* @brief Declaraciones de funciones del planificador de tareas periódicas.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+#include "mbed.h"
+
+//=====[Declaration of private defines]=================================
+#define SCHEDULER_MAX_TASKS 8   /**< Cantidad máxima de tareas registrables */
+#define SCHEDULER_INVALID_TASK  -1  /**< Identificador devuelto si no se pudo registrar la tarea */
+#define SCHEDULER_WAKE_FLAG 0x1 /**< Flag del hilo que interrumpe la espera */
+#define SCHEDULER_NO_PERIOD 0   /**< Periodo de una tarea que solo corre al liberarla con schedulerRelease() */
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Función que ejecuta una tarea periódica.
+ */
+typedef void (*schedulerTask_t)();
+
+/**
+ * @brief Función que espera hasta el instante indicado en microsegundos (rtcNowUs).
+ */
+typedef void (*schedulerIdle_t)(uint64_t wake_us);
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Inicializa el planificador.
+ *
+ * Elimina todas las tareas registradas. Requiere rtcInit().
+ */
+void schedulerInit();
+
+/**
+ * @brief Registra una tarea periódica.
+ *
+ * La tarea se libera por primera vez en la próxima llamada a schedulerUpdate()
+ * y luego cada period_ms. Las tareas que vencen juntas se ejecutan en el orden
+ * en que fueron registradas.
+ *
+ * @param task Función a ejecutar.
+ * @param period_ms Periodo de la tarea en milisegundos, SCHEDULER_NO_PERIOD si solo corre
+ * al liberarla.
+ * @param deadline_ms Plazo máximo desde la liberación hasta que la tarea termina.
+ *
+ * @return int Identificador de la tarea o SCHEDULER_INVALID_TASK.
+ */
+int schedulerAddTask(schedulerTask_t task, const int period_ms, const int deadline_ms);
+
+/**
+ * @brief Libera una tarea ya, sin esperar a su periodo.
+ *
+ * Se puede llamar desde interrupciones: despierta al planificador si estaba durmiendo y la
+ * tarea se ejecuta en la próxima schedulerUpdate(). Sus liberaciones periódicas no cambian.
+ *
+ * @param task_id Identificador devuelto por schedulerAddTask().
+ */
+void schedulerRelease(const int task_id);
+
+/**
+ * @brief Cambia el periodo de una tarea.
+ *
+ * Se puede llamar desde la misma tarea. Con otro periodo la próxima liberación queda a
+ * period_ms de ahora; con el mismo no cambia nada.
+ *
+ * @param task_id Identificador devuelto por schedulerAddTask().
+ * @param period_ms Periodo en milisegundos, SCHEDULER_NO_PERIOD para que solo corra al liberarla.
+ */
+void schedulerSetPeriod(const int task_id, const int period_ms);
+
+/**
+ * @brief Ejecuta las tareas vencidas y duerme hasta la próxima liberación.
+ *
+ * Mientras duerme el RTOS deja al microcontrolador en reposo.
+ */
+void schedulerUpdate();
+
+/**
+ * @brief Reemplaza la espera entre liberaciones.
+ *
+ * Con un reloj virtual (rtcSetClockSource) la espera debe avanzar ese reloj
+ * en lugar de dormir. Con nullptr vuelve a dormir el hilo.
+ *
+ * @param idle Función que espera hasta el instante indicado.
+ */
+void schedulerSetIdleHook(schedulerIdle_t idle);
+
+/**
+ * @brief Cantidad de veces que la tarea terminó fuera de su plazo.
+ *
+ * @param task_id Identificador devuelto por schedulerAddTask().
+ *
+ * @return int Plazos incumplidos.
+ */
+int schedulerGetDeadlineMisses(const int task_id);
+
+//=====[#include guards - end]==========================================
+#endif
@@ -0,0 +1,496 @@
+/**
+* @file session_journal.cpp
+* @brief Implementación del diario de sesiones de secado en la flash interna.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "session_journal.h"
+#include "modules/rtc/rtc.h"
+#include "modules/heater/heater.h"
+#include "modules/temperature_sensor/temperature_sensor.h"
+#include "modules/telemetry_frame/telemetry_frame.h"
+#include "modules/event_log/event_log.h"
+#include "modules/flash_record/flash_record.h"
+
+//=====[Declaration of private defines]=================================
+#define JOURNAL_MAGIC   0x4C4E4A53  /**< "SJNL", cabecera de sector */
+#define JOURNAL_VERSION 1   /**< Versión del formato de los registros */
+#define JOURNAL_SECTORS 2   /**< Sectores que se alternan */
+#define JOURNAL_CRC_OFFSET  (SESSION_JOURNAL_RECORD_SIZE - 2)   /**< El CRC-16 va al final */
+#define US_PER_SECOND   1000000ULL
+#define SECONDS_PER_HOUR    3600
+
+// las herramientas de mbed definen la región del programa a partir de target.restrict_size
+#if defined(MBED_APP_START) && defined(MBED_APP_SIZE)
+static_assert(MBED_APP_START + MBED_APP_SIZE <= SESSION_JOURNAL_SECTOR_A, "el programa se superpone con el diario");
+#endif
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Estado de un sector del diario.
+ */
+typedef struct{
+    uint32_t address;   /**< Comienzo del sector */
+    uint32_t slots; /**< Lugares de registro contando la cabecera */
+    bool valid; /**< Tiene una cabecera válida */
+    uint32_t generation;    /**< Generación, crece en cada borrado */
+    uint32_t first_number;  /**< Número del registro del lugar 1 */
+}journalSector_t;
+
+/**
+ * @brief Sesión en curso.
+ */
+typedef struct{
+    bool active;    /**< Hay una sesión en curso */
+    uint64_t start_us;  /**< rtcNowUs() al iniciar */
+    int64_t temperature_sum;    /**< Suma de la temperatura de cada tick */
+    uint32_t ticks; /**< Ticks sumados */
+    uint32_t heater_ticks;  /**< Ticks con el calentador encendido */
+    int max_centi;  /**< Temperatura máxima */
+    int setpoint;   /**< Última consigna mientras secaba (al detener el sistema la restablece) */
+    int target_hours;   /**< Últimas horas mientras secaba */
+}journalTracker_t;
+
+//=====[Declaration and initialization of public global objects]========
+FlashIAP* journalFlash = nullptr;  /** Flash interna */
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+static journalSector_t sectors[JOURNAL_SECTORS];    /**< Los dos sectores */
+static int active_sector = 0;   /**< Sector en el que se agrega */
+static uint32_t next_slot = 0;  /**< Primer lugar libre del sector activo */
+static bool ready = false;  /**< El diario se abrió */
+static journalTracker_t tracker;    /**< Sesión en curso */
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Dirección de un lugar de un sector.
+ *
+ * @param sector Número de sector.
+ * @param slot Lugar, 0 es la cabecera.
+ *
+ * @return uint32_t Dirección.
+ */
+static uint32_t journalSlotAddress(const int sector, const uint32_t slot);
+
+/**
+ * @brief Lee y valida la cabecera de un sector.
+ *
+ * @param sector Número de sector.
+ */
+static void journalReadHeader(const int sector);
+
+/**
+ * @brief Borra un sector y escribe su cabecera.
+ *
+ * @param sector Número de sector.
+ * @param generation Generación nueva.
+ * @param first_number Número del primer registro que tendrá.
+ *
+ * @return true si se borró y programó.
+ */
+static bool journalFormat(const int sector, const uint32_t generation, const uint32_t first_number);
+
+/**
+ * @brief Busca por bisección el primer lugar libre del sector activo.
+ *
+ * @return uint32_t Lugar, sectors[active_sector].slots si está lleno.
+ */
+static uint32_t journalFindTail();
+
+/**
+ * @brief Arma el resumen de la sesión en curso.
+ *
+ * @param end Cómo terminó.
+ * @param record Destino.
+ */
+static void journalBuildRecord(sessionJournalEnd_t end, sessionJournalRecord_t *record);
+
+/**
+ * @brief Cierra la sesión en curso y la agrega al diario.
+ *
+ * @param end Cómo terminó.
+ */
+static void journalCloseSession(sessionJournalEnd_t end);
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Abre el diario: elige el sector activo y busca la posición libre.
+ *
+ * Si ningún sector tiene una cabecera válida borra el primero y empieza vacío.
+ *
+ * @return true si la flash responde y el diario quedó listo.
+ */
+bool sessionJournalInit(){
+    const uint32_t addresses[JOURNAL_SECTORS] = {SESSION_JOURNAL_SECTOR_A, SESSION_JOURNAL_SECTOR_B};
+
+    ready = false;
+    tracker.active = false;
+
+    if(journalFlash == nullptr){
+        journalFlash = new FlashIAP();
+    }
+
+    // un registro tiene que ser una sola programación
+    if(journalFlash->init() != 0 or SESSION_JOURNAL_RECORD_SIZE % journalFlash->get_page_size() != 0){
+        return false;
+    }
+
+    for(int i = 0; i < JOURNAL_SECTORS; i++){
+        sectors[i].address = addresses[i];
+        sectors[i].slots = journalFlash->get_sector_size(addresses[i]) / SESSION_JOURNAL_RECORD_SIZE;
+
+        if(sectors[i].slots < 2){
+            return false;
+        }
+
+        journalReadHeader(i);
+    }
+
+    // el activo es el de la generación más alta, el otro tiene los registros anteriores
+    if(sectors[0].valid and sectors[1].valid){
+        active_sector = (sectors[1].generation > sectors[0].generation) ? 1 : 0;
+    }else if(sectors[0].valid or sectors[1].valid){
+        active_sector = sectors[0].valid ? 0 : 1;
+    }else{
+        active_sector = 0;
+
+        if(not journalFormat(0, 1, 0)){
+            return false;
+        }
+    }
+
+    next_slot = journalFindTail();
+    ready = true;
+
+    return true;
+}
+
+/**
+ * @brief Sigue la sesión en curso y agrega su registro al terminar.
+ *
+ * Se llama en cada tick del sistema, después de la máquina de estados.
+ *
+ * @param state Estado del sistema.
+ * @param work_temperature Temperatura de secado.
+ * @param activity_time Horas de secado.
+ */
+void sessionJournalUpdate(systemState_t state, const int work_temperature, const int activity_time){
+
+    if(state != SYSTEM_WORK){
+
+        // systemWorking() pasa a SYSTEM_FINISH al cumplir el tiempo, el resto es una detención
+        if(tracker.active){
+            journalCloseSession((state == SYSTEM_FINISH or state == SYSTEM_FINISH_AWAIT) ? SESSION_JOURNAL_FINISHED : SESSION_JOURNAL_STOPPED);
+        }
+
+        return;
+    }
+
+    int temperature = temperatureSensorReadCentiCelsius();
+
+    if(not tracker.active){
+        tracker.active = true;
+        tracker.start_us = rtcNowUs();
+        tracker.temperature_sum = 0;
+        tracker.ticks = 0;
+        tracker.heater_ticks = 0;
+        tracker.max_centi = temperature;
+    }
+
+    tracker.temperature_sum = tracker.temperature_sum + temperature;
+    tracker.ticks = tracker.ticks + 1;
+
+    if(heaterStatus()){
+        tracker.heater_ticks = tracker.heater_ticks + 1;
+    }
+
+    if(temperature > tracker.max_centi){
+        tracker.max_centi = temperature;
+    }
+
+    tracker.setpoint = work_temperature;
+    tracker.target_hours = activity_time;
+}
+
+/**
+ * @brief Resumen de la sesión en curso hasta el momento, sin agregarlo al diario.
+ *
+ * @param record Destino, el número queda en 0 y el fin en SESSION_JOURNAL_POWER_LOSS.
+ *
+ * @return true si hay una sesión en curso.
+ */
+bool sessionJournalGetCurrent(sessionJournalRecord_t *record){
+
+    if(not tracker.active){
+        return false;
+    }
+
+    // si se corta la energía así es como terminaría
+    journalBuildRecord(SESSION_JOURNAL_POWER_LOSS, record);
+
+    return true;
+}
+
+/**
+ * @brief Agrega un registro con una sola programación de la flash.
+ *
+ * Si el sector activo está lleno borra el otro antes (bloquea mientras dura el borrado).
+ *
+ * @param record Registro, el número lo asigna el diario.
+ *
+ * @return true si se programó.
+ */
+bool sessionJournalAppend(const sessionJournalRecord_t *record){
+    uint8_t data[SESSION_JOURNAL_RECORD_SIZE];
+    uint32_t number;
+
+    if(not ready){
+        return false;
+    }
+
+    // sector lleno: el otro, que tiene los registros más viejos, pasa a ser el activo
+    if(next_slot >= sectors[active_sector].slots){
+        int other = 1 - active_sector;
+
+        if(not journalFormat(other, sectors[active_sector].generation + 1, sessionJournalGetCount())){
+            return false;
+        }
+
+        active_sector = other;
+        next_slot = 1;
+    }
+
+    number = sessionJournalGetCount();
+
+    memset(data, 0xFF, sizeof(data));
+    flashRecordPut(&data[0], number, 4);
+    flashRecordPut(&data[4], record->boot, 2);
+    flashRecordPut(&data[6], record->end, 1);
+    flashRecordPut(&data[7], record->setpoint, 1);
+    flashRecordPut(&data[8], record->target_hours, 1);
+    flashRecordPut(&data[9], JOURNAL_VERSION, 1);
+    flashRecordPut(&data[10], record->start_s, 4);
+    flashRecordPut(&data[14], record->duration_s, 4);
+    flashRecordPut(&data[18], record->heater_on_s, 4);
+    flashRecordPut(&data[22], (uint16_t)record->mean_centi, 2);
+    flashRecordPut(&data[24], (uint16_t)record->max_centi, 2);
+    flashRecordPut(&data[26], record->energy_wh, 2);
+    flashRecordPut(&data[JOURNAL_CRC_OFFSET], telemetryFrameCrc16(data, JOURNAL_CRC_OFFSET), 2);
+
+    // el lugar se consume aunque falle, un registro a medias no se vuelve a programar encima
+    uint32_t address = journalSlotAddress(active_sector, next_slot);
+
+    next_slot = next_slot + 1;
+
+    return journalFlash->program(data, address, sizeof(data)) == 0;
+}
+
+/**
+ * @brief Registros agregados desde que se creó el diario.
+ *
+ * @return uint32_t Número que tendrá el próximo registro.
+ */
+uint32_t sessionJournalGetCount(){
+
+    if(not ready){
+        return 0;
+    }
+
+    // el número sale de la posición, no hace falta leer el último registro
+    return sectors[active_sector].first_number + next_slot - 1;
+}
+
+/**
+ * @brief Número del registro más viejo que sigue en la flash.
+ *
+ * @return uint32_t Número de registro.
+ */
+uint32_t sessionJournalGetOldest(){
+    const journalSector_t *previous = &sectors[1 - active_sector];
+
+    if(not ready){
+        return 0;
+    }
+
+    if(previous->valid and previous->generation + 1 == sectors[active_sector].generation){
+        return previous->first_number;
+    }
+
+    return sectors[active_sector].first_number;
+}
+
+/**
+ * @brief Lee un registro por su número.
+ *
+ * @param number Número, de sessionJournalGetOldest() a sessionJournalGetCount() - 1.
+ * @param record Destino.
+ *
+ * @return true si el registro existe y su CRC es válido.
+ */
+bool sessionJournalRead(const uint32_t number, sessionJournalRecord_t *record){
+    uint8_t data[SESSION_JOURNAL_RECORD_SIZE];
+    int sector = active_sector;
+
+    if(not ready or number < sessionJournalGetOldest() or number >= sessionJournalGetCount()){
+        return false;
+    }
+
+    if(number < sectors[active_sector].first_number){
+        sector = 1 - active_sector;
+    }
+
+    if(journalFlash->read(data, journalSlotAddress(sector, number - sectors[sector].first_number + 1), sizeof(data)) != 0){
+        return false;
+    }
+
+    if(flashRecordGet(&data[JOURNAL_CRC_OFFSET], 2) != telemetryFrameCrc16(data, JOURNAL_CRC_OFFSET) or flashRecordGet(&data[0], 4) != number){
+        return false;
+    }
+
+    record->number = number;
+    record->boot = flashRecordGet(&data[4], 2);
+    record->end = flashRecordGet(&data[6], 1);
+    record->setpoint = flashRecordGet(&data[7], 1);
+    record->target_hours = flashRecordGet(&data[8], 1);
+    record->start_s = flashRecordGet(&data[10], 4);
+    record->duration_s = flashRecordGet(&data[14], 4);
+    record->heater_on_s = flashRecordGet(&data[18], 4);
+    record->mean_centi = (int16_t)flashRecordGet(&data[22], 2);
+    record->max_centi = (int16_t)flashRecordGet(&data[24], 2);
+    record->energy_wh = flashRecordGet(&data[26], 2);
+
+    return true;
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Dirección de un lugar de un sector.
+ *
+ * @param sector Número de sector.
+ * @param slot Lugar, 0 es la cabecera.
+ *
+ * @return uint32_t Dirección.
+ */
+static uint32_t journalSlotAddress(const int sector, const uint32_t slot){
+    return sectors[sector].address + slot * SESSION_JOURNAL_RECORD_SIZE;
+}
+
+/**
+ * @brief Lee y valida la cabecera de un sector.
+ *
+ * @param sector Número de sector.
+ */
+static void journalReadHeader(const int sector){
+    uint8_t data[SESSION_JOURNAL_RECORD_SIZE];
+
+    sectors[sector].valid = false;
+
+    if(journalFlash->read(data, sectors[sector].address, sizeof(data)) != 0){
+        return;
+    }
+
+    if(flashRecordGet(&data[0], 4) != JOURNAL_MAGIC or flashRecordGet(&data[JOURNAL_CRC_OFFSET], 2) != telemetryFrameCrc16(data, JOURNAL_CRC_OFFSET)){
+        return;
+    }
+
+    sectors[sector].generation = flashRecordGet(&data[4], 4);
+    sectors[sector].first_number = flashRecordGet(&data[8], 4);
+    sectors[sector].valid = true;
+}
+
+/**
+ * @brief Borra un sector y escribe su cabecera.
+ *
+ * @param sector Número de sector.
+ * @param generation Generación nueva.
+ * @param first_number Número del primer registro que tendrá.
+ *
+ * @return true si se borró y programó.
+ */
+static bool journalFormat(const int sector, const uint32_t generation, const uint32_t first_number){
+    uint32_t size = sectors[sector].slots * SESSION_JOURNAL_RECORD_SIZE;
+    uint8_t data[SESSION_JOURNAL_RECORD_SIZE];
+
+    sectors[sector].valid = false;
+
+    if(journalFlash->erase(sectors[sector].address, size) != 0){
+        return false;
+    }
+
+    memset(data, 0xFF, sizeof(data));
+    flashRecordPut(&data[0], JOURNAL_MAGIC, 4);
+    flashRecordPut(&data[4], generation, 4);
+    flashRecordPut(&data[8], first_number, 4);
+    flashRecordPut(&data[12], SESSION_JOURNAL_RECORD_SIZE, 2);
+    flashRecordPut(&data[14], JOURNAL_VERSION, 1);
+    flashRecordPut(&data[JOURNAL_CRC_OFFSET], telemetryFrameCrc16(data, JOURNAL_CRC_OFFSET), 2);
+
+    // hasta que la cabecera está completa el sector no cuenta, un corte acá deja el anterior activo
+    if(journalFlash->program(data, sectors[sector].address, sizeof(data)) != 0){
+        return false;
+    }
+
+    sectors[sector].generation = generation;
+    sectors[sector].first_number = first_number;
+    sectors[sector].valid = true;
+
+    return true;
+}
+
+/**
+ * @brief Busca por bisección el primer lugar libre del sector activo.
+ *
+ * @return uint32_t Lugar, sectors[active_sector].slots si está lleno.
+ */
+static uint32_t journalFindTail(){
+    // el lugar 0 es la cabecera
+    return flashRecordFindTail(journalFlash, sectors[active_sector].address, SESSION_JOURNAL_RECORD_SIZE, 1, sectors[active_sector].slots);
+}
+
+/**
+ * @brief Arma el resumen de la sesión en curso.
+ *
+ * @param end Cómo terminó.
+ * @param record Destino.
+ */
+static void journalBuildRecord(sessionJournalEnd_t end, sessionJournalRecord_t *record){
+    uint64_t duration_us = rtcNowUs() - tracker.start_us;
+    uint32_t heater_on_s = 0;
+
+    // la fracción de ticks con el calentador encendido sobre la duración medida
+    if(tracker.ticks > 0){
+        heater_on_s = (uint64_t)tracker.heater_ticks * (duration_us / US_PER_SECOND) / tracker.ticks;
+    }
+
+    record->number = 0;
+    record->boot = eventLogGetBoots();
+    record->end = end;
+    record->setpoint = tracker.setpoint;
+    record->target_hours = tracker.target_hours;
+    record->start_s = tracker.start_us / US_PER_SECOND;
+    record->duration_s = duration_us / US_PER_SECOND;
+    record->heater_on_s = heater_on_s;
+    record->mean_centi = (tracker.ticks > 0) ? tracker.temperature_sum / tracker.ticks : 0;
+    record->max_centi = tracker.max_centi;
+    record->energy_wh = (uint32_t)heater_on_s * SESSION_JOURNAL_HEATER_W / SECONDS_PER_HOUR;
+}
+
+/**
+ * @brief Cierra la sesión en curso y la agrega al diario.
+ *
+ * @param end Cómo terminó.
+ */
+static void journalCloseSession(sessionJournalEnd_t end){
+    sessionJournalRecord_t record;
+
+    journalBuildRecord(end, &record);
+    tracker.active = false;
+
+    sessionJournalAppend(&record);
+}
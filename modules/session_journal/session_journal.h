@@ -0,0 +1,139 @@
+/**
+* @file session_journal.h
+* @brief Declaraciones del diario de sesiones de secado en la flash interna.
+*
+* Al terminar cada secado se agrega un registro de SESSION_JOURNAL_RECORD_SIZE bytes con
+* una sola programación. Se usan dos sectores que se alternan: los registros se agregan
+* uno tras otro en el sector activo y cuando se llena se borra el otro, que pasa a ser el
+* activo con una generación mayor. Así cada sector se borra una vez cada dos llenados y
+* ningún byte se reescribe.
+*
+* Cada sector empieza con una cabecera (generación y número del primer registro). Al
+* arrancar se elige el sector con la generación válida más alta y la posición libre se
+* busca por bisección (los registros escritos quedan antes que los borrados), leyendo
+* unos pocos registros en lugar de toda la región. Un registro cortado por falta de
+* energía queda con CRC inválido y se saltea.
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _SESSION_JOURNAL_H_
+#define _SESSION_JOURNAL_H_
+
+#include "mbed.h"
+#include "modules/filament_dryer_system/filament_dryer_system.h"
+
+//=====[Declaration of private defines]=================================
+// Si no esta declarado el primer sector del diario (sector 6 del STM32F401RE, el programa debe terminar antes del sector 5)
+#ifndef SESSION_JOURNAL_SECTOR_A
+#define SESSION_JOURNAL_SECTOR_A    0x08040000
+#endif
+
+// Si no esta declarado el segundo sector del diario (sector 7 del STM32F401RE)
+#ifndef SESSION_JOURNAL_SECTOR_B
+#define SESSION_JOURNAL_SECTOR_B    0x08060000
+#endif
+
+// Si no esta declarada la potencia de la hotbed para estimar la energía
+#ifndef SESSION_JOURNAL_HEATER_W
+#define SESSION_JOURNAL_HEATER_W    120
+#endif
+
+#define SESSION_JOURNAL_RECORD_SIZE 32  /**< Bytes de cada registro y de la cabecera de sector */
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Cómo terminó una sesión.
+ */
+typedef enum{
+    SESSION_JOURNAL_FINISHED = 1,   /**< Se cumplió el tiempo de secado (systemWorking()) */
+    SESSION_JOURNAL_STOPPED,    /**< Detenida por el usuario (SYSTEM_STOP) */
+    SESSION_JOURNAL_POWER_LOSS  /**< Se cortó la energía durante el secado */
+}sessionJournalEnd_t;
+
+/**
+ * @brief Resumen de una sesión de secado.
+ */
+typedef struct{
+    uint32_t number;    /**< Número de registro, lo asigna el diario */
+    uint16_t boot;  /**< Arranque en que empezó (eventLogGetBoots()) */
+    uint8_t end;    /**< sessionJournalEnd_t */
+    uint8_t setpoint;   /**< Consigna en grados */
+    uint8_t target_hours;   /**< Horas de secado configuradas */
+    uint32_t start_s;   /**< Segundos desde el arranque al iniciar */
+    uint32_t duration_s;    /**< Duración */
+    uint32_t heater_on_s;   /**< Tiempo con el calentador encendido */
+    int16_t mean_centi; /**< Temperatura media en centésimas de grado */
+    int16_t max_centi;  /**< Temperatura máxima en centésimas de grado */
+    uint16_t energy_wh; /**< Energía estimada con SESSION_JOURNAL_HEATER_W */
+}sessionJournalRecord_t;
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Abre el diario: elige el sector activo y busca la posición libre.
+ *
+ * Si ningún sector tiene una cabecera válida borra el primero y empieza vacío.
+ *
+ * @return true si la flash responde y el diario quedó listo.
+ */
+bool sessionJournalInit();
+
+/**
+ * @brief Sigue la sesión en curso y agrega su registro al terminar.
+ *
+ * Se llama en cada tick del sistema, después de la máquina de estados.
+ *
+ * @param state Estado del sistema.
+ * @param work_temperature Temperatura de secado.
+ * @param activity_time Horas de secado.
+ */
+void sessionJournalUpdate(systemState_t state, const int work_temperature, const int activity_time);
+
+/**
+ * @brief Resumen de la sesión en curso hasta el momento, sin agregarlo al diario.
+ *
+ * @param record Destino, el número queda en 0 y el fin en SESSION_JOURNAL_POWER_LOSS.
+ *
+ * @return true si hay una sesión en curso.
+ */
+bool sessionJournalGetCurrent(sessionJournalRecord_t *record);
+
+/**
+ * @brief Agrega un registro con una sola programación de la flash.
+ *
+ * Si el sector activo está lleno borra el otro antes (bloquea mientras dura el borrado).
+ *
+ * @param record Registro, el número lo asigna el diario.
+ *
+ * @return true si se programó.
+ */
+bool sessionJournalAppend(const sessionJournalRecord_t *record);
+
+/**
+ * @brief Registros agregados desde que se creó el diario.
+ *
+ * @return uint32_t Número que tendrá el próximo registro.
+ */
+uint32_t sessionJournalGetCount();
+
+/**
+ * @brief Número del registro más viejo que sigue en la flash.
+ *
+ * @return uint32_t Número de registro.
+ */
+uint32_t sessionJournalGetOldest();
+
+/**
+ * @brief Lee un registro por su número.
+ *
+ * @param number Número, de sessionJournalGetOldest() a sessionJournalGetCount() - 1.
+ * @param record Destino.
+ *
+ * @return true si el registro existe y su CRC es válido.
+ */
+bool sessionJournalRead(const uint32_t number, sessionJournalRecord_t *record);
+
+//=====[#include guards - end]==========================================
+#endif
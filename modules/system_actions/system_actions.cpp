@@ -0,0 +1,239 @@
+/**
+* @file system_actions.cpp
+* @brief Implementación de las transiciones y los valores de secado compartidos por el teclado y los comandos por uart.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "system_actions.h"
+#include "modules/system_fsm/system_fsm.h"
+#include "modules/event_bus/event_bus.h"
+
+//=====[Declaration of private defines]=================================
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+static int work_temperature = MIN_TEMP; /**< Temperatura de secado */
+static int activity_time = MIN_TIME;    /**< Horas de secado */
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Publica la temperatura y las horas de secado en el bus.
+ */
+static void systemActionPublishSettings();
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Inicializa la temperatura y las horas de secado en los mínimos.
+ *
+ * Se llama después de eventBusInit(), publica los valores iniciales.
+ */
+void systemActionInit(){
+    work_temperature = MIN_TEMP;
+    activity_time = MIN_TIME;
+
+    systemActionPublishSettings();
+}
+
+/**
+ * @brief Arranca el secado si está detenido o terminó.
+ *
+ * @return true si pasó a SYSTEM_WORK.
+ */
+bool systemActionStart(){
+    // la tabla lo acepta detenido o terminado, SYSTEM_ON y SYSTEM_FINISH duran un ciclo y lo ignoran
+    return systemFsmDispatch(SYSTEM_EVENT_START);
+}
+
+/**
+ * @brief Detiene el secado en curso.
+ *
+ * @return true si pasó a SYSTEM_STOP.
+ */
+bool systemActionStop(){
+    return systemFsmDispatch(SYSTEM_EVENT_STOP);
+}
+
+/**
+ * @brief Arranca o detiene el secado, como el botón de arranque/parada.
+ */
+void systemActionRunStop(){
+
+    // en cada estado la tabla acepta a lo sumo uno de los dos
+    if(not systemActionStop()){
+        systemActionStart();
+    }
+}
+
+/**
+ * @brief Indica si se pueden cambiar la temperatura y las horas de secado.
+ *
+ * Detenido el sistema vuelve a los mínimos al entrar en SYSTEM_STOP, los valores se
+ * fijan secando, al terminar o con el comando start.
+ *
+ * @return true secando o con el secado terminado.
+ */
+bool systemActionCanAdjust(){
+    systemState_t state = systemFsmReadState();
+
+    return state == SYSTEM_WORK or state == SYSTEM_FINISH_AWAIT;
+}
+
+/**
+ * @brief Incrementa el valor actual dentro de un límite especificado.
+ *
+ * Incrementa el valor actual por un valor de incremento dado,
+ * asegurándose de que no se exceda el valor límite.
+ *
+ * @param actualValue Puntero al valor actual que se va a incrementar.
+ * @param incrementValue Valor de incremento.
+ * @param limitValue Valor límite máximo.
+ */
+void systemActionIncrease(int *actualValue, const int incrementValue, const int limitValue){
+
+    if(*actualValue < limitValue){
+        *actualValue = *actualValue + incrementValue;
+    }
+
+}
+
+/**
+ * @brief Decrementa el valor actual dentro de un límite especificado.
+ *
+ * Decrementa el valor actual por un valor de decremento dado,
+ * asegurándose de que no se baje del valor límite.
+ *
+ * @param actualValue Puntero al valor actual que se va a decrementar.
+ * @param incrementValue Valor de decremento.
+ * @param limitValue Valor límite mínimo.
+ */
+void systemActionDecrease(int *actualValue, const int incrementValue, const int limitValue){
+
+    if(*actualValue > limitValue){
+        *actualValue = *actualValue - incrementValue;
+    }
+
+}
+
+/**
+ * @brief Fija la temperatura de secado.
+ *
+ * Publica EVENT_BUS_SETTINGS si cambió.
+ *
+ * @param temperature Temperatura nueva, entre MIN_TEMP y MAX_TEMP.
+ *
+ * @return true si estaba dentro del rango.
+ */
+bool systemActionSetTemperature(const int temperature){
+
+    if(temperature < MIN_TEMP or temperature > MAX_TEMP){
+        return false;
+    }
+
+    if(temperature != work_temperature){
+        work_temperature = temperature;
+        systemActionPublishSettings();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Fija las horas de secado.
+ *
+ * Publica EVENT_BUS_SETTINGS si cambiaron.
+ *
+ * @param hours Horas nuevas, entre MIN_TIME y MAX_TIME.
+ *
+ * @return true si estaban dentro del rango.
+ */
+bool systemActionSetHours(const int hours){
+
+    if(hours < MIN_TIME or hours > MAX_TIME){
+        return false;
+    }
+
+    if(hours != activity_time){
+        activity_time = hours;
+        systemActionPublishSettings();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Vuelve la temperatura y las horas de secado a los mínimos.
+ */
+void systemActionResetSettings(){
+    systemActionSetTemperature(MIN_TEMP);
+    systemActionSetHours(MIN_TIME);
+}
+
+/**
+ * @brief Sube o baja un paso la temperatura o las horas de secado, dentro de los límites.
+ *
+ * @param setting TEMPERATURE o TIME.
+ * @param increase true para subir, false para bajar.
+ */
+void systemActionStep(adjustState_t setting, const bool increase){
+    int temperature = work_temperature;
+    int hours = activity_time;
+
+    switch (setting){
+        case TEMPERATURE:
+
+            if(increase){
+                systemActionIncrease(&temperature, INCREMENT_TEMP, MAX_TEMP);
+            }else{
+                systemActionDecrease(&temperature, INCREMENT_TEMP, MIN_TEMP);
+            }
+
+            systemActionSetTemperature(temperature);
+        break;
+
+        case TIME:
+
+            if(increase){
+                systemActionIncrease(&hours, INCREMENT_TIME, MAX_TIME);
+            }else{
+                systemActionDecrease(&hours, INCREMENT_TIME, MIN_TIME);
+            }
+
+            systemActionSetHours(hours);
+        break;
+    }
+}
+
+/**
+ * @brief Temperatura de secado.
+ *
+ * @return int Grados Celsius.
+ */
+int systemActionGetTemperature(){
+    return work_temperature;
+}
+
+/**
+ * @brief Horas de secado.
+ *
+ * @return int Horas.
+ */
+int systemActionGetHours(){
+    return activity_time;
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Publica la temperatura y las horas de secado en el bus.
+ */
+static void systemActionPublishSettings(){
+    eventBusPublish(EVENT_BUS_SETTINGS, work_temperature, activity_time);
+}
@@ -0,0 +1,130 @@
+/**
+* @file system_actions.h
+* @brief Declaraciones de las transiciones y los valores de secado compartidos por el teclado y los comandos por uart.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _SYSTEM_ACTIONS_H_
+#define _SYSTEM_ACTIONS_H_
+
+#include "mbed.h"
+#include "modules/filament_dryer_system/filament_dryer_system.h"
+
+//=====[Declaration of private defines]=================================
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Inicializa la temperatura y las horas de secado en los mínimos.
+ *
+ * Se llama después de eventBusInit(), publica los valores iniciales.
+ */
+void systemActionInit();
+
+/**
+ * @brief Arranca el secado si está detenido o terminó.
+ *
+ * @return true si pasó a SYSTEM_WORK.
+ */
+bool systemActionStart();
+
+/**
+ * @brief Detiene el secado en curso.
+ *
+ * @return true si pasó a SYSTEM_STOP.
+ */
+bool systemActionStop();
+
+/**
+ * @brief Arranca o detiene el secado, como el botón de arranque/parada.
+ */
+void systemActionRunStop();
+
+/**
+ * @brief Indica si se pueden cambiar la temperatura y las horas de secado.
+ *
+ * Detenido el sistema vuelve a los mínimos al entrar en SYSTEM_STOP, los valores se
+ * fijan secando, al terminar o con el comando start.
+ *
+ * @return true secando o con el secado terminado.
+ */
+bool systemActionCanAdjust();
+
+/**
+ * @brief Incrementa el valor actual dentro de un límite especificado.
+ *
+ * Incrementa el valor actual por un valor de incremento dado,
+ * asegurándose de que no se exceda el valor límite.
+ *
+ * @param actualValue Puntero al valor actual que se va a incrementar.
+ * @param incrementValue Valor de incremento.
+ * @param limitValue Valor límite máximo.
+ */
+void systemActionIncrease(int *actualValue, const int incrementValue, const int limitValue);
+
+/**
+ * @brief Decrementa el valor actual dentro de un límite especificado.
+ *
+ * Decrementa el valor actual por un valor de decremento dado,
+ * asegurándose de que no se baje del valor límite.
+ *
+ * @param actualValue Puntero al valor actual que se va a decrementar.
+ * @param incrementValue Valor de decremento.
+ * @param limitValue Valor límite mínimo.
+ */
+void systemActionDecrease(int *actualValue, const int incrementValue, const int limitValue);
+
+/**
+ * @brief Fija la temperatura de secado.
+ *
+ * Publica EVENT_BUS_SETTINGS si cambió.
+ *
+ * @param temperature Temperatura nueva, entre MIN_TEMP y MAX_TEMP.
+ *
+ * @return true si estaba dentro del rango.
+ */
+bool systemActionSetTemperature(const int temperature);
+
+/**
+ * @brief Fija las horas de secado.
+ *
+ * Publica EVENT_BUS_SETTINGS si cambiaron.
+ *
+ * @param hours Horas nuevas, entre MIN_TIME y MAX_TIME.
+ *
+ * @return true si estaban dentro del rango.
+ */
+bool systemActionSetHours(const int hours);
+
+/**
+ * @brief Vuelve la temperatura y las horas de secado a los mínimos.
+ */
+void systemActionResetSettings();
+
+/**
+ * @brief Sube o baja un paso la temperatura o las horas de secado, dentro de los límites.
+ *
+ * @param setting TEMPERATURE o TIME.
+ * @param increase true para subir, false para bajar.
+ */
+void systemActionStep(adjustState_t setting, const bool increase);
+
+/**
+ * @brief Temperatura de secado.
+ *
+ * @return int Grados Celsius.
+ */
+int systemActionGetTemperature();
+
+/**
+ * @brief Horas de secado.
+ *
+ * @return int Horas.
+ */
+int systemActionGetHours();
+
+//=====[#include guards - end]==========================================
+#endif
@@ -0,0 +1,154 @@
+/**
+* @file system_fsm.cpp
+* @brief Implementación de la máquina de estados del sistema guiada por tablas.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "system_fsm.h"
+#include "modules/event_log/event_log.h"
+#include "modules/event_bus/event_bus.h"
+
+//=====[Declaration of private defines]=================================
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+static const systemFsmTransition_t *fsm_transitions = nullptr;  /**< Tabla de transiciones */
+static int fsm_transition_count = 0;    /**< Filas de la tabla de transiciones */
+static const systemFsmState_t *fsm_states = nullptr;    /**< Acciones de cada estado */
+static systemState_t fsm_state = SYSTEM_ON; /**< Estado actual */
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Busca la fila del estado actual para un evento.
+ *
+ * @param event Evento.
+ *
+ * @return const systemFsmTransition_t* Fila o nullptr si el evento no se acepta.
+ */
+static const systemFsmTransition_t *systemFsmFind(systemEvent_t event);
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Toma las tablas y entra al estado inicial.
+ *
+ * Ejecuta la acción de entrada del estado inicial, los módulos que usa ya deben estar inicializados,
+ * y lo publica en el bus de eventos con el mismo estado como anterior.
+ *
+ * @param transitions Tabla de transiciones, debe existir mientras se use la máquina.
+ * @param transition_count Filas de la tabla de transiciones.
+ * @param states Tabla de estados, uno por estado en el orden de systemState_t.
+ * @param initial Estado inicial.
+ */
+void systemFsmInit(const systemFsmTransition_t *transitions, const int transition_count, const systemFsmState_t *states, systemState_t initial){
+    fsm_transitions = transitions;
+    fsm_transition_count = transition_count;
+    fsm_states = states;
+    fsm_state = initial;
+
+    if(fsm_states[fsm_state].entry != nullptr){
+        fsm_states[fsm_state].entry(initial, initial);
+    }
+
+    eventBusPublish(EVENT_BUS_STATE, initial, initial);
+}
+
+/**
+ * @brief Envía un evento.
+ *
+ * Si el estado actual tiene una fila para el evento ejecuta la salida, la acción de la
+ * transición y la entrada, registra el cambio en el registro de eventos y lo publica en el bus.
+ *
+ * @param event Evento.
+ *
+ * @return true si hubo transición, false si el evento no se acepta en el estado actual.
+ */
+bool systemFsmDispatch(systemEvent_t event){
+    const systemFsmTransition_t *transition = systemFsmFind(event);
+
+    if(transition == nullptr){
+        return false;
+    }
+
+    systemState_t from = transition->from;
+    systemState_t to = transition->to;
+
+    if(fsm_states[from].exit != nullptr){
+        fsm_states[from].exit(from, to);
+    }
+
+    if(transition->action != nullptr){
+        transition->action(from, to);
+    }
+
+    fsm_state = to;
+
+    if(fsm_states[to].entry != nullptr){
+        fsm_states[to].entry(from, to);
+    }
+
+    eventLogWrite(EVENT_LOG_STATE, (from << 8) | to);
+    eventBusPublish(EVENT_BUS_STATE, to, from);
+
+    return true;
+}
+
+/**
+ * @brief Indica si un evento se aceptaría en el estado actual, sin enviarlo.
+ *
+ * @param event Evento.
+ *
+ * @return true si hay una fila para el estado actual y el evento.
+ */
+bool systemFsmAccepts(systemEvent_t event){
+    return systemFsmFind(event) != nullptr;
+}
+
+/**
+ * @brief Ejecuta la acción del estado activo.
+ *
+ * Se llama en cada tick de la tarea del sistema.
+ */
+void systemFsmUpdate(){
+
+    if(fsm_states[fsm_state].during != nullptr){
+        fsm_states[fsm_state].during(fsm_state, fsm_state);
+    }
+}
+
+/**
+ * @brief Estado actual.
+ *
+ * @return systemState_t Estado.
+ */
+systemState_t systemFsmReadState(){
+    return fsm_state;
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Busca la fila del estado actual para un evento.
+ *
+ * @param event Evento.
+ *
+ * @return const systemFsmTransition_t* Fila o nullptr si el evento no se acepta.
+ */
+static const systemFsmTransition_t *systemFsmFind(systemEvent_t event){
+
+    for(int i = 0; i < fsm_transition_count; i++){
+
+        if(fsm_transitions[i].from == fsm_state and fsm_transitions[i].event == event){
+            return &fsm_transitions[i];
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,166 @@
+/**
+* @file system_fsm.h
+* @brief Declaraciones de la máquina de estados del sistema guiada por tablas.
+*
+* Las transiciones son una tabla constante de filas (estado, evento, estado siguiente,
+* acción) y cada estado tiene acciones de entrada, de salida y mientras está activo.
+* Los demás módulos no escriben el estado: envían eventos con systemFsmDispatch() y un
+* evento que no tiene fila para el estado actual se descarta, por lo que una transición
+* que no está en la tabla no puede ocurrir.
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _SYSTEM_FSM_H_
+#define _SYSTEM_FSM_H_
+
+#include "mbed.h"
+#include "modules/filament_dryer_system/filament_dryer_system.h"
+
+//=====[Declaration of private defines]=================================
+#define SYSTEM_FSM_STATES   (SYSTEM_FINISH_AWAIT + 1)   /**< Cantidad de estados de systemState_t */
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Eventos que mueven la máquina de estados.
+ */
+typedef enum{
+    SYSTEM_EVENT_BOOTED,    /**< Terminó el encendido */
+    SYSTEM_EVENT_RESUME,    /**< Al encender había un secado cortado por falta de energía */
+    SYSTEM_EVENT_START, /**< Arranque pedido por el teclado o un comando */
+    SYSTEM_EVENT_STOP,  /**< Parada pedida por el teclado o un comando */
+    SYSTEM_EVENT_TIME_UP,   /**< Se cumplieron las horas de secado */
+    SYSTEM_EVENT_FINISHED   /**< Se avisó el fin del secado */
+}systemEvent_t;
+
+/**
+ * @brief Acción de una transición o de un estado.
+ *
+ * @param from Estado de origen de la transición (el actual para las acciones mientras está activo).
+ * @param to Estado de destino de la transición (el actual para las acciones mientras está activo).
+ */
+typedef void (*systemFsmAction_t)(systemState_t from, systemState_t to);
+
+/**
+ * @brief Fila de la tabla de transiciones.
+ */
+typedef struct{
+    systemState_t from; /**< Estado en que se acepta el evento */
+    systemEvent_t event;    /**< Evento */
+    systemState_t to;   /**< Estado siguiente */
+    systemFsmAction_t action;   /**< Acción de la transición, entre la salida y la entrada, o nullptr */
+}systemFsmTransition_t;
+
+/**
+ * @brief Acciones de un estado, nullptr si no tiene.
+ */
+typedef struct{
+    systemState_t state;    /**< Estado, la tabla va en el orden de systemState_t */
+    systemFsmAction_t entry;    /**< Al entrar, no debe enviar eventos */
+    systemFsmAction_t exit; /**< Al salir, no debe enviar eventos */
+    systemFsmAction_t during;   /**< En cada systemFsmUpdate() mientras está activo, puede enviar eventos */
+}systemFsmState_t;
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Indica si ningún par (estado, evento) aparece dos veces en la tabla.
+ *
+ * Se usa con static_assert sobre la tabla constexpr.
+ *
+ * @param transitions Tabla de transiciones.
+ * @param count Filas de la tabla.
+ *
+ * @return true si para cada estado y evento hay a lo sumo una transición.
+ */
+constexpr bool systemFsmIsDeterministic(const systemFsmTransition_t *transitions, const int count){
+
+    for(int i = 0; i < count; i++){
+        for(int j = i + 1; j < count; j++){
+
+            if(transitions[i].from == transitions[j].from and transitions[i].event == transitions[j].event){
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Indica si la tabla de estados tiene uno por estado en el orden de systemState_t.
+ *
+ * Se usa con static_assert sobre la tabla constexpr.
+ *
+ * @param states Tabla de estados.
+ * @param count Filas de la tabla.
+ *
+ * @return true si la fila n es el estado n y están todos.
+ */
+constexpr bool systemFsmStatesInOrder(const systemFsmState_t *states, const int count){
+
+    if(count != SYSTEM_FSM_STATES){
+        return false;
+    }
+
+    for(int i = 0; i < count; i++){
+
+        if(states[i].state != i){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Toma las tablas y entra al estado inicial.
+ *
+ * Ejecuta la acción de entrada del estado inicial, los módulos que usa ya deben estar inicializados,
+ * y lo publica en el bus de eventos con el mismo estado como anterior.
+ *
+ * @param transitions Tabla de transiciones, debe existir mientras se use la máquina.
+ * @param transition_count Filas de la tabla de transiciones.
+ * @param states Tabla de estados, uno por estado en el orden de systemState_t.
+ * @param initial Estado inicial.
+ */
+void systemFsmInit(const systemFsmTransition_t *transitions, const int transition_count, const systemFsmState_t *states, systemState_t initial);
+
+/**
+ * @brief Envía un evento.
+ *
+ * Si el estado actual tiene una fila para el evento ejecuta la salida, la acción de la
+ * transición y la entrada, registra el cambio en el registro de eventos y lo publica en el bus.
+ *
+ * @param event Evento.
+ *
+ * @return true si hubo transición, false si el evento no se acepta en el estado actual.
+ */
+bool systemFsmDispatch(systemEvent_t event);
+
+/**
+ * @brief Indica si un evento se aceptaría en el estado actual, sin enviarlo.
+ *
+ * @param event Evento.
+ *
+ * @return true si hay una fila para el estado actual y el evento.
+ */
+bool systemFsmAccepts(systemEvent_t event);
+
+/**
+ * @brief Ejecuta la acción del estado activo.
+ *
+ * Se llama en cada tick de la tarea del sistema.
+ */
+void systemFsmUpdate();
+
+/**
+ * @brief Estado actual.
+ *
+ * @return systemState_t Estado.
+ */
+systemState_t systemFsmReadState();
+
+//=====[#include guards - end]==========================================
+#endif
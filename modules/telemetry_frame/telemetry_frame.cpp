@@ -0,0 +1,391 @@
+/**
+* @file telemetry_frame.cpp
+* @brief Implementación de las tramas binarias de telemetría (COBS + CRC-16).
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "telemetry_frame.h"
+
+//=====[Declaration of private defines]=================================
+#define CRC16_INITIAL   0xFFFF  /**< Valor inicial de CRC-16/CCITT-FALSE */
+
+#define COBS_MAX_BLOCK  0xFF    /**< Código de un bloque de 254 bytes sin ceros */
+
+#define PAYLOAD_MAX TELEMETRY_FRAME_SAMPLES_MAX_LENGTH  /**< Carga más grande que se arma en la pila */
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+/** CRC de cada nibble con polinomio 0x1021, tabla de 32 bytes en lugar de 512 */
+static const uint16_t crc16_nibble_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Escribe un entero de 16 bits en little-endian.
+ *
+ * @param destination Destino.
+ * @param value Valor.
+ */
+static void telemetryFramePut16(uint8_t *destination, const uint16_t value);
+
+/**
+ * @brief Escribe un entero de 32 bits en little-endian.
+ *
+ * @param destination Destino.
+ * @param value Valor.
+ */
+static void telemetryFramePut32(uint8_t *destination, const uint32_t value);
+
+/**
+ * @brief Lee un entero de 16 bits en little-endian.
+ *
+ * @param source Origen.
+ *
+ * @return uint16_t Valor.
+ */
+static uint16_t telemetryFrameGet16(const uint8_t *source);
+
+/**
+ * @brief Lee un entero de 32 bits en little-endian.
+ *
+ * @param source Origen.
+ *
+ * @return uint32_t Valor.
+ */
+static uint32_t telemetryFrameGet32(const uint8_t *source);
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief CRC-16/CCITT-FALSE.
+ *
+ * @param data Bytes.
+ * @param length Cantidad de bytes.
+ *
+ * @return uint16_t CRC.
+ */
+uint16_t telemetryFrameCrc16(const uint8_t *data, const int length){
+    uint16_t crc = CRC16_INITIAL;
+
+    for(int i = 0; i < length; i++){
+        crc = (crc << 4) ^ crc16_nibble_table[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ crc16_nibble_table[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+
+    return crc;
+}
+
+/**
+ * @brief Codifica con COBS, sin el delimitador.
+ *
+ * @param input Bytes a codificar.
+ * @param length Cantidad de bytes.
+ * @param output Destino, al menos length + length / 254 + 1 bytes.
+ *
+ * @return int Bytes codificados.
+ */
+int telemetryFrameCobsEncode(const uint8_t *input, const int length, uint8_t *output){
+    int code_index = 0; // lugar del código del bloque actual
+    int out = 1;
+    uint8_t code = 1;
+
+    for(int i = 0; i < length; i++){
+
+        if(input[i] != 0){
+            output[out] = input[i];
+            out = out + 1;
+            code = code + 1;
+        }
+
+        // un cero o un bloque lleno cierran el bloque
+        if(input[i] == 0 or code == COBS_MAX_BLOCK){
+            output[code_index] = code;
+            code_index = out;
+            out = out + 1;
+            code = 1;
+        }
+    }
+
+    output[code_index] = code;
+
+    return out;
+}
+
+/**
+ * @brief Decodifica COBS, sin el delimitador.
+ *
+ * @param input Bytes codificados.
+ * @param length Cantidad de bytes.
+ * @param output Destino, al menos length bytes.
+ *
+ * @return int Bytes decodificados o -1 si la codificación es inválida.
+ */
+int telemetryFrameCobsDecode(const uint8_t *input, const int length, uint8_t *output){
+    int in = 0;
+    int out = 0;
+
+    while(in < length){
+        uint8_t code = input[in];
+
+        if(code == 0 or in + code > length){
+            return -1;
+        }
+
+        in = in + 1;
+
+        for(int i = 1; i < code; i++){
+            output[out] = input[in];
+            out = out + 1;
+            in = in + 1;
+        }
+
+        // el cero implícito no existe al final ni después de un bloque lleno
+        if(code != COBS_MAX_BLOCK and in < length){
+            output[out] = 0;
+            out = out + 1;
+        }
+    }
+
+    return out;
+}
+
+/**
+ * @brief Arma una trama completa: agrega el CRC, codifica y agrega el delimitador.
+ *
+ * @param payload Carga, empieza con versión y tipo.
+ * @param length Bytes de carga.
+ * @param frame Destino de TELEMETRY_FRAME_ENCODED_MAX(length) bytes.
+ *
+ * @return int Bytes de la trama.
+ */
+int telemetryFrameWrap(const uint8_t *payload, const int length, uint8_t *frame){
+    uint8_t raw[PAYLOAD_MAX + TELEMETRY_FRAME_CRC_LENGTH];
+    int encoded;
+
+    if(length > PAYLOAD_MAX){
+        return 0;
+    }
+
+    memcpy(raw, payload, length);
+    telemetryFramePut16(&raw[length], telemetryFrameCrc16(payload, length));
+
+    encoded = telemetryFrameCobsEncode(raw, length + TELEMETRY_FRAME_CRC_LENGTH, frame);
+    frame[encoded] = TELEMETRY_FRAME_DELIMITER;
+
+    return encoded + 1;
+}
+
+/**
+ * @brief Recupera la carga de una trama: decodifica y verifica el CRC.
+ *
+ * @param frame Trama sin el delimitador.
+ * @param length Bytes de la trama.
+ * @param payload Destino, al menos length bytes.
+ *
+ * @return int Bytes de carga o -1 si la trama es inválida.
+ */
+int telemetryFrameUnwrap(const uint8_t *frame, const int length, uint8_t *payload){
+    int decoded = telemetryFrameCobsDecode(frame, length, payload);
+
+    if(decoded < TELEMETRY_FRAME_CRC_LENGTH){
+        return -1;
+    }
+
+    decoded = decoded - TELEMETRY_FRAME_CRC_LENGTH;
+
+    if(telemetryFrameGet16(&payload[decoded]) != telemetryFrameCrc16(payload, decoded)){
+        return -1;
+    }
+
+    return decoded;
+}
+
+/**
+ * @brief Arma la trama de estado.
+ *
+ * @param status Contenido.
+ * @param frame Destino de TELEMETRY_FRAME_ENCODED_MAX(TELEMETRY_FRAME_STATUS_LENGTH) bytes.
+ *
+ * @return int Bytes de la trama.
+ */
+int telemetryFrameEncodeStatus(const telemetryStatus_t *status, uint8_t *frame){
+    uint8_t payload[TELEMETRY_FRAME_STATUS_LENGTH];
+
+    payload[0] = TELEMETRY_FRAME_VERSION;
+    payload[1] = TELEMETRY_FRAME_STATUS;
+    telemetryFramePut16(&payload[2], status->sequence);
+    telemetryFramePut16(&payload[4], (uint16_t)status->temperature_centi);
+    payload[6] = status->setpoint;
+    telemetryFramePut32(&payload[7], status->elapsed_ms);
+    payload[11] = status->target_hours;
+    payload[12] = status->system_state;
+    payload[13] = status->adjust_mode;
+    payload[14] = status->heater;
+    payload[15] = status->output_percent;
+
+    return telemetryFrameWrap(payload, TELEMETRY_FRAME_STATUS_LENGTH, frame);
+}
+
+/**
+ * @brief Interpreta la carga de una trama de estado.
+ *
+ * @param payload Carga obtenida con telemetryFrameUnwrap().
+ * @param length Bytes de carga.
+ * @param status Destino del contenido.
+ *
+ * @return true si la versión, el tipo y el largo son los de una trama de estado.
+ */
+bool telemetryFrameDecodeStatus(const uint8_t *payload, const int length, telemetryStatus_t *status){
+
+    if(length != TELEMETRY_FRAME_STATUS_LENGTH or payload[0] != TELEMETRY_FRAME_VERSION or payload[1] != TELEMETRY_FRAME_STATUS){
+        return false;
+    }
+
+    status->sequence = telemetryFrameGet16(&payload[2]);
+    status->temperature_centi = (int16_t)telemetryFrameGet16(&payload[4]);
+    status->setpoint = payload[6];
+    status->elapsed_ms = telemetryFrameGet32(&payload[7]);
+    status->target_hours = payload[11];
+    status->system_state = payload[12];
+    status->adjust_mode = payload[13];
+    status->heater = payload[14];
+    status->output_percent = payload[15];
+
+    return true;
+}
+
+/**
+ * @brief Arma la trama de muestras.
+ *
+ * @param block Contenido, sample_count y event_count dentro de los máximos.
+ * @param frame Destino de TELEMETRY_FRAME_ENCODED_MAX(TELEMETRY_FRAME_SAMPLES_MAX_LENGTH) bytes.
+ *
+ * @return int Bytes de la trama.
+ */
+int telemetryFrameEncodeSamples(const telemetrySamples_t *block, uint8_t *frame){
+    uint8_t payload[TELEMETRY_FRAME_SAMPLES_MAX_LENGTH];
+    int length = TELEMETRY_FRAME_SAMPLES_HEADER;
+
+    if(block->sample_count > TELEMETRY_FRAME_MAX_SAMPLES or block->event_count > TELEMETRY_FRAME_MAX_EVENTS){
+        return 0;
+    }
+
+    payload[0] = TELEMETRY_FRAME_VERSION;
+    payload[1] = TELEMETRY_FRAME_SAMPLES;
+    telemetryFramePut16(&payload[2], block->sequence);
+    telemetryFramePut32(&payload[4], block->timestamp_us);
+    telemetryFramePut32(&payload[8], block->period_us);
+    payload[12] = block->decimation;
+    payload[13] = block->sample_count;
+    payload[14] = block->event_count;
+
+    for(int i = 0; i < block->sample_count; i++){
+        telemetryFramePut16(&payload[length], block->samples[i]);
+        length = length + 2;
+    }
+
+    for(int i = 0; i < block->event_count; i++){
+        telemetryFramePut32(&payload[length], block->events[i].timestamp_us);
+        payload[length + 4] = block->events[i].heater;
+        length = length + TELEMETRY_FRAME_EVENT_LENGTH;
+    }
+
+    return telemetryFrameWrap(payload, length, frame);
+}
+
+/**
+ * @brief Interpreta la carga de una trama de muestras.
+ *
+ * @param payload Carga obtenida con telemetryFrameUnwrap().
+ * @param length Bytes de carga.
+ * @param block Destino del contenido.
+ *
+ * @return true si la versión, el tipo y el largo son los de una trama de muestras.
+ */
+bool telemetryFrameDecodeSamples(const uint8_t *payload, const int length, telemetrySamples_t *block){
+    int position = TELEMETRY_FRAME_SAMPLES_HEADER;
+
+    if(length < TELEMETRY_FRAME_SAMPLES_HEADER or payload[0] != TELEMETRY_FRAME_VERSION or payload[1] != TELEMETRY_FRAME_SAMPLES){
+        return false;
+    }
+
+    block->sequence = telemetryFrameGet16(&payload[2]);
+    block->timestamp_us = telemetryFrameGet32(&payload[4]);
+    block->period_us = telemetryFrameGet32(&payload[8]);
+    block->decimation = payload[12];
+    block->sample_count = payload[13];
+    block->event_count = payload[14];
+
+    if(block->sample_count > TELEMETRY_FRAME_MAX_SAMPLES or block->event_count > TELEMETRY_FRAME_MAX_EVENTS
+        or length != TELEMETRY_FRAME_SAMPLES_HEADER + 2 * block->sample_count + TELEMETRY_FRAME_EVENT_LENGTH * block->event_count){
+        return false;
+    }
+
+    for(int i = 0; i < block->sample_count; i++){
+        block->samples[i] = telemetryFrameGet16(&payload[position]);
+        position = position + 2;
+    }
+
+    for(int i = 0; i < block->event_count; i++){
+        block->events[i].timestamp_us = telemetryFrameGet32(&payload[position]);
+        block->events[i].heater = payload[position + 4];
+        position = position + TELEMETRY_FRAME_EVENT_LENGTH;
+    }
+
+    return true;
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Escribe un entero de 16 bits en little-endian.
+ *
+ * @param destination Destino.
+ * @param value Valor.
+ */
+static void telemetryFramePut16(uint8_t *destination, const uint16_t value){
+    destination[0] = value & 0xFF;
+    destination[1] = value >> 8;
+}
+
+/**
+ * @brief Escribe un entero de 32 bits en little-endian.
+ *
+ * @param destination Destino.
+ * @param value Valor.
+ */
+static void telemetryFramePut32(uint8_t *destination, const uint32_t value){
+    telemetryFramePut16(destination, value & 0xFFFF);
+    telemetryFramePut16(destination + 2, value >> 16);
+}
+
+/**
+ * @brief Lee un entero de 16 bits en little-endian.
+ *
+ * @param source Origen.
+ *
+ * @return uint16_t Valor.
+ */
+static uint16_t telemetryFrameGet16(const uint8_t *source){
+    return source[0] | (source[1] << 8);
+}
+
+/**
+ * @brief Lee un entero de 32 bits en little-endian.
+ *
+ * @param source Origen.
+ *
+ * @return uint32_t Valor.
+ */
+static uint32_t telemetryFrameGet32(const uint8_t *source){
+    return telemetryFrameGet16(source) | ((uint32_t)telemetryFrameGet16(source + 2) << 16);
+}
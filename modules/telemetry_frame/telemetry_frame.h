@@ -0,0 +1,203 @@
+/**
+* @file telemetry_frame.h
+* @brief Declaraciones de funciones de las tramas binarias de telemetría (COBS + CRC-16).
+*
+* Cada trama es: COBS(carga || CRC-16) seguido de un 0x00 delimitador.
+* La carga empieza con versión y tipo, los enteros van en little-endian.
+*
+* Trama de estado (TELEMETRY_FRAME_STATUS), 16 bytes de carga:
+*
+*   0  versión          uint8   TELEMETRY_FRAME_VERSION
+*   1  tipo             uint8   TELEMETRY_FRAME_STATUS
+*   2  secuencia        uint16  se incrementa en cada trama, detecta pérdidas
+*   4  temperatura      int16   centésimas de grado
+*   6  consigna         uint8   grados
+*   7  transcurrido     uint32  milisegundos de secado
+*   11 horas objetivo   uint8
+*   12 estado sistema   uint8   systemState_t
+*   13 modo ajuste      uint8   adjustState_t
+*   14 calentador       uint8   0 apagado, 1 encendido
+*   15 salida control   uint8   porcentaje
+*
+* Trama de muestras (TELEMETRY_FRAME_SAMPLES), 15 bytes de cabecera más muestras y eventos:
+*
+*   0  versión          uint8
+*   1  tipo             uint8   TELEMETRY_FRAME_SAMPLES
+*   2  secuencia        uint16  propia de este tipo, un salto indica bloques descartados
+*   4  instante         uint32  microsegundos de la primera muestra (rtcNowUs, da la vuelta cada 71 min)
+*   8  periodo          uint32  microsegundos entre muestras del bloque, ya decimadas
+*   12 decimación       uint8   muestras crudas por muestra enviada
+*   13 muestras N       uint8
+*   14 eventos M        uint8
+*   15 N muestras       uint16  cuentas crudas del ADC (escala read_u16)
+*   .. M eventos        uint32 instante en microsegundos + uint8 calentador (0/1)
+*
+* El CRC es CRC-16/CCITT-FALSE (polinomio 0x1021, inicial 0xFFFF) sobre la carga.
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _TELEMETRY_FRAME_H_
+#define _TELEMETRY_FRAME_H_
+
+#include "mbed.h"
+
+//=====[Declaration of private defines]=================================
+#define TELEMETRY_FRAME_VERSION 1   /**< Versión del formato, cambia si cambia algún campo */
+
+#define TELEMETRY_FRAME_STATUS  1   /**< Tipo: estado periódico */
+#define TELEMETRY_FRAME_SAMPLES 2   /**< Tipo: bloque de muestras crudas y eventos del calentador */
+
+#define TELEMETRY_FRAME_DELIMITER   0x00    /**< Fin de trama */
+#define TELEMETRY_FRAME_STATUS_LENGTH   16  /**< Bytes de carga de la trama de estado */
+#define TELEMETRY_FRAME_CRC_LENGTH  2   /**< Bytes del CRC */
+
+#define TELEMETRY_FRAME_SAMPLES_HEADER  15  /**< Bytes de cabecera de la trama de muestras */
+#define TELEMETRY_FRAME_MAX_SAMPLES 20  /**< Muestras por trama */
+#define TELEMETRY_FRAME_MAX_EVENTS  4   /**< Eventos del calentador por trama */
+#define TELEMETRY_FRAME_EVENT_LENGTH    5   /**< Bytes por evento */
+/** Bytes de carga de la trama de muestras más grande */
+#define TELEMETRY_FRAME_SAMPLES_MAX_LENGTH  (TELEMETRY_FRAME_SAMPLES_HEADER + 2 * TELEMETRY_FRAME_MAX_SAMPLES + TELEMETRY_FRAME_EVENT_LENGTH * TELEMETRY_FRAME_MAX_EVENTS)
+
+/** Bytes que ocupa una carga codificada con COBS más el delimitador */
+#define TELEMETRY_FRAME_ENCODED_MAX(payload)    ((payload) + TELEMETRY_FRAME_CRC_LENGTH + ((payload) + TELEMETRY_FRAME_CRC_LENGTH) / 254 + 2)
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Contenido de la trama de estado.
+ */
+typedef struct{
+    uint16_t sequence;  /**< Número de trama */
+    int16_t temperature_centi;  /**< Temperatura en centésimas de grado */
+    uint8_t setpoint;   /**< Consigna en grados */
+    uint32_t elapsed_ms;    /**< Tiempo de secado transcurrido */
+    uint8_t target_hours;   /**< Horas de secado configuradas */
+    uint8_t system_state;   /**< systemState_t */
+    uint8_t adjust_mode;    /**< adjustState_t */
+    uint8_t heater; /**< Estado del calentador */
+    uint8_t output_percent; /**< Salida del control */
+}telemetryStatus_t;
+
+/**
+ * @brief Cambio de estado del calentador.
+ */
+typedef struct{
+    uint32_t timestamp_us;  /**< Instante del cambio (rtcNowUs) */
+    uint8_t heater; /**< Estado nuevo */
+}telemetryEvent_t;
+
+/**
+ * @brief Contenido de la trama de muestras.
+ */
+typedef struct{
+    uint16_t sequence;  /**< Número de bloque */
+    uint32_t timestamp_us;  /**< Instante de la primera muestra */
+    uint32_t period_us; /**< Tiempo entre muestras enviadas */
+    uint8_t decimation; /**< Muestras crudas por muestra enviada */
+    uint8_t sample_count;   /**< Muestras válidas */
+    uint8_t event_count;    /**< Eventos válidos */
+    uint16_t samples[TELEMETRY_FRAME_MAX_SAMPLES];  /**< Cuentas crudas del ADC */
+    telemetryEvent_t events[TELEMETRY_FRAME_MAX_EVENTS];    /**< Cambios del calentador */
+}telemetrySamples_t;
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief CRC-16/CCITT-FALSE.
+ *
+ * @param data Bytes.
+ * @param length Cantidad de bytes.
+ *
+ * @return uint16_t CRC.
+ */
+uint16_t telemetryFrameCrc16(const uint8_t *data, const int length);
+
+/**
+ * @brief Codifica con COBS, sin el delimitador.
+ *
+ * @param input Bytes a codificar.
+ * @param length Cantidad de bytes.
+ * @param output Destino, al menos length + length / 254 + 1 bytes.
+ *
+ * @return int Bytes codificados.
+ */
+int telemetryFrameCobsEncode(const uint8_t *input, const int length, uint8_t *output);
+
+/**
+ * @brief Decodifica COBS, sin el delimitador.
+ *
+ * @param input Bytes codificados.
+ * @param length Cantidad de bytes.
+ * @param output Destino, al menos length bytes.
+ *
+ * @return int Bytes decodificados o -1 si la codificación es inválida.
+ */
+int telemetryFrameCobsDecode(const uint8_t *input, const int length, uint8_t *output);
+
+/**
+ * @brief Arma una trama completa: agrega el CRC, codifica y agrega el delimitador.
+ *
+ * @param payload Carga, empieza con versión y tipo.
+ * @param length Bytes de carga.
+ * @param frame Destino de TELEMETRY_FRAME_ENCODED_MAX(length) bytes.
+ *
+ * @return int Bytes de la trama.
+ */
+int telemetryFrameWrap(const uint8_t *payload, const int length, uint8_t *frame);
+
+/**
+ * @brief Recupera la carga de una trama: decodifica y verifica el CRC.
+ *
+ * @param frame Trama sin el delimitador.
+ * @param length Bytes de la trama.
+ * @param payload Destino, al menos length bytes.
+ *
+ * @return int Bytes de carga o -1 si la trama es inválida.
+ */
+int telemetryFrameUnwrap(const uint8_t *frame, const int length, uint8_t *payload);
+
+/**
+ * @brief Arma la trama de estado.
+ *
+ * @param status Contenido.
+ * @param frame Destino de TELEMETRY_FRAME_ENCODED_MAX(TELEMETRY_FRAME_STATUS_LENGTH) bytes.
+ *
+ * @return int Bytes de la trama.
+ */
+int telemetryFrameEncodeStatus(const telemetryStatus_t *status, uint8_t *frame);
+
+/**
+ * @brief Interpreta la carga de una trama de estado.
+ *
+ * @param payload Carga obtenida con telemetryFrameUnwrap().
+ * @param length Bytes de carga.
+ * @param status Destino del contenido.
+ *
+ * @return true si la versión, el tipo y el largo son los de una trama de estado.
+ */
+bool telemetryFrameDecodeStatus(const uint8_t *payload, const int length, telemetryStatus_t *status);
+
+/**
+ * @brief Arma la trama de muestras.
+ *
+ * @param block Contenido, sample_count y event_count dentro de los máximos.
+ * @param frame Destino de TELEMETRY_FRAME_ENCODED_MAX(TELEMETRY_FRAME_SAMPLES_MAX_LENGTH) bytes.
+ *
+ * @return int Bytes de la trama.
+ */
+int telemetryFrameEncodeSamples(const telemetrySamples_t *block, uint8_t *frame);
+
+/**
+ * @brief Interpreta la carga de una trama de muestras.
+ *
+ * @param payload Carga obtenida con telemetryFrameUnwrap().
+ * @param length Bytes de carga.
+ * @param block Destino del contenido.
+ *
+ * @return true si la versión, el tipo y el largo son los de una trama de muestras.
+ */
+bool telemetryFrameDecodeSamples(const uint8_t *payload, const int length, telemetrySamples_t *block);
+
+//=====[#include guards - end]==========================================
+#endif
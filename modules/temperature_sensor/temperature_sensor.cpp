@@ -7,9 +7,37 @@
 */
 //=====[Libraries]======================================================
 #include "temperature_sensor.h"
+#include "modules/adc_acquisition/adc_acquisition.h"
+#include "modules/event_log/event_log.h"
+#include "modules/rtc/rtc.h"
 
 //=====[Declaration of private defines]=================================
-#define SAMPLES 100 /**< Número de muestras para el promedio del sensor. */
+// Si no esta declarado TIME_MS
+#ifndef TIME_MS
+#define TIME_MS 10
+#endif
+
+// Si no esta declarado el largo de la ráfaga que llena la ventana al iniciar
+#ifndef TEMPERATURE_SENSOR_PRIME_SAMPLES
+#define TEMPERATURE_SENSOR_PRIME_SAMPLES 16
+#endif
+
+// Si no esta declarado cuántos periodos de muestreo sin bloques nuevos son una falla
+#ifndef TEMPERATURE_SENSOR_STALE_PERIODS
+#define TEMPERATURE_SENSOR_STALE_PERIODS    (5 * ADC_ACQUISITION_BLOCK_SAMPLES)
+#endif
+
+#define SAMPLE_PERIOD_US    (TIME_MS * 1000)    /**< Periodo de muestreo continuo, la ventana sigue cubriendo SAMPLES * TIME_MS */
+#define STALE_US    ((uint64_t)TEMPERATURE_SENSOR_STALE_PERIODS * SAMPLE_PERIOD_US)   /**< Tiempo sin bloques nuevos que se toma como falla */
+#define US_PER_MS   1000    /**< Microsegundos en un milisegundo */
+
+#define SAMPLES TEMPERATURE_SENSOR_SAMPLES /**< Número de muestras para el promedio del sensor. */
+#define ADC_FULL_SCALE  65535   /**< Valor máximo de read_u16() */
+#define ADC_VREF_MV 3300    /**< Tensión de referencia del ADC en milivoltios */
+#define LM35_CENTI_CELSIUS_PER_MV   10  /**< El LM35 entrega 10 mV/°C, es decir 10 centésimas de grado por mV */
+
+/** Centésimas de grado por unidad de samplesSum en Q32, calculado al compilar, evita float en tiempo de ejecución */
+#define CENTI_CELSIUS_PER_SUM_Q32   ((uint64_t)((double)ADC_VREF_MV * LM35_CENTI_CELSIUS_PER_MV * 4294967296.0 / ((double)ADC_FULL_SCALE * SAMPLES) + 0.5))
 
 #define LM35    0   /**< Selección del tipo de sensor utilizado. */
 #define LM35_MINIMUN_OPERATION_CELCIUS  -55 /**< Temperatura mínima de operación del sensor LM35 en grados Celsius. */
@@ -17,77 +45,353 @@
 #define LM35_ERROR_MAXIMUN_COMPLETE   2 /**< Error máximo del sensor LM35 en toda la gama de temperaturas en grados Celsius. */
 #define LM35_ERROR_MAXIMUN_AMBIENT   0.5    /**< Error máximo del sensor LM35 en rango de temperatura ambiente en grados Celsius. */
 
+/** Cuentas del ADC sobre la temperatura máxima del LM35: salida en corto a la alimentación o pin flotante */
+#define SENSOR_FAULT_HIGH_COUNTS    ((uint32_t)((double)LM35_MAXIMUN_OPERATION_CELCIUS * 100 / LM35_CENTI_CELSIUS_PER_MV * ADC_FULL_SCALE / ADC_VREF_MV))
+
 #define SENSOR_SELECT   LM35    /**< Sensor utilizado. */    
 //=====[Declaration of private data types]==============================
 
 //=====[Declaration and initialization of public global objects]========
+#if !TEMPERATURE_SENSOR_CONTINUOUS
 AnalogIn* heaterSensor;    /** Objeto para el sensor del calentador */
+#endif
 
 //=====[Declaration of external public global variables]================
 
 //=====[Declaration and initialization of public global variables]======
 
 //=====[Declaration and initialization of private global variables]=====
-static float voltageSensorValue[SAMPLES]; /**< muestras de voltaje leídas del sensor de temperatura */
-static float voltageSensorAVG = 0; /**< valor promedio del voltaje del sensor de temperatura */
+static uint16_t sensorSamples[SAMPLES]; /**< muestras crudas del ADC (read_u16) leídas del sensor de temperatura */
+static volatile uint32_t samplesSum = 0; /**< suma de las muestras de la ventana, entera para que no acumule error */
+static int sampleIndex = 0; /**< posición de la muestra más antigua en la ventana */
+static volatile temperatureSensorTap_t rawTap = nullptr; /**< copia de las muestras crudas, para transmitirlas */
+static volatile bool sensorFault = false; /**< la última muestra estaba fuera de rango, se registra solo el cambio */
+static volatile uint32_t blocksFed = 0; /**< grupos de muestras recibidos, la interrupción solo lo incrementa */
+static uint32_t blocksSeen = 0; /**< valor de blocksFed en el último control */
+static uint64_t lastBlockUs = 0; /**< rtcNowUs() del último grupo de muestras visto */
+static bool sensorStale = false; /**< la adquisición dejó de entregar muestras */
+
+// la suma de la ventana completa debe entrar en samplesSum
+static_assert(SAMPLES > 0 and SAMPLES <= UINT32_MAX / ADC_FULL_SCALE, "TEMPERATURE_SENSOR_SAMPLES fuera de rango");
 //=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Indica si una muestra cruda está fuera del rango del sensor.
+ *
+ * @param sample Muestra con escala de read_u16().
+ *
+ * @return true si el sensor está desconectado o en corto.
+ */
+static bool temperatureSensorIsFault(const uint16_t sample);
+
+/**
+ * @brief Pone el mismo valor en toda la ventana.
+ *
+ * @param sample Muestra con escala de read_u16().
+ *
+ * @return uint32_t Suma de la ventana.
+ */
+static uint32_t temperatureSensorFill(const uint16_t sample);
+
+/**
+ * @brief Controla que la adquisición continua siga entregando bloques.
+ *
+ * Pasados TEMPERATURE_SENSOR_STALE_PERIODS periodos de muestreo sin muestras nuevas la
+ * ventana quedó congelada en el último valor, se toma como falla del sensor.
+ */
+static void temperatureSensorCheckStale();
 
 //=====[Implementations of public functions]============================
 
 /**
  * @brief Inicializa el sensor de temperatura.
  * 
- * Esta función configura el pin del sensor de temperatura e inicializa 
- * el valor promedio de voltaje del sensor.
+ * Esta función configura el pin del sensor de temperatura, llena la ventana
+ * del promedio con temperatureSensorPrime() y en modo continuo arranca la adquisición.
  * 
  * @param heaterSensorPin Pin del sensor de temperatura.
  */
 void temperatureSensorInit(PinName heaterSensorPin){
+    sampleIndex = 0;
+    sensorFault = false;
+    sensorStale = false;
+    blocksSeen = blocksFed;
+    lastBlockUs = rtcNowUs();
+    samplesSum = temperatureSensorFill(0);
+
+#if TEMPERATURE_SENSOR_CONTINUOUS
+    adcAcquisitionInit(heaterSensorPin, SAMPLE_PERIOD_US, temperatureSensorFeed);
+    temperatureSensorPrime(); // antes de arrancar, el ADC todavía está libre
+    adcAcquisitionStart();
+#else
     heaterSensor = new AnalogIn(heaterSensorPin);
-    
-    voltageSensorAVG = 0;
-    
-    for(int i = 0; i < SAMPLES; i++){
-        voltageSensorValue[i] = 0;
+    temperatureSensorPrime();
+#endif
+}
+
+/**
+ * @brief Llena la ventana del promedio con una ráfaga de conversiones.
+ *
+ * La ventana completa queda con el promedio de la ráfaga, así la primera lectura ya es
+ * la temperatura real y no sube desde 0 durante SAMPLES periodos. Con la adquisición
+ * continua en marcha no hace nada (solo se llama desde la inicialización).
+ */
+void temperatureSensorPrime(){
+    uint16_t burst[TEMPERATURE_SENSOR_PRIME_SAMPLES];
+    uint32_t sum = 0;
+    int valid = 0;
+    int count;
+
+#if TEMPERATURE_SENSOR_CONTINUOUS
+    count = adcAcquisitionReadBurst(burst, TEMPERATURE_SENSOR_PRIME_SAMPLES);
+#else
+    for(count = 0; count < TEMPERATURE_SENSOR_PRIME_SAMPLES; count++){
+        burst[count] = heaterSensor->read_u16();
     }
+#endif
+
+    // la adquisición continua ya estaba en marcha
+    if(count == 0){
+        return;
+    }
+
+    for(int i = 0; i < count; i++){
+
+        if(not temperatureSensorIsFault(burst[i])){
+            sum = sum + burst[i];
+            valid = valid + 1;
+        }
+    }
+
+    // sin ninguna muestra válida la ventana queda como está y la falla se registra
+    if(valid == 0){
+
+        if(not sensorFault){
+            eventLogWrite(EVENT_LOG_SENSOR_FAULT, burst[0]);
+            sensorFault = true;
+        }
+
+        return;
+    }
+
+    samplesSum = temperatureSensorFill((sum + valid / 2) / valid);
 }
 
 /**
  * @brief Lee la temperatura en grados Celsius.
  * 
- * Convierte el valor promedio de voltaje del sensor a grados Celsius.
+ * Convierte el valor promedio del sensor a grados Celsius (truncado).
  * 
  * @return int Temperatura en grados Celsius.
  */
 int temperatureSensorReadCelsius(){
-    // El LM35 proporciona 10mV por grado Celsius, así que convertimos el voltaje a grados Celsius
-    return static_cast<int>(voltageSensorAVG * 100); // Convertir a grados Celsius y truncar a entero
+    return temperatureSensorReadCentiCelsius() / 100; // truncar a grados enteros
+}
+
+/**
+ * @brief Lee la temperatura en centésimas de grado Celsius.
+ * 
+ * Convierte la suma de la ventana (cuentas del ADC) a centésimas de grado
+ * con una multiplicación entera en Q32, sin punto flotante.
+ * 
+ * @return int Temperatura en centésimas de grado Celsius.
+ */
+int temperatureSensorReadCentiCelsius(){
+    // El LM35 proporciona 10mV por grado Celsius: cuentas -> mV -> centésimas de grado
+    return static_cast<int>(((uint64_t)samplesSum * CENTI_CELSIUS_PER_SUM_Q32) >> 32);
 }
 
 /**
  * @brief Actualiza los valores de temperatura.
  * 
- * Lee el voltaje del sensor de temperatura, lo almacena en un 
- * arreglo y calcula el promedio de las muestras para obtener una lectura estable.
+ * En modo continuo las muestras llegan solas por interrupción, solo se atiende la
+ * fuente simulada si la hay y se controla que sigan llegando. Si no, lee una conversión
+ * y la agrega a la ventana.
  */
 void temperatureSensorUpdate(){
-    static int index = 0;
-    float samples_sum = 0;
+#if TEMPERATURE_SENSOR_CONTINUOUS
+    adcAcquisitionUpdate();
+    temperatureSensorCheckStale();
+#else
+    uint16_t sample = heaterSensor->read_u16();
+
+    temperatureSensorFeed(&sample, 1);
+#endif
+}
+
+/**
+ * @brief Agrega muestras crudas a la ventana del promedio.
+ * 
+ * Por cada muestra resta la que sale y suma la que entra, sin recorrer el arreglo.
+ * La adquisición continua la llama desde la interrupción con cada bloque.
+ * 
+ * @param samples Muestras con escala de read_u16().
+ * @param count Cantidad de muestras.
+ */
+void temperatureSensorFeed(const uint16_t *samples, const int count){
+    uint32_t sum = samplesSum;
+
+    for(int i = 0; i < count; i++){
+        bool fault = temperatureSensorIsFault(samples[i]);
+
+        if(fault != sensorFault){
+            eventLogWrite(fault ? EVENT_LOG_SENSOR_FAULT : EVENT_LOG_SENSOR_OK, samples[i]);
+            sensorFault = fault;
+
+            // el sensor volvió: la ventana tiene las muestras de la falla, se arranca desde esta
+            if(not fault){
+                sum = temperatureSensorFill(samples[i]);
+            }
+        }
+
+        sum = sum - sensorSamples[sampleIndex] + samples[i];
+        sensorSamples[sampleIndex] = samples[i];
 
-    voltageSensorValue[index] = heaterSensor->read() * 3.3f; // Convertir la lectura a voltaje (0.0 a 3.3V)
+        sampleIndex++;
 
-    index++;
+        if(sampleIndex >= SAMPLES){
+            sampleIndex = 0;
+        }
+    }
+
+    // una sola escritura de 32 bits, la lectura desde el bucle principal no ve estados intermedios
+    samplesSum = sum;
+    blocksFed = blocksFed + 1;
 
-    if(index >= SAMPLES){
-        index = 0;
+    temperatureSensorTap_t tap = rawTap;
+
+    if(tap != nullptr){
+        tap(samples, count);
     }
+}
+
+/**
+ * @brief Indica si la lectura no es confiable.
+ *
+ * @return true si la última muestra estaba fuera de rango o la adquisición dejó de
+ * entregar muestras.
+ */
+bool temperatureSensorIsFaulty(){
+    return sensorFault or sensorStale;
+}
+
+/**
+ * @brief Registra una función que recibe las muestras crudas.
+ *
+ * @param tap Función a llamar con cada grupo de muestras, nullptr para quitarla.
+ */
+void temperatureSensorSetRawTap(temperatureSensorTap_t tap){
+    rawTap = tap;
+}
+
+/**
+ * @brief Guarda el estado de la ventana y la deja lista para muestras de prueba.
+ *
+ * Quita la salida de muestras crudas y la falla registrada, así las muestras de prueba en
+ * rango no llegan a la transmisión ni al registro de eventos. Con la adquisición continua
+ * detenida, hasta temperatureSensorRestoreState().
+ *
+ * @param state Destino de la copia.
+ */
+void temperatureSensorSaveState(temperatureSensorState_t *state){
 
     for(int i = 0; i < SAMPLES; i++){
-        samples_sum = samples_sum + voltageSensorValue[i];
+        state->samples[i] = sensorSamples[i];
     }
 
-    voltageSensorAVG = samples_sum / SAMPLES;
+    state->samplesSum = samplesSum;
+    state->sampleIndex = sampleIndex;
+    state->sensorFault = sensorFault;
+    state->blocksFed = blocksFed;
+    state->rawTap = rawTap;
+
+    rawTap = nullptr;
+    sensorFault = false;
+}
+
+/**
+ * @brief Vuelve la ventana al estado guardado con temperatureSensorSaveState().
+ *
+ * @param state Copia guardada.
+ */
+void temperatureSensorRestoreState(const temperatureSensorState_t *state){
+
+    for(int i = 0; i < SAMPLES; i++){
+        sensorSamples[i] = state->samples[i];
+    }
 
+    samplesSum = state->samplesSum;
+    sampleIndex = state->sampleIndex;
+    sensorFault = state->sensorFault;
+    blocksFed = state->blocksFed; // el control de adquisición no ve los grupos de prueba
+    rawTap = state->rawTap;
 }
 
-//=====[Implementations of private functions]===========================
\ No newline at end of file
+/**
+ * @brief Periodo entre muestras crudas.
+ *
+ * En modo por consultas es el periodo de la tarea que llama a temperatureSensorUpdate().
+ *
+ * @return int Microsegundos entre muestras.
+ */
+int temperatureSensorGetSamplePeriodUs(){
+    return SAMPLE_PERIOD_US;
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Indica si una muestra cruda está fuera del rango del sensor.
+ *
+ * @param sample Muestra con escala de read_u16().
+ *
+ * @return true si el sensor está desconectado o en corto.
+ */
+static bool temperatureSensorIsFault(const uint16_t sample){
+    // el LM35 no llega a 0 V en el recinto: 0 es un sensor desconectado o en corto a masa
+    return sample == 0 or sample >= SENSOR_FAULT_HIGH_COUNTS;
+}
+
+/**
+ * @brief Pone el mismo valor en toda la ventana.
+ *
+ * @param sample Muestra con escala de read_u16().
+ *
+ * @return uint32_t Suma de la ventana.
+ */
+static uint32_t temperatureSensorFill(const uint16_t sample){
+
+    for(int i = 0; i < SAMPLES; i++){
+        sensorSamples[i] = sample;
+    }
+
+    return (uint32_t)sample * SAMPLES;
+}
+
+/**
+ * @brief Controla que la adquisición continua siga entregando bloques.
+ *
+ * Pasados TEMPERATURE_SENSOR_STALE_PERIODS periodos de muestreo sin muestras nuevas la
+ * ventana quedó congelada en el último valor, se toma como falla del sensor.
+ */
+static void temperatureSensorCheckStale(){
+    uint32_t blocks = blocksFed;
+    uint64_t now = rtcNowUs();
+
+    if(blocks != blocksSeen){
+        blocksSeen = blocks;
+        lastBlockUs = now;
+
+        if(sensorStale){
+            sensorStale = false;
+            eventLogWrite(EVENT_LOG_SENSOR_OK, sensorSamples[(sampleIndex + SAMPLES - 1) % SAMPLES]);
+        }
+
+        return;
+    }
+
+    if(not sensorStale and now - lastBlockUs >= STALE_US){
+        uint64_t silent_ms = (now - lastBlockUs) / US_PER_MS;
+
+        sensorStale = true;
+        eventLogWrite(EVENT_LOG_SENSOR_STALE, silent_ms > UINT16_MAX ? UINT16_MAX : silent_ms);
+    }
+}
@@ -13,37 +13,135 @@
 #include "mbed.h"
 
 //=====[Declaration of private defines]=================================
+// Si no esta declarado el largo de la ventana del promedio
+#ifndef TEMPERATURE_SENSOR_SAMPLES
+#define TEMPERATURE_SENSOR_SAMPLES 100
+#endif
+
+// Si no esta declarado el modo de adquisición: 1 continua por DMA/Ticker, 0 una conversión por llamada
+#ifndef TEMPERATURE_SENSOR_CONTINUOUS
+#define TEMPERATURE_SENSOR_CONTINUOUS 1
+#endif
 
 //=====[Declaration of private data types]==============================
+/**
+ * @brief Recibe una copia de las muestras crudas que entran a la ventana.
+ *
+ * En modo continuo se llama desde la interrupción de la adquisición, debe ser breve.
+ */
+typedef void (*temperatureSensorTap_t)(const uint16_t *samples, const int count);
+
+/**
+ * @brief Copia del estado de la ventana, para medir temperatureSensorFeed() sin alterar la lectura.
+ */
+typedef struct{
+    uint16_t samples[TEMPERATURE_SENSOR_SAMPLES]; /**< muestras de la ventana */
+    uint32_t samplesSum; /**< suma de la ventana */
+    int sampleIndex; /**< posición de la muestra más antigua */
+    bool sensorFault; /**< la última muestra estaba fuera de rango */
+    uint32_t blocksFed; /**< grupos de muestras recibidos */
+    temperatureSensorTap_t rawTap; /**< salida de muestras crudas registrada */
+}temperatureSensorState_t;
 
 //=====[Declaration (prototypes) of public functions]===================
 
 /**
  * @brief Inicializa el sensor de temperatura.
  * 
- * Esta función configura el pin del sensor de temperatura e inicializa 
- * el valor promedio de voltaje del sensor.
+ * Esta función configura el pin del sensor de temperatura, llena la ventana
+ * del promedio con temperatureSensorPrime() y en modo continuo arranca la adquisición.
  * 
  * @param heaterSensorPin Pin del sensor de temperatura.
  */
 void temperatureSensorInit(PinName heaterSensorPin);
 
+/**
+ * @brief Llena la ventana del promedio con una ráfaga de conversiones.
+ *
+ * La ventana completa queda con el promedio de la ráfaga, así la primera lectura ya es
+ * la temperatura real y no sube desde 0 durante SAMPLES periodos. Con la adquisición
+ * continua en marcha no hace nada (solo se llama desde la inicialización).
+ */
+void temperatureSensorPrime();
+
 /**
  * @brief Lee la temperatura en grados Celsius.
  * 
- * Convierte el valor promedio de voltaje del sensor a grados Celsius.
+ * Convierte el valor promedio del sensor a grados Celsius (truncado).
  * 
  * @return int Temperatura en grados Celsius.
  */
 int temperatureSensorReadCelsius();
 
+/**
+ * @brief Lee la temperatura en centésimas de grado Celsius.
+ * 
+ * Convierte la suma de la ventana (cuentas del ADC) a centésimas de grado
+ * con una multiplicación entera en Q32, sin punto flotante.
+ * 
+ * @return int Temperatura en centésimas de grado Celsius.
+ */
+int temperatureSensorReadCentiCelsius();
+
 /**
  * @brief Actualiza los valores de temperatura.
  * 
- * Lee el voltaje del sensor de temperatura, lo almacena en un 
- * arreglo y calcula el promedio de las muestras para obtener una lectura estable.
+ * En modo continuo las muestras llegan solas por interrupción, solo se atiende la
+ * fuente simulada si la hay y se controla que sigan llegando. Si no, lee una conversión
+ * y la agrega a la ventana.
  */
 void temperatureSensorUpdate();
 
+/**
+ * @brief Agrega muestras crudas a la ventana del promedio.
+ * 
+ * Por cada muestra resta la que sale y suma la que entra, sin recorrer el arreglo.
+ * La adquisición continua la llama desde la interrupción con cada bloque.
+ * 
+ * @param samples Muestras con escala de read_u16().
+ * @param count Cantidad de muestras.
+ */
+void temperatureSensorFeed(const uint16_t *samples, const int count);
+
+/**
+ * @brief Indica si la lectura no es confiable.
+ *
+ * @return true si la última muestra estaba fuera de rango o la adquisición dejó de
+ * entregar muestras.
+ */
+bool temperatureSensorIsFaulty();
+
+/**
+ * @brief Registra una función que recibe las muestras crudas.
+ *
+ * @param tap Función a llamar con cada grupo de muestras, nullptr para quitarla.
+ */
+void temperatureSensorSetRawTap(temperatureSensorTap_t tap);
+
+/**
+ * @brief Guarda el estado de la ventana y la deja lista para muestras de prueba.
+ *
+ * Quita la salida de muestras crudas y la falla registrada, así las muestras de prueba en
+ * rango no llegan a la transmisión ni al registro de eventos. Con la adquisición continua
+ * detenida, hasta temperatureSensorRestoreState().
+ *
+ * @param state Destino de la copia.
+ */
+void temperatureSensorSaveState(temperatureSensorState_t *state);
+
+/**
+ * @brief Vuelve la ventana al estado guardado con temperatureSensorSaveState().
+ *
+ * @param state Copia guardada.
+ */
+void temperatureSensorRestoreState(const temperatureSensorState_t *state);
+
+/**
+ * @brief Periodo entre muestras crudas.
+ *
+ * @return int Microsegundos entre muestras.
+ */
+int temperatureSensorGetSamplePeriodUs();
+
 //=====[#include guards - end]==========================================
 #endif
\ No newline at end of file
@@ -0,0 +1,180 @@
+/**
+* @file text_format.cpp
+* @brief Implementación del formateo de texto sin printf ni memoria dinámica.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "text_format.h"
+
+//=====[Declaration of private defines]=================================
+#define FIXED_MAX_DECIMALS  9   /**< Decimales que entran en un entero de 32 bits */
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+/** Los 100 pares de dígitos, convierte dos dígitos por cada división */
+static const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/** Potencias de 10 para contar dígitos y separar decimales */
+static const uint32_t powers_of_ten[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Cantidad de dígitos decimales de un valor.
+ *
+ * @param value Valor.
+ *
+ * @return int Dígitos, al menos 1.
+ */
+static int textFormatDigits(uint32_t value);
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Convierte un entero sin signo a decimal.
+ *
+ * @param value Valor.
+ * @param out Destino de al menos TEXT_FORMAT_INT_MAX caracteres, sin terminador.
+ *
+ * @return int Caracteres escritos.
+ */
+int textFormatUint(uint32_t value, char *out){
+    int length = textFormatDigits(value);
+    char *cursor = out + length;
+
+    // se escribe desde el final; dividir por la constante 100 el compilador lo hace con una multiplicación
+    while(value >= 100){
+        uint32_t pair = value % 100;
+
+        value = value / 100;
+        cursor = cursor - 2;
+        cursor[0] = digit_pairs[2 * pair];
+        cursor[1] = digit_pairs[2 * pair + 1];
+    }
+
+    if(value >= 10){
+        cursor[-2] = digit_pairs[2 * value];
+        cursor[-1] = digit_pairs[2 * value + 1];
+    }else{
+        cursor[-1] = '0' + value;
+    }
+
+    return length;
+}
+
+/**
+ * @brief Convierte un entero con signo a decimal.
+ *
+ * @param value Valor.
+ * @param out Destino de al menos TEXT_FORMAT_INT_MAX caracteres, sin terminador.
+ *
+ * @return int Caracteres escritos.
+ */
+int textFormatInt(int32_t value, char *out){
+
+    if(value < 0){
+        out[0] = '-';
+
+        // el negativo se calcula sin signo para que INT32_MIN no desborde
+        return 1 + textFormatUint(0U - (uint32_t)value, out + 1);
+    }
+
+    return textFormatUint(value, out);
+}
+
+/**
+ * @brief Agrega caracteres, los que entran.
+ *
+ * @param writer Destino.
+ * @param text Caracteres.
+ * @param length Cantidad de caracteres.
+ */
+void textFormatAppend(textWriter_t *writer, const char *text, const int length){
+    int count = length;
+
+    if(count > writer->capacity - writer->length){
+        count = writer->capacity - writer->length;
+    }
+
+    if(count <= 0){
+        return;
+    }
+
+    memcpy(writer->data + writer->length, text, count);
+    writer->length = writer->length + count;
+}
+
+/**
+ * @brief Agrega un entero escalado con decimales fijos.
+ */
+void textFormatPut(textWriter_t *writer, const textFixed_t fixed){
+    int decimals = fixed.decimals;
+    uint32_t magnitude;
+    uint32_t scale;
+    char digits[TEXT_FORMAT_INT_MAX];
+    int length;
+
+    if(decimals < 1 or decimals > FIXED_MAX_DECIMALS){
+        textFormatPut(writer, (long)fixed.value);
+        return;
+    }
+
+    scale = powers_of_ten[decimals];
+
+    if(fixed.value < 0){
+        textFormatPut(writer, '-');
+        magnitude = 0U - (uint32_t)fixed.value;
+    }else{
+        magnitude = fixed.value;
+    }
+
+    textFormatAppend(writer, digits, textFormatUint(magnitude / scale, digits));
+    textFormatPut(writer, '.');
+
+    // la parte decimal se completa con ceros a la izquierda
+    length = textFormatUint(magnitude % scale, digits);
+
+    for(int i = length; i < decimals; i++){
+        textFormatPut(writer, '0');
+    }
+
+    textFormatAppend(writer, digits, length);
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Cantidad de dígitos decimales de un valor.
+ *
+ * @param value Valor.
+ *
+ * @return int Dígitos, al menos 1.
+ */
+static int textFormatDigits(uint32_t value){
+    int digits = 1;
+
+    // solo comparaciones, sin divisiones
+    while(digits < 10 and value >= powers_of_ten[digits]){
+        digits = digits + 1;
+    }
+
+    return digits;
+}
@@ -0,0 +1,185 @@
+/**
+* @file text_format.h
+* @brief Declaraciones del formateo de texto sin printf ni memoria dinámica.
+*
+* El formato se arma en tiempo de compilación con los tipos de los argumentos, no hay
+* una cadena de formato que interpretar:
+*
+*   textFormat(line, sizeof(line), "temperatura: ", temperature, " kp: ", textFixed(kp_centi, 2), "\n");
+*
+* Los textos se copian, los enteros se convierten con una tabla de pares de dígitos y
+* textFixed() imprime un entero escalado con decimales fijos (reemplaza a "%d.%02d").
+* Si no entra todo se trunca como snprintf().
+*
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _TEXT_FORMAT_H_
+#define _TEXT_FORMAT_H_
+
+#include "mbed.h"
+
+//=====[Declaration of private defines]=================================
+#define TEXT_FORMAT_INT_MAX 11  /**< Caracteres del entero de 32 bits más largo, "-2147483648" */
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Destino del texto formateado.
+ */
+typedef struct{
+    char *data; /**< Buffer */
+    int capacity;   /**< Caracteres que entran sin contar el terminador */
+    int length; /**< Caracteres escritos */
+}textWriter_t;
+
+/**
+ * @brief Entero escalado que se imprime con decimales fijos.
+ */
+typedef struct{
+    int32_t value;  /**< Valor por 10^decimals */
+    uint8_t decimals;   /**< Decimales a imprimir */
+}textFixed_t;
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Convierte un entero sin signo a decimal.
+ *
+ * @param value Valor.
+ * @param out Destino de al menos TEXT_FORMAT_INT_MAX caracteres, sin terminador.
+ *
+ * @return int Caracteres escritos.
+ */
+int textFormatUint(uint32_t value, char *out);
+
+/**
+ * @brief Convierte un entero con signo a decimal.
+ *
+ * @param value Valor.
+ * @param out Destino de al menos TEXT_FORMAT_INT_MAX caracteres, sin terminador.
+ *
+ * @return int Caracteres escritos.
+ */
+int textFormatInt(int32_t value, char *out);
+
+/**
+ * @brief Agrega caracteres, los que entran.
+ *
+ * @param writer Destino.
+ * @param text Caracteres.
+ * @param length Cantidad de caracteres.
+ */
+void textFormatAppend(textWriter_t *writer, const char *text, const int length);
+
+/**
+ * @brief Entero escalado con decimales fijos, por ejemplo textFixed(1234, 2) es "12.34".
+ *
+ * @param value Valor por 10^decimals.
+ * @param decimals Decimales, de 1 a 9.
+ *
+ * @return textFixed_t Argumento para textFormat().
+ */
+inline textFixed_t textFixed(const int32_t value, const int decimals){
+    textFixed_t fixed = {value, (uint8_t)decimals};
+
+    return fixed;
+}
+
+/**
+ * @brief Agrega un texto terminado en '\0'.
+ */
+inline void textFormatPut(textWriter_t *writer, const char *text){
+    textFormatAppend(writer, text, strlen(text));
+}
+
+/**
+ * @brief Agrega un carácter.
+ */
+inline void textFormatPut(textWriter_t *writer, const char character){
+    textFormatAppend(writer, &character, 1);
+}
+
+/**
+ * @brief Agrega un booleano como 0 o 1, igual que printf con %d.
+ */
+inline void textFormatPut(textWriter_t *writer, const bool value){
+    textFormatPut(writer, value ? '1' : '0');
+}
+
+/**
+ * @brief Agrega un entero con signo (también enums y enteros chicos por promoción).
+ */
+inline void textFormatPut(textWriter_t *writer, const int value){
+    char digits[TEXT_FORMAT_INT_MAX];
+
+    textFormatAppend(writer, digits, textFormatInt(value, digits));
+}
+
+/**
+ * @brief Agrega un entero sin signo.
+ */
+inline void textFormatPut(textWriter_t *writer, const unsigned int value){
+    char digits[TEXT_FORMAT_INT_MAX];
+
+    textFormatAppend(writer, digits, textFormatUint(value, digits));
+}
+
+/**
+ * @brief Agrega un entero largo con signo (int32_t en arm-none-eabi).
+ */
+inline void textFormatPut(textWriter_t *writer, const long value){
+    char digits[TEXT_FORMAT_INT_MAX];
+
+    textFormatAppend(writer, digits, textFormatInt((int32_t)value, digits));
+}
+
+/**
+ * @brief Agrega un entero largo sin signo (uint32_t en arm-none-eabi).
+ */
+inline void textFormatPut(textWriter_t *writer, const unsigned long value){
+    char digits[TEXT_FORMAT_INT_MAX];
+
+    textFormatAppend(writer, digits, textFormatUint((uint32_t)value, digits));
+}
+
+/**
+ * @brief Agrega un entero escalado con decimales fijos.
+ */
+void textFormatPut(textWriter_t *writer, const textFixed_t fixed);
+
+/**
+ * @brief Fin de la lista de argumentos.
+ */
+inline void textFormatPutAll(textWriter_t *writer){}
+
+/**
+ * @brief Agrega cada argumento en orden, el tipo de cada uno elige la conversión.
+ */
+template <typename First, typename... Rest>
+inline void textFormatPutAll(textWriter_t *writer, const First &first, const Rest &... rest){
+    textFormatPut(writer, first);
+    textFormatPutAll(writer, rest...);
+}
+
+/**
+ * @brief Formatea los argumentos en un buffer, reemplaza a snprintf().
+ *
+ * @param out Destino, siempre queda terminado en '\0'.
+ * @param size Tamaño del destino.
+ * @param args Textos, caracteres, enteros y textFixed() en el orden en que se imprimen.
+ *
+ * @return int Caracteres escritos sin el terminador.
+ */
+template <typename... Args>
+int textFormat(char *out, const int size, const Args &... args){
+    textWriter_t writer = {out, size - 1, 0};
+
+    textFormatPutAll(&writer, args...);
+    out[writer.length] = '\0';
+
+    return writer.length;
+}
+
+//=====[#include guards - end]==========================================
+#endif
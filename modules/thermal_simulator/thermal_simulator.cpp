@@ -0,0 +1,218 @@
+/**
+* @file thermal_simulator.cpp
+* @brief Implementación del modelo térmico simulado de la secadora (hotbed, recinto y bobina).
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "thermal_simulator.h"
+#include "modules/rtc/rtc.h"
+#include "modules/scheduler/scheduler.h"
+#include "modules/heater/heater.h"
+#include "modules/adc_acquisition/adc_acquisition.h"
+
+//=====[Declaration of private defines]=================================
+#define STEP_US 100000  /**< Paso máximo de integración, muy por debajo de la constante de tiempo de la hotbed */
+#define US_PER_SECOND   1000000.0f
+
+#define ADC_FULL_SCALE  65535   /**< Valor máximo de read_u16() */
+#define ADC_VREF_MV 3300.0f /**< Tensión de referencia del ADC en milivoltios */
+#define LM35_MV_PER_CELSIUS 10.0f   /**< El LM35 entrega 10 mV/°C */
+
+#define SECONDS_PER_HOUR    3600.0f
+
+//=====[Declaration of private data types]==============================
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+static thermalPlant_t plant_params; /**< Parámetros del modelo */
+static thermalState_t plant_state; /**< Temperaturas de los nodos */
+static float energy_j = 0; /**< Energía entregada por la hotbed */
+
+static uint64_t virtual_us = 0; /**< Reloj virtual */
+static uint32_t noise_seed = 1; /**< Estado del generador de ruido */
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Fuente de tiempo virtual para rtcSetClockSource().
+ *
+ * @return uint64_t Microsegundos del reloj virtual.
+ */
+static uint64_t thermalSimulatorClock();
+
+/**
+ * @brief Ruido uniforme del sensor.
+ *
+ * @return float Valor entre -1 y 1.
+ */
+static float thermalSimulatorNoise();
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Parámetros por defecto: hotbed de 120 W, bobina de 1 kg y caja aislada.
+ *
+ * @return thermalPlant_t parámetros del modelo
+ */
+thermalPlant_t thermalSimulatorDefaultPlant(){
+    thermalPlant_t plant;
+
+    plant.heater_power_w = 120;
+    plant.ambient_c = 25;
+    plant.hotbed_capacity_j_k = 350;    // placa de aluminio de 220x220x3 mm
+    plant.air_capacity_j_k = 1500;  // aire más paredes interiores
+    plant.spool_capacity_j_k = 2000;    // 1 kg de PLA más el carrete
+    plant.hotbed_air_w_k = 4;
+    plant.air_spool_w_k = 2;
+    plant.air_ambient_w_k = 1.5;
+    plant.sensor_noise_c = 0.2;
+
+    return plant;
+}
+
+/**
+ * @brief Inicializa el modelo con todos los nodos a temperatura ambiente.
+ *
+ * @param plant parámetros del modelo
+ */
+void thermalSimulatorInit(const thermalPlant_t *plant){
+    plant_params = *plant;
+
+    plant_state.hotbed_c = plant_params.ambient_c;
+    plant_state.air_c = plant_params.ambient_c;
+    plant_state.spool_c = plant_params.ambient_c;
+
+    energy_j = 0;
+    noise_seed = 1;
+}
+
+/**
+ * @brief Integra el modelo.
+ *
+ * @param heater_on estado de la hotbed durante el intervalo
+ * @param dt_s duración del intervalo en segundos
+ */
+void thermalSimulatorStep(bool heater_on, float dt_s){
+    float power_w = heater_on ? plant_params.heater_power_w : 0;
+
+    // flujos de calor entre nodos
+    float hotbed_air_w = plant_params.hotbed_air_w_k * (plant_state.hotbed_c - plant_state.air_c);
+    float air_spool_w = plant_params.air_spool_w_k * (plant_state.air_c - plant_state.spool_c);
+    float air_ambient_w = plant_params.air_ambient_w_k * (plant_state.air_c - plant_params.ambient_c);
+
+    // Euler explícito, el paso es chico frente a las constantes de tiempo
+    plant_state.hotbed_c = plant_state.hotbed_c + (power_w - hotbed_air_w) * dt_s / plant_params.hotbed_capacity_j_k;
+    plant_state.air_c = plant_state.air_c + (hotbed_air_w - air_spool_w - air_ambient_w) * dt_s / plant_params.air_capacity_j_k;
+    plant_state.spool_c = plant_state.spool_c + air_spool_w * dt_s / plant_params.spool_capacity_j_k;
+
+    energy_j = energy_j + power_w * dt_s;
+}
+
+/**
+ * @brief Temperaturas actuales del modelo.
+ *
+ * @return thermalState_t temperaturas de los nodos
+ */
+thermalState_t thermalSimulatorRead(){
+    return plant_state;
+}
+
+/**
+ * @brief Muestra del LM35 sobre la hotbed con la escala de read_u16().
+ *
+ * @return uint16_t muestra simulada del ADC
+ */
+uint16_t thermalSimulatorSensorSample(){
+    float celsius = plant_state.hotbed_c + plant_params.sensor_noise_c * thermalSimulatorNoise();
+    float counts = celsius * LM35_MV_PER_CELSIUS * ADC_FULL_SCALE / ADC_VREF_MV;
+
+    // el LM35 sin tensión negativa no baja de 0 V y el ADC satura en la referencia
+    if(counts < 0){
+        counts = 0;
+    }
+
+    if(counts > ADC_FULL_SCALE){
+        counts = ADC_FULL_SCALE;
+    }
+
+    return (uint16_t)(counts + 0.5f);
+}
+
+/**
+ * @brief Energía entregada por la hotbed desde la inicialización.
+ *
+ * @return float energía en watt hora
+ */
+float thermalSimulatorEnergyWh(){
+    return energy_j / SECONDS_PER_HOUR;
+}
+
+/**
+ * @brief Conecta el modelo al sistema con un reloj virtual.
+ *
+ * Reemplaza el reloj (rtcSetClockSource), la espera del planificador y el ADC del sensor:
+ * cada vez que el planificador dormiría, el reloj salta a la próxima liberación y el modelo
+ * se integra con el estado del calentador. Llamar después de filamentDryerInit().
+ */
+void thermalSimulatorStart(){
+
+    // el reloj virtual continúa desde el instante actual, así no se corren los temporizadores ya armados
+    virtual_us = rtcNowUs();
+
+    rtcSetClockSource(thermalSimulatorClock);
+    schedulerSetIdleHook(thermalSimulatorAdvance);
+    adcAcquisitionSetFakeSource(thermalSimulatorSensorSample);
+}
+
+/**
+ * @brief Avanza el reloj virtual integrando el modelo.
+ *
+ * Sirve para manejar el reloj virtual sin el planificador (benchmarks, pruebas).
+ *
+ * @param wake_us instante (rtcNowUs) hasta el que se avanza
+ */
+void thermalSimulatorAdvance(uint64_t wake_us){
+
+    // el calentador solo cambia dentro de las tareas, durante la espera su estado es constante
+    bool heater_on = heaterStatus();
+
+    while(virtual_us < wake_us){
+        uint64_t step_us = wake_us - virtual_us;
+
+        if(step_us > STEP_US){
+            step_us = STEP_US;
+        }
+
+        thermalSimulatorStep(heater_on, step_us / US_PER_SECOND);
+
+        virtual_us = virtual_us + step_us;
+    }
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Fuente de tiempo virtual para rtcSetClockSource().
+ *
+ * @return uint64_t Microsegundos del reloj virtual.
+ */
+static uint64_t thermalSimulatorClock(){
+    return virtual_us;
+}
+
+/**
+ * @brief Ruido uniforme del sensor.
+ *
+ * Generador congruencial, repetible entre corridas.
+ *
+ * @return float Valor entre -1 y 1.
+ */
+static float thermalSimulatorNoise(){
+    noise_seed = noise_seed * 1664525 + 1013904223;
+
+    return (float)(noise_seed >> 8) / (float)(1 << 23) - 1.0f;
+}
@@ -0,0 +1,106 @@
+/**
+* @file thermal_simulator.h
+* @brief Declaraciones de funciones del modelo térmico simulado de la secadora (hotbed, recinto y bobina).
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _THERMAL_SIMULATOR_H_
+#define _THERMAL_SIMULATOR_H_
+
+#include "mbed.h"
+
+//=====[Declaration of private defines]=================================
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Parámetros del modelo de parámetros concentrados.
+ *
+ * Tres nodos: hotbed (donde está el LM35), aire del recinto y bobina de filamento.
+ */
+typedef struct{
+    float heater_power_w;   /**< Potencia de la hotbed encendida */
+    float ambient_c;    /**< Temperatura ambiente */
+    float hotbed_capacity_j_k;  /**< Capacidad térmica de la hotbed */
+    float air_capacity_j_k; /**< Capacidad térmica del aire y paredes del recinto */
+    float spool_capacity_j_k;   /**< Capacidad térmica de la bobina */
+    float hotbed_air_w_k;   /**< Conductancia hotbed -> aire */
+    float air_spool_w_k;    /**< Conductancia aire -> bobina */
+    float air_ambient_w_k;  /**< Conductancia aire -> ambiente (aislación del recinto) */
+    float sensor_noise_c;   /**< Ruido pico del sensor */
+}thermalPlant_t;
+
+/**
+ * @brief Temperaturas de los nodos del modelo.
+ */
+typedef struct{
+    float hotbed_c; /**< Hotbed, la que mide el sensor */
+    float air_c;    /**< Aire del recinto */
+    float spool_c;  /**< Bobina de filamento */
+}thermalState_t;
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Parámetros por defecto: hotbed de 120 W, bobina de 1 kg y caja aislada.
+ *
+ * @return thermalPlant_t parámetros del modelo
+ */
+thermalPlant_t thermalSimulatorDefaultPlant();
+
+/**
+ * @brief Inicializa el modelo con todos los nodos a temperatura ambiente.
+ *
+ * @param plant parámetros del modelo
+ */
+void thermalSimulatorInit(const thermalPlant_t *plant);
+
+/**
+ * @brief Integra el modelo.
+ *
+ * @param heater_on estado de la hotbed durante el intervalo
+ * @param dt_s duración del intervalo en segundos
+ */
+void thermalSimulatorStep(bool heater_on, float dt_s);
+
+/**
+ * @brief Temperaturas actuales del modelo.
+ *
+ * @return thermalState_t temperaturas de los nodos
+ */
+thermalState_t thermalSimulatorRead();
+
+/**
+ * @brief Muestra del LM35 sobre la hotbed con la escala de read_u16().
+ *
+ * @return uint16_t muestra simulada del ADC
+ */
+uint16_t thermalSimulatorSensorSample();
+
+/**
+ * @brief Energía entregada por la hotbed desde la inicialización.
+ *
+ * @return float energía en watt hora
+ */
+float thermalSimulatorEnergyWh();
+
+/**
+ * @brief Conecta el modelo al sistema con un reloj virtual.
+ *
+ * Reemplaza el reloj (rtcSetClockSource), la espera del planificador y el ADC del sensor:
+ * cada vez que el planificador dormiría, el reloj salta a la próxima liberación y el modelo
+ * se integra con el estado del calentador. Llamar después de filamentDryerInit().
+ */
+void thermalSimulatorStart();
+
+/**
+ * @brief Avanza el reloj virtual integrando el modelo.
+ *
+ * Sirve para manejar el reloj virtual sin el planificador (benchmarks, pruebas).
+ *
+ * @param wake_us instante (rtcNowUs) hasta el que se avanza
+ */
+void thermalSimulatorAdvance(uint64_t wake_us);
+
+//=====[#include guards - end]==========================================
+#endif
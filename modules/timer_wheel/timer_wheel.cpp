@@ -0,0 +1,369 @@
+/**
+* @file timer_wheel.cpp
+* @brief Implementación de la rueda jerárquica de temporizadores por software.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[Libraries]======================================================
+#include "timer_wheel.h"
+#include "modules/rtc/rtc.h"
+
+//=====[Declaration of private defines]=================================
+#define TICK_US (TIMER_WHEEL_TICK_MS * 1000ULL) /**< Duración de un tick de la rueda */
+
+#define WHEEL_BITS  6   /**< Bits de tick que resuelve cada nivel */
+#define WHEEL_SLOTS (1 << WHEEL_BITS)   /**< Ranuras por nivel */
+#define WHEEL_MASK  (WHEEL_SLOTS - 1)   /**< Máscara de ranura */
+#define WHEEL_LEVELS    4   /**< Niveles, cubren 2^24 ticks (46 horas con ticks de 10 ms) */
+
+#define NO_TIMER    -1  /**< Fin de lista */
+#define EXPIRED_SLOT    (WHEEL_LEVELS * WHEEL_SLOTS)    /**< Ranura ficticia de la lista de vencidos del tick en curso */
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Datos de un temporizador.
+ */
+typedef struct{
+    timerWheelCallback_t callback;  /**< Función a ejecutar al vencer */
+    uint32_t expires;   /**< Tick absoluto de vencimiento */
+    uint32_t period;    /**< Periodo en ticks, 0 para un solo disparo */
+    int next;   /**< Siguiente temporizador en la ranura */
+    int prev;   /**< Anterior temporizador en la ranura */
+    bool active;    /**< Está enlazado en alguna ranura */
+}timerWheelEntry_t;
+
+//=====[Declaration and initialization of public global objects]========
+
+//=====[Declaration of external public global variables]================
+
+//=====[Declaration and initialization of public global variables]======
+
+//=====[Declaration and initialization of private global variables]=====
+static timerWheelEntry_t timers[TIMER_WHEEL_MAX_TIMERS]; /**< Temporizadores reservados */
+static int timers_count = 0; /**< Cantidad de temporizadores reservados */
+
+static int wheel[WHEEL_LEVELS][WHEEL_SLOTS]; /**< Primer temporizador de cada ranura */
+static int wheel_slot[TIMER_WHEEL_MAX_TIMERS]; /**< Ranura (nivel * WHEEL_SLOTS + índice o EXPIRED_SLOT) de cada temporizador */
+static int expired = NO_TIMER; /**< Primer temporizador vencido que falta ejecutar en el tick en curso */
+
+static uint32_t current_tick = 0; /**< Próximo tick a procesar */
+static uint64_t origin_us = 0; /**< Instante del tick 0 */
+
+//=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Enlaza el temporizador en la ranura que corresponde a su vencimiento.
+ *
+ * @param timer_id Temporizador a enlazar.
+ */
+static void timerWheelLink(const int timer_id);
+
+/**
+ * @brief Desenlaza el temporizador de su ranura.
+ *
+ * @param timer_id Temporizador a desenlazar.
+ */
+static void timerWheelUnlink(const int timer_id);
+
+/**
+ * @brief Redistribuye una ranura de un nivel superior en los niveles inferiores.
+ *
+ * @param level Nivel a redistribuir.
+ * @param index Ranura a redistribuir.
+ *
+ * @return int La ranura redistribuida (0 indica que hay que seguir con el nivel siguiente).
+ */
+static int timerWheelCascade(const int level, const int index);
+
+/**
+ * @brief Procesa un tick de la rueda.
+ */
+static void timerWheelTick();
+
+/**
+ * @brief Convierte milisegundos a ticks redondeando hacia arriba.
+ *
+ * @param ms Milisegundos.
+ *
+ * @return uint32_t Ticks.
+ */
+static uint32_t timerWheelMsToTicks(const int ms);
+
+//=====[Implementations of public functions]============================
+/**
+ * @brief Inicializa la rueda de temporizadores.
+ *
+ * Toma el instante actual del reloj (rtcNowUs) como tick 0. Requiere rtcInit().
+ */
+void timerWheelInit(){
+
+    for(int level = 0; level < WHEEL_LEVELS; level++){
+        for(int index = 0; index < WHEEL_SLOTS; index++){
+            wheel[level][index] = NO_TIMER;
+        }
+    }
+
+    expired = NO_TIMER;
+    timers_count = 0;
+    current_tick = 0;
+    origin_us = rtcNowUs();
+}
+
+/**
+ * @brief Reserva un temporizador.
+ *
+ * El temporizador queda detenido y pertenece al módulo que lo creó
+ * mientras dure el programa.
+ *
+ * @param callback Función a ejecutar al vencer.
+ *
+ * @return int Identificador del temporizador o TIMER_WHEEL_INVALID.
+ */
+int timerWheelCreate(timerWheelCallback_t callback){
+
+    if(timers_count >= TIMER_WHEEL_MAX_TIMERS){
+        return TIMER_WHEEL_INVALID;
+    }
+
+    timers[timers_count].callback = callback;
+    timers[timers_count].expires = 0;
+    timers[timers_count].period = 0;
+    timers[timers_count].next = NO_TIMER;
+    timers[timers_count].prev = NO_TIMER;
+    timers[timers_count].active = false;
+
+    timers_count = timers_count + 1;
+
+    return timers_count - 1;
+}
+
+/**
+ * @brief Arranca (o rearranca) un temporizador.
+ *
+ * @param timer_id Identificador devuelto por timerWheelCreate().
+ * @param delay_ms Tiempo hasta el primer vencimiento.
+ * @param period_ms Periodo de repetición, 0 para un solo disparo.
+ */
+void timerWheelStart(const int timer_id, const int delay_ms, const int period_ms){
+
+    if(timer_id < 0 or timer_id >= timers_count){
+        return;
+    }
+
+    timerWheelStop(timer_id);
+
+    timers[timer_id].expires = current_tick + timerWheelMsToTicks(delay_ms);
+    timers[timer_id].period = (period_ms > 0) ? timerWheelMsToTicks(period_ms) : 0;
+
+    timerWheelLink(timer_id);
+}
+
+/**
+ * @brief Detiene un temporizador.
+ *
+ * @param timer_id Identificador devuelto por timerWheelCreate().
+ */
+void timerWheelStop(const int timer_id){
+
+    if(timer_id < 0 or timer_id >= timers_count){
+        return;
+    }
+
+    if(timers[timer_id].active){
+        timerWheelUnlink(timer_id);
+    }
+}
+
+/**
+ * @brief Indica si el temporizador está corriendo.
+ *
+ * @param timer_id Identificador devuelto por timerWheelCreate().
+ *
+ * @return true si está corriendo.
+ */
+bool timerWheelIsActive(const int timer_id){
+
+    if(timer_id < 0 or timer_id >= timers_count){
+        return false;
+    }
+
+    return timers[timer_id].active;
+}
+
+/**
+ * @brief Avanza la rueda hasta el instante actual.
+ *
+ * Procesa los ticks transcurridos desde la llamada anterior y ejecuta los
+ * temporizadores vencidos.
+ */
+void timerWheelUpdate(){
+
+    uint32_t target_tick = (rtcNowUs() - origin_us) / TICK_US;
+
+    // si la llamada se demoró se procesan todos los ticks perdidos
+    while((int32_t)(target_tick - current_tick) >= 0){
+        timerWheelTick();
+    }
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Enlaza el temporizador en la ranura que corresponde a su vencimiento.
+ *
+ * @param timer_id Temporizador a enlazar.
+ */
+static void timerWheelLink(const int timer_id){
+
+    uint32_t expires = timers[timer_id].expires;
+    int32_t delta = expires - current_tick;
+    int level;
+    int index;
+
+    if(delta < 0){
+        // ya vencido, se procesa en el próximo tick
+        level = 0;
+        index = current_tick & WHEEL_MASK;
+    }else if(delta < (1 << WHEEL_BITS)){
+        level = 0;
+        index = expires & WHEEL_MASK;
+    }else if(delta < (1 << (2 * WHEEL_BITS))){
+        level = 1;
+        index = (expires >> WHEEL_BITS) & WHEEL_MASK;
+    }else if(delta < (1 << (3 * WHEEL_BITS))){
+        level = 2;
+        index = (expires >> (2 * WHEEL_BITS)) & WHEEL_MASK;
+    }else{
+        // se limita al alcance de la rueda
+        if(delta >= (1 << (4 * WHEEL_BITS))){
+            expires = current_tick + (1 << (4 * WHEEL_BITS)) - 1;
+            timers[timer_id].expires = expires;
+        }
+        level = 3;
+        index = (expires >> (3 * WHEEL_BITS)) & WHEEL_MASK;
+    }
+
+    // se inserta al principio de la ranura
+    timers[timer_id].prev = NO_TIMER;
+    timers[timer_id].next = wheel[level][index];
+
+    if(wheel[level][index] != NO_TIMER){
+        timers[wheel[level][index]].prev = timer_id;
+    }
+
+    wheel[level][index] = timer_id;
+    wheel_slot[timer_id] = level * WHEEL_SLOTS + index;
+    timers[timer_id].active = true;
+}
+
+/**
+ * @brief Desenlaza el temporizador de su ranura.
+ *
+ * @param timer_id Temporizador a desenlazar.
+ */
+static void timerWheelUnlink(const int timer_id){
+
+    int level = wheel_slot[timer_id] / WHEEL_SLOTS;
+    int index = wheel_slot[timer_id] % WHEEL_SLOTS;
+
+    if(timers[timer_id].prev != NO_TIMER){
+        timers[timers[timer_id].prev].next = timers[timer_id].next;
+    }else if(wheel_slot[timer_id] == EXPIRED_SLOT){
+        expired = timers[timer_id].next;
+    }else{
+        wheel[level][index] = timers[timer_id].next;
+    }
+
+    if(timers[timer_id].next != NO_TIMER){
+        timers[timers[timer_id].next].prev = timers[timer_id].prev;
+    }
+
+    timers[timer_id].next = NO_TIMER;
+    timers[timer_id].prev = NO_TIMER;
+    timers[timer_id].active = false;
+}
+
+/**
+ * @brief Redistribuye una ranura de un nivel superior en los niveles inferiores.
+ *
+ * @param level Nivel a redistribuir.
+ * @param index Ranura a redistribuir.
+ *
+ * @return int La ranura redistribuida (0 indica que hay que seguir con el nivel siguiente).
+ */
+static int timerWheelCascade(const int level, const int index){
+
+    int timer_id = wheel[level][index];
+
+    wheel[level][index] = NO_TIMER;
+
+    while(timer_id != NO_TIMER){
+        int next = timers[timer_id].next;
+
+        timerWheelLink(timer_id);
+
+        timer_id = next;
+    }
+
+    return index;
+}
+
+/**
+ * @brief Procesa un tick de la rueda.
+ */
+static void timerWheelTick(){
+
+    int index = current_tick & WHEEL_MASK;
+
+    // al dar la vuelta un nivel se baja la siguiente ranura del nivel superior
+    if(index == 0){
+        if(timerWheelCascade(1, (current_tick >> WHEEL_BITS) & WHEEL_MASK) == 0){
+            if(timerWheelCascade(2, (current_tick >> (2 * WHEEL_BITS)) & WHEEL_MASK) == 0){
+                timerWheelCascade(3, (current_tick >> (3 * WHEEL_BITS)) & WHEEL_MASK);
+            }
+        }
+    }
+
+    current_tick = current_tick + 1;
+
+    // la ranura se vacía antes de los callbacks: un vencimiento 64 ticks después (periodo
+    // de 64 * k ticks o rearmado desde un callback) vuelve a caer en esta misma ranura
+    expired = wheel[0][index];
+    wheel[0][index] = NO_TIMER;
+
+    for(int timer_id = expired; timer_id != NO_TIMER; timer_id = timers[timer_id].next){
+        wheel_slot[timer_id] = EXPIRED_SLOT;
+    }
+
+    // un callback puede detener o rearmar otro temporizador que todavía está en la lista
+    while(expired != NO_TIMER){
+        int timer_id = expired;
+
+        timerWheelUnlink(timer_id);
+
+        if(timers[timer_id].period > 0){
+            timers[timer_id].expires = timers[timer_id].expires + timers[timer_id].period;
+            timerWheelLink(timer_id);
+        }
+
+        timers[timer_id].callback();
+    }
+}
+
+/**
+ * @brief Convierte milisegundos a ticks redondeando hacia arriba.
+ *
+ * @param ms Milisegundos.
+ *
+ * @return uint32_t Ticks.
+ */
+static uint32_t timerWheelMsToTicks(const int ms){
+
+    uint32_t ticks = (ms + TIMER_WHEEL_TICK_MS - 1) / TIMER_WHEEL_TICK_MS;
+
+    // como mínimo un tick
+    if(ticks == 0){
+        ticks = 1;
+    }
+
+    return ticks;
+}
@@ -0,0 +1,84 @@
+/**
+* @file timer_wheel.h
+* @brief Declaraciones de funciones de la rueda jerárquica de temporizadores por software.
+* @author Matias Leonardo Baez
+* @date 2024
+* @contact elmattprofe@gmail.com
+*/
+//=====[#include guards - begin]========================================
+#ifndef _TIMER_WHEEL_H_
+#define _TIMER_WHEEL_H_
+
+#include "mbed.h"
+
+//=====[Declaration of private defines]=================================
+// Si no esta declarado TIME_MS
+#ifndef TIME_MS
+#define TIME_MS 10
+#endif
+
+#define TIMER_WHEEL_TICK_MS TIME_MS /**< Duración de un tick de la rueda, periodo con el que llamar a timerWheelUpdate() */
+#define TIMER_WHEEL_MAX_TIMERS  16  /**< Cantidad máxima de temporizadores */
+#define TIMER_WHEEL_INVALID -1  /**< Identificador devuelto si no quedan temporizadores libres */
+
+//=====[Declaration of private data types]==============================
+/**
+ * @brief Función que se ejecuta al vencer un temporizador.
+ */
+typedef void (*timerWheelCallback_t)();
+
+//=====[Declaration (prototypes) of public functions]===================
+/**
+ * @brief Inicializa la rueda de temporizadores.
+ *
+ * Toma el instante actual del reloj (rtcNowUs) como tick 0. Requiere rtcInit().
+ */
+void timerWheelInit();
+
+/**
+ * @brief Reserva un temporizador.
+ *
+ * El temporizador queda detenido y pertenece al módulo que lo creó
+ * mientras dure el programa.
+ *
+ * @param callback Función a ejecutar al vencer.
+ *
+ * @return int Identificador del temporizador o TIMER_WHEEL_INVALID.
+ */
+int timerWheelCreate(timerWheelCallback_t callback);
+
+/**
+ * @brief Arranca (o rearranca) un temporizador.
+ *
+ * @param timer_id Identificador devuelto por timerWheelCreate().
+ * @param delay_ms Tiempo hasta el primer vencimiento.
+ * @param period_ms Periodo de repetición, 0 para un solo disparo.
+ */
+void timerWheelStart(const int timer_id, const int delay_ms, const int period_ms);
+
+/**
+ * @brief Detiene un temporizador.
+ *
+ * @param timer_id Identificador devuelto por timerWheelCreate().
+ */
+void timerWheelStop(const int timer_id);
+
+/**
+ * @brief Indica si el temporizador está corriendo.
+ *
+ * @param timer_id Identificador devuelto por timerWheelCreate().
+ *
+ * @return true si está corriendo.
+ */
+bool timerWheelIsActive(const int timer_id);
+
+/**
+ * @brief Avanza la rueda hasta el instante actual.
+ *
+ * Procesa los ticks transcurridos desde la llamada anterior y ejecuta los
+ * temporizadores vencidos.
+ */
+void timerWheelUpdate();
+
+//=====[#include guards - end]==========================================
+#endif
@@ -7,11 +7,12 @@
 */
 //=====[Libraries]======================================================
 #include "uart_manager.h"
-#include "modules/rtc/rtc.h"
-#include "modules/heater/heater.h"
-#include "modules/temperature_sensor/temperature_sensor.h"
+#include "modules/heater_manager/heater_manager.h"
+#include "modules/ring_buffer/ring_buffer.h"
+#include "modules/telemetry_frame/telemetry_frame.h"
 
 //=====[Declaration of private defines]=================================
+#define MS_PER_SECOND   1000
 
 //=====[Declaration of private data types]==============================
 
@@ -23,98 +24,531 @@ UnbufferedSerial* uart; /** Objeto asociado al convertidor serial USB */
 //=====[Declaration and initialization of public global variables]======
 
 //=====[Declaration and initialization of private global variables]=====
+static uint8_t tx_storage[UART_TX_BUFFER_SIZE]; /**< Almacenamiento del buffer de transmisión */
+static ringBuffer_t tx_buffer; /**< Bytes pendientes de transmitir */
+static volatile bool tx_active = false; /**< La interrupción de transmisión está habilitada */
+static uartTxPolicy_t tx_policy = UART_TX_DROP_NEWEST; /**< Política ante buffer lleno */
+static uartTxStats_t tx_stats; /**< Contadores de la transmisión */
+static uint8_t rx_storage[UART_RX_BUFFER_SIZE]; /**< Almacenamiento del buffer de recepción */
+static ringBuffer_t rx_buffer; /**< Bytes recibidos pendientes de leer */
+static volatile uint32_t rx_overruns = 0; /**< Bytes perdidos con el buffer de recepción lleno */
+static volatile uartRxWake_t rx_wake = nullptr; /**< Aviso de bytes recibidos */
+static uartTelemetryMode_t telemetry_mode = UART_TELEMETRY_DEFAULT; /**< Formato de la telemetría */
+static uint16_t telemetry_sequence = 0; /**< Número de la próxima trama binaria */
+static int bus_subscriber = EVENT_BUS_INVALID_SUBSCRIBER; /**< Suscripción al bus de eventos */
+static systemState_t system_state = SYSTEM_ON; /**< Último estado publicado */
+static adjustState_t adjust_mode = TIME; /**< Último modo de ajuste publicado */
+static int work_temperature = MIN_TEMP; /**< Última temperatura de secado publicada */
+static int activity_time = MIN_TIME; /**< Últimas horas de secado publicadas */
+static int autotune_gains[HEATER_MANAGER_GAINS]; /**< Resultado del autoajuste en centésimas, llega antes que su fin */
+
+static_assert((UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) == 0, "UART_TX_BUFFER_SIZE debe ser potencia de 2");
+static_assert((UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) == 0, "UART_RX_BUFFER_SIZE debe ser potencia de 2");
 
 //=====[Declaration (prototypes) of private functions]==================
+/**
+ * @brief Aplica un mensaje del bus a los valores guardados.
+ *
+ * @param message Mensaje recibido.
+ */
+static void uartReceive(const eventBusMessage_t *message);
+
+/**
+ * @brief Informa por UART un cambio de estado del sistema.
+ *
+ * Solo los cambios que se avisan; en telemetría binaria no envía nada, el estado va
+ * en cada trama.
+ *
+ * @param state Estado al que entró el sistema.
+ * @param previous Estado anterior.
+ */
+static void uartReportState(systemState_t state, systemState_t previous);
+
+/**
+ * @brief Último valor publicado de un tema, 0 si todavía no se publicó.
+ *
+ * @param topic Tema.
+ * @param detail true para el dato secundario.
+ *
+ * @return int32_t Valor.
+ */
+static int32_t uartLast(eventBusTopic_t topic, const bool detail);
+
+/**
+ * @brief Informa por UART un cambio de estado del autoajuste del PID.
+ *
+ * Solo con telemetría de texto; al terminar incluye el resultado recibido antes.
+ *
+ * @param state Estado del autoajuste.
+ * @param cycles Ciclos límite medidos.
+ */
+static void uartReportAutotune(heaterAutotuneState_t state, const int cycles);
+
+/**
+ * @brief Envía la trama binaria de estado.
+ */
+static void uartSendStatusFrame();
+
+/**
+ * @brief Habilita la interrupción de transmisión si no estaba corriendo.
+ */
+static void uartTxStart();
+
+/**
+ * @brief Interrupción de transmisión, pasa bytes del buffer al periférico.
+ */
+static void uartTxIsr();
+
+/**
+ * @brief Interrupción de recepción, pasa bytes del periférico al buffer.
+ */
+static void uartRxIsr();
 
 //=====[Implementations of public functions]============================
 /**
  * @brief Inicializa la comunicación UART.
  * 
- * Configura los pines y la velocidad de la comunicación UART.
+ * Configura los pines y la velocidad de la comunicación UART. Se suscribe en el bus de
+ * eventos a los estados del sistema, los valores de secado, el modo de ajuste y el
+ * autoajuste, después de eventBusInit().
  * 
  * @param rxPin El pin de recepción UART.
  * @param txPin El pin de transmisión UART.
  * @param bauds La velocidad de baudios para la comunicación UART.
  */
 void uartManagerInit(PinName rxPin, PinName txPin, const int bauds){
+    ringBufferInit(&tx_buffer, tx_storage, UART_TX_BUFFER_SIZE);
+    memset(&tx_stats, 0, sizeof(tx_stats));
+    tx_active = false;
+
+    ringBufferInit(&rx_buffer, rx_storage, UART_RX_BUFFER_SIZE);
+    rx_overruns = 0;
+
     uart = new UnbufferedSerial(rxPin, txPin, bauds);
+
+    uart->attach(uartRxIsr, SerialBase::RxIrq);
+
+    bus_subscriber = eventBusSubscribe(EVENT_BUS_TOPIC_BIT(EVENT_BUS_STATE) | EVENT_BUS_TOPIC_BIT(EVENT_BUS_SETTINGS) | EVENT_BUS_TOPIC_BIT(EVENT_BUS_ADJUST)
+                                     | EVENT_BUS_TOPIC_BIT(EVENT_BUS_AUTOTUNE) | EVENT_BUS_TOPIC_BIT(EVENT_BUS_AUTOTUNE_GAIN), nullptr);
+
+    // lo publicado antes de suscribirse queda como último valor de cada tema
+    work_temperature = uartLast(EVENT_BUS_SETTINGS, false);
+    activity_time = uartLast(EVENT_BUS_SETTINGS, true);
+    adjust_mode = (adjustState_t)uartLast(EVENT_BUS_ADJUST, false);
 }
 
 /**
  * @brief Informa el estado del sistema a través de UART.
  * 
- * Envía el estado actual del sistema, el modo de ajuste, y el tiempo de actividad 
- * a través de la comunicación UART.
- * 
- * @param state El estado actual del sistema.
- * @param mode El modo de ajuste actual (temperatura o tiempo).
- * @param activity_time El tiempo de actividad configurado para el sistema.
+ * Toma los mensajes del bus de eventos en orden: avisa los cambios de estado, de modo
+ * de ajuste y del autoajuste, y secando envía cada segundo la temperatura, el calentador
+ * y el tiempo transcurrido con los últimos valores publicados.
  */
-void uartManagerUpdate(systemState_t state, adjustState_t mode, const int activity_time){
+void uartManagerUpdate(){
 
     static int previous_second = 0;
-    static systemState_t previous_state = SYSTEM_STOP;
     static adjustState_t previous_mode = TIME;
+    eventBusMessage_t message;
+
+    // los cambios publicados desde la llamada anterior
+    while(eventBusRead(bus_subscriber, &message)){
+        uartReceive(&message);
+    }
+
+    if(telemetry_mode == UART_TELEMETRY_BINARY){
+        uartSendStatusFrame();
+        return;
+    }
+
+    // los avisos de cambio de estado los envía uartReportState()
+    if(system_state != SYSTEM_WORK){
+        return;
+    }
+
+    // si hubo cambio de modo
+    if(previous_mode != adjust_mode){
+
+        previous_mode = adjust_mode;
+
+        switch (adjust_mode){
+            case TIME:
+                uartManagerPrint("-> Modo Tiempo\n");
+            break;
+            case TEMPERATURE:
+                uartManagerPrint("-> Modo Temperatura\n");
+            break;
+        }
+        
+    }
+
+    int elapsed_s = uartLast(EVENT_BUS_ELAPSED, false);
+    int seconds = elapsed_s % 60;
+
+    // si paso 1 segundo
+    if(previous_second != seconds){
+        previous_second = seconds;
+
+        // informa el estado de la maquina
+        uartManagerPrint("temperature_now: ", uartLast(EVENT_BUS_TEMPERATURE, false) / 100, " temperature_user: ", work_temperature, " hour: ", elapsed_s / 3600, "  minutes: ", (elapsed_s / 60) % 60, " seconds: ", seconds, " hour_user: ", activity_time, " heater: ", uartLast(EVENT_BUS_HEATER, false), "\n");
+    }
+}
+
+/**
+ * @brief Registra la función que avisa que llegaron mensajes del bus.
+ *
+ * @param wake Función a llamar, nullptr para quitarla.
+ */
+void uartManagerSetWake(eventBusWake_t wake){
+    eventBusSetWake(bus_subscriber, wake);
+}
+
+/**
+ * @brief Registra la función que avisa que llegaron bytes.
+ *
+ * Se llama desde la interrupción de recepción, debe ser breve. Permite leer los comandos
+ * al llegar en lugar de consultar el buffer periódicamente.
+ *
+ * @param wake Función a llamar, nullptr para quitarla.
+ */
+void uartManagerSetRxWake(uartRxWake_t wake){
+    rx_wake = wake;
+}
+
+/**
+ * @brief Selecciona el formato de la telemetría.
+ *
+ * En binario no se envían los mensajes de texto, los eventos se deducen del estado de cada trama.
+ *
+ * @param mode Formato.
+ */
+void uartManagerSetTelemetryMode(uartTelemetryMode_t mode){
+    telemetry_mode = mode;
+}
+
+/**
+ * @brief Formato actual de la telemetría.
+ *
+ * @return uartTelemetryMode_t Formato.
+ */
+uartTelemetryMode_t uartManagerGetTelemetryMode(){
+    return telemetry_mode;
+}
+
+/**
+ * @brief Encola bytes para transmitir sin bloquear.
+ *
+ * La interrupción de transmisión vacía el buffer; si el mensaje no entra se aplica
+ * la política configurada con uartManagerSetTxPolicy().
+ *
+ * @param data Bytes a transmitir.
+ * @param length Cantidad de bytes.
+ *
+ * @return int Bytes encolados (0 si se descartó el mensaje).
+ */
+int uartManagerWrite(const char *data, const int length){
+    uint32_t free_bytes;
+
+    if(uart == nullptr or length <= 0){
+        return 0;
+    }
+
+    free_bytes = ringBufferFree(&tx_buffer);
+
+    if(free_bytes < (uint32_t)length){
+
+        // un mensaje más grande que el buffer nunca entra, se descarta con cualquier política
+        if(tx_policy == UART_TX_DROP_NEWEST or (uint32_t)length > ringBufferSize(&tx_buffer)){
+            tx_stats.dropped_messages = tx_stats.dropped_messages + 1;
+            tx_stats.dropped_bytes = tx_stats.dropped_bytes + length;
+            return 0;
+        }
+
+        // la interrupción también mueve el índice de lectura
+        core_util_critical_section_enter();
+        tx_stats.overwritten_bytes = tx_stats.overwritten_bytes + ringBufferDiscard(&tx_buffer, length - ringBufferFree(&tx_buffer));
+        core_util_critical_section_exit();
+    }
+
+    ringBufferWrite(&tx_buffer, (const uint8_t *)data, length);
+
+    tx_stats.queued_bytes = tx_stats.queued_bytes + length;
+
+    if(ringBufferUsed(&tx_buffer) > tx_stats.high_water){
+        tx_stats.high_water = ringBufferUsed(&tx_buffer);
+    }
+
+    uartTxStart();
+
+    return length;
+}
+
+/**
+ * @brief Selecciona la política ante buffer lleno.
+ *
+ * @param policy Política de descarte.
+ */
+void uartManagerSetTxPolicy(uartTxPolicy_t policy){
+    tx_policy = policy;
+}
+
+/**
+ * @brief Lugar libre en el buffer de transmisión.
+ *
+ * @return int Bytes que se pueden encolar sin descartar.
+ */
+int uartManagerGetTxFree(){
+    return ringBufferFree(&tx_buffer);
+}
+
+/**
+ * @brief Lee bytes recibidos sin bloquear.
+ *
+ * La interrupción de recepción los guarda en un buffer; los que llegan con el buffer
+ * lleno se pierden y se cuentan en uartManagerGetRxOverruns().
+ *
+ * @param data Destino.
+ * @param length Cantidad máxima de bytes.
+ *
+ * @return int Bytes leídos (0 si no hay).
+ */
+int uartManagerRead(char *data, const int length){
+    int count = 0;
+
+    while(count < length and ringBufferReadByte(&rx_buffer, (uint8_t *)&data[count])){
+        count = count + 1;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Bytes recibidos perdidos por buffer de recepción lleno.
+ *
+ * @return uint32_t Cantidad de bytes.
+ */
+uint32_t uartManagerGetRxOverruns(){
+    return rx_overruns;
+}
+
+/**
+ * @brief Contadores de la transmisión.
+ *
+ * @return uartTxStats_t Bytes encolados, descartes y máxima ocupación.
+ */
+uartTxStats_t uartManagerGetTxStats(){
+    return tx_stats;
+}
+
+//=====[Implementations of private functions]===========================
+/**
+ * @brief Aplica un mensaje del bus a los valores guardados.
+ *
+ * @param message Mensaje recibido.
+ */
+static void uartReceive(const eventBusMessage_t *message){
+
+    switch (message->topic){
+        case EVENT_BUS_STATE:
+            system_state = (systemState_t)message->value;
+            uartReportState(system_state, (systemState_t)message->detail);
+        break;
+
+        case EVENT_BUS_SETTINGS:
+            work_temperature = message->value;
+            activity_time = message->detail;
+        break;
+
+        case EVENT_BUS_ADJUST:
+            adjust_mode = (adjustState_t)message->value;
+        break;
 
-    rtcTime_t realTime = rtcRead();
+        case EVENT_BUS_AUTOTUNE_GAIN:
+            if(message->value >= 0 and message->value < HEATER_MANAGER_GAINS){
+                autotune_gains[message->value] = message->detail;
+            }
+        break;
+
+        case EVENT_BUS_AUTOTUNE:
+            uartReportAutotune((heaterAutotuneState_t)message->value, message->detail);
+        break;
+
+        default:
+        break;
+    }
+}
+
+/**
+ * @brief Informa por UART un cambio de estado del sistema.
+ *
+ * Solo los cambios que se avisan; en telemetría binaria no envía nada, el estado va
+ * en cada trama.
+ *
+ * @param state Estado al que entró el sistema.
+ * @param previous Estado anterior.
+ */
+static void uartReportState(systemState_t state, systemState_t previous){
+
+    if(telemetry_mode != UART_TELEMETRY_TEXT){
+        return;
+    }
 
     switch (state){
         case SYSTEM_ON:
-            printf("*** Secadora de filamento encendida!.\n");
+            uartManagerPrint("*** Secadora de filamento encendida!.\n");
         break;
 
         case SYSTEM_STOP:    /**< Estado de sistema detenido */
-            if(previous_state == SYSTEM_WORK){
-                previous_state = SYSTEM_STOP;
 
-                printf("-> Secado detenido por el usuario, presione run para volver a secar\n");
+            // al terminar el encendido también se detiene, sin aviso
+            if(previous == SYSTEM_WORK){
+                uartManagerPrint("-> Secado detenido por el usuario, presione run para volver a secar\n");
             }
-
         break;
 
         case SYSTEM_WORK:    /**< Estado de sistema secando */
-            
-            if(previous_state == SYSTEM_STOP or previous_state == SYSTEM_FINISH){
-                previous_state = SYSTEM_WORK;
+            uartManagerPrint("-> Secado iniciado\n");
+        break;
 
-                printf("-> Secado iniciado\n");
-            }
+        case SYSTEM_FINISH:   /**< Estado de sistema secado finalizado */
+            uartManagerPrint("-> Secado finalizado, para volver a secar presione un boton\n");
+        break;
+
+        default:
+        break;
+    }
+}
 
-            // si hubo cambio de modo
-            if(previous_mode != mode){
+/**
+ * @brief Último valor publicado de un tema, 0 si todavía no se publicó.
+ *
+ * @param topic Tema.
+ * @param detail true para el dato secundario.
+ *
+ * @return int32_t Valor.
+ */
+static int32_t uartLast(eventBusTopic_t topic, const bool detail){
+    eventBusMessage_t message;
 
-                previous_mode = mode;
+    if(not eventBusLast(topic, &message)){
+        return 0;
+    }
 
-                switch (mode){
-                    case TIME:
-                        printf("-> Modo Tiempo\n");
-                    break;
-                    case TEMPERATURE:
-                        printf("-> Modo Temperatura\n");
-                    break;
-                }
-                
-            }
+    return detail ? message.detail : message.value;
+}
 
-            // si paso 1 segundo
-            if(previous_second != realTime.seconds){
-                previous_second = realTime.seconds;
+/**
+ * @brief Informa por UART un cambio de estado del autoajuste del PID.
+ *
+ * Solo con telemetría de texto; al terminar incluye el resultado recibido antes.
+ *
+ * @param state Estado del autoajuste.
+ * @param cycles Ciclos límite medidos.
+ */
+static void uartReportAutotune(heaterAutotuneState_t state, const int cycles){
 
-                // informa el estado de la maquina
-                printf("temperature_now: %d temperature_user: %d hour: %d  minutes: %d seconds: %d hour_user: %d heater: %d\n", temperatureSensorReadCelsius(), heaterGetTemperatureWork(), realTime.hours, realTime.minutes, realTime.seconds, activity_time, heaterStatus() );
-            }
+    if(telemetry_mode != UART_TELEMETRY_TEXT){
+        return;
+    }
+
+    switch (state){
+        case HEATER_AUTOTUNE_RUNNING:
+            uartManagerPrint("-> Autoajuste PID iniciado\n");
         break;
 
-        case SYSTEM_FINISH:   /**< Estado de sistema secado finalizado */
-            previous_state = SYSTEM_FINISH;
-            printf("-> Secado finalizado, para volver a secar presione un boton\n");
+        case HEATER_AUTOTUNE_DONE:
+            uartManagerPrint("-> Autoajuste PID finalizado, ciclos: ", cycles,
+                " ku: ", textFixed(autotune_gains[HEATER_MANAGER_KU], 2),
+                " tu: ", textFixed(autotune_gains[HEATER_MANAGER_TU], 2),
+                " kp: ", textFixed(autotune_gains[HEATER_MANAGER_KP], 2),
+                " ki: ", textFixed(autotune_gains[HEATER_MANAGER_KI], 2),
+                " kd: ", textFixed(autotune_gains[HEATER_MANAGER_KD], 2), "\n");
         break;
 
-        case SYSTEM_FINISH_AWAIT:
+        case HEATER_AUTOTUNE_FAILED:
+            uartManagerPrint("-> Autoajuste PID fallido, se vuelve a control ON/OFF\n");
         break;
 
         default:
         break;
     }
 }
-//=====[Implementations of private functions]===========================
\ No newline at end of file
+
+/**
+ * @brief Envía la trama binaria de estado.
+ */
+static void uartSendStatusFrame(){
+    telemetryStatus_t status;
+    uint8_t frame[TELEMETRY_FRAME_ENCODED_MAX(TELEMETRY_FRAME_STATUS_LENGTH)];
+
+    status.sequence = telemetry_sequence;
+    status.temperature_centi = uartLast(EVENT_BUS_TEMPERATURE, false);
+    status.setpoint = work_temperature;
+    status.elapsed_ms = (uint32_t)uartLast(EVENT_BUS_ELAPSED, false) * MS_PER_SECOND; // el tema tiene resolución de 1 s
+    status.target_hours = activity_time;
+    status.system_state = system_state;
+    status.adjust_mode = adjust_mode;
+    status.heater = uartLast(EVENT_BUS_HEATER, false);
+    status.output_percent = uartLast(EVENT_BUS_HEATER, true);
+
+    // la secuencia avanza aunque se descarte la trama, así el receptor ve la pérdida
+    telemetry_sequence = telemetry_sequence + 1;
+
+    uartManagerWrite((const char *)frame, telemetryFrameEncodeStatus(&status, frame));
+}
+
+/**
+ * @brief Habilita la interrupción de transmisión si no estaba corriendo.
+ */
+static void uartTxStart(){
+    bool start;
+
+    core_util_critical_section_enter();
+    start = not tx_active;
+    tx_active = true;
+    core_util_critical_section_exit();
+
+    // con el registro de datos vacío la interrupción se dispara enseguida
+    if(start){
+        uart->attach(uartTxIsr, SerialBase::TxIrq);
+    }
+}
+
+/**
+ * @brief Interrupción de transmisión, pasa bytes del buffer al periférico.
+ */
+static void uartTxIsr(){
+    uint8_t byte;
+
+    while(uart->writable()){
+
+        // sin datos se deshabilita hasta el próximo mensaje
+        if(not ringBufferReadByte(&tx_buffer, &byte)){
+            uart->attach(nullptr, SerialBase::TxIrq);
+            tx_active = false;
+            return;
+        }
+
+        uart->write(&byte, 1);
+    }
+}
+
+/**
+ * @brief Interrupción de recepción, pasa bytes del periférico al buffer.
+ */
+static void uartRxIsr(){
+    uint8_t byte;
+    uartRxWake_t wake = rx_wake;
+
+    // hay que leer el registro de datos siempre, si no la interrupción no se limpia
+    while(uart->readable()){
+        uart->read(&byte, 1);
+
+        if(ringBufferWrite(&rx_buffer, &byte, 1) == 0){
+            rx_overruns = rx_overruns + 1;
+        }
+    }
+
+    if(wake != nullptr){
+        wake();
+    }
+}
\ No newline at end of file
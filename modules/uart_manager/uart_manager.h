@@ -1,6 +1,6 @@
 /**
 * @file uart_manager.h
-* @brief Declaraciones de funciones para el manejo de XXXXX.
+* @brief Declaraciones de funciones para el manejo de alertas por UART.
 * @author Matias Leonardo Baez
 * @date 2024
 * @contact elmattprofe@gmail.com
@@ -12,16 +12,70 @@
 
 #include "mbed.h"
 #include "modules/filament_dryer_system/filament_dryer_system.h"
+#include "modules/text_format/text_format.h"
+#include "modules/event_bus/event_bus.h"
 
 //=====[Declaration of private defines]=================================
+// Si no esta declarado el tamaño del buffer de transmisión (potencia de 2)
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE 512
+#endif
+
+// Si no esta declarado el tamaño del buffer de recepción (potencia de 2)
+#ifndef UART_RX_BUFFER_SIZE
+#define UART_RX_BUFFER_SIZE 64
+#endif
+
+// Si no esta declarado el largo máximo de un mensaje formateado
+#ifndef UART_LINE_MAX
+#define UART_LINE_MAX   160
+#endif
+
+// Si no esta declarado el formato de telemetría con el que arranca
+#ifndef UART_TELEMETRY_DEFAULT
+#define UART_TELEMETRY_DEFAULT  UART_TELEMETRY_TEXT
+#endif
 
 //=====[Declaration of private data types]==============================
+/**
+ * @brief Qué hacer cuando un mensaje no entra en el buffer de transmisión.
+ */
+typedef enum{
+    UART_TX_DROP_NEWEST,    /**< Se descarta el mensaje nuevo completo */
+    UART_TX_OVERWRITE_OLDEST    /**< Se descartan los bytes más viejos pendientes */
+}uartTxPolicy_t;
+
+/**
+ * @brief Formato de la telemetría.
+ */
+typedef enum{
+    UART_TELEMETRY_TEXT,    /**< Líneas de texto con eventos y estado cada 1 segundo */
+    UART_TELEMETRY_BINARY   /**< Trama de estado binaria (telemetry_frame.h) en cada llamada a uartManagerUpdate(), periódica o por mensajes del bus */
+}uartTelemetryMode_t;
+
+/**
+ * @brief Contadores de la transmisión.
+ */
+typedef struct{
+    uint32_t queued_bytes;  /**< Bytes encolados */
+    uint32_t dropped_messages;  /**< Mensajes descartados por falta de lugar */
+    uint32_t dropped_bytes; /**< Bytes de los mensajes descartados */
+    uint32_t overwritten_bytes; /**< Bytes pendientes pisados por mensajes nuevos */
+    uint32_t high_water;    /**< Máxima ocupación del buffer */
+}uartTxStats_t;
+
+/**
+ * @brief Se llama (desde la interrupción de recepción) cuando llegaron bytes.
+ */
+typedef void (*uartRxWake_t)();
 
 //=====[Declaration (prototypes) of public functions]===================
 /**
  * @brief Inicializa la comunicación UART.
  * 
- * Configura los pines y la velocidad de la comunicación UART.
+ * Configura los pines y la velocidad de la comunicación UART. Se suscribe en el bus de
+ * eventos a los estados del sistema, los valores de secado, el modo de ajuste y el
+ * autoajuste, después de eventBusInit().
  * 
  * @param rxPin El pin de recepción UART.
  * @param txPin El pin de transmisión UART.
@@ -32,14 +86,114 @@ void uartManagerInit(PinName rxPin, PinName txPin, const int bauds);
 /**
  * @brief Informa el estado del sistema a través de UART.
  * 
- * Envía el estado actual del sistema, el modo de ajuste, y el tiempo de actividad 
- * a través de la comunicación UART.
- * 
- * @param state El estado actual del sistema.
- * @param mode El modo de ajuste actual (temperatura o tiempo).
- * @param activity_time El tiempo de actividad configurado para el sistema.
+ * Toma los mensajes del bus de eventos en orden: avisa los cambios de estado, de modo
+ * de ajuste y del autoajuste, y secando envía cada segundo la temperatura, el calentador
+ * y el tiempo transcurrido con los últimos valores publicados.
+ */
+void uartManagerUpdate();
+
+/**
+ * @brief Registra la función que avisa que llegaron mensajes del bus.
+ *
+ * @param wake Función a llamar, nullptr para quitarla.
+ */
+void uartManagerSetWake(eventBusWake_t wake);
+
+/**
+ * @brief Registra la función que avisa que llegaron bytes.
+ *
+ * Se llama desde la interrupción de recepción, debe ser breve. Permite leer los comandos
+ * al llegar en lugar de consultar el buffer periódicamente.
+ *
+ * @param wake Función a llamar, nullptr para quitarla.
+ */
+void uartManagerSetRxWake(uartRxWake_t wake);
+
+/**
+ * @brief Selecciona el formato de la telemetría.
+ *
+ * En binario no se envían los mensajes de texto, los eventos se deducen del estado de cada trama.
+ *
+ * @param mode Formato.
+ */
+void uartManagerSetTelemetryMode(uartTelemetryMode_t mode);
+
+/**
+ * @brief Formato actual de la telemetría.
+ *
+ * @return uartTelemetryMode_t Formato.
+ */
+uartTelemetryMode_t uartManagerGetTelemetryMode();
+
+/**
+ * @brief Encola bytes para transmitir sin bloquear.
+ *
+ * La interrupción de transmisión vacía el buffer; si el mensaje no entra se aplica
+ * la política configurada con uartManagerSetTxPolicy().
+ *
+ * @param data Bytes a transmitir.
+ * @param length Cantidad de bytes.
+ *
+ * @return int Bytes encolados (0 si se descartó el mensaje).
+ */
+int uartManagerWrite(const char *data, const int length);
+
+/**
+ * @brief Formatea y encola un mensaje sin bloquear.
+ *
+ * Usa textFormat() en lugar de printf: uartManagerPrint("temperatura: ", temperature, "\n").
+ *
+ * @param args Textos, caracteres, enteros y textFixed() en el orden en que se imprimen.
+ *
+ * @return int Bytes encolados (0 si se descartó el mensaje).
+ */
+template <typename... Args>
+int uartManagerPrint(const Args &... args){
+    char line[UART_LINE_MAX];
+
+    return uartManagerWrite(line, textFormat(line, sizeof(line), args...));
+}
+
+/**
+ * @brief Selecciona la política ante buffer lleno.
+ *
+ * @param policy Política de descarte.
+ */
+void uartManagerSetTxPolicy(uartTxPolicy_t policy);
+
+/**
+ * @brief Lugar libre en el buffer de transmisión.
+ *
+ * @return int Bytes que se pueden encolar sin descartar.
+ */
+int uartManagerGetTxFree();
+
+/**
+ * @brief Lee bytes recibidos sin bloquear.
+ *
+ * La interrupción de recepción los guarda en un buffer; los que llegan con el buffer
+ * lleno se pierden y se cuentan en uartManagerGetRxOverruns().
+ *
+ * @param data Destino.
+ * @param length Cantidad máxima de bytes.
+ *
+ * @return int Bytes leídos (0 si no hay).
+ */
+int uartManagerRead(char *data, const int length);
+
+/**
+ * @brief Bytes recibidos perdidos por buffer de recepción lleno.
+ *
+ * @return uint32_t Cantidad de bytes.
+ */
+uint32_t uartManagerGetRxOverruns();
+
+/**
+ * @brief Contadores de la transmisión.
+ *
+ * @return uartTxStats_t Bytes encolados, descartes y máxima ocupación.
  */
-void uartManagerUpdate(systemState_t state, adjustState_t mode, const int activity_time);
+uartTxStats_t uartManagerGetTxStats();
 
 //=====[#include guards - end]==========================================
 #endif
\ No newline at end of file